@@ -0,0 +1,44 @@
+#ifndef BML_ASYNCIO_HPP
+#define BML_ASYNCIO_HPP
+
+#include "bml/blockFile.hpp"
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <future>
+#include <string>
+
+namespace bml
+{
+    /**
+     * @brief Write a snapshot of @p m to @p path on a background thread.
+     *
+     * The snapshot shares @p m's cells (copy-on-write), so the call returns at once
+     * and the caller may keep modifying @p m; later writes detach and never reach the
+     * file. The file holds a 4 KiB header (shape, cell type, XXH64 of the payload)
+     * followed by the toByteStream() bytes, written through BlockFile while the next
+     * block is being filled and hashed. @p path is replaced only once the whole file
+     * is written.
+     *
+     * The future rethrows any I/O error.
+     */
+    template <typename T>
+    std::future<void> saveAsync(const Matrix<T>& m, const std::string& path,
+                                const AsyncIoOptions& options = AsyncIoOptions());
+
+    /**
+     * @brief Read a saveAsync() snapshot on a background thread.
+     *
+     * POD cells are read straight into the new matrix's buffer; std::string cells are
+     * decoded block by block as they arrive. The checksum is computed on each block
+     * while the following ones are still being read.
+     *
+     * The future throws std::runtime_error if the file cannot be read, was written for
+     * another cell type, or fails its checksum.
+     */
+    template <typename T>
+    std::future<Matrix<T>> loadAsync(const std::string& path,
+                                     const AsyncIoOptions& options = AsyncIoOptions());
+} // namespace bml
+
+#endif // BML_ASYNCIO_HPP
@@ -0,0 +1,119 @@
+#ifndef BML_BLOCKFILE_HPP
+#define BML_BLOCKFILE_HPP
+
+#include "bml/export.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace bml
+{
+    /// @brief How BlockFile issues its reads and writes.
+    enum class IoBackend
+    {
+        Auto,        ///< io_uring when the kernel allows it, otherwise ThreadPool
+        Uring,       ///< Linux io_uring; BlockFile throws if it is unavailable
+        ThreadPool   ///< blocking pread/pwrite on a small pool of I/O threads
+    };
+
+    struct AsyncIoOptions
+    {
+        IoBackend backend = IoBackend::Auto;
+        /// Bypass the page cache (O_DIRECT) where the filesystem supports it.
+        bool direct = true;
+        /// Bytes per request; rounded up to a multiple of BlockFile::kAlignment.
+        std::size_t blockBytes = std::size_t{4} << 20;
+        /// Requests kept in flight at once.
+        std::size_t queueDepth = 4;
+    };
+
+    /// @brief The backend IoBackend::Auto resolves to on this machine (never Auto).
+    BML_API IoBackend availableIoBackend() noexcept;
+
+    namespace detail
+    {
+        class IoQueue;
+    }
+
+    /**
+     * @brief A file read or written in large aligned blocks with several requests in flight.
+     *
+     * Data is handed to the caller (or taken from it) one block at a time, in file
+     * order, while the following blocks are still being transferred, so the caller's
+     * per-block work overlaps the I/O. Offsets and transfer sizes are multiples of
+     * kAlignment; a write pads its last block with zeros.
+     *
+     * Files opened for writing are created under a temporary name and only replace
+     * @p path on commit(); an uncommitted file is removed by the destructor.
+     * Errors are reported by throwing std::runtime_error.
+     */
+    class BML_API BlockFile
+    {
+    public:
+        /// @brief Offset, size and buffer alignment required for O_DIRECT transfers.
+        static constexpr std::size_t kAlignment = 4096;
+
+        enum class Mode
+        {
+            Read,
+            Write
+        };
+
+        BlockFile(const std::string& path, Mode mode, const AsyncIoOptions& options = AsyncIoOptions());
+        ~BlockFile();
+
+        BlockFile(const BlockFile&) = delete;
+        BlockFile& operator=(const BlockFile&) = delete;
+
+        /// @brief File size in bytes when opened for reading.
+        [[nodiscard]] std::uint64_t size() const noexcept { return fileSize; }
+
+        /// @brief True if the page cache is bypassed.
+        [[nodiscard]] bool direct() const noexcept { return directIo; }
+
+        /// @brief The backend actually in use (never Auto).
+        [[nodiscard]] IoBackend backend() const noexcept { return activeBackend; }
+
+        /**
+         * @brief Read @p length bytes starting at @p offset and pass them to @p consume in order.
+         *
+         * @p consume(bytes, n) runs on the calling thread once per block. Without
+         * @p destination the blocks land in internal buffers that are reused after
+         * @p consume returns. With @p destination (aligned to kAlignment, with room for
+         * @p length rounded up to kAlignment) each block is read straight into place.
+         *
+         * @throws std::runtime_error on I/O errors or if the file ends early.
+         */
+        void readBlocks(std::uint64_t offset, std::uint64_t length,
+                        const std::function<void(const std::uint8_t*, std::size_t)>& consume,
+                        std::uint8_t* destination = nullptr);
+
+        /**
+         * @brief Write @p length bytes at @p offset, asking @p produce(buffer, n) for each block in order.
+         *
+         * @p produce fills exactly @p n bytes while earlier blocks are being written.
+         */
+        void writeBlocks(std::uint64_t offset, std::uint64_t length,
+                         const std::function<void(std::uint8_t*, std::size_t)>& produce);
+
+        /// @brief Finish a written file and move it to its final path.
+        void commit();
+
+    private:
+        std::string path;
+        std::string tempPath;
+        int fd = -1;
+        bool directIo = false;
+        bool committed = false;
+        IoBackend activeBackend = IoBackend::ThreadPool;
+        std::size_t blockBytes = 0;
+        std::size_t queueDepth = 0;
+        std::uint64_t fileSize = 0;
+        std::unique_ptr<detail::IoQueue> queue;
+    };
+} // namespace bml
+
+#endif // BML_BLOCKFILE_HPP
@@ -6,6 +6,31 @@
 #include "bml/iterator.hpp"
 #include "bml/rowView.hpp"
 #include "bml/boolRef.hpp"
+#include "bml/fixedMatrix.hpp"
+#include "bml/sparse.hpp"
+#include "bml/gemm.hpp"
+#include "bml/gemv.hpp"
+#include "bml/matrixBatch.hpp"
+#include "bml/lazy.hpp"
+#include "bml/linalg.hpp"
+#include "bml/integerGemm.hpp"
+#include "bml/convolve.hpp"
+#include "bml/scan.hpp"
+#include "bml/parallel.hpp"
+#include "bml/dispatch.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/trace.hpp"
+#include "bml/memoryStats.hpp"
+#include "bml/hash.hpp"
+#include "bml/sink.hpp"
+#include "bml/source.hpp"
+#include "bml/byteStream.hpp"
+#include "bml/mappedFile.hpp"
+#include "bml/blockFile.hpp"
+#include "bml/asyncIo.hpp"
+#include "bml/csv.hpp"
+#include "bml/npy.hpp"
+#include "bml/codec.hpp"
 
 
 extern int testMatrix();
@@ -0,0 +1,52 @@
+#ifndef BML_BYTESTREAM_HPP
+#define BML_BYTESTREAM_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+
+namespace bml
+{
+    /**
+     * @brief Push-style reader for the toByteStream() format.
+     *
+     * Fills an already-shaped matrix from bytes as they arrive, in pieces of any
+     * size (e.g. whatever a non-blocking socket returned). POD cells are copied
+     * straight into the matrix buffer; std::string cells are NUL-terminated and
+     * appended to the cell in place.
+     *
+     * @note The target's buffer is detached once, at construction. Do not copy or
+     *       resize the target until the decoder is complete.
+     */
+    template <typename T>
+    class BML_API ByteStreamDecoder
+    {
+    public:
+        explicit ByteStreamDecoder(Matrix<T>& target);
+
+        /**
+         * @brief Consume bytes up to the end of the matrix.
+         * @return Bytes used; less than @p size only once the matrix is complete,
+         *         so the caller can hand the rest to whatever follows in the stream.
+         */
+        std::size_t feed(const void* bytes, std::size_t size);
+
+        [[nodiscard]] bool complete() const noexcept { return cellIndex == cellCount; }
+
+        /// @brief Cells fully written so far.
+        [[nodiscard]] std::size_t cellsDone() const noexcept { return cellIndex; }
+
+        /// @brief Throw std::runtime_error if the stream ended before the matrix was full.
+        void finish() const;
+
+    private:
+        typename Matrix<T>::storage_type* cells;
+        std::size_t cellCount;
+        std::size_t cellIndex = 0;
+        std::size_t partialBytes = 0;   // POD: bytes of cells[cellIndex] already written
+        bool inCell = false;            // std::string: cells[cellIndex] has been started
+    };
+} // namespace bml
+
+#endif // BML_BYTESTREAM_HPP
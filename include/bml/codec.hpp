@@ -0,0 +1,64 @@
+#ifndef BML_CODEC_HPP
+#define BML_CODEC_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bml
+{
+    /**
+     * @brief Compression scheme for encode().
+     *
+     * | Codec        | Types                        | Good for                                  |
+     * |--------------|------------------------------|-------------------------------------------|
+     * | None         | all POD                      | incompressible data (framing only)        |
+     * | Rle          | all POD (bit runs for bool)  | masks, piecewise-constant data            |
+     * | DeltaBitpack | integers and char            | sorted ids, counters, small integers      |
+     * | ShuffleLz    | all POD                      | smooth float fields, repetitive content   |
+     * | Gorilla      | float, double                | slowly varying series along the rows      |
+     */
+    enum class Codec : std::uint8_t
+    {
+        None = 0,
+        Rle = 1,
+        DeltaBitpack = 2,
+        ShuffleLz = 3,
+        Gorilla = 4
+    };
+
+    /// @brief True if @p codec can encode Matrix<T>.
+    template <typename T>
+    bool codecSupports(Codec codec) noexcept;
+
+    /**
+     * @brief Compress @p m into a self-describing byte stream.
+     *
+     * Cells are taken in row-major order and split into fixed-size chunks that are
+     * encoded independently on the worker pool; a chunk table in the header lets
+     * decode() work on the chunks in parallel too. The stream records the codec,
+     * the cell type and the shape.
+     *
+     * @throws std::invalid_argument if the codec does not support T.
+     */
+    template <typename T>
+    std::vector<std::uint8_t> encode(const Matrix<T>& m, Codec codec);
+
+    /**
+     * @brief Rebuild a matrix from encode() output.
+     * @throws std::runtime_error if the stream is malformed or was written for another cell type.
+     */
+    template <typename T>
+    Matrix<T> decode(const std::uint8_t* bytes, std::size_t size);
+
+    template <typename T>
+    Matrix<T> decode(const std::vector<std::uint8_t>& bytes)
+    {
+        return decode<T>(bytes.data(), bytes.size());
+    }
+} // namespace bml
+
+#endif // BML_CODEC_HPP
@@ -0,0 +1,120 @@
+#ifndef BML_CONVOLVE_HPP
+#define BML_CONVOLVE_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace bml
+{
+    /// @brief How cells outside the input are filled for convolution/correlation.
+    enum class BoundaryMode : std::uint8_t
+    {
+        Zero,      ///< 0 outside
+        Reflect,   ///< mirrored about the edge cell, which is not repeated: d c b | a b c d | c b a
+        Wrap       ///< periodic: c d | a b c d | a b
+    };
+
+    /// @brief Algorithm used by convolve2d()/correlate2d().
+    enum class ConvolutionMethod : std::uint8_t
+    {
+        Auto,        ///< Separable for rank-1 kernels, Direct up to 15x15 cells, Fft above
+        Direct,      ///< sliding window, O(kernel cells) per output
+        Separable,   ///< one row and one column pass; throws if the kernel has rank > 1
+        Gemm,        ///< im2col-style row windows times a banded kernel matrix, one GEMM per column tile
+        Fft          ///< overlap-save FFT tiles; cost nearly independent of kernel size
+    };
+
+    struct ConvolutionOptions
+    {
+        BoundaryMode boundary = BoundaryMode::Zero;
+        ConvolutionMethod method = ConvolutionMethod::Auto;
+    };
+
+    /**
+     * @brief 2D correlation with output the size of @p input:
+     *        out(i, j) = sum_uv kernel(u, v) * input(i + u - kr/2, j + v - kc/2),
+     * where kr x kc is the kernel shape and cells outside the input follow the
+     * boundary mode.
+     *
+     * ConvolutionMethod::Auto uses two 1D passes for rank-1 kernels, the direct
+     * window up to 15x15 kernels and FFT tiles for larger ones. All methods agree
+     * up to rounding. Work is spread over the worker pool.
+     *
+     * @throws std::invalid_argument if the kernel is empty.
+     * @tparam T float, double or long double.
+     */
+    template <typename T>
+    Matrix<T> correlate2d(const Matrix<T>& input, const Matrix<T>& kernel,
+                          const ConvolutionOptions& options = ConvolutionOptions());
+
+    /**
+     * @brief 2D convolution with output the size of @p input:
+     *        out(i, j) = sum_uv kernel(u, v) * input(i - u + kr/2, j - v + kc/2),
+     * i.e. correlation with the kernel rotated by 180 degrees.
+     */
+    template <typename T>
+    Matrix<T> convolve2d(const Matrix<T>& input, const Matrix<T>& kernel,
+                         const ConvolutionOptions& options = ConvolutionOptions());
+
+    /**
+     * @brief Row-at-a-time convolution for inputs that are produced or read in rows.
+     *
+     * Keeps only the first and the last kr rows (kr = kernel rows), so memory is
+     * O(kr * width) whatever the number of rows. Each output row is handed to the
+     * sink as soon as the input rows it depends on have been pushed; finish()
+     * emits the rows that depend on the bottom boundary. With BoundaryMode::Wrap
+     * the top kr/2 output rows depend on the last input rows and are emitted from
+     * finish() too, after the others. Results match convolve2d()/correlate2d()
+     * with the same kernel and boundary.
+     */
+    template <typename T>
+    class BML_API StreamingConvolver
+    {
+    public:
+        /// @brief Receives (output row index, pointer to width values).
+        using RowSink = std::function<void(std::uint32_t row, const T* values)>;
+
+        /// @param correlate Correlate instead of convolve (the kernel is not rotated).
+        StreamingConvolver(const Matrix<T>& kernel, std::uint32_t width, RowSink sink,
+                           BoundaryMode boundary = BoundaryMode::Zero, bool correlate = false);
+
+        /// @brief Append one input row of width() values.
+        void push(const T* row);
+        void push(const std::vector<T>& row);
+        /// @brief Emit the remaining rows; no rows may be pushed afterwards.
+        void finish();
+
+        [[nodiscard]] std::uint32_t width() const noexcept { return cols; }
+        [[nodiscard]] std::uint32_t rowsPushed() const noexcept { return received; }
+
+    private:
+        [[nodiscard]] bool ready(std::uint32_t row) const noexcept;
+        [[nodiscard]] const T* sourceRow(std::int64_t index) const noexcept;
+        void emit(std::uint32_t row);
+
+        std::uint32_t cols;
+        std::size_t kernelRows;
+        std::size_t kernelCols;
+        std::size_t anchorRow;
+        std::size_t anchorCol;
+        std::vector<T> taps;          // kernel in correlation orientation
+        RowSink sink;
+        BoundaryMode boundary;
+        std::size_t stride;           // padded row length
+        std::vector<T> head;          // the first kernelRows rows, padded
+        std::vector<T> ring;          // the last kernelRows rows, padded
+        std::vector<T> zeros;
+        std::vector<T> output;
+        std::vector<const T*> window;
+        std::uint32_t received = 0;
+        std::uint32_t nextOut = 0;
+        bool finished = false;
+    };
+} // namespace bml
+
+#endif // BML_CONVOLVE_HPP
@@ -0,0 +1,63 @@
+#ifndef BML_CSV_HPP
+#define BML_CSV_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace bml
+{
+    /**
+     * @brief Dialect for readCsv() / parseCsv().
+     *
+     * One line is one matrix row; every non-empty line must have the same number
+     * of fields. Empty lines are skipped and "\r\n" line ends are accepted.
+     * Quoted fields ("a, b" with "" for a literal quote) may contain the delimiter
+     * but not a line break.
+     */
+    struct CsvOptions
+    {
+        char delimiter = ',';
+
+        /// Leading lines to ignore, e.g. 1 for a header row.
+        std::size_t skipRows = 0;
+
+        /// Honour double-quoted fields.
+        bool quoted = true;
+
+        /// Ignore spaces and tabs around each field (unless the delimiter is one of them).
+        bool trimSpaces = true;
+
+        /// Tab-separated values with otherwise default settings.
+        static CsvOptions tsv()
+        {
+            CsvOptions o;
+            o.delimiter = '\t';
+            return o;
+        }
+    };
+
+    /**
+     * @brief Parse delimited text into a new matrix.
+     *
+     * The text is split into newline-aligned chunks that are parsed in parallel
+     * (std::from_chars for numbers), after a counting pass that fixes the shape so
+     * every chunk writes straight into the matrix buffer. Integers and floats accept
+     * an optional leading '+'; bool accepts 0/1/true/false (any case); char cells
+     * must be exactly one character.
+     *
+     * @throws std::runtime_error on ragged rows or a cell that does not parse as T;
+     *         the message names the data row and column (both 0-based).
+     */
+    template <typename T>
+    Matrix<T> parseCsv(std::string_view text, const CsvOptions& options = CsvOptions());
+
+    /// @brief Memory-map @p path and parse it with parseCsv().
+    template <typename T>
+    Matrix<T> readCsv(const std::string& path, const CsvOptions& options = CsvOptions());
+} // namespace bml
+
+#endif // BML_CSV_HPP
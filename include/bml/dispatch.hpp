@@ -0,0 +1,51 @@
+#ifndef BML_DISPATCH_HPP
+#define BML_DISPATCH_HPP
+
+#include "bml/export.hpp"
+
+namespace bml
+{
+    /**
+     * @brief Whether the hot kernels were built for several x86-64 levels
+     * (CMake option BML_ENABLE_MULTIVERSIONING, GCC on x86-64 ELF targets).
+     */
+    BML_API bool multiversioningCompiledIn() noexcept;
+
+    /**
+     * @brief The instruction set level whose kernels run on this machine:
+     * "x86-64-v4", "x86-64-v3", "x86-64-v2", or "default" for the baseline
+     * build (also what a library without multiversioning reports).
+     *
+     * The choice is made once per kernel when the library is loaded; every
+     * level rounds floating-point results the same way.
+     */
+    BML_API const char* kernelIsa() noexcept;
+} // namespace bml
+
+/**
+ * @brief Put before a kernel definition to compile it once per x86-64 level;
+ * an ifunc resolver binds the best clone the CPU supports at load time.
+ *
+ * Meant for leaf loops: lambdas and callees inside the kernel are not cloned.
+ * Expands to nothing unless BML_MULTIVERSIONING is defined to 1, which the
+ * library build does when BML_ENABLE_MULTIVERSIONING is ON and supported.
+ */
+#if defined(BML_MULTIVERSIONING) && BML_MULTIVERSIONING
+    #define BML_HOT_KERNEL \
+        __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "arch=x86-64-v2", "default")))
+#else
+    #define BML_HOT_KERNEL
+#endif
+
+/**
+ * @brief Marks kernel pointer parameters that do not alias one another. At -O2
+ * the vectorizer will not add run-time overlap checks, so loops that store
+ * through one pointer and load through another stay scalar without it.
+ */
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+    #define BML_RESTRICT __restrict
+#else
+    #define BML_RESTRICT
+#endif
+
+#endif // BML_DISPATCH_HPP
@@ -0,0 +1,476 @@
+#ifndef BML_FIXEDMATRIX_HPP
+#define BML_FIXEDMATRIX_HPP
+
+#include "bml/matrix.hpp"
+#include "bml/typeTraits.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace bml
+{
+    /**
+     * @brief Dense matrix whose shape is a compile-time constant.
+     *
+     * Storage is a row-major @c std::array, so a FixedMatrix is trivially copyable,
+     * lives on the stack and every loop bound is known to the compiler. Element-wise
+     * operators and the products below are expanded over @c std::index_sequence, so
+     * small shapes (4x4 transforms, 6x6 covariances) compile to straight-line code.
+     *
+     * Semantics mirror Matrix<T>: @c operator* is element-wise; use bml::matmul()
+     * for the matrix product.
+     *
+     * @tparam T Element type (any math-arithmetic T; bool/char excluded).
+     * @tparam R Number of rows.
+     * @tparam C Number of columns.
+     */
+    template <typename T, std::size_t R, std::size_t C>
+    class FixedMatrix
+    {
+        static_assert(bml_is_math_arithmetic<T>::value,
+                      "bml::FixedMatrix<T,R,C>: T must be a math-arithmetic type");
+        static_assert(R > 0 && C > 0, "bml::FixedMatrix<T,R,C>: R and C must be non-zero");
+
+    public:
+        using value_type = T;
+
+        static constexpr std::size_t Rows = R;
+        static constexpr std::size_t Cols = C;
+        static constexpr std::size_t Size = R * C;
+
+    private:
+        std::array<T, Size> values{};
+
+        using Indices = std::make_index_sequence<Size>;
+
+        template <typename F, std::size_t... I>
+        static constexpr FixedMatrix generate(F&& f, std::index_sequence<I...>)
+        {
+            FixedMatrix out;
+            ((out.values[I] = f(I)), ...);
+            return out;
+        }
+
+        template <typename F, std::size_t... I>
+        constexpr void apply(F&& f, std::index_sequence<I...>)
+        {
+            (f(values[I], I), ...);
+        }
+
+    public:
+        /// @brief Zero-initialised matrix.
+        constexpr FixedMatrix() noexcept = default;
+
+        /// @brief Matrix with every element set to @p value.
+        constexpr explicit FixedMatrix(const T& value) noexcept
+        {
+            fill(value);
+        }
+
+        /**
+         * @brief Construct from row-major values.
+         * @pre @p init has exactly R*C elements.
+         */
+        constexpr FixedMatrix(const std::array<T, Size>& init) noexcept : values(init) {}
+
+        /**
+         * @brief Copy the contents of a runtime-shaped matrix.
+         * @throws std::invalid_argument if the shape of @p m is not R x C.
+         */
+        explicit FixedMatrix(const Matrix<T>& m)
+        {
+            if (m.numRows() != R || m.numCols() != C)
+                throw std::invalid_argument("FixedMatrix: source shape does not match R x C.");
+            for (std::size_t r = 0; r < R; ++r)
+            {
+                const auto row = m[static_cast<std::uint32_t>(r)];
+                const T* src = row.begin();
+                for (std::size_t c = 0; c < C; ++c)
+                    values[r * C + c] = src[c];
+            }
+        }
+
+        /// @brief Copy into a runtime-shaped Matrix<T>.
+        [[nodiscard]] Matrix<T> toMatrix() const
+        {
+            Matrix<T> out(static_cast<std::uint32_t>(R), static_cast<std::uint32_t>(C));
+            for (std::size_t r = 0; r < R; ++r)
+            {
+                auto row = out[static_cast<std::uint32_t>(r)];
+                T* dst = row.begin();
+                for (std::size_t c = 0; c < C; ++c)
+                    dst[c] = values[r * C + c];
+            }
+            return out;
+        }
+
+        /// @brief Identity matrix (square shapes only).
+        template <std::size_t RR = R, std::size_t CC = C>
+        static constexpr std::enable_if_t<RR == CC, FixedMatrix> identity() noexcept
+        {
+            return generate([](std::size_t i) { return (i / C == i % C) ? T{1} : T{0}; }, Indices{});
+        }
+
+        // ---- shape ----
+        [[nodiscard]] static constexpr std::size_t numRows() noexcept { return R; }
+        [[nodiscard]] static constexpr std::size_t numCols() noexcept { return C; }
+        [[nodiscard]] static constexpr std::size_t size() noexcept { return Size; }
+
+        // ---- element access (unchecked; the shape is static) ----
+        constexpr T& operator()(std::size_t r, std::size_t c) noexcept { return values[r * C + c]; }
+        constexpr const T& operator()(std::size_t r, std::size_t c) const noexcept { return values[r * C + c]; }
+
+        /// @brief Row pointer, so that @c m[r][c] works as it does for Matrix<T>.
+        constexpr T* operator[](std::size_t r) noexcept { return values.data() + r * C; }
+        constexpr const T* operator[](std::size_t r) const noexcept { return values.data() + r * C; }
+
+        constexpr T* data() noexcept { return values.data(); }
+        constexpr const T* data() const noexcept { return values.data(); }
+
+        constexpr void fill(const T& value) noexcept
+        {
+            apply([&](T& cell, std::size_t) { cell = value; }, Indices{});
+        }
+
+        // ---- element-wise arithmetic ----
+        constexpr FixedMatrix operator+(const FixedMatrix& o) const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(values[i] + o.values[i]); }, Indices{});
+        }
+        constexpr FixedMatrix operator-(const FixedMatrix& o) const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(values[i] - o.values[i]); }, Indices{});
+        }
+        constexpr FixedMatrix operator*(const FixedMatrix& o) const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(values[i] * o.values[i]); }, Indices{});
+        }
+        constexpr FixedMatrix operator/(const FixedMatrix& o) const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(values[i] / o.values[i]); }, Indices{});
+        }
+
+        constexpr FixedMatrix operator+(const T& s) const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(values[i] + s); }, Indices{});
+        }
+        constexpr FixedMatrix operator-(const T& s) const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(values[i] - s); }, Indices{});
+        }
+        constexpr FixedMatrix operator*(const T& s) const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(values[i] * s); }, Indices{});
+        }
+        constexpr FixedMatrix operator/(const T& s) const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(values[i] / s); }, Indices{});
+        }
+
+        constexpr FixedMatrix operator-() const noexcept
+        {
+            return generate([&](std::size_t i) { return static_cast<T>(-values[i]); }, Indices{});
+        }
+
+        constexpr FixedMatrix& operator+=(const FixedMatrix& o) noexcept
+        {
+            apply([&](T& cell, std::size_t i) { cell += o.values[i]; }, Indices{});
+            return *this;
+        }
+        constexpr FixedMatrix& operator-=(const FixedMatrix& o) noexcept
+        {
+            apply([&](T& cell, std::size_t i) { cell -= o.values[i]; }, Indices{});
+            return *this;
+        }
+        constexpr FixedMatrix& operator*=(const FixedMatrix& o) noexcept
+        {
+            apply([&](T& cell, std::size_t i) { cell *= o.values[i]; }, Indices{});
+            return *this;
+        }
+        constexpr FixedMatrix& operator/=(const FixedMatrix& o) noexcept
+        {
+            apply([&](T& cell, std::size_t i) { cell /= o.values[i]; }, Indices{});
+            return *this;
+        }
+        constexpr FixedMatrix& operator+=(const T& s) noexcept
+        {
+            apply([&](T& cell, std::size_t) { cell += s; }, Indices{});
+            return *this;
+        }
+        constexpr FixedMatrix& operator-=(const T& s) noexcept
+        {
+            apply([&](T& cell, std::size_t) { cell -= s; }, Indices{});
+            return *this;
+        }
+        constexpr FixedMatrix& operator*=(const T& s) noexcept
+        {
+            apply([&](T& cell, std::size_t) { cell *= s; }, Indices{});
+            return *this;
+        }
+        constexpr FixedMatrix& operator/=(const T& s) noexcept
+        {
+            apply([&](T& cell, std::size_t) { cell /= s; }, Indices{});
+            return *this;
+        }
+
+        // ---- reductions ----
+        [[nodiscard]] constexpr T sum() const noexcept
+        {
+            T s{0};
+            for (std::size_t i = 0; i < Size; ++i) s += values[i];
+            return s;
+        }
+        [[nodiscard]] constexpr T min() const noexcept
+        {
+            T m = values[0];
+            for (std::size_t i = 1; i < Size; ++i) if (values[i] < m) m = values[i];
+            return m;
+        }
+        [[nodiscard]] constexpr T max() const noexcept
+        {
+            T m = values[0];
+            for (std::size_t i = 1; i < Size; ++i) if (values[i] > m) m = values[i];
+            return m;
+        }
+
+        friend constexpr bool operator==(const FixedMatrix& a, const FixedMatrix& b) noexcept
+        {
+            for (std::size_t i = 0; i < Size; ++i)
+                if (!(a.values[i] == b.values[i])) return false;
+            return true;
+        }
+        friend constexpr bool operator!=(const FixedMatrix& a, const FixedMatrix& b) noexcept
+        {
+            return !(a == b);
+        }
+    };
+
+    // ======================= Products / shape ops =======================
+
+    namespace detail
+    {
+        template <typename T, std::size_t R, std::size_t K, std::size_t C, std::size_t... I>
+        constexpr void fixedMatmulRow(const FixedMatrix<T, R, K>& a, const FixedMatrix<T, K, C>& b,
+                                      FixedMatrix<T, R, C>& out, std::size_t r,
+                                      std::index_sequence<I...>) noexcept
+        {
+            // out[r][:] = sum_k a[r][k] * b[k][:]  — axpy form keeps the inner loop contiguous
+            for (std::size_t k = 0; k < K; ++k)
+            {
+                const T s = a(r, k);
+                ((out(r, I) += s * b(k, I)), ...);
+            }
+        }
+
+        template <typename T>
+        constexpr T fixedAbs(const T& v) noexcept
+        {
+            return v < T{0} ? -v : v;
+        }
+    }
+
+    /// @brief Matrix product of two fixed-shape matrices (inner dimensions checked at compile time).
+    template <typename T, std::size_t R, std::size_t K, std::size_t C>
+    constexpr FixedMatrix<T, R, C> matmul(const FixedMatrix<T, R, K>& a, const FixedMatrix<T, K, C>& b) noexcept
+    {
+        FixedMatrix<T, R, C> out;
+        for (std::size_t r = 0; r < R; ++r)
+            detail::fixedMatmulRow(a, b, out, r, std::make_index_sequence<C>{});
+        return out;
+    }
+
+    template <typename T, std::size_t R, std::size_t C>
+    constexpr FixedMatrix<T, C, R> transpose(const FixedMatrix<T, R, C>& m) noexcept
+    {
+        FixedMatrix<T, C, R> out;
+        for (std::size_t r = 0; r < R; ++r)
+            for (std::size_t c = 0; c < C; ++c)
+                out(c, r) = m(r, c);
+        return out;
+    }
+
+    /**
+     * @brief Determinant of a square fixed-shape matrix.
+     *
+     * Closed forms are used up to 4x4. Larger integral matrices use Bareiss'
+     * fraction-free elimination (exact); larger floating matrices use Gaussian
+     * elimination with partial pivoting.
+     */
+    template <typename T, std::size_t N>
+    constexpr T determinant(const FixedMatrix<T, N, N>& m) noexcept
+    {
+        if constexpr (N == 1)
+        {
+            return m(0, 0);
+        }
+        else if constexpr (N == 2)
+        {
+            return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+        }
+        else if constexpr (N == 3)
+        {
+            return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1))
+                 - m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0))
+                 + m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+        }
+        else if constexpr (N == 4)
+        {
+            // 2x2 minors of the bottom two rows, shared by all four cofactors
+            const T s0 = m(2, 0) * m(3, 1) - m(2, 1) * m(3, 0);
+            const T s1 = m(2, 0) * m(3, 2) - m(2, 2) * m(3, 0);
+            const T s2 = m(2, 0) * m(3, 3) - m(2, 3) * m(3, 0);
+            const T s3 = m(2, 1) * m(3, 2) - m(2, 2) * m(3, 1);
+            const T s4 = m(2, 1) * m(3, 3) - m(2, 3) * m(3, 1);
+            const T s5 = m(2, 2) * m(3, 3) - m(2, 3) * m(3, 2);
+            return m(0, 0) * (m(1, 1) * s5 - m(1, 2) * s4 + m(1, 3) * s3)
+                 - m(0, 1) * (m(1, 0) * s5 - m(1, 2) * s2 + m(1, 3) * s1)
+                 + m(0, 2) * (m(1, 0) * s4 - m(1, 1) * s2 + m(1, 3) * s0)
+                 - m(0, 3) * (m(1, 0) * s3 - m(1, 1) * s1 + m(1, 2) * s0);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            FixedMatrix<T, N, N> a = m;
+            T sign{1};
+            T prev{1};
+            for (std::size_t k = 0; k + 1 < N; ++k)
+            {
+                if (a(k, k) == T{0})
+                {
+                    std::size_t p = k + 1;
+                    while (p < N && a(p, k) == T{0}) ++p;
+                    if (p == N) return T{0};
+                    for (std::size_t j = 0; j < N; ++j)
+                    {
+                        const T t = a(k, j); a(k, j) = a(p, j); a(p, j) = t;
+                    }
+                    sign = static_cast<T>(-sign);
+                }
+                for (std::size_t i = k + 1; i < N; ++i)
+                    for (std::size_t j = k + 1; j < N; ++j)
+                        a(i, j) = static_cast<T>((a(i, j) * a(k, k) - a(i, k) * a(k, j)) / prev);
+                prev = a(k, k);
+            }
+            return static_cast<T>(sign * a(N - 1, N - 1));
+        }
+        else
+        {
+            FixedMatrix<T, N, N> a = m;
+            T det{1};
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                std::size_t p = k;
+                for (std::size_t i = k + 1; i < N; ++i)
+                    if (detail::fixedAbs(a(i, k)) > detail::fixedAbs(a(p, k))) p = i;
+                if (a(p, k) == T{0}) return T{0};
+                if (p != k)
+                {
+                    for (std::size_t j = 0; j < N; ++j)
+                    {
+                        const T t = a(k, j); a(k, j) = a(p, j); a(p, j) = t;
+                    }
+                    det = -det;
+                }
+                det *= a(k, k);
+                for (std::size_t i = k + 1; i < N; ++i)
+                {
+                    const T f = a(i, k) / a(k, k);
+                    for (std::size_t j = k + 1; j < N; ++j)
+                        a(i, j) -= f * a(k, j);
+                }
+            }
+            return det;
+        }
+    }
+
+    /**
+     * @brief Inverse of a square fixed-shape floating-point matrix.
+     *
+     * Uses the adjugate for 2x2/3x3 and Gauss-Jordan elimination with partial
+     * pivoting otherwise.
+     * @throws std::runtime_error if the matrix is singular.
+     */
+    template <typename T, std::size_t N>
+    FixedMatrix<T, N, N> inverse(const FixedMatrix<T, N, N>& m)
+    {
+        static_assert(std::is_floating_point_v<T>, "bml::inverse(FixedMatrix): T must be floating point");
+
+        if constexpr (N == 2 || N == 3)
+        {
+            const T det = determinant(m);
+            if (det == T{0})
+                throw std::runtime_error("FixedMatrix::inverse() on singular matrix.");
+            const T inv = T{1} / det;
+            FixedMatrix<T, N, N> out;
+            if constexpr (N == 2)
+            {
+                out(0, 0) =  m(1, 1) * inv; out(0, 1) = -m(0, 1) * inv;
+                out(1, 0) = -m(1, 0) * inv; out(1, 1) =  m(0, 0) * inv;
+            }
+            else
+            {
+                out(0, 0) = (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1)) * inv;
+                out(0, 1) = (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * inv;
+                out(0, 2) = (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * inv;
+                out(1, 0) = (m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2)) * inv;
+                out(1, 1) = (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * inv;
+                out(1, 2) = (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * inv;
+                out(2, 0) = (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0)) * inv;
+                out(2, 1) = (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * inv;
+                out(2, 2) = (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * inv;
+            }
+            return out;
+        }
+        else
+        {
+            FixedMatrix<T, N, N> a = m;
+            FixedMatrix<T, N, N> out = FixedMatrix<T, N, N>::identity();
+            for (std::size_t k = 0; k < N; ++k)
+            {
+                std::size_t p = k;
+                for (std::size_t i = k + 1; i < N; ++i)
+                    if (detail::fixedAbs(a(i, k)) > detail::fixedAbs(a(p, k))) p = i;
+                if (a(p, k) == T{0})
+                    throw std::runtime_error("FixedMatrix::inverse() on singular matrix.");
+                if (p != k)
+                {
+                    for (std::size_t j = 0; j < N; ++j)
+                    {
+                        T t = a(k, j); a(k, j) = a(p, j); a(p, j) = t;
+                        t = out(k, j); out(k, j) = out(p, j); out(p, j) = t;
+                    }
+                }
+                const T invPivot = T{1} / a(k, k);
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    a(k, j) *= invPivot;
+                    out(k, j) *= invPivot;
+                }
+                for (std::size_t i = 0; i < N; ++i)
+                {
+                    if (i == k) continue;
+                    const T f = a(i, k);
+                    if (f == T{0}) continue;
+                    for (std::size_t j = 0; j < N; ++j)
+                    {
+                        a(i, j) -= f * a(k, j);
+                        out(i, j) -= f * out(k, j);
+                    }
+                }
+            }
+            return out;
+        }
+    }
+
+    // Handy aliases for the common small shapes.
+    template <typename T> using FixedMatrix2 = FixedMatrix<T, 2, 2>;
+    template <typename T> using FixedMatrix3 = FixedMatrix<T, 3, 3>;
+    template <typename T> using FixedMatrix4 = FixedMatrix<T, 4, 4>;
+    template <typename T> using FixedMatrix6 = FixedMatrix<T, 6, 6>;
+
+} // namespace bml
+
+#endif // BML_FIXEDMATRIX_HPP
@@ -0,0 +1,34 @@
+#ifndef BML_GEMM_HPP
+#define BML_GEMM_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+
+namespace bml
+{
+    /**
+     * @brief General matrix multiply on row-major buffers: C = alpha * op(A) * op(B) + beta * C.
+     *
+     * op(A) is m x k and op(B) is k x n; @p transA / @p transB select the transpose
+     * of the stored matrix (A is then stored k x m, B n x k). @p lda, @p ldb and
+     * @p ldc are the row strides in elements, so sub-blocks of larger matrices can
+     * be passed directly. C must not overlap A or B. With beta == 0, C is
+     * overwritten without being read.
+     *
+     * Panels of A and B are packed into cache-sized blocks and multiplied by a
+     * register-tiled micro-kernel; row/column blocks of C are spread over the
+     * worker pool. Tiny products use a plain loop.
+     */
+    template <typename T>
+    void gemm(bool transA, bool transB, std::size_t m, std::size_t n, std::size_t k,
+              T alpha, const T* a, std::size_t lda, const T* b, std::size_t ldb,
+              T beta, T* c, std::size_t ldc);
+
+    /// @brief Matrix product a * b (Matrix::operator* is element-wise).
+    template <typename T>
+    Matrix<T> matmul(const Matrix<T>& a, const Matrix<T>& b);
+} // namespace bml
+
+#endif // BML_GEMM_HPP
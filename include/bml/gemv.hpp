@@ -0,0 +1,85 @@
+#ifndef BML_GEMV_HPP
+#define BML_GEMV_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace bml
+{
+    /// @brief Activation applied by a GEMV epilogue.
+    enum class Activation
+    {
+        None,
+        Relu,       ///< max(v, 0)
+        Clamp,      ///< min(max(v, clampLow), clampHigh)
+        Sigmoid     ///< 1 / (1 + exp(-v)); floating-point types only
+    };
+
+    /**
+     * @brief What a GEMV does with each dot product before storing it:
+     *        y[i] = activation(scale * dot_i + bias[i]).
+     *
+     * @p bias is not owned and must hold one value per output (or be null).
+     * Integer types compute in T with its usual wrap-around.
+     */
+    template <typename T>
+    struct GemvEpilogue
+    {
+        T scale = T{1};
+        const T* bias = nullptr;
+        Activation activation = Activation::None;
+        T clampLow = T{0};
+        T clampHigh = T{0};
+    };
+
+    /**
+     * @brief Matrix-vector product on a row-major buffer with a fused epilogue:
+     *        y = epilogue(op(A) * x).
+     *
+     * op(A) is m x n, stored m x n (or n x m when @p transA) with row stride
+     * @p lda; x has n entries and y receives m. y must not overlap A or x.
+     *
+     * Without transpose each output is a dot product over a row of A, computed
+     * in several independent partial sums so it vectorizes; rows are split over
+     * the worker pool. The partial sums make floating-point results differ from
+     * a left-to-right loop in the last bits. With transpose, rows of A are
+     * accumulated into column blocks of y, one block per task, in row order.
+     * Either way A is read once and the epilogue runs while y is in registers
+     * or L1, so no extra pass is made over the result.
+     *
+     * @throws std::invalid_argument for a sigmoid epilogue on an integer type.
+     */
+    template <typename T>
+    void gemv(bool transA, std::size_t m, std::size_t n, const T* a, std::size_t lda,
+              const T* x, T* y, const GemvEpilogue<T>& epilogue = {});
+
+    /// @brief epilogue(a * x); x.size() must equal a.numCols().
+    template <typename T>
+    std::vector<T> matvec(const Matrix<T>& a, const std::vector<T>& x, const GemvEpilogue<T>& epilogue = {});
+
+    /**
+     * @brief epilogue(a * x) for a column (numCols x 1) or row (1 x numCols) vector @p x;
+     * the result has the orientation of @p x.
+     */
+    template <typename T>
+    Matrix<T> matvec(const Matrix<T>& a, const Matrix<T>& x, const GemvEpilogue<T>& epilogue = {});
+
+    /// @brief epilogue(x^T * a), one output per column of @p a; x.size() must equal a.numRows().
+    template <typename T>
+    std::vector<T> vecmat(const std::vector<T>& x, const Matrix<T>& a, const GemvEpilogue<T>& epilogue = {});
+
+    /**
+     * @brief matvec() of every row of @p xs against one @p a: row b of the result is
+     * epilogue(a * xs.row(b)), so xs is batch x a.numCols() and the result batch x a.numRows().
+     *
+     * Each task holds a block of rows of A in cache and streams the batch past
+     * it, four vectors at a time, so A is read from memory once.
+     */
+    template <typename T>
+    Matrix<T> matvecBatch(const Matrix<T>& a, const Matrix<T>& xs, const GemvEpilogue<T>& epilogue = {});
+} // namespace bml
+
+#endif // BML_GEMV_HPP
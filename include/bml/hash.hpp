@@ -0,0 +1,70 @@
+#ifndef BML_HASH_HPP
+#define BML_HASH_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace bml
+{
+    /**
+     * @brief Streaming 64-bit non-cryptographic hash (the XXH64 algorithm).
+     *
+     * Feeding the same bytes in any split across update() calls yields the same digest,
+     * and the digest matches the reference XXH64 for the same seed.
+     */
+    class BML_API Hasher64
+    {
+    public:
+        explicit Hasher64(std::uint64_t seed = 0) noexcept;
+
+        /// @brief Append @p size bytes to the hashed stream.
+        void update(const void* bytes, std::size_t size) noexcept;
+
+        /// @brief Hash of everything appended so far (does not reset the state).
+        [[nodiscard]] std::uint64_t digest() const noexcept;
+
+    private:
+        std::uint64_t acc[4];
+        std::uint64_t seed;
+        std::uint64_t totalLength = 0;
+        unsigned char pending[32];
+        std::size_t pendingSize = 0;
+    };
+
+    /// @brief One-shot XXH64 of a byte range.
+    BML_API std::uint64_t hashBytes(const void* bytes, std::size_t size, std::uint64_t seed = 0) noexcept;
+
+    /**
+     * @brief Content hash of a matrix (shape and cells).
+     *
+     * Consistent with operator==: matrices that compare equal hash equally. In
+     * particular bool cells are hashed as 0/1, -0.0 hashes like 0.0, and the
+     * padding bytes of long double are ignored.
+     */
+    template <typename T>
+    std::uint64_t hash(const Matrix<T>& m, std::uint64_t seed = 0);
+
+    /// @brief Hash functor for unordered containers keyed by Matrix<T>.
+    template <typename T>
+    struct MatrixHash
+    {
+        std::size_t operator()(const Matrix<T>& m) const
+        {
+            return static_cast<std::size_t>(bml::hash(m));
+        }
+    };
+} // namespace bml
+
+namespace std
+{
+    template <typename T>
+    struct hash<bml::Matrix<T>> : bml::MatrixHash<T>
+    {
+    };
+}
+
+#endif // BML_HASH_HPP
@@ -0,0 +1,71 @@
+#ifndef BML_INTEGER_GEMM_HPP
+#define BML_INTEGER_GEMM_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bml
+{
+    /// @brief Accumulator of the widened integer GEMM: int32 for 8-bit cells, int64 for int16.
+    template <typename T>
+    struct widened_accumulator;
+    template <>
+    struct widened_accumulator<std::int8_t> { using type = std::int32_t; };
+    template <>
+    struct widened_accumulator<std::uint8_t> { using type = std::int32_t; };
+    template <>
+    struct widened_accumulator<std::int16_t> { using type = std::int64_t; };
+
+    template <typename T>
+    using widened_accumulator_t = typename widened_accumulator<T>::type;
+
+    /**
+     * @brief Integer GEMM on row-major buffers with widened accumulation:
+     *        C = op(A) * op(B), or C += op(A) * op(B) when @p accumulate.
+     *
+     * Products and sums are formed in widened_accumulator_t<T>, so no element-type
+     * overflow happens. Results are exact while every partial sum fits: for 8-bit
+     * cells that is k < 2^31 / max|a*b| (131072 for int8, 33025 for uint8).
+     *
+     * The kernel is picked once at run time: AVX-512 VNNI (int8), AVX2
+     * (int8/uint8) or portable code; int16 always uses the portable kernel. The
+     * SIMD kernels take operands packed in groups of four consecutive k values,
+     * the layout the x86 multiply-add instructions consume. Blocks of C are spread
+     * over the worker pool.
+     */
+    template <typename T>
+    void gemmWidened(bool transA, bool transB, std::size_t m, std::size_t n, std::size_t k,
+                     const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                     widened_accumulator_t<T>* c, std::size_t ldc, bool accumulate = false);
+
+    /**
+     * @brief Widened product (a - aZeroPoint) * (b - bZeroPoint) of quantized matrices.
+     *
+     * Zero points are folded in afterwards from row sums of @p a and column sums
+     * of @p b, so the inner loop runs on the raw cells.
+     */
+    template <typename T>
+    Matrix<widened_accumulator_t<T>> matmulWidened(const Matrix<T>& a, const Matrix<T>& b,
+                                                   std::int32_t aZeroPoint = 0, std::int32_t bZeroPoint = 0);
+
+    /// @brief Mapping of 32-bit accumulators to a narrow output: round(acc * scale) + zeroPoint.
+    struct Requantization
+    {
+        float scale = 1.0f;
+        std::int32_t zeroPoint = 0;
+    };
+
+    /// @brief Requantize accumulators to int8/uint8, rounding half away from zero and saturating.
+    template <typename Out>
+    Matrix<Out> requantize(const Matrix<std::int32_t>& acc, const Requantization& q);
+
+    /// @brief matmulWidened() followed by requantize() back to the 8-bit input type.
+    template <typename T>
+    Matrix<T> matmulQuantized(const Matrix<T>& a, const Matrix<T>& b, std::int32_t aZeroPoint,
+                              std::int32_t bZeroPoint, const Requantization& out);
+} // namespace bml
+
+#endif // BML_INTEGER_GEMM_HPP
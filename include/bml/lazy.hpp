@@ -0,0 +1,166 @@
+#ifndef BML_LAZY_HPP
+#define BML_LAZY_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+#include "bml/typeTraits.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace bml
+{
+    template <typename T> class LazyGraph;
+
+    /// @brief Operation recorded by a LazyGraph node.
+    enum class LazyOp : std::uint8_t
+    {
+        Input,      ///< a captured Matrix
+        Constant,   ///< a scalar operand
+        Add,
+        Sub,
+        Mul,
+        Div
+    };
+
+    /**
+     * @brief A matrix-valued node of a LazyGraph, computed only when asked for.
+     *
+     * A small handle (graph pointer and node id); copying it copies no data. It
+     * must not outlive its graph. The operators mirror the element-wise ones of
+     * Matrix<T> and throw the same exceptions, at the same point for shapes and
+     * scalar divisors and during evaluation for zero divisors inside a matrix.
+     */
+    template <typename T>
+    class BML_API LazyExpr
+    {
+    public:
+        [[nodiscard]] std::uint32_t numRows() const;
+        [[nodiscard]] std::uint32_t numCols() const;
+        [[nodiscard]] LazyGraph<T>& graph() const noexcept { return *owner; }
+        [[nodiscard]] std::uint32_t id() const noexcept { return node; }
+
+        LazyExpr operator+(const LazyExpr& other) const;
+        LazyExpr operator-(const LazyExpr& other) const;
+        LazyExpr operator*(const LazyExpr& other) const;
+        LazyExpr operator/(const LazyExpr& other) const;
+        LazyExpr operator+(const T& scalar) const;
+        LazyExpr operator-(const T& scalar) const;
+        LazyExpr operator*(const T& scalar) const;
+        /// @brief Throws std::runtime_error for a zero scalar, like Matrix<T>.
+        LazyExpr operator/(const T& scalar) const;
+
+        /// @brief graph().evaluate(*this).
+        [[nodiscard]] Matrix<T> eval() const;
+        /// @brief graph().sum(*this), and likewise for min() and max().
+        [[nodiscard]] T sum() const;
+        [[nodiscard]] T min() const;
+        [[nodiscard]] T max() const;
+
+    private:
+        friend class LazyGraph<T>;
+        LazyExpr(LazyGraph<T>* graph, std::uint32_t id) noexcept : owner(graph), node(id) {}
+
+        LazyGraph<T>* owner;
+        std::uint32_t node;
+    };
+
+    /**
+     * @brief Opt-in deferred evaluation: element-wise Matrix<T> expressions are
+     * recorded as a DAG and computed in one pass when a result is requested.
+     *
+     * @code
+     * LazyGraph<double> g;
+     * auto a = g.input(A), b = g.input(B);
+     * auto e = (a * b + 1.0) / (a * b - 1.0);   // a * b is recorded once
+     * Matrix<double> r = e.eval();
+     * double dot = (a * b).sum();               // no a * b temporary
+     * @endcode
+     *
+     * Building an expression that already exists returns the existing node
+     * (common-subexpression elimination; + and * match either operand order),
+     * and inputs sharing a buffer are one node. Evaluation walks the nodes the
+     * requested results need in tiles of a few KB, each task of the worker pool
+     * taking a run of tiles: every operation of a tile runs while its operands
+     * are still in L1, intermediates never reach memory, and each input is read
+     * once however often it is used. Reductions consume the tiles directly.
+     *
+     * Results are identical to the eager Matrix<T> operators element by element.
+     * sum() adds per-tile Kahan sums with Kahan summation, so for floating point
+     * it may differ from Matrix::sum() in the last bits.
+     *
+     * Inputs are captured by value, sharing the Matrix buffer (no copy); later
+     * changes to the caller's Matrix detach it and do not affect the graph.
+     * Evaluated matrices are kept and act as inputs to later evaluations until
+     * clear(). A graph is not safe to build from several threads at once, and
+     * cannot be copied or moved since its expressions point at it.
+     *
+     * @tparam T Element type (any math-arithmetic T; bool/char excluded).
+     */
+    template <typename T>
+    class BML_API LazyGraph
+    {
+        static_assert(bml_is_math_arithmetic<T>::value,
+                      "bml::LazyGraph<T>: T must be a math-arithmetic type");
+
+    public:
+        LazyGraph() = default;
+        LazyGraph(const LazyGraph&) = delete;
+        LazyGraph& operator=(const LazyGraph&) = delete;
+
+        /// @brief A leaf for @p matrix; the same buffer and shape give the same node.
+        LazyExpr<T> input(const Matrix<T>& matrix);
+
+        /// @brief Compute @p expr (or return it, if already computed).
+        [[nodiscard]] Matrix<T> evaluate(const LazyExpr<T>& expr);
+        /// @brief Compute several expressions in a single pass over their inputs.
+        [[nodiscard]] std::vector<Matrix<T>> evaluate(const std::vector<LazyExpr<T>>& exprs);
+
+        /// @brief Sum of @p expr without materializing it; 0 for an empty matrix.
+        [[nodiscard]] T sum(const LazyExpr<T>& expr);
+        /// @brief Minimum of @p expr without materializing it; throws std::runtime_error when empty.
+        [[nodiscard]] T min(const LazyExpr<T>& expr);
+        [[nodiscard]] T max(const LazyExpr<T>& expr);
+
+        /// @brief Distinct nodes recorded (inputs and scalars included).
+        [[nodiscard]] std::size_t size() const noexcept { return nodes.size(); }
+        /// @brief Forget every node, input and kept result; existing expressions become invalid.
+        void clear() noexcept;
+
+        /// @brief Record op(lhs, rhs); what the LazyExpr operators call.
+        LazyExpr<T> binary(LazyOp op, const LazyExpr<T>& lhs, const LazyExpr<T>& rhs);
+        LazyExpr<T> binary(LazyOp op, const LazyExpr<T>& lhs, const T& scalar);
+
+        [[nodiscard]] std::uint32_t numRows(std::uint32_t id) const { return nodes.at(id).rows; }
+        [[nodiscard]] std::uint32_t numCols(std::uint32_t id) const { return nodes.at(id).cols; }
+
+    private:
+        enum class Reduction : std::uint8_t { None, Sum, Min, Max };
+
+        struct Node
+        {
+            LazyOp op;
+            std::uint32_t lhs;     // operand ids; for Input the index into inputs
+            std::uint32_t rhs;
+            std::uint32_t rows;
+            std::uint32_t cols;
+            T value;               // Constant only
+        };
+
+        void checkOwn(const LazyExpr<T>& expr) const;
+        std::uint32_t record(LazyOp op, std::uint32_t lhs, std::uint32_t rhs);
+        std::uint32_t constant(const T& value);
+        T reduce(const LazyExpr<T>& expr, Reduction reduction);
+        void sweep(const std::vector<std::uint32_t>& roots, std::vector<Matrix<T>>& results,
+                   Reduction reduction, std::vector<T>& partials);
+
+        std::vector<Node> nodes;
+        std::vector<Matrix<T>> inputs;
+        std::map<std::tuple<LazyOp, std::uint32_t, std::uint32_t>, std::uint32_t> memo;
+    };
+} // namespace bml
+
+#endif // BML_LAZY_HPP
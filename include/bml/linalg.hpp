@@ -0,0 +1,154 @@
+#ifndef BML_LINALG_HPP
+#define BML_LINALG_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    /**
+     * @brief LU factorization with partial pivoting, P*A = L*U, of a square matrix.
+     *
+     * Factorizes once and solves any number of right-hand sides. Right-looking
+     * blocked algorithm: each 64-column panel is factorized with row pivoting,
+     * and the trailing submatrix is updated with one GEMM per panel, which is
+     * where the time goes for large n and what runs on the worker pool.
+     *
+     * A zero pivot marks the matrix singular(); determinant() is then 0 and
+     * solve()/inverse() throw std::runtime_error.
+     *
+     * @tparam T float, double or long double.
+     */
+    template <typename T>
+    class BML_API LuFactorization
+    {
+        static_assert(std::is_floating_point_v<T>, "bml::LuFactorization<T>: T must be floating point");
+
+    public:
+        /// @brief Factorize @p a; throws std::invalid_argument if it is not square.
+        explicit LuFactorization(const Matrix<T>& a);
+
+        [[nodiscard]] std::size_t order() const noexcept { return n; }
+        [[nodiscard]] bool singular() const noexcept { return isSingular; }
+        [[nodiscard]] T determinant() const;
+
+        /// @brief X with A*X = B for every column of @p b (b.numRows() == order()).
+        [[nodiscard]] Matrix<T> solve(const Matrix<T>& b) const;
+        [[nodiscard]] std::vector<T> solve(const std::vector<T>& b) const;
+        [[nodiscard]] Matrix<T> inverse() const;
+
+        /// @brief L (strictly lower, unit diagonal implied) and U packed in one matrix.
+        [[nodiscard]] const Matrix<T>& packed() const noexcept { return lu; }
+        /// @brief Row i was swapped with row pivots()[i], in order of i.
+        [[nodiscard]] const std::vector<std::uint32_t>& pivots() const noexcept { return piv; }
+
+    private:
+        std::size_t n;
+        Matrix<T> lu;
+        std::vector<std::uint32_t> piv;
+        bool oddSwaps = false;
+        bool isSingular = false;
+    };
+
+    /**
+     * @brief Cholesky factorization A = L*L^T of a symmetric positive definite matrix.
+     *
+     * Only the lower triangle of the input is read. About half the work of LU and
+     * needs no pivoting; the trailing update is a GEMM restricted to the lower
+     * triangle.
+     *
+     * @throws std::invalid_argument if the matrix is not square,
+     *         std::runtime_error if it is not positive definite.
+     * @tparam T float, double or long double.
+     */
+    template <typename T>
+    class BML_API CholeskyFactorization
+    {
+        static_assert(std::is_floating_point_v<T>, "bml::CholeskyFactorization<T>: T must be floating point");
+
+    public:
+        explicit CholeskyFactorization(const Matrix<T>& a);
+
+        [[nodiscard]] std::size_t order() const noexcept { return n; }
+        [[nodiscard]] T determinant() const;
+
+        [[nodiscard]] Matrix<T> solve(const Matrix<T>& b) const;
+        [[nodiscard]] std::vector<T> solve(const std::vector<T>& b) const;
+        [[nodiscard]] Matrix<T> inverse() const;
+
+        /// @brief The factor L (upper triangle zero).
+        [[nodiscard]] const Matrix<T>& lower() const noexcept { return l; }
+
+    private:
+        std::size_t n;
+        Matrix<T> l;
+    };
+
+    /**
+     * @brief Householder QR factorization A = Q*R of an m x n matrix with m >= n.
+     *
+     * Reflectors are accumulated per 64-column panel into the compact WY form
+     * I - V*T*V^T, so applying them to the trailing columns (and to right-hand
+     * sides) is three GEMMs per panel. Q is kept implicitly as the reflectors.
+     *
+     * @throws std::invalid_argument if rows < cols.
+     * @tparam T float, double or long double.
+     */
+    template <typename T>
+    class BML_API QrFactorization
+    {
+        static_assert(std::is_floating_point_v<T>, "bml::QrFactorization<T>: T must be floating point");
+
+    public:
+        explicit QrFactorization(const Matrix<T>& a);
+
+        [[nodiscard]] std::size_t numRows() const noexcept { return m; }
+        [[nodiscard]] std::size_t numCols() const noexcept { return n; }
+
+        /**
+         * @brief Least-squares solution X minimizing ||A*X - B|| column by column.
+         * @throws std::runtime_error if A is (numerically) rank deficient.
+         */
+        [[nodiscard]] Matrix<T> solve(const Matrix<T>& b) const;
+        [[nodiscard]] std::vector<T> solve(const std::vector<T>& b) const;
+
+        /// @brief Q^T * b for b with numRows() rows.
+        [[nodiscard]] Matrix<T> applyQt(const Matrix<T>& b) const;
+        /// @brief The n x n upper-triangular factor.
+        [[nodiscard]] Matrix<T> R() const;
+        /// @brief The m x n factor with orthonormal columns (thin Q).
+        [[nodiscard]] Matrix<T> Q() const;
+
+    private:
+        void applyBlock(std::size_t k0, std::size_t kb, bool transpose, T* c, std::size_t ldc, std::size_t cols) const;
+
+        std::size_t m;
+        std::size_t n;
+        Matrix<T> qr;            // R on and above the diagonal, reflectors below
+        std::vector<T> tau;
+        std::vector<T> tBlocks;  // the kb x kb T factor of each panel, kBlock*kBlock apart
+    };
+
+    /// @brief X with a*X = b via LU; throws std::runtime_error if @p a is singular.
+    template <typename T>
+    Matrix<T> solve(const Matrix<T>& a, const Matrix<T>& b);
+
+    /// @brief Inverse via LU; throws std::runtime_error if @p a is singular.
+    template <typename T>
+    Matrix<T> inverse(const Matrix<T>& a);
+
+    /// @brief Determinant via LU (0 for singular matrices).
+    template <typename T>
+    T determinant(const Matrix<T>& a);
+
+    /// @brief Least-squares solution of a*X = b via QR (a.numRows() >= a.numCols()).
+    template <typename T>
+    Matrix<T> lstsq(const Matrix<T>& a, const Matrix<T>& b);
+} // namespace bml
+
+#endif // BML_LINALG_HPP
@@ -0,0 +1,52 @@
+#ifndef BML_MAPPEDFILE_HPP
+#define BML_MAPPEDFILE_HPP
+
+#include "bml/export.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace bml
+{
+    /**
+     * @brief Read-only view of a whole file.
+     *
+     * On POSIX systems the file is memory-mapped, so pages are only read when they
+     * are touched; elsewhere it is read into memory once. The view stays valid until
+     * the object is destroyed. Throws std::runtime_error if the file cannot be opened.
+     */
+    class BML_API MappedFile
+    {
+    public:
+        enum class Access
+        {
+            ReadOnly,   ///< data() only
+            Private     ///< mutableData() too; writes stay in this process and never reach the file
+        };
+
+        explicit MappedFile(const std::string& path, Access access = Access::ReadOnly);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        [[nodiscard]] const char* data() const noexcept { return bytes; }
+        [[nodiscard]] std::size_t size() const noexcept { return length; }
+
+        /// @brief Writable view; throws std::logic_error unless opened with Access::Private.
+        [[nodiscard]] char* mutableData() const;
+
+    private:
+        void release() noexcept;
+
+        const char* bytes = nullptr;
+        std::size_t length = 0;
+        bool mapped = false;   // true: munmap on release, false: delete[]
+        bool writable = false;
+    };
+} // namespace bml
+
+#endif // BML_MAPPEDFILE_HPP
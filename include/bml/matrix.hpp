@@ -2,8 +2,12 @@
 #define BML_MATRIX_HPP
 
 #include "bml/export.hpp"
+#include "bml/memoryStats.hpp"
+#include "bml/reductionCache.hpp"
 #include "bml/typeTraits.hpp"
 #include "bml/rowView.hpp"
+#include "bml/sharedBuffer.hpp"
+#include "bml/textFormat.hpp"
 #include "bml/traversal.hpp"
 
 #include <vector>
@@ -16,9 +20,11 @@ namespace bml
 
     template<class T> class MatrixIterator;
     template<class T> class ConstMatrixIterator;
+    class ByteSink;
+    class ByteSource;
 
     template <typename T>
-    class BML_API Matrix
+    class BML_API Matrix : private detail::MatrixInstanceCount
     {
         // Fail fast for completely unsupported storage types.
         static_assert(
@@ -30,16 +36,34 @@ namespace bml
 
     private:
         using store_t = storage_of_t<T>;
-        std::vector<store_t> data;
+        SharedBuffer<store_t> data;   // copy-on-write; shared between copies until written
         std::uint32_t rows;
         std::uint32_t cols;
+        detail::ReductionCacheSlot<T> reductionCache;   // empty unless enableReductionCache()
 
         [[nodiscard]] std::size_t toIdx(std::uint32_t r, std::uint32_t c) const noexcept;
         [[nodiscard]] std::pair<std::uint32_t, std::uint32_t> toCoords(std::size_t i) const;
 
+        // Writers report what they may touch, so cached reductions stay correct.
+        void markRowsDirty(std::uint32_t first, std::uint32_t last) noexcept;
+        void markAllDirty() noexcept;
+        // After rows or cols change: a cache sized for the old rows starts over.
+        void shapeChanged();
+        // Make the buffer size() == cells, growing capacity geometrically.
+        void growTo(std::size_t cells);
+        // data.data() for a write anywhere in the matrix.
+        store_t* writableCells();
+
     public:
+        using value_type   = T;
+        using storage_type = storage_of_t<T>;   // cell type in memory (std::uint8_t for bool)
+
         Matrix(std::uint32_t numRows, std::uint32_t numCols);
+        // Adopt row-major cells without copying; throws if cells.size() != numRows*numCols.
+        Matrix(std::uint32_t numRows, std::uint32_t numCols, SharedBuffer<storage_type> cells);
 
+        // Copies are O(1): the element buffer is shared until either side is
+        // written through operator[], fill, a compound operator or an iterator.
         Matrix(const Matrix&) = default;
         Matrix& operator=(const Matrix&) = default;
 
@@ -53,21 +77,83 @@ namespace bml
         [[nodiscard]] size_t size() const noexcept;
         [[nodiscard]] bool empty() const noexcept;
 
+        // True while this matrix and other still share one copy-on-write buffer.
+        [[nodiscard]] bool sharesStorageWith(const Matrix& other) const noexcept;
+
+        // Bytes held: the object, its cell buffer and, for std::string cells, the heap
+        // payloads of strings too long for the small-string buffer. A buffer shared
+        // with copies is counted in full by each of them.
+        [[nodiscard]] std::size_t memoryUsage() const noexcept;
+
+        // Opt-in incremental reductions: keep sum/min/max/count_true partials per block
+        // of blockRows rows (0 picks ~64 KiB blocks) and, after writes, rescan only the
+        // blocks written since. operator[] marks its row, paste() its rows, and every
+        // other non-const access (iterators, data_storage(), fill, compound operators)
+        // the whole matrix; read through a const reference to avoid marking. A RowView
+        // or pointer kept across a reduction and written afterwards is not seen. With
+        // the cache on, floating-point sum() adds per-block Kahan sums and may differ
+        // from the uncached result in the last bits. Copies carry their own cache.
+        void enableReductionCache(std::uint32_t blockRows = 0);
+        void disableReductionCache() noexcept;
+        [[nodiscard]] bool reductionCacheEnabled() const noexcept;
+
         bool any_of(std::function<bool(T)> p) const;
         bool none_of(std::function<bool(T)> p) const;
 
         RowView<T> operator[](std::uint32_t row);
         RowView<const T> operator[](std::uint32_t row) const;
 
+        // Raw row-major cells, size() long (bool cells are 0/1 bytes). The non-const
+        // overload detaches a shared buffer first, like operator[].
+        [[nodiscard]] const storage_type* data_storage() const noexcept;
+        [[nodiscard]] storage_type* data_storage();
+
         void initFromByteStream(const uint8_t* byteStream, size_t byteSize);
         void initFromByteStream(const std::vector<uint8_t>& byteStream);
+        // Pull exactly one matrix worth of bytes from source. POD cells are read straight
+        // into the buffer; std::string cells go through a 64 KiB block, and a block that
+        // runs past the last cell throws (use ByteStreamDecoder for multiplexed streams).
+        void initFromByteStream(ByteSource& source);
 
         [[nodiscard]] std::vector<std::uint8_t> toByteStream() const;
+        // Same bytes as toByteStream(), handed to sink in ~1 MiB pieces without an
+        // intermediate copy (std::string cells are gathered, writev-style).
+        void toByteStream(ByteSink& sink) const;
 
         Matrix copy(std::uint32_t startRow = 0, std::uint32_t startCol = 0,
                     std::int32_t endRow = -1, std::int32_t endCol = -1) const;
 
         void paste(const Matrix& source, std::uint32_t destRow = 0, std::uint32_t destCol = 0);
+        // Same as above, but non-trivial cells (std::string) are moved out of an unshared source.
+        void paste(Matrix&& source, std::uint32_t destRow = 0, std::uint32_t destCol = 0);
+
+        // ---- Changing the shape in place ----
+        // Like std::vector, the buffer can hold more rows than numRows(): appends grow it
+        // geometrically, so a stream of appendRow() calls costs O(1) per cell, and
+        // erasing keeps the capacity. Rows move with memmove (std::move for strings).
+        // Cells stay dense row-major (data_storage() is unchanged), so the column
+        // operations re-lay the rows out in place, in one pass within the capacity.
+        // Reserved room is not shared by copies. Any of these resets cached reductions.
+
+        // Room for rowCapacity rows of numCols() cells without reallocating.
+        void reserve(std::uint32_t rowCapacity);
+        [[nodiscard]] std::uint32_t rowCapacity() const noexcept;
+        // Give unused capacity back.
+        void shrinkToFit();
+
+        // Append count values as a row; count must equal numCols() (a 0 x 0 matrix takes any).
+        void appendRow(const T* values, std::uint32_t count);
+        void appendRow(const std::vector<T>& values);
+        void appendRows(const Matrix& block);
+        // Rows of block go in before row `at` (numRows() appends); the rows below move down.
+        void insertRows(std::uint32_t at, const Matrix& block);
+        // Remove rows [first, first + count); the rows below move up.
+        void eraseRows(std::uint32_t first, std::uint32_t count);
+        // Columns of block (numRows() rows) go in before column `at`.
+        void insertCols(std::uint32_t at, const Matrix& block);
+        void eraseCols(std::uint32_t first, std::uint32_t count);
+        // New shape keeping the top-left cells both shapes share; other cells are T{}.
+        void resize(std::uint32_t numRows, std::uint32_t numCols);
 
         bool all(std::function<bool(T)> condition) const;
 
@@ -78,7 +164,13 @@ namespace bml
         ConstMatrixIterator<T> begin(TraversalType type = TraversalType::Row) const;
         ConstMatrixIterator<T> end(TraversalType type = TraversalType::Row) const;
 
+        // Space after every cell, newline after every row, 6 significant digits.
         [[nodiscard]] std::string toString() const;
+        [[nodiscard]] std::string toString(const TextFormat& format) const;
+
+        // Stream the text form to sink in chunks of ~64 KiB; large matrices are
+        // formatted on the worker pool, but bytes still reach the sink in row order.
+        void writeText(ByteSink& sink, const TextFormat& format = TextFormat()) const;
 
         std::vector<T> getRow(std::uint32_t row, std::int32_t startCol = 0, std::int32_t endCol = -1) const;
         std::vector<T> getColumn(std::uint32_t col, std::int32_t startRow = 0, std::int32_t endRow = -1) const;
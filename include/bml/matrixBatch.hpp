@@ -0,0 +1,159 @@
+#ifndef BML_MATRIX_BATCH_HPP
+#define BML_MATRIX_BATCH_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+#include "bml/typeTraits.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bml
+{
+    /// @brief Storage order of a MatrixBatch.
+    enum class BatchLayout : std::uint8_t
+    {
+        Contiguous,   ///< one row-major matrix after another
+        Interleaved   ///< groups of InterleavedLanes matrices, cell by cell: the matrices of a group are adjacent
+    };
+
+    /**
+     * @brief Many matrices of one shape in a single buffer.
+     *
+     * Meant for large numbers of small matrices (8x8 to 32x32), where a Matrix
+     * per item would spend more on allocation, dispatch and checks than on the
+     * math. Element access through operator() is unchecked.
+     *
+     * In the Interleaved layout cell (i, j) of matrices g*W .. g*W+W-1
+     * (W = InterleavedLanes, one 64-byte vector of cells) is stored
+     * contiguously, so every kernel runs its innermost loop across the batch
+     * in SIMD lanes whatever the shape. The last group is padded with zeros;
+     * the padding is never computed on. Contiguous keeps each matrix in one
+     * piece; element-wise operations still vectorize (they run over the buffer
+     * as a whole), the other kernels go matrix by matrix.
+     *
+     * Semantics mirror Matrix<T>: @c operator* is element-wise; use
+     * bml::matmul() for the products. Binary operations convert the right
+     * operand to the layout of the left one first. Work is split over the
+     * worker pool by groups of matrices.
+     *
+     * @tparam T Element type (any math-arithmetic T; bool/char excluded).
+     */
+    template <typename T>
+    class BML_API MatrixBatch
+    {
+        static_assert(bml_is_math_arithmetic<T>::value,
+                      "bml::MatrixBatch<T>: T must be a math-arithmetic type");
+
+    public:
+        using value_type = T;
+
+        /// @brief Matrices per group of the Interleaved layout.
+        static constexpr std::size_t InterleavedLanes = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+
+        /// @brief @p count zero matrices of @p numRows x @p numCols.
+        MatrixBatch(std::size_t count, std::uint32_t numRows, std::uint32_t numCols,
+                    BatchLayout layout = BatchLayout::Contiguous);
+
+        /// @brief Copy of @p matrices; throws std::invalid_argument unless they share one shape.
+        explicit MatrixBatch(const std::vector<Matrix<T>>& matrices, BatchLayout layout = BatchLayout::Contiguous);
+
+        [[nodiscard]] std::size_t size() const noexcept { return count; }
+        [[nodiscard]] std::uint32_t numRows() const noexcept { return rows; }
+        [[nodiscard]] std::uint32_t numCols() const noexcept { return cols; }
+        [[nodiscard]] BatchLayout layout() const noexcept { return order; }
+        /// @brief Matrices stored side by side: InterleavedLanes or 1.
+        [[nodiscard]] std::size_t lanes() const noexcept { return order == BatchLayout::Interleaved ? InterleavedLanes : 1; }
+
+        /// @brief Cell (row, col) of matrix @p index, unchecked.
+        [[nodiscard]] T& operator()(std::size_t index, std::uint32_t row, std::uint32_t col) noexcept
+        {
+            return cells[offset(index, row, col)];
+        }
+        [[nodiscard]] const T& operator()(std::size_t index, std::uint32_t row, std::uint32_t col) const noexcept
+        {
+            return cells[offset(index, row, col)];
+        }
+
+        /// @brief Checked access; throws std::out_of_range.
+        [[nodiscard]] T& at(std::size_t index, std::uint32_t row, std::uint32_t col);
+        [[nodiscard]] const T& at(std::size_t index, std::uint32_t row, std::uint32_t col) const;
+
+        /// @brief Position of a cell in data(), per the layout.
+        [[nodiscard]] std::size_t offset(std::size_t index, std::uint32_t row, std::uint32_t col) const noexcept
+        {
+            const std::size_t cell = std::size_t{row} * cols + col;
+            if (order == BatchLayout::Contiguous) return index * matrixCells() + cell;
+            return (index / InterleavedLanes * matrixCells() + cell) * InterleavedLanes + index % InterleavedLanes;
+        }
+
+        /// @brief The buffer, padding included (see offset()).
+        [[nodiscard]] T* data() noexcept { return cells.data(); }
+        [[nodiscard]] const T* data() const noexcept { return cells.data(); }
+
+        /// @brief Matrix @p index as a Matrix; throws std::out_of_range.
+        [[nodiscard]] Matrix<T> get(std::size_t index) const;
+        /// @brief Overwrite matrix @p index; throws std::out_of_range or std::invalid_argument (shape).
+        void set(std::size_t index, const Matrix<T>& matrix);
+
+        /// @brief Same matrices in @p layout (a copy if already in it).
+        [[nodiscard]] MatrixBatch toLayout(BatchLayout layout) const;
+        /// @brief Every matrix transposed.
+        [[nodiscard]] MatrixBatch transpose() const;
+
+        // ---- Element-wise; operands must have the same count and shape ----
+        MatrixBatch operator+(const MatrixBatch& other) const;
+        MatrixBatch operator-(const MatrixBatch& other) const;
+        MatrixBatch operator*(const MatrixBatch& other) const;
+        /// @brief Throws std::runtime_error on a zero divisor, like Matrix<T>.
+        MatrixBatch operator/(const MatrixBatch& other) const;
+        MatrixBatch operator+(const T& scalar) const;
+        MatrixBatch operator-(const T& scalar) const;
+        MatrixBatch operator*(const T& scalar) const;
+        MatrixBatch operator/(const T& scalar) const;
+
+        // ---- Reductions, one value per matrix ----
+        /// @brief Sums of each matrix (Kahan-compensated for floating point, like Matrix::sum()).
+        [[nodiscard]] std::vector<T> sums() const;
+        /// @brief Minimum of each matrix; throws std::runtime_error for an empty shape.
+        [[nodiscard]] std::vector<T> mins() const;
+        [[nodiscard]] std::vector<T> maxs() const;
+
+    private:
+        [[nodiscard]] std::size_t matrixCells() const noexcept { return std::size_t{rows} * cols; }
+        [[nodiscard]] std::size_t groups() const noexcept { return (count + lanes() - 1) / lanes(); }
+        void checkIndex(std::size_t index, std::uint32_t row, std::uint32_t col) const;
+        void checkSameShape(const MatrixBatch& other, const char* what) const;
+
+        template <typename Op>
+        MatrixBatch zip(const MatrixBatch& other, Op op) const;
+        template <typename Op>
+        MatrixBatch map(Op op) const;
+        template <typename Reduce>
+        std::vector<T> reduce(Reduce reduceGroup) const;
+        [[nodiscard]] bool hasZero() const;
+
+        std::size_t count;
+        std::uint32_t rows;
+        std::uint32_t cols;
+        BatchLayout order;
+        std::vector<T> cells;
+    };
+
+    /// @brief Pairwise products a[i] * b[i]; a.numCols() must equal b.numRows().
+    template <typename T>
+    MatrixBatch<T> matmul(const MatrixBatch<T>& a, const MatrixBatch<T>& b);
+
+    /**
+     * @brief Solve a[i] * x[i] = b[i] for every i: a is a batch of n x n matrices,
+     * b of n x k right-hand sides (floating point only).
+     *
+     * Gaussian elimination with partial pivoting, pivoting each matrix on its
+     * own. Throws std::runtime_error naming the first singular matrix found.
+     */
+    template <typename T>
+    MatrixBatch<T> solve(const MatrixBatch<T>& a, const MatrixBatch<T>& b);
+} // namespace bml
+
+#endif // BML_MATRIX_BATCH_HPP
@@ -0,0 +1,121 @@
+#ifndef BML_MEMORY_STATS_HPP
+#define BML_MEMORY_STATS_HPP
+
+#include "bml/export.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bml
+{
+    /**
+     * @brief Counters of the cell buffers allocated for matrices.
+     *
+     * Buffers are counted when SharedBuffer allocates them (new matrices and
+     * copy-on-write detaches); adopted blocks such as file mappings are not.
+     * Sizes are sizeof(cell) x cells, so std::string payloads on the heap are
+     * not included (see Matrix::memoryUsage()).
+     */
+    struct AllocationStats
+    {
+        std::uint64_t liveMatrices = 0;     ///< Matrix objects alive (copies sharing a buffer count separately)
+        std::uint64_t liveBuffers = 0;      ///< cell buffers alive
+        std::uint64_t liveBytes = 0;        ///< bytes in those buffers
+        std::uint64_t peakBytes = 0;        ///< highest liveBytes since the last reset
+        std::uint64_t allocations = 0;      ///< buffers allocated since the last reset
+        std::uint64_t bytesAllocated = 0;
+        std::uint64_t deallocations = 0;    ///< buffers freed since the last reset
+        std::uint64_t bytesFreed = 0;
+        std::uint64_t temporaries = 0;      ///< buffers allocated and freed inside one AllocationScope
+        std::uint64_t temporaryBytes = 0;
+    };
+
+    namespace detail
+    {
+        // Identifies one counted buffer; kept in its deleter.
+        struct AllocationTicket
+        {
+            std::uint64_t bytes;
+            std::uint64_t serial;
+        };
+
+        BML_API AllocationTicket noteAllocation(std::size_t bytes) noexcept;
+        BML_API void noteRelease(const AllocationTicket& ticket) noexcept;
+        BML_API void noteMatrixCreated() noexcept;
+        BML_API void noteMatrixDestroyed() noexcept;
+    } // namespace detail
+
+    /// @brief Process-wide counters.
+    BML_API AllocationStats allocationStats() noexcept;
+
+    /**
+     * @brief Counters of the calling thread: what it allocated and freed, whoever
+     * owned the buffers. The live and peak values are this thread's allocations
+     * minus its frees (0 if it freed more than it allocated).
+     */
+    BML_API AllocationStats threadAllocationStats() noexcept;
+
+    /**
+     * @brief Zero the cumulative counters (global and the calling thread's); peaks
+     * restart at the live values. Not meant to be called inside an AllocationScope.
+     */
+    BML_API void resetAllocationStats() noexcept;
+
+    /**
+     * @brief Measures the allocations of a block of code on the calling thread.
+     *
+     * A buffer allocated after the scope opened and freed on this thread before
+     * it closes is a temporary: `AllocationScope s; auto r = a + b * c;` sees two
+     * allocations and one temporary (b * c). Scopes nest.
+     */
+    class BML_API AllocationScope
+    {
+    public:
+        AllocationScope() noexcept;
+        ~AllocationScope();
+
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator=(const AllocationScope&) = delete;
+
+        /// @brief Changes on this thread since the scope opened; live values are the net growth.
+        [[nodiscard]] AllocationStats stats() const noexcept;
+
+    private:
+        friend void detail::noteRelease(const detail::AllocationTicket& ticket) noexcept;
+
+        AllocationScope* outer;
+        AllocationStats start;            // cumulative counters of the thread at open
+        std::int64_t startLive[3];        // thread's live matrices, buffers and bytes at open
+        std::int64_t savedPeak;           // thread's peak before the scope restarted it
+        std::uint64_t firstSerial;        // buffers numbered from here were allocated inside
+        std::uint64_t temporaries = 0;
+        std::uint64_t temporaryBytes = 0;
+    };
+
+    namespace detail
+    {
+        // Deleter of counted buffers.
+        template <typename S>
+        struct CountedArrayDelete
+        {
+            AllocationTicket ticket;
+
+            void operator()(S* p) const noexcept
+            {
+                delete[] p;
+                noteRelease(ticket);
+            }
+        };
+
+        // Empty base of Matrix that keeps AllocationStats::liveMatrices.
+        struct MatrixInstanceCount
+        {
+            MatrixInstanceCount() noexcept { noteMatrixCreated(); }
+            MatrixInstanceCount(const MatrixInstanceCount&) noexcept { noteMatrixCreated(); }
+            MatrixInstanceCount& operator=(const MatrixInstanceCount&) noexcept = default;
+            ~MatrixInstanceCount() { noteMatrixDestroyed(); }
+        };
+    } // namespace detail
+} // namespace bml
+
+#endif // BML_MEMORY_STATS_HPP
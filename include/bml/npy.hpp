@@ -0,0 +1,132 @@
+#ifndef BML_NPY_HPP
+#define BML_NPY_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bml
+{
+    class ByteSink;
+    class FileSink;
+    class MappedFile;
+
+    // NumPy interchange for every POD instantiation (integers, float, double,
+    // long double as '<f16', bool as '|b1', char as '|S1'). Matrix<std::string>
+    // has no NumPy equivalent and is not supported.
+    //
+    // Reading accepts format versions 1.0, 2.0 and 3.0, little- or big-endian data,
+    // and C or Fortran order (Fortran data is transposed in cache-sized tiles).
+    // Shapes may be (rows, cols), (n,) -> 1 x n, or () -> 1 x 1. The dtype must match
+    // T exactly; a mismatch or a malformed file throws std::runtime_error.
+
+    /// @brief Decode an in-memory .npy image.
+    template <typename T>
+    Matrix<T> parseNpy(const void* bytes, std::size_t size);
+
+    /// @brief Read a .npy file into a freshly allocated matrix.
+    template <typename T>
+    Matrix<T> loadNpy(const std::string& path);
+
+    /**
+     * @brief Read a .npy file without copying when its layout already matches.
+     *
+     * For native-endian C-order data the matrix cells live directly in a private
+     * memory mapping of the file; pages are read on first touch, writes stay local
+     * to the process, and the mapping is released with the last matrix sharing it.
+     * Other layouts fall back to loadNpy().
+     */
+    template <typename T>
+    Matrix<T> mapNpy(const std::string& path);
+
+    /// @brief Write @p m as a version 1.0, C-order, little-endian .npy image.
+    template <typename T>
+    void writeNpy(const Matrix<T>& m, ByteSink& sink);
+
+    template <typename T>
+    void saveNpy(const Matrix<T>& m, const std::string& path);
+
+    /**
+     * @brief Writes an uncompressed (stored) .npz archive, readable by numpy.load().
+     *
+     * Each add() appends "<name>.npy". Payloads are padded to 64-byte file offsets so
+     * NpzReader can hand them out without copying. Zip64 records are emitted when the
+     * archive grows past 4 GiB. close() writes the central directory; the destructor
+     * calls it if needed but swallows errors, so call close() to see them.
+     */
+    class BML_API NpzWriter
+    {
+    public:
+        explicit NpzWriter(const std::string& path);
+        explicit NpzWriter(ByteSink& sink);
+        ~NpzWriter();
+
+        NpzWriter(const NpzWriter&) = delete;
+        NpzWriter& operator=(const NpzWriter&) = delete;
+
+        template <typename T>
+        void add(const std::string& name, const Matrix<T>& m);
+
+        void close();
+
+    private:
+        struct Entry
+        {
+            std::string fileName;
+            std::uint32_t crc;
+            std::uint64_t size;
+            std::uint64_t offset;
+        };
+
+        void put(const void* bytes, std::size_t size);
+        void beginEntry(const std::string& name, std::uint32_t crc, std::uint64_t size);
+
+        std::FILE* ownedFile = nullptr;
+        std::unique_ptr<FileSink> fileSink;
+        ByteSink* sink = nullptr;
+        std::uint64_t written = 0;
+        std::vector<Entry> entries;
+        bool closed = false;
+    };
+
+    /**
+     * @brief Reads arrays from a stored .npz archive (memory-mapped).
+     *
+     * get() shares the mapping when the entry is native-endian, C-order and suitably
+     * aligned (always the case for archives written by NpzWriter), and copies
+     * otherwise. Compressed (deflate) entries throw std::runtime_error.
+     */
+    class BML_API NpzReader
+    {
+    public:
+        explicit NpzReader(const std::string& path);
+
+        /// @brief Array names, without the ".npy" suffix, in archive order.
+        [[nodiscard]] const std::vector<std::string>& names() const noexcept { return arrayNames; }
+        [[nodiscard]] bool contains(const std::string& name) const noexcept;
+
+        template <typename T>
+        Matrix<T> get(const std::string& name) const;
+
+    private:
+        struct Entry
+        {
+            std::uint64_t offset;   // start of the .npy image in the file
+            std::uint64_t size;
+        };
+
+        const Entry& find(const std::string& name) const;
+
+        std::shared_ptr<MappedFile> file;
+        std::vector<std::string> arrayNames;
+        std::vector<Entry> entries;
+    };
+} // namespace bml
+
+#endif // BML_NPY_HPP
@@ -0,0 +1,38 @@
+#ifndef BML_PARALLEL_HPP
+#define BML_PARALLEL_HPP
+
+#include "bml/export.hpp"
+
+#include <cstddef>
+#include <functional>
+
+namespace bml
+{
+    /**
+     * @brief Number of threads (including the caller) that parallel kernels may use.
+     *
+     * Defaults to @c std::thread::hardware_concurrency(), or the value of the
+     * @c BML_NUM_THREADS environment variable when it is set.
+     */
+    BML_API std::size_t parallelism() noexcept;
+
+    /**
+     * @brief Change the number of threads used by parallel kernels.
+     * @param threads Thread count; 0 restores the default, 1 makes every kernel serial.
+     * @note Must not be called while a parallel kernel is running.
+     */
+    BML_API void setParallelism(std::size_t threads);
+
+    /**
+     * @brief Split [0, count) into blocks and run @p body(begin, end) on each.
+     *
+     * Blocks are at least @p grain items long, so small ranges run inline on the
+     * calling thread. The caller participates in the work and the call returns once
+     * every block has finished. Calls made from inside a running block execute
+     * serially. The first exception thrown by any block is rethrown to the caller.
+     */
+    BML_API void parallelFor(std::size_t count, std::size_t grain,
+                             const std::function<void(std::size_t, std::size_t)>& body);
+} // namespace bml
+
+#endif // BML_PARALLEL_HPP
@@ -0,0 +1,191 @@
+#ifndef BML_PERF_COUNTERS_HPP
+#define BML_PERF_COUNTERS_HPP
+
+#include "bml/export.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    /// @brief Hardware events counted around instrumented operations.
+    enum class PerfEvent : std::uint8_t
+    {
+        Cycles,
+        Instructions,
+        LlcMisses,      ///< last-level cache read misses
+        DtlbMisses,     ///< data TLB read misses
+        BranchMisses
+    };
+
+    inline constexpr std::size_t kPerfEventCount = 5;
+
+    /// @brief Totals for one (operation, element type) pair.
+    struct PerfCounts
+    {
+        std::uint64_t calls = 0;
+        std::uint64_t nanoseconds = 0;                       ///< wall time on the calling thread
+        std::array<std::uint64_t, kPerfEventCount> events{};  ///< calling thread plus pool workers
+
+        [[nodiscard]] std::uint64_t operator[](PerfEvent e) const noexcept
+        {
+            return events[static_cast<std::size_t>(e)];
+        }
+    };
+
+    struct PerfRecord
+    {
+        std::string operation;   ///< e.g. "operator+", "sum", "matmul"
+        std::string type;        ///< element type, e.g. "int32", "double"
+        PerfCounts counts;
+    };
+
+    /// @brief Short name of an event ("cycles", "instructions", "llc-misses", ...).
+    BML_API const char* perfEventName(PerfEvent e) noexcept;
+
+    /// @brief Whether the library was built with instrumentation (CMake option BML_ENABLE_PERF_COUNTERS).
+    BML_API bool perfCountersCompiledIn() noexcept;
+
+    /**
+     * @brief Whether @p e can be counted on this thread.
+     *
+     * Counters are opened with perf_event_open for user-space code of the calling
+     * thread only, which works with the default perf_event_paranoid of 2. Events
+     * the kernel, the CPU or a container refuses read as 0 and report false here.
+     */
+    BML_API bool perfEventAvailable(PerfEvent e);
+
+    /**
+     * @brief Turn instrumentation on or off at run time.
+     *
+     * Off by default, or on when the @c BML_PERF_COUNTERS environment variable is
+     * set to a non-zero value. While off, an instrumented operation costs one
+     * relaxed load and a predicted branch; with BML_ENABLE_PERF_COUNTERS=OFF the
+     * scopes are not compiled at all and this call has no effect.
+     */
+    BML_API void setPerfCountersEnabled(bool enabled) noexcept;
+    BML_API bool perfCountersEnabled() noexcept;
+
+    /// @brief Totals of every (operation, type) pair seen since the last reset, sorted by name.
+    BML_API std::vector<PerfRecord> perfCounterSnapshot();
+
+    /// @brief Zero all totals.
+    BML_API void resetPerfCounters() noexcept;
+
+    /// @brief Print the snapshot as a table with time per call and instructions per cycle.
+    BML_API void dumpPerfCounters(std::ostream& out);
+
+    namespace detail
+    {
+        // Totals of one instrumented call site, in static storage. Constant-initialised,
+        // so a disabled scope never runs a static-initialisation guard; it is added to
+        // the registry the first time a scope on it closes.
+        struct PerfSite
+        {
+            constexpr PerfSite(const char* op, const char* t) noexcept : operation(op), type(t) {}
+
+            const char* operation;
+            const char* type;
+            std::atomic<std::uint64_t> calls{0};
+            std::atomic<std::uint64_t> nanoseconds{0};
+            std::atomic<std::uint64_t> events[kPerfEventCount] = {{0}, {0}, {0}, {0}, {0}};
+            std::atomic<bool> registered{false};
+        };
+
+        extern BML_API std::atomic<bool> perfEnabled;
+
+        // Counts the calling thread's events between construction and destruction.
+        // Scopes nest, and each includes the events of the scopes inside it as well as
+        // those of the blocks that parallelFor() hands to pool workers meanwhile.
+        class BML_API PerfScope
+        {
+        public:
+            explicit PerfScope(PerfSite& site) noexcept
+            {
+                if (perfEnabled.load(std::memory_order_relaxed)) open(site);
+            }
+
+            ~PerfScope()
+            {
+                if (site) close();
+            }
+
+            PerfScope(const PerfScope&) = delete;
+            PerfScope& operator=(const PerfScope&) = delete;
+
+        private:
+            void open(PerfSite& s) noexcept;
+            void close() noexcept;
+
+            // Only site is set while disabled; open() fills in the rest.
+            PerfSite* site = nullptr;
+            PerfScope* outer;
+            std::uint64_t startNs;
+            std::array<std::uint64_t, kPerfEventCount> start;
+
+            friend class PerfWorkerScope;
+        };
+
+        // Innermost scope open on this thread (for parallelFor to hand to the workers).
+        BML_API const PerfScope* currentPerfScope() noexcept;
+
+        // Adds a pool worker's share of a job to the caller's open scopes, which stay
+        // alive because the caller waits for the job.
+        class BML_API PerfWorkerScope
+        {
+        public:
+            explicit PerfWorkerScope(const PerfScope* scope) noexcept;
+            ~PerfWorkerScope();
+
+            PerfWorkerScope(const PerfWorkerScope&) = delete;
+            PerfWorkerScope& operator=(const PerfWorkerScope&) = delete;
+
+        private:
+            const PerfScope* scope;
+            std::array<std::uint64_t, kPerfEventCount> start{};
+        };
+
+        template <typename T>
+        constexpr const char* elementTypeName() noexcept
+        {
+            if constexpr (std::is_same_v<T, std::int8_t>) return "int8";
+            else if constexpr (std::is_same_v<T, std::uint8_t>) return "uint8";
+            else if constexpr (std::is_same_v<T, std::int16_t>) return "int16";
+            else if constexpr (std::is_same_v<T, std::uint16_t>) return "uint16";
+            else if constexpr (std::is_same_v<T, std::int32_t>) return "int32";
+            else if constexpr (std::is_same_v<T, std::uint32_t>) return "uint32";
+            else if constexpr (std::is_same_v<T, std::int64_t>) return "int64";
+            else if constexpr (std::is_same_v<T, std::uint64_t>) return "uint64";
+            else if constexpr (std::is_same_v<T, float>) return "float";
+            else if constexpr (std::is_same_v<T, double>) return "double";
+            else if constexpr (std::is_same_v<T, long double>) return "long_double";
+            else if constexpr (std::is_same_v<T, char>) return "char";
+            else if constexpr (std::is_same_v<T, bool>) return "bool";
+            else if constexpr (std::is_same_v<T, std::string>) return "string";
+            else return "other";
+        }
+    } // namespace detail
+} // namespace bml
+
+/**
+ * @brief Count the rest of the enclosing block as operation @p operation on element type @p T.
+ *
+ * Expands to nothing unless BML_PERF_COUNTERS is defined to 1, which the library
+ * build does when BML_ENABLE_PERF_COUNTERS is ON. Code outside the library may
+ * define it too to instrument its own functions.
+ */
+#if defined(BML_PERF_COUNTERS) && BML_PERF_COUNTERS
+    #define BML_PERF_SCOPE(operation, T)                                                          \
+        static ::bml::detail::PerfSite bmlPerfSite_(operation, ::bml::detail::elementTypeName<T>()); \
+        const ::bml::detail::PerfScope bmlPerfScope_(bmlPerfSite_)
+#else
+    #define BML_PERF_SCOPE(operation, T) static_cast<void>(0)
+#endif
+
+#endif // BML_PERF_COUNTERS_HPP
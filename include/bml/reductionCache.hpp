@@ -0,0 +1,106 @@
+#ifndef BML_REDUCTIONCACHE_HPP
+#define BML_REDUCTIONCACHE_HPP
+
+#include "bml/typeTraits.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace bml::detail
+{
+    // Bits of ReductionCache::valid, one per cached reduction.
+    enum : std::uint8_t
+    {
+        kCachedSum  = 1,
+        kCachedMin  = 2,
+        kCachedMax  = 4,
+        kCachedTrue = 8
+    };
+
+    /**
+     * @brief Partial reductions of one Matrix per block of rows (see
+     * Matrix::enableReductionCache()).
+     *
+     * Writes clear the bits of the blocks they may touch; a reduction rescans
+     * only the blocks whose bit for it is clear and combines the partials.
+     */
+    template <typename T>
+    struct ReductionCache
+    {
+        using store_t = storage_of_t<T>;
+
+        ReductionCache(std::uint32_t blockRows, std::uint32_t rows)
+            : blockRows(blockRows), valid((rows + blockRows - 1) / blockRows, 0),
+              sums(valid.size()), mins(valid.size()), maxs(valid.size()), trues(valid.size())
+        {
+        }
+
+        ReductionCache(const ReductionCache& other)
+        {
+            std::lock_guard<std::mutex> lock(other.mutex);
+            blockRows = other.blockRows;
+            valid = other.valid;
+            sums = other.sums;
+            mins = other.mins;
+            maxs = other.maxs;
+            trues = other.trues;
+        }
+
+        ReductionCache& operator=(const ReductionCache&) = delete;
+
+        /// @brief Rows [first, last) may have changed.
+        void markRows(std::uint32_t first, std::uint32_t last) noexcept
+        {
+            const std::size_t begin = std::min<std::size_t>(valid.size(), first / blockRows);
+            const std::size_t end = std::min<std::size_t>(valid.size(), (std::size_t{last} + blockRows - 1) / blockRows);
+            if (begin < end) std::fill(valid.begin() + begin, valid.begin() + end, std::uint8_t{0});
+        }
+
+        void markAll() noexcept { std::fill(valid.begin(), valid.end(), std::uint8_t{0}); }
+
+        [[nodiscard]] std::size_t bytes() const noexcept
+        {
+            return sizeof(*this) + valid.size() * (sizeof(std::uint8_t) + 3 * sizeof(store_t) + sizeof(std::size_t));
+        }
+
+        std::uint32_t blockRows = 1;
+        std::vector<std::uint8_t> valid;
+        std::vector<store_t> sums;
+        std::vector<store_t> mins;
+        std::vector<store_t> maxs;
+        std::vector<std::size_t> trues;
+        mutable std::mutex mutex;   // reductions are const, so two threads may refresh at once
+    };
+
+    /// @brief Owner of an optional ReductionCache; copies clone it, so every Matrix tracks its own writes.
+    template <typename T>
+    class ReductionCacheSlot
+    {
+    public:
+        ReductionCacheSlot() noexcept = default;
+        ReductionCacheSlot(const ReductionCacheSlot& other)
+            : cache(other.cache ? std::make_unique<ReductionCache<T>>(*other.cache) : nullptr)
+        {
+        }
+        ReductionCacheSlot& operator=(const ReductionCacheSlot& other)
+        {
+            if (this != &other) cache = other.cache ? std::make_unique<ReductionCache<T>>(*other.cache) : nullptr;
+            return *this;
+        }
+        ReductionCacheSlot(ReductionCacheSlot&&) noexcept = default;
+        ReductionCacheSlot& operator=(ReductionCacheSlot&&) noexcept = default;
+
+        [[nodiscard]] ReductionCache<T>* get() const noexcept { return cache.get(); }
+        void reset(std::unique_ptr<ReductionCache<T>> fresh = nullptr) noexcept { cache = std::move(fresh); }
+
+    private:
+        std::unique_ptr<ReductionCache<T>> cache;
+    };
+} // namespace bml::detail
+
+#endif // BML_REDUCTIONCACHE_HPP
@@ -0,0 +1,106 @@
+#ifndef BML_SCAN_HPP
+#define BML_SCAN_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+#include "bml/typeTraits.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bml
+{
+    /// @brief Direction of a prefix sum.
+    enum class ScanAxis : std::uint8_t
+    {
+        Rows,   ///< along each row, left to right
+        Cols    ///< down each column, top to bottom
+    };
+
+    /// @brief How floating-point running sums are accumulated (integers are always exact).
+    enum class Summation : std::uint8_t
+    {
+        Plain,        ///< one rounding per addition; error grows with the length of the line
+        Compensated   ///< error-free transformations carry the lost low bits (about 2x the cost)
+    };
+
+    /// @brief Cell type of scans and summed-area tables: 64-bit for integers up to 32 bits, T otherwise.
+    template <typename T>
+    struct scan_accumulator { using type = T; };
+    template <>
+    struct scan_accumulator<std::int8_t> { using type = std::int64_t; };
+    template <>
+    struct scan_accumulator<std::int16_t> { using type = std::int64_t; };
+    template <>
+    struct scan_accumulator<std::int32_t> { using type = std::int64_t; };
+    template <>
+    struct scan_accumulator<std::uint8_t> { using type = std::uint64_t; };
+    template <>
+    struct scan_accumulator<std::uint16_t> { using type = std::uint64_t; };
+    template <>
+    struct scan_accumulator<std::uint32_t> { using type = std::uint64_t; };
+
+    template <typename T>
+    using scan_accumulator_t = typename scan_accumulator<T>::type;
+
+    /**
+     * @brief Inclusive prefix sums: out(i, j) is the sum of the cells up to and
+     * including (i, j) along @p axis.
+     *
+     * Integer sums wrap modulo 2^64 (64-bit inputs) instead of overflowing.
+     * Lines are spread over the worker pool; when there are fewer lines than
+     * workers, long lines are split into chunks whose totals are scanned first.
+     * Row scans interleave several rows so independent additions overlap, and
+     * column scans run across a row of cells at a time, which vectorizes.
+     */
+    template <typename T>
+    Matrix<scan_accumulator_t<T>> inclusiveScan(const Matrix<T>& m, ScanAxis axis = ScanAxis::Rows,
+                                                Summation summation = Summation::Plain);
+
+    /// @brief Exclusive prefix sums: like inclusiveScan() without the cell itself (0 first).
+    template <typename T>
+    Matrix<scan_accumulator_t<T>> exclusiveScan(const Matrix<T>& m, ScanAxis axis = ScanAxis::Rows,
+                                                Summation summation = Summation::Plain);
+
+    /**
+     * @brief Integral image answering rectangle sums in O(1).
+     *
+     * Holds (rows+1) x (cols+1) running sums with a zero first row and column.
+     * Integer tables combine modulo 2^64, so rectSum() is exact whenever the
+     * rectangle's own sum fits the accumulator, even if the total does not.
+     * Plain floating-point tables lose precision as sums grow (a small rectangle
+     * far from the origin is a difference of large numbers); Summation::Compensated
+     * keeps a second table with the rounding error of every entry.
+     *
+     * @tparam T Element type (any math-arithmetic T; bool/char excluded).
+     */
+    template <typename T>
+    class BML_API SummedAreaTable
+    {
+        static_assert(bml_is_math_arithmetic<T>::value,
+                      "bml::SummedAreaTable<T>: T must be a math-arithmetic type");
+
+    public:
+        using value_type = scan_accumulator_t<T>;
+
+        explicit SummedAreaTable(const Matrix<T>& m, Summation summation = Summation::Plain);
+
+        [[nodiscard]] std::uint32_t numRows() const noexcept { return rows; }
+        [[nodiscard]] std::uint32_t numCols() const noexcept { return cols; }
+        [[nodiscard]] Summation summation() const noexcept { return lo.empty() ? Summation::Plain : Summation::Compensated; }
+
+        /// @brief Sum of the cells in rows [r0, r1) and columns [c0, c1); throws std::out_of_range.
+        [[nodiscard]] value_type rectSum(std::uint32_t r0, std::uint32_t c0, std::uint32_t r1, std::uint32_t c1) const;
+        /// @brief Sum of all cells.
+        [[nodiscard]] value_type total() const noexcept;
+
+    private:
+        std::uint32_t rows;
+        std::uint32_t cols;
+        std::vector<value_type> hi;   // running sums, (rows+1) x (cols+1)
+        std::vector<value_type> lo;   // their rounding errors (compensated floating point only)
+    };
+} // namespace bml
+
+#endif // BML_SCAN_HPP
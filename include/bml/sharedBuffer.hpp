@@ -0,0 +1,187 @@
+#ifndef BML_SHAREDBUFFER_HPP
+#define BML_SHAREDBUFFER_HPP
+
+#include "bml/memoryStats.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace bml
+{
+    /**
+     * @brief Reference-counted, copy-on-write element buffer backing Matrix<T>.
+     *
+     * Copying a SharedBuffer is O(1): both copies point at the same block. The
+     * first access through a non-const accessor (data(), operator[], begin/end)
+     * on a shared buffer detaches it by cloning the block, so writers never see
+     * each other. Const accessors never detach.
+     *
+     * @note Raw pointers obtained from a non-const accessor stay bound to the block
+     *       they were taken from. Copying the owner afterwards shares that block
+     *       again, so do not keep writing through an old pointer across a copy.
+     * @note The reference count is atomic, but detaching is not synchronised with
+     *       a concurrent copy of the same object (the same rule as for any other
+     *       write racing a read).
+     * @note Like std::vector the block may hold more than size() elements
+     *       (reserve()); those are kept value-initialised. Detaching copies
+     *       size() elements only, so reserved room is never shared.
+     */
+    template <typename S>
+    class SharedBuffer
+    {
+    public:
+        SharedBuffer() noexcept = default;
+
+        /// @brief Allocate @p n value-initialised elements.
+        explicit SharedBuffer(std::size_t n) : block(allocate(n)), count(n), room(n) {}
+
+        /**
+         * @brief Adopt an existing block of @p n elements.
+         *
+         * The block may alias memory owned by something else (e.g. a file mapping via
+         * the shared_ptr aliasing constructor); it must stay writable while this buffer
+         * holds the only reference, because writes then happen in place.
+         */
+        SharedBuffer(std::shared_ptr<S[]> adopted, std::size_t n) noexcept
+            : block(std::move(adopted)), count(n), room(n)
+        {
+        }
+
+        SharedBuffer(const SharedBuffer&) noexcept = default;
+        SharedBuffer& operator=(const SharedBuffer&) noexcept = default;
+
+        SharedBuffer(SharedBuffer&& other) noexcept
+            : block(std::move(other.block)), count(other.count), room(other.room)
+        {
+            other.count = other.room = 0;
+        }
+
+        SharedBuffer& operator=(SharedBuffer&& other) noexcept
+        {
+            if (this != &other)
+            {
+                block = std::move(other.block);
+                count = other.count;
+                room = other.room;
+                other.count = other.room = 0;
+            }
+            return *this;
+        }
+
+        ~SharedBuffer() = default;
+
+        [[nodiscard]] std::size_t size() const noexcept { return count; }
+        [[nodiscard]] bool empty() const noexcept { return count == 0; }
+        /// @brief Elements the block holds; size() can grow to this without reallocating.
+        [[nodiscard]] std::size_t capacity() const noexcept { return room; }
+
+        // ---- read access (never detaches) ----
+        const S* data() const noexcept { return block.get(); }
+        const S& operator[](std::size_t i) const noexcept { return block[i]; }
+        const S* begin() const noexcept { return block.get(); }
+        const S* end() const noexcept { return block.get() + count; }
+
+        // ---- write access (detaches a shared block first) ----
+        S* data()
+        {
+            detach();
+            return block.get();
+        }
+        S& operator[](std::size_t i)
+        {
+            detach();
+            return block[i];
+        }
+        S* begin() { return data(); }
+        S* end() { return data() + count; }
+
+        /**
+         * @brief Mutable pointer for a caller that is about to overwrite every element.
+         *
+         * Like data(), but a shared block is replaced by a fresh one without copying
+         * the old contents first.
+         */
+        S* dataForOverwrite()
+        {
+            if (shared())
+            {
+                block = allocate(count);
+                room = count;
+            }
+            return block.get();
+        }
+
+        /// @brief Release the block; size() becomes 0.
+        void clear() noexcept
+        {
+            block.reset();
+            count = room = 0;
+        }
+
+        /**
+         * @brief Make room for @p n elements. A shared block, or one too small, is
+         * replaced by a fresh one holding the current elements (moved if unshared).
+         */
+        void reserve(std::size_t n)
+        {
+            if (n <= room && !shared()) return;
+            n = std::max(n, count);
+            std::shared_ptr<S[]> fresh = allocate(n);
+            if (shared())
+                std::copy(block.get(), block.get() + count, fresh.get());
+            else
+                std::move(block.get(), block.get() + count, fresh.get());
+            block = std::move(fresh);
+            room = n;
+        }
+
+        /// @brief Grow (with value-initialised elements) or shrink to @p n elements; detaches.
+        void resize(std::size_t n)
+        {
+            if (n > room || shared()) reserve(n);
+            // Elements past size() stay value-initialised, so growing needs no writes.
+            std::fill(block.get() + std::min(n, count), block.get() + count, S{});
+            count = n;
+        }
+
+        /// @brief Give this buffer a private copy of its block if it is shared.
+        void detach()
+        {
+            if (!shared()) return;
+            std::shared_ptr<S[]> fresh = allocate(count);
+            std::copy(block.get(), block.get() + count, fresh.get());
+            block = std::move(fresh);
+            room = count;
+        }
+
+        /// @brief True if another buffer currently references the same block.
+        [[nodiscard]] bool shared() const noexcept { return block && block.use_count() > 1; }
+
+        /// @brief True if both buffers reference the same (non-empty) block.
+        [[nodiscard]] bool sameBlock(const SharedBuffer& other) const noexcept
+        {
+            return block && block == other.block;
+        }
+
+    private:
+        static std::shared_ptr<S[]> allocate(std::size_t n)
+        {
+            if (n == 0) return {};
+            if (n > std::numeric_limits<std::ptrdiff_t>::max() / sizeof(S)) throw std::bad_array_new_length();
+            // Counted in bml::allocationStats() until the last owner lets go (the deleter
+            // also runs if the control block cannot be allocated).
+            S* cells = new S[n]();
+            return std::shared_ptr<S[]>(cells, detail::CountedArrayDelete<S>{detail::noteAllocation(n * sizeof(S))});
+        }
+
+        std::shared_ptr<S[]> block;
+        std::size_t count = 0;
+        std::size_t room = 0;
+    };
+} // namespace bml
+
+#endif // BML_SHAREDBUFFER_HPP
@@ -0,0 +1,83 @@
+#ifndef BML_SINK_HPP
+#define BML_SINK_HPP
+
+#include "bml/export.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace bml
+{
+    /// @brief One contiguous piece of a gathered write.
+    struct ByteSpan
+    {
+        const void* data;
+        std::size_t size;
+    };
+
+    /**
+     * @brief Destination for bytes produced by the writers (text export, serialization).
+     *
+     * Writers hand over data in large chunks, so implementations can forward each
+     * call straight to the underlying file or buffer. Errors are reported by throwing
+     * std::runtime_error.
+     */
+    class BML_API ByteSink
+    {
+    public:
+        virtual ~ByteSink() = default;
+
+        /// @brief Append @p size bytes; either writes all of them or throws.
+        virtual void write(const void* bytes, std::size_t size) = 0;
+
+        /// @brief Append several pieces in order (one writev() where the sink supports it).
+        virtual void writeGather(const ByteSpan* spans, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i) write(spans[i].data, spans[i].size);
+        }
+
+        /// @brief Push buffered bytes to the underlying device (no-op by default).
+        virtual void flush() {}
+    };
+
+    /// @brief Writes to a C stdio stream. The stream is not closed.
+    class BML_API FileSink final : public ByteSink
+    {
+    public:
+        explicit FileSink(std::FILE* file);
+
+        void write(const void* bytes, std::size_t size) override;
+        void flush() override;
+
+    private:
+        std::FILE* file;
+    };
+
+    /// @brief Writes to a POSIX file descriptor, retrying short writes. The fd is not closed.
+    class BML_API FdSink final : public ByteSink
+    {
+    public:
+        explicit FdSink(int fd);
+
+        void write(const void* bytes, std::size_t size) override;
+        void writeGather(const ByteSpan* spans, std::size_t count) override;
+
+    private:
+        int fd;
+    };
+
+    /// @brief Appends to a caller-owned std::string.
+    class BML_API StringSink final : public ByteSink
+    {
+    public:
+        explicit StringSink(std::string& out) noexcept : out(out) {}
+
+        void write(const void* bytes, std::size_t size) override;
+
+    private:
+        std::string& out;
+    };
+} // namespace bml
+
+#endif // BML_SINK_HPP
@@ -0,0 +1,68 @@
+#ifndef BML_SOURCE_HPP
+#define BML_SOURCE_HPP
+
+#include "bml/export.hpp"
+
+#include <cstddef>
+#include <cstdio>
+
+namespace bml
+{
+    /**
+     * @brief Origin of bytes for the streaming readers; the counterpart of ByteSink.
+     *
+     * read() may return fewer bytes than asked for (e.g. what a socket has buffered);
+     * it returns 0 only at end of input. Errors are reported by throwing
+     * std::runtime_error.
+     */
+    class BML_API ByteSource
+    {
+    public:
+        virtual ~ByteSource() = default;
+
+        /// @brief Read up to @p maxBytes into @p dst; 0 means end of input.
+        virtual std::size_t read(void* dst, std::size_t maxBytes) = 0;
+    };
+
+    /// @brief Reads from a C stdio stream. The stream is not closed.
+    class BML_API FileSource final : public ByteSource
+    {
+    public:
+        explicit FileSource(std::FILE* file);
+
+        std::size_t read(void* dst, std::size_t maxBytes) override;
+
+    private:
+        std::FILE* file;
+    };
+
+    /// @brief Reads from a POSIX file descriptor (file, pipe or socket). The fd is not closed.
+    class BML_API FdSource final : public ByteSource
+    {
+    public:
+        explicit FdSource(int fd);
+
+        std::size_t read(void* dst, std::size_t maxBytes) override;
+
+    private:
+        int fd;
+    };
+
+    /// @brief Reads from a caller-owned memory range.
+    class BML_API MemorySource final : public ByteSource
+    {
+    public:
+        MemorySource(const void* bytes, std::size_t size) noexcept
+            : p(static_cast<const unsigned char*>(bytes)), remaining(size)
+        {
+        }
+
+        std::size_t read(void* dst, std::size_t maxBytes) override;
+
+    private:
+        const unsigned char* p;
+        std::size_t remaining;
+    };
+} // namespace bml
+
+#endif // BML_SOURCE_HPP
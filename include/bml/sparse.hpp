@@ -0,0 +1,162 @@
+#ifndef BML_SPARSE_HPP
+#define BML_SPARSE_HPP
+
+#include "bml/export.hpp"
+#include "bml/matrix.hpp"
+#include "bml/typeTraits.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace bml
+{
+    /// @brief Compressed storage order of a SparseMatrix.
+    enum class SparseLayout : std::uint8_t
+    {
+        CSR,   ///< compressed rows: offsets per row, column indices
+        CSC    ///< compressed columns: offsets per column, row indices
+    };
+
+    /**
+     * @brief Compressed sparse matrix (CSR or CSC) holding only the stored entries.
+     *
+     * Memory and the cost of every operation scale with nonZeros() rather than
+     * rows*cols. The "outer" dimension is rows for CSR and columns for CSC:
+     * offsets() has outer+1 entries, and the entries of outer slot @c i are
+     * indices()/values() in [offsets()[i], offsets()[i+1]), sorted by inner index
+     * without duplicates.
+     *
+     * Semantics mirror Matrix<T>: @c operator* is element-wise; use bml::matmul()
+     * and bml::matvec() for products. Operands in different layouts are converted
+     * to the left operand's layout first. Work is split by outer slot (row
+     * partition for CSR) across the worker pool.
+     *
+     * Results keep entries that cancel to zero (e.g. a - a); call pruned() to drop them.
+     *
+     * @tparam T Element type (any math-arithmetic T; bool/char excluded).
+     */
+    template <typename T>
+    class BML_API SparseMatrix
+    {
+        static_assert(bml_is_math_arithmetic<T>::value,
+                      "bml::SparseMatrix<T>: T must be a math-arithmetic type");
+
+    public:
+        using value_type = T;
+
+        /// @brief All-zero matrix.
+        SparseMatrix(std::uint32_t numRows, std::uint32_t numCols, SparseLayout layout = SparseLayout::CSR);
+
+        /// @brief Adopt compressed arrays; throws std::invalid_argument if they are inconsistent.
+        SparseMatrix(std::uint32_t numRows, std::uint32_t numCols, SparseLayout layout,
+                     std::vector<std::size_t> offsets, std::vector<std::uint32_t> indices, std::vector<T> values);
+
+        /// @brief Keep the non-zero cells of @p dense.
+        explicit SparseMatrix(const Matrix<T>& dense, SparseLayout layout = SparseLayout::CSR);
+
+        [[nodiscard]] std::uint32_t numRows() const noexcept { return rows; }
+        [[nodiscard]] std::uint32_t numCols() const noexcept { return cols; }
+        [[nodiscard]] SparseLayout layout() const noexcept { return order; }
+        [[nodiscard]] std::size_t nonZeros() const noexcept { return vals.size(); }
+        /// @brief nonZeros() / (rows*cols); 0 for an empty shape.
+        [[nodiscard]] double density() const noexcept;
+
+        [[nodiscard]] const std::vector<std::size_t>& offsets() const noexcept { return starts; }
+        [[nodiscard]] const std::vector<std::uint32_t>& indices() const noexcept { return inner; }
+        [[nodiscard]] const std::vector<T>& values() const noexcept { return vals; }
+
+        /// @brief Value at (row, col), 0 if not stored; throws std::out_of_range.
+        [[nodiscard]] T at(std::uint32_t row, std::uint32_t col) const;
+
+        [[nodiscard]] Matrix<T> toDense() const;
+        /// @brief Same matrix in @p layout (a counting sort; a copy if already in it).
+        [[nodiscard]] SparseMatrix toLayout(SparseLayout layout) const;
+        /// @brief Transposed matrix; relabels the arrays (CSR <-> CSC) without sorting.
+        [[nodiscard]] SparseMatrix transpose() const;
+        /// @brief Copy without the entries whose magnitude is <= @p tolerance.
+        [[nodiscard]] SparseMatrix pruned(T tolerance = T{0}) const;
+
+        /// @brief Apply @p f to the stored values only (implicit zeros stay zero).
+        [[nodiscard]] SparseMatrix transform(const std::function<T(T)>& f) const;
+
+        // ---- Element-wise, sparse result ----
+        SparseMatrix operator+(const SparseMatrix& other) const;   // union of patterns
+        SparseMatrix operator-(const SparseMatrix& other) const;
+        SparseMatrix operator*(const SparseMatrix& other) const;   // intersection of patterns
+        SparseMatrix operator*(const Matrix<T>& other) const;      // pattern of *this
+        SparseMatrix operator*(const T& scalar) const;
+        SparseMatrix operator/(const T& scalar) const;
+        SparseMatrix operator-() const;
+
+        // ---- Element-wise with a dense operand, dense result ----
+        Matrix<T> operator+(const Matrix<T>& other) const;
+        Matrix<T> operator-(const Matrix<T>& other) const;
+
+        // ---- Reductions (implicit zeros included) ----
+        /// @brief Sum of all cells (Kahan-compensated for floating point).
+        [[nodiscard]] T sum() const;
+        [[nodiscard]] T min() const;   // throws on empty
+        [[nodiscard]] T max() const;   // throws on empty
+        [[nodiscard]] std::vector<T> rowSums() const;
+        [[nodiscard]] std::vector<T> colSums() const;
+
+    private:
+        [[nodiscard]] std::size_t outerSize() const noexcept { return order == SparseLayout::CSR ? rows : cols; }
+        [[nodiscard]] std::size_t innerSize() const noexcept { return order == SparseLayout::CSR ? cols : rows; }
+
+        template <typename Op>
+        SparseMatrix merge(const SparseMatrix& other, bool unionPattern, Op op) const;
+        template <typename F>
+        SparseMatrix mapValues(F f) const;
+
+        std::uint32_t rows;
+        std::uint32_t cols;
+        SparseLayout order;
+        std::vector<std::size_t> starts;
+        std::vector<std::uint32_t> inner;
+        std::vector<T> vals;
+    };
+
+    /**
+     * @brief Coordinate-list (COO) builder for SparseMatrix.
+     *
+     * Entries may be added in any order; build() sorts them and sums duplicate
+     * coordinates (in the order they were added).
+     */
+    template <typename T>
+    class BML_API CooBuilder
+    {
+    public:
+        CooBuilder(std::uint32_t numRows, std::uint32_t numCols);
+
+        void reserve(std::size_t entries);
+        /// @brief Add @p value at (row, col); throws std::out_of_range.
+        void add(std::uint32_t row, std::uint32_t col, const T& value);
+        [[nodiscard]] std::size_t size() const noexcept { return vals.size(); }
+
+        [[nodiscard]] SparseMatrix<T> build(SparseLayout layout = SparseLayout::CSR) const;
+
+    private:
+        std::uint32_t rows;
+        std::uint32_t cols;
+        std::vector<std::uint32_t> rowIdx;
+        std::vector<std::uint32_t> colIdx;
+        std::vector<T> vals;
+    };
+
+    /// @brief Sparse matrix-vector product a*x (SpMV); x.size() must equal a.numCols().
+    template <typename T>
+    std::vector<T> matvec(const SparseMatrix<T>& a, const std::vector<T>& x);
+
+    /// @brief Sparse times dense matrix product (SpMM).
+    template <typename T>
+    Matrix<T> matmul(const SparseMatrix<T>& a, const Matrix<T>& b);
+
+    /// @brief Dense times sparse matrix product.
+    template <typename T>
+    Matrix<T> matmul(const Matrix<T>& a, const SparseMatrix<T>& b);
+} // namespace bml
+
+#endif // BML_SPARSE_HPP
@@ -0,0 +1,32 @@
+#ifndef BML_TEXTFORMAT_HPP
+#define BML_TEXTFORMAT_HPP
+
+namespace bml
+{
+    /**
+     * @brief Layout options for Matrix::toString(const TextFormat&) and Matrix::writeText().
+     *
+     * Cells are written row by row, separated by @c delimiter, each row ending in
+     * @c lineEnd. Numbers are formatted with std::to_chars, so the output does not
+     * depend on the global locale. Integers (including int8_t/uint8_t) are written
+     * as numbers, bool as 0/1, char and std::string cells verbatim.
+     */
+    struct TextFormat
+    {
+        /// Precision value selecting the shortest representation that reads back exactly.
+        static constexpr int kShortest = -1;
+
+        /// Significant digits for floating-point cells (like printf "%g"), at most 100;
+        /// kShortest for round-trip output.
+        int precision = 6;
+
+        char delimiter = ' ';
+
+        /// Also emit the delimiter after the last cell of each row.
+        bool trailingDelimiter = false;
+
+        char lineEnd = '\n';
+    };
+} // namespace bml
+
+#endif // BML_TEXTFORMAT_HPP
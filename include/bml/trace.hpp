@@ -0,0 +1,142 @@
+#ifndef BML_TRACE_HPP
+#define BML_TRACE_HPP
+
+#include "bml/export.hpp"
+#include "bml/perfCounters.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bml
+{
+    class ByteSink;
+
+    /// @brief One completed span.
+    struct TraceEvent
+    {
+        std::string name;            ///< operation, e.g. "operator+", or the name given to a TraceSpan
+        std::string category;        ///< "bml" for library operations, the TraceSpan category otherwise
+        std::string type;            ///< element type of library operations, empty for user spans
+        std::uint32_t rows = 0;      ///< shape of the matrix the operation ran on
+        std::uint32_t cols = 0;
+        std::uint64_t bytes = 0;     ///< nominal bytes read plus written
+        std::uint64_t startNs = 0;   ///< since the first span of the process
+        std::uint64_t durationNs = 0;
+        std::uint64_t threadId = 0;  ///< OS thread id
+    };
+
+    /// @brief Whether the library was built with trace hooks (CMake option BML_ENABLE_TRACING).
+    BML_API bool tracingCompiledIn() noexcept;
+
+    /**
+     * @brief Start or stop recording spans.
+     *
+     * Off by default, or on when the @c BML_TRACE environment variable is set to a
+     * non-zero value. While off, a hooked operation costs one relaxed load and a
+     * predicted branch; with BML_ENABLE_TRACING=OFF the hooks are not compiled.
+     *
+     * Each thread records into its own ring of the most recent 32768 spans, so
+     * recording takes no locks; older spans are overwritten and counted by
+     * traceEventsDropped().
+     */
+    BML_API void setTracingEnabled(bool enabled) noexcept;
+    BML_API bool tracingEnabled() noexcept;
+
+    /// @brief Spans recorded by all threads since the last clearTrace(), ordered by start time.
+    BML_API std::vector<TraceEvent> traceSnapshot();
+
+    /// @brief Spans lost to ring overwrites since the last clearTrace().
+    BML_API std::uint64_t traceEventsDropped() noexcept;
+
+    /// @brief Forget all recorded spans. Safe while other threads are recording.
+    BML_API void clearTrace() noexcept;
+
+    /**
+     * @brief Write the snapshot in the Chrome trace event format ("X" complete events),
+     * which chrome://tracing and ui.perfetto.dev open directly.
+     *
+     * Library spans carry dtype, rows, cols and bytes in their args.
+     */
+    BML_API void writeChromeTrace(ByteSink& sink);
+
+    /// @brief writeChromeTrace() into a file; throws std::runtime_error if it cannot be written.
+    BML_API void saveChromeTrace(const std::string& path);
+
+    namespace detail
+    {
+        extern BML_API std::atomic<bool> traceEnabled;
+
+        // Records one span when it goes out of scope. The strings must outlive the
+        // trace (string literals in practice): only the pointers are stored.
+        class BML_API TraceScope
+        {
+        public:
+            TraceScope(const char* name, const char* category, const char* type,
+                       std::uint32_t rows, std::uint32_t cols, std::uint64_t bytes) noexcept
+            {
+                if (traceEnabled.load(std::memory_order_relaxed)) open(name, category, type, rows, cols, bytes);
+            }
+
+            ~TraceScope()
+            {
+                if (name) close();
+            }
+
+            TraceScope(const TraceScope&) = delete;
+            TraceScope& operator=(const TraceScope&) = delete;
+
+        private:
+            void open(const char* n, const char* c, const char* t,
+                      std::uint32_t r, std::uint32_t k, std::uint64_t b) noexcept;
+            void close() noexcept;
+
+            // Only name is set while disabled; open() fills in the rest.
+            const char* name = nullptr;
+            const char* category;
+            const char* type;
+            std::uint32_t rows;
+            std::uint32_t cols;
+            std::uint64_t bytes;
+            std::uint64_t startNs;
+        };
+    } // namespace detail
+
+    /**
+     * @brief A span of user code on the same timeline as the library operations.
+     *
+     * @p name and @p category must outlive the trace; pass string literals.
+     * Records nothing unless tracing is enabled.
+     */
+    class TraceSpan
+    {
+    public:
+        explicit TraceSpan(const char* name, const char* category = "user") noexcept
+            : scope(name, category, nullptr, 0, 0, 0) {}
+
+    private:
+        detail::TraceScope scope;
+    };
+} // namespace bml
+
+/**
+ * @brief Trace the rest of the enclosing block as operation @p operation on a
+ * @p rows x @p cols matrix of @p T touching @p bytes bytes.
+ *
+ * Expands to nothing (arguments unevaluated) unless BML_TRACING is defined to 1,
+ * which the library build does when BML_ENABLE_TRACING is ON.
+ */
+#if defined(BML_TRACING) && BML_TRACING
+    #define BML_TRACE_SCOPE(operation, T, rows, cols, bytes)                                  \
+        const ::bml::detail::TraceScope bmlTraceScope_(operation, "bml",                      \
+                                                       ::bml::detail::elementTypeName<T>(),   \
+                                                       static_cast<std::uint32_t>(rows),      \
+                                                       static_cast<std::uint32_t>(cols),      \
+                                                       static_cast<std::uint64_t>(bytes))
+#else
+    #define BML_TRACE_SCOPE(operation, T, rows, cols, bytes) static_cast<void>(0)
+#endif
+
+#endif // BML_TRACE_HPP
@@ -0,0 +1,198 @@
+#include "bml/asyncIo.hpp"
+#include "bml/byteStream.hpp"
+#include "bml/hash.hpp"
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Snapshot layout (little-endian), header padded to BlockFile::kAlignment:
+        //   "BMLS" | version u32 | kind u8 | cell size u8 | reserved u16 | rows u32 | cols u32
+        //   | reserved u32 | payload bytes u64 | XXH64 of payload u64 || payload (toByteStream() bytes)
+        constexpr char kSnapshotMagic[4] = {'B', 'M', 'L', 'S'};
+        constexpr std::uint32_t kSnapshotVersion = 1;
+        constexpr std::size_t kSnapshotHeaderSize = 40;
+
+        template<typename T>
+        constexpr std::uint8_t snapshotKind() noexcept
+        {
+            if constexpr (std::is_same_v<T, std::string>) return 's';
+            else if constexpr (bml_is_bool<T>::value) return 'b';
+            else if constexpr (std::is_same_v<T, char>) return 'c';
+            else if constexpr (std::is_floating_point_v<T>) return 'f';
+            else if constexpr (std::is_signed_v<T>) return 'i';
+            else return 'u';
+        }
+
+        template<typename T>
+        constexpr std::uint8_t snapshotCellSize() noexcept
+        {
+            if constexpr (std::is_same_v<T, std::string>) return 0;
+            else return sizeof(storage_of_t<T>);
+        }
+
+        inline void putField(std::uint8_t* p, std::uint64_t v, int bytes) noexcept
+        {
+            for (int i = 0; i < bytes; ++i) p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+        }
+
+        inline std::uint64_t getField(const std::uint8_t* p, int bytes) noexcept
+        {
+            std::uint64_t v = 0;
+            for (int i = 0; i < bytes; ++i) v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+            return v;
+        }
+
+        [[noreturn]] inline void snapshotError(const std::string& path, const std::string& what)
+        {
+            throw std::runtime_error("loadAsync: '" + path + "' " + what);
+        }
+
+        // Cell buffer aligned for O_DIRECT, with room for the padded last block.
+        template<typename S>
+        SharedBuffer<S> alignedCells(std::size_t count)
+        {
+            constexpr std::size_t align = BlockFile::kAlignment;
+            const std::size_t bytes = (count * sizeof(S) + align - 1) / align * align;
+            std::shared_ptr<S[]> block(static_cast<S*>(::operator new(bytes, std::align_val_t{align})),
+                                       [](S* p) { ::operator delete(p, std::align_val_t{align}); });
+            return SharedBuffer<S>(std::move(block), count);
+        }
+
+        template<typename T>
+        void writeSnapshot(const Matrix<T>& m, const std::string& path, const AsyncIoOptions& options)
+        {
+            BlockFile file(path, BlockFile::Mode::Write, options);
+            Hasher64 hasher;
+            const auto* cells = m.data_storage();
+            std::uint64_t payload = 0;
+
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                for (std::size_t i = 0; i < m.size(); ++i) payload += cells[i].size() + 1;
+
+                std::size_t cell = 0, used = 0;   // position inside cells[cell], excluding its NUL
+                file.writeBlocks(BlockFile::kAlignment, payload, [&](std::uint8_t* out, std::size_t n) {
+                    std::size_t filled = 0;
+                    while (filled < n)
+                    {
+                        const std::string& s = cells[cell];
+                        const std::size_t take = std::min(s.size() - used, n - filled);
+                        std::memcpy(out + filled, s.data() + used, take);
+                        filled += take;
+                        used += take;
+                        if (used == s.size() && filled < n)
+                        {
+                            out[filled++] = 0;
+                            ++cell;
+                            used = 0;
+                        }
+                    }
+                    hasher.update(out, n);
+                });
+            }
+            else
+            {
+                payload = static_cast<std::uint64_t>(m.size()) * sizeof(*cells);
+                const auto bytes = reinterpret_cast<const std::uint8_t*>(cells);
+                std::uint64_t position = 0;
+                file.writeBlocks(BlockFile::kAlignment, payload, [&](std::uint8_t* out, std::size_t n) {
+                    std::memcpy(out, bytes + position, n);
+                    hasher.update(out, n);
+                    position += n;
+                });
+            }
+
+            // The header goes last, once the checksum is known.
+            file.writeBlocks(0, BlockFile::kAlignment, [&](std::uint8_t* out, std::size_t n) {
+                std::memset(out, 0, n);
+                std::memcpy(out, kSnapshotMagic, 4);
+                putField(out + 4, kSnapshotVersion, 4);
+                out[8] = snapshotKind<T>();
+                out[9] = snapshotCellSize<T>();
+                putField(out + 12, m.numRows(), 4);
+                putField(out + 16, m.numCols(), 4);
+                putField(out + 24, payload, 8);
+                putField(out + 32, hasher.digest(), 8);
+            });
+            file.commit();
+        }
+
+        template<typename T>
+        Matrix<T> readSnapshot(const std::string& path, const AsyncIoOptions& options)
+        {
+            BlockFile file(path, BlockFile::Mode::Read, options);
+            if (file.size() < BlockFile::kAlignment) snapshotError(path, "is not a matrix snapshot.");
+
+            std::uint8_t header[kSnapshotHeaderSize];
+            file.readBlocks(0, BlockFile::kAlignment, [&](const std::uint8_t* p, std::size_t) {
+                std::memcpy(header, p, sizeof header);
+            });
+            if (std::memcmp(header, kSnapshotMagic, 4) != 0) snapshotError(path, "is not a matrix snapshot.");
+            if (getField(header + 4, 4) != kSnapshotVersion) snapshotError(path, "has an unsupported version.");
+            if (header[8] != snapshotKind<T>() || header[9] != snapshotCellSize<T>())
+                snapshotError(path, "was written for another cell type.");
+
+            const auto rows = static_cast<std::uint32_t>(getField(header + 12, 4));
+            const auto cols = static_cast<std::uint32_t>(getField(header + 16, 4));
+            const std::uint64_t payload = getField(header + 24, 8);
+            const std::uint64_t checksum = getField(header + 32, 8);
+            const std::uint64_t cellCount = static_cast<std::uint64_t>(rows) * cols;
+            const std::uint64_t paddedPayload = (payload + BlockFile::kAlignment - 1) / BlockFile::kAlignment * BlockFile::kAlignment;
+            if (file.size() < BlockFile::kAlignment + paddedPayload) snapshotError(path, "is truncated.");
+
+            Hasher64 hasher;
+            auto verify = [&] {
+                if (hasher.digest() != checksum) snapshotError(path, "failed its checksum.");
+            };
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                if (payload < cellCount) snapshotError(path, "has an invalid payload size.");
+                Matrix<T> m(rows, cols);
+                ByteStreamDecoder<T> decoder(m);
+                file.readBlocks(BlockFile::kAlignment, payload, [&](const std::uint8_t* p, std::size_t n) {
+                    hasher.update(p, n);
+                    if (decoder.feed(p, n) != n) snapshotError(path, "has more strings than cells.");
+                });
+                if (!decoder.complete()) snapshotError(path, "has fewer strings than cells.");
+                verify();
+                return m;
+            }
+            else
+            {
+                using S = storage_of_t<T>;
+                if (payload != cellCount * sizeof(S)) snapshotError(path, "has an invalid payload size.");
+                SharedBuffer<S> cells = alignedCells<S>(static_cast<std::size_t>(cellCount));
+                file.readBlocks(BlockFile::kAlignment, payload,
+                                [&](const std::uint8_t* p, std::size_t n) { hasher.update(p, n); },
+                                reinterpret_cast<std::uint8_t*>(cells.data()));
+                verify();
+                return Matrix<T>(rows, cols, std::move(cells));
+            }
+        }
+    }
+
+    template<typename T>
+    std::future<void> saveAsync(const Matrix<T>& m, const std::string& path, const AsyncIoOptions& options)
+    {
+        return std::async(std::launch::async, [snapshot = m, path, options] {
+            detail::writeSnapshot(snapshot, path, options);
+        });
+    }
+
+    template<typename T>
+    std::future<Matrix<T>> loadAsync(const std::string& path, const AsyncIoOptions& options)
+    {
+        return std::async(std::launch::async, [path, options] {
+            return detail::readSnapshot<T>(path, options);
+        });
+    }
+} // namespace bml
@@ -0,0 +1,830 @@
+// bml_bench: microbenchmarks for every Matrix operation family and cell type.
+//
+// Each case runs a few warmup samples and then --reps timed samples; one sample
+// repeats the operation until it lasts at least --min-sample-ms. Reported per
+// case: time per operation (min, median, mean, p90, p99, max over the samples)
+// and bytes/s and elements/s at the median, plus (in the JSON) the matrix
+// buffers one operation allocates. Working sets are sized from the cache
+// hierarchy so every family is measured in L1, L2, the last-level cache and
+// DRAM. --json writes the results in a stable layout meant to be diffed
+// between releases.
+
+#include "bml/bml.hpp"
+#include "bml/version.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace bml;
+
+namespace
+{
+    // ---------- command line ----------
+    struct Options
+    {
+        std::string filter;                 // substring of the case name; empty runs everything
+        std::vector<std::string> tiers{"L1", "L2", "LLC", "DRAM"};
+        std::size_t reps = 10;
+        std::size_t warmup = 2;
+        double minSampleMs = 2.0;
+        std::string jsonPath;               // "-" for stdout
+        std::size_t threads = 0;            // 0 keeps parallelism()
+        bool list = false;
+    };
+
+    void printUsage()
+    {
+        std::cout <<
+            "usage: bml_bench [options]\n"
+            "  --filter TEXT         run only cases whose name contains TEXT\n"
+            "                        (names look like arith/add<float>@L2)\n"
+            "  --tiers LIST          comma-separated subset of L1,L2,LLC,DRAM\n"
+            "  --reps N              timed samples per case (default 10)\n"
+            "  --warmup N            untimed samples per case (default 2)\n"
+            "  --min-sample-ms MS    minimum duration of one sample (default 2)\n"
+            "  --threads N           worker threads for the parallel kernels\n"
+            "  --json FILE           write the results as JSON (- for stdout)\n"
+            "  --list                print the case names without running them\n";
+    }
+
+    std::vector<std::string> splitList(const std::string& text)
+    {
+        std::vector<std::string> out;
+        std::stringstream ss(text);
+        for (std::string item; std::getline(ss, item, ',');)
+            if (!item.empty()) out.push_back(item);
+        return out;
+    }
+
+    bool parseOptions(int argc, char** argv, Options& o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--filter") o.filter = value();
+            else if (arg == "--tiers") o.tiers = splitList(value());
+            else if (arg == "--reps") o.reps = std::max<std::size_t>(1, std::stoul(value()));
+            else if (arg == "--warmup") o.warmup = std::stoul(value());
+            else if (arg == "--min-sample-ms") o.minSampleMs = std::stod(value());
+            else if (arg == "--threads") o.threads = std::stoul(value());
+            else if (arg == "--json") o.jsonPath = value();
+            else if (arg == "--list") o.list = true;
+            else if (arg == "--help" || arg == "-h") return false;
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+        for (const std::string& t : o.tiers)
+            if (t != "L1" && t != "L2" && t != "LLC" && t != "DRAM")
+                throw std::invalid_argument("unknown tier " + t);
+        return true;
+    }
+
+    // ---------- machine ----------
+    struct CacheSizes
+    {
+        std::size_t l1 = 32 * 1024;
+        std::size_t l2 = 1024 * 1024;
+        std::size_t llc = 32 * 1024 * 1024;
+    };
+
+    CacheSizes detectCaches()
+    {
+        CacheSizes c;
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+        const long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+        const long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if (l1 > 0) c.l1 = static_cast<std::size_t>(l1);
+        if (l2 > 0) c.l2 = static_cast<std::size_t>(l2);
+        if (l3 > 0) c.llc = static_cast<std::size_t>(l3);
+        else if (l2 > 0) c.llc = static_cast<std::size_t>(l2);
+#endif
+        return c;
+    }
+
+    std::string cpuModel()
+    {
+        std::ifstream in("/proc/cpuinfo");
+        for (std::string line; std::getline(in, line);)
+        {
+            if (line.rfind("model name", 0) != 0) continue;
+            const std::size_t colon = line.find(':');
+            if (colon != std::string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+        }
+        return "unknown";
+    }
+
+    // Working set of one case: about half a cache level, so inputs and output stay
+    // resident, or four times the last level for DRAM.
+    struct Tier
+    {
+        std::string name;
+        std::size_t bytes;
+    };
+
+    std::vector<Tier> selectTiers(const Options& o, const CacheSizes& c)
+    {
+        std::vector<Tier> out;
+        for (const std::string& t : o.tiers)
+        {
+            if (t == "L1") out.push_back({t, c.l1 / 2});
+            else if (t == "L2") out.push_back({t, c.l2 / 2});
+            else if (t == "LLC") out.push_back({t, c.llc / 2});
+            else out.push_back({t, c.llc * 4});
+        }
+        return out;
+    }
+
+    // ---------- statistics ----------
+    struct Stats
+    {
+        double min = 0, median = 0, mean = 0, p90 = 0, p99 = 0, max = 0;
+    };
+
+    // Linear interpolation between the closest ranks of sorted samples.
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.size() == 1) return sorted.front();
+        const double pos = p * static_cast<double>(sorted.size() - 1);
+        const std::size_t lo = static_cast<std::size_t>(pos);
+        const std::size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - static_cast<double>(lo));
+    }
+
+    Stats summarize(std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        Stats s;
+        s.min = samples.front();
+        s.max = samples.back();
+        s.median = percentile(samples, 0.5);
+        s.p90 = percentile(samples, 0.9);
+        s.p99 = percentile(samples, 0.99);
+        double total = 0;
+        for (double v : samples) total += v;
+        s.mean = total / static_cast<double>(samples.size());
+        return s;
+    }
+
+    std::string formatTime(double ns)
+    {
+        char buf[32];
+        if (ns < 1e3) std::snprintf(buf, sizeof buf, "%.1f ns", ns);
+        else if (ns < 1e6) std::snprintf(buf, sizeof buf, "%.2f us", ns / 1e3);
+        else if (ns < 1e9) std::snprintf(buf, sizeof buf, "%.2f ms", ns / 1e6);
+        else std::snprintf(buf, sizeof buf, "%.2f s", ns / 1e9);
+        return buf;
+    }
+
+    std::string formatRate(double perSecond, const char* unit)
+    {
+        static constexpr const char* prefixes[] = {"", "K", "M", "G", "T"};
+        int i = 0;
+        while (perSecond >= 1000.0 && i < 4) { perSecond /= 1000.0; ++i; }
+        char buf[32];
+        std::snprintf(buf, sizeof buf, "%.2f %s%s/s", perSecond, prefixes[i], unit);
+        return buf;
+    }
+
+    std::string jsonEscape(const std::string& s)
+    {
+        std::string out;
+        for (char ch : s)
+        {
+            if (ch == '"' || ch == '\\') { out += '\\'; out += ch; }
+            else if (static_cast<unsigned char>(ch) < 0x20) out += ' ';
+            else out += ch;
+        }
+        return out;
+    }
+
+    // ---------- harness ----------
+    struct CaseInfo
+    {
+        std::string family;
+        std::string op;
+        std::string type;
+        std::string tier;
+        std::uint32_t rows = 0;
+        std::uint32_t cols = 0;
+        double bytes = 0;      // bytes read plus written by one operation
+        double elements = 0;   // cells processed by one operation
+
+        [[nodiscard]] std::string name() const { return family + "/" + op + "<" + type + ">@" + tier; }
+    };
+
+    struct Result
+    {
+        CaseInfo info;
+        std::size_t iterations = 0;   // operations per sample
+        std::size_t samples = 0;
+        Stats ns;                     // per operation
+        std::uint64_t allocations = 0;      // matrix buffers allocated by one operation
+        std::uint64_t allocatedBytes = 0;
+        std::string error;
+    };
+
+    // Keeps the compiler from discarding a result nobody reads.
+    template<typename V>
+    inline void keep(const V& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static const void* volatile sink;
+        sink = &value;
+#endif
+    }
+
+    class Bench
+    {
+    public:
+        explicit Bench(const Options& options) : opts(options) {}
+
+        // prepare() builds the inputs and returns the operation to time; it is only
+        // called when the case passes the filter, so skipped tiers allocate nothing.
+        void run(const CaseInfo& info, const std::function<std::function<void()>()>& prepare)
+        {
+            const std::string name = info.name();
+            if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) return;
+            if (opts.list)
+            {
+                std::cout << name << '\n';
+                return;
+            }
+
+            Result r;
+            r.info = info;
+            try
+            {
+                const std::function<void()> op = prepare();
+                r.iterations = calibrate(op);
+                for (std::size_t w = 0; w < opts.warmup; ++w) sample(op, r.iterations);
+                countAllocations(op, r);
+                std::vector<double> perOp;
+                for (std::size_t s = 0; s < opts.reps; ++s)
+                    perOp.push_back(sample(op, r.iterations) / static_cast<double>(r.iterations));
+                r.samples = perOp.size();
+                r.ns = summarize(std::move(perOp));
+            }
+            catch (const std::exception& e)
+            {
+                r.error = e.what();
+            }
+            report(r);
+            results.push_back(std::move(r));
+        }
+
+        void writeJson(std::ostream& out, const CacheSizes& caches) const
+        {
+            char stamp[32] = "";
+            const std::time_t now = std::time(nullptr);
+            if (const std::tm* utc = std::gmtime(&now)) std::strftime(stamp, sizeof stamp, "%Y-%m-%dT%H:%M:%SZ", utc);
+
+            out << "{\n  \"schema\": 1,\n";
+            out << "  \"bml_version\": \"" << BML_VERSION_MAJOR << '.' << BML_VERSION_MINOR << '.' << BML_VERSION_PATCH << "\",\n";
+            out << "  \"timestamp\": \"" << stamp << "\",\n";
+            out << "  \"host\": {\"cpu\": \"" << jsonEscape(cpuModel()) << "\", \"hardware_threads\": "
+                << std::thread::hardware_concurrency() << ", \"parallelism\": " << parallelism()
+                << ", \"l1d_bytes\": " << caches.l1 << ", \"l2_bytes\": " << caches.l2
+                << ", \"llc_bytes\": " << caches.llc << ", \"kernel_isa\": \"" << kernelIsa() << "\"},\n";
+#if defined(__VERSION__)
+            out << "  \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+#endif
+            out << "  \"config\": {\"reps\": " << opts.reps << ", \"warmup\": " << opts.warmup
+                << ", \"min_sample_ms\": " << opts.minSampleMs << ", \"filter\": \"" << jsonEscape(opts.filter) << "\"},\n";
+            out << "  \"results\": [";
+            for (std::size_t i = 0; i < results.size(); ++i)
+            {
+                const Result& r = results[i];
+                out << (i ? ",\n" : "\n") << "    {\"name\": \"" << jsonEscape(r.info.name())
+                    << "\", \"family\": \"" << r.info.family << "\", \"op\": \"" << r.info.op
+                    << "\", \"type\": \"" << r.info.type << "\", \"tier\": \"" << r.info.tier
+                    << "\", \"rows\": " << r.info.rows << ", \"cols\": " << r.info.cols;
+                if (!r.error.empty())
+                {
+                    out << ", \"error\": \"" << jsonEscape(r.error) << "\"}";
+                    continue;
+                }
+                const double seconds = r.ns.median * 1e-9;
+                out << ", \"iterations\": " << r.iterations << ", \"samples\": " << r.samples
+                    << ", \"ns\": {\"min\": " << r.ns.min << ", \"median\": " << r.ns.median
+                    << ", \"mean\": " << r.ns.mean << ", \"p90\": " << r.ns.p90 << ", \"p99\": " << r.ns.p99
+                    << ", \"max\": " << r.ns.max << "}"
+                    << ", \"bytes_per_second\": " << (seconds > 0 ? r.info.bytes / seconds : 0.0)
+                    << ", \"elements_per_second\": " << (seconds > 0 ? r.info.elements / seconds : 0.0)
+                    << ", \"allocations_per_op\": " << r.allocations
+                    << ", \"allocated_bytes_per_op\": " << r.allocatedBytes << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+        [[nodiscard]] std::size_t failures() const
+        {
+            return static_cast<std::size_t>(std::count_if(results.begin(), results.end(),
+                                                          [](const Result& r) { return !r.error.empty(); }));
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        static double sample(const std::function<void()>& op, std::size_t iterations)
+        {
+            const Clock::time_point t0 = Clock::now();
+            for (std::size_t i = 0; i < iterations; ++i) op();
+            return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        }
+
+        // Process-wide counters, so buffers that pool workers allocate are included.
+        static void countAllocations(const std::function<void()>& op, Result& r)
+        {
+            const AllocationStats before = allocationStats();
+            op();
+            const AllocationStats after = allocationStats();
+            r.allocations = after.allocations - before.allocations;
+            r.allocatedBytes = after.bytesAllocated - before.bytesAllocated;
+        }
+
+        // Operations per sample so that one sample lasts at least --min-sample-ms.
+        std::size_t calibrate(const std::function<void()>& op) const
+        {
+            const double target = opts.minSampleMs * 1e6;
+            std::size_t n = 1;
+            for (;;)
+            {
+                const double t = sample(op, n);
+                if (t >= target || n >= (std::size_t{1} << 30)) return n;
+                const double scale = t > 0 ? target / t : 100.0;
+                n = static_cast<std::size_t>(static_cast<double>(n) * std::min(100.0, std::max(2.0, scale * 1.1)));
+            }
+        }
+
+        static void report(const Result& r)
+        {
+            char line[256];
+            if (!r.error.empty())
+            {
+                std::snprintf(line, sizeof line, "%-48s  ERROR: %s\n", r.info.name().c_str(), r.error.c_str());
+                std::cout << line;
+                return;
+            }
+            const double seconds = r.ns.median * 1e-9;
+            std::snprintf(line, sizeof line, "%-48s %12s %12s %14s %16s\n", r.info.name().c_str(),
+                          formatTime(r.ns.median).c_str(), formatTime(r.ns.p90).c_str(),
+                          formatRate(seconds > 0 ? r.info.bytes / seconds : 0.0, "B").c_str(),
+                          formatRate(seconds > 0 ? r.info.elements / seconds : 0.0, "elem").c_str());
+            std::cout << line << std::flush;
+        }
+
+        const Options& opts;
+        std::vector<Result> results;
+    };
+
+    // ---------- cell types ----------
+    template<typename T>
+    const char* typeName()
+    {
+        if constexpr (std::is_same_v<T, std::int8_t>) return "int8";
+        else if constexpr (std::is_same_v<T, std::uint8_t>) return "uint8";
+        else if constexpr (std::is_same_v<T, std::int16_t>) return "int16";
+        else if constexpr (std::is_same_v<T, std::uint16_t>) return "uint16";
+        else if constexpr (std::is_same_v<T, std::int32_t>) return "int32";
+        else if constexpr (std::is_same_v<T, std::uint32_t>) return "uint32";
+        else if constexpr (std::is_same_v<T, std::int64_t>) return "int64";
+        else if constexpr (std::is_same_v<T, std::uint64_t>) return "uint64";
+        else if constexpr (std::is_same_v<T, float>) return "float";
+        else if constexpr (std::is_same_v<T, double>) return "double";
+        else if constexpr (std::is_same_v<T, long double>) return "long_double";
+        else if constexpr (std::is_same_v<T, char>) return "char";
+        else if constexpr (std::is_same_v<T, bool>) return "bool";
+        else return "string";
+    }
+
+    // Nominal bytes of one cell (the in-place std::string object for strings).
+    template<typename T>
+    constexpr double cellBytes()
+    {
+        return static_cast<double>(sizeof(typename Matrix<T>::storage_type));
+    }
+
+    // Values in [1, 100] (never 0, so they are safe divisors), letters, coin flips,
+    // and strings of 4..24 characters (some in the small-string buffer, some on the heap).
+    template<typename T>
+    T randomCell(std::mt19937_64& rng)
+    {
+        if constexpr (std::is_same_v<T, bool>) return (rng() & 1) != 0;
+        else if constexpr (std::is_same_v<T, char>) return static_cast<char>('a' + rng() % 26);
+        else if constexpr (std::is_same_v<T, std::string>)
+        {
+            std::string s(4 + rng() % 21, ' ');
+            for (char& ch : s) ch = static_cast<char>('a' + rng() % 26);
+            return s;
+        }
+        else return static_cast<T>(1 + rng() % 100);
+    }
+
+    template<typename T>
+    Matrix<T> randomMatrix(std::uint32_t rows, std::uint32_t cols, std::uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        Matrix<T> m(rows, cols);
+        for (std::uint32_t i = 0; i < rows; ++i)
+        {
+            auto row = m[i];
+            for (std::uint32_t j = 0; j < cols; ++j) row[j] = randomCell<T>(rng);
+        }
+        return m;
+    }
+
+    // Contribution of a cell to the checksum the traversal cases keep alive.
+    template<typename V>
+    std::size_t weight(const V& v)
+    {
+        if constexpr (std::is_same_v<std::decay_t<V>, std::string>) return v.size();
+        else return static_cast<std::size_t>(v);
+    }
+
+    // Inputs shared by the cases of one (type, tier): two random operands of the same shape.
+    template<typename T>
+    struct Fixture
+    {
+        explicit Fixture(std::uint32_t side)
+            : a(randomMatrix<T>(side, side, 1)), b(randomMatrix<T>(side, side, 2)), scratch(a.copy())
+        {
+        }
+
+        Matrix<T> a;
+        Matrix<T> b;
+        Matrix<T> scratch;   // target of in-place operations
+    };
+
+    // Square side such that three matrices fill the tier.
+    template<typename T>
+    std::uint32_t sideFor(std::size_t tierBytes)
+    {
+        const double cells = static_cast<double>(tierBytes) / (3.0 * cellBytes<T>());
+        return std::max<std::uint32_t>(8, static_cast<std::uint32_t>(std::sqrt(cells)));
+    }
+
+    // One (type, tier): every case reads the same lazily built fixture.
+    template<typename T>
+    class TypeBench
+    {
+    public:
+        TypeBench(Bench& bench, const Tier& tier) : bench(bench), tier(tier), side(sideFor<T>(tier.bytes)) {}
+
+        // makeOp(fixture) returns the timed operation. @p matrices is how many operands
+        // one operation reads and writes, and @p coverage the fraction of each it touches.
+        template<typename MakeOp>
+        void add(const char* family, const char* op, double matrices, MakeOp makeOp, double coverage = 1.0)
+        {
+            const double cells = static_cast<double>(side) * side * coverage;
+            CaseInfo info{family, op, typeName<T>(), tier.name, side, side, matrices * cells * cellBytes<T>(), cells};
+            bench.run(info, [&]() -> std::function<void()> {
+                Fixture<T>& f = inputs();
+                f.scratch = f.a.copy();   // undo the previous in-place case
+                return makeOp(f);
+            });
+        }
+
+        [[nodiscard]] std::uint32_t size() const noexcept { return side; }
+
+    private:
+        Fixture<T>& inputs()
+        {
+            if (!fixture) fixture = std::make_unique<Fixture<T>>(side);
+            return *fixture;
+        }
+
+        Bench& bench;
+        const Tier& tier;
+        std::uint32_t side;
+        std::unique_ptr<Fixture<T>> fixture;
+    };
+
+    // ---------- families ----------
+    template<typename T>
+    void benchStorage(TypeBench<T>& tb)
+    {
+        const std::uint32_t n = tb.size();
+        tb.add("storage", "construct", 1, [n](Fixture<T>&) {
+            return [n] { Matrix<T> m(n, n); keep(m); };
+        });
+        tb.add("storage", "fill", 1, [](Fixture<T>& f) {
+            const T value = std::as_const(f.a)[0][0];
+            return [&f, value] { f.scratch.fill(value); };
+        });
+        tb.add("storage", "copy", 2, [](Fixture<T>& f) {
+            return [&f] { keep(f.a.copy()); };
+        });
+        tb.add("storage", "copy_block", 2, [n](Fixture<T>& f) {
+            const std::uint32_t q = n / 4;
+            const auto end = static_cast<std::int32_t>(q + n / 2);
+            return [&f, q, end] { keep(f.a.copy(q, q, end, end)); };
+        }, 0.25);
+        tb.add("storage", "paste", 2, [](Fixture<T>& f) {
+            return [&f] { f.scratch.paste(f.b); };
+        });
+        tb.add("storage", "paste_block", 2, [n](Fixture<T>& f) {
+            const Matrix<T> block = f.b.copy(0, 0, static_cast<std::int32_t>(n / 2), static_cast<std::int32_t>(n / 2));
+            return [&f, block, n] { f.scratch.paste(block, n / 4, n / 4); };
+        }, 0.25);
+    }
+
+    template<typename T>
+    void benchTraversal(TypeBench<T>& tb)
+    {
+        // The diagonal orders visit one cell per row.
+        const double line = 1.0 / tb.size();
+        const struct { const char* name; TraversalType type; double coverage; } orders[] = {
+            {"row", TraversalType::Row, 1.0},
+            {"column", TraversalType::Column, 1.0},
+            {"diagonal", TraversalType::Diagonal, line},
+            {"antidiagonal", TraversalType::AntiDiagonal, line},
+        };
+        for (const auto& order : orders)
+        {
+            const TraversalType type = order.type;
+            tb.add("iterate", order.name, 1, [type](Fixture<T>& f) {
+                return [&f, type] {
+                    const Matrix<T>& m = f.a;
+                    std::size_t acc = 0;
+                    for (auto it = m.begin(type); it != m.end(type); ++it) acc += weight(std::get<2>(*it));
+                    keep(acc);
+                };
+            }, order.coverage);
+        }
+        tb.add("iterate", "index", 1, [](Fixture<T>& f) {
+            return [&f] {
+                const Matrix<T>& m = f.a;
+                std::size_t acc = 0;
+                for (std::uint32_t i = 0; i < m.numRows(); ++i)
+                {
+                    const auto row = m[i];
+                    for (std::uint32_t j = 0; j < m.numCols(); ++j) acc += weight(row[j]);
+                }
+                keep(acc);
+            };
+        });
+    }
+
+    template<typename T>
+    void benchComparison(TypeBench<T>& tb)
+    {
+        // Equal contents in separate buffers, so both have to look at every cell.
+        tb.add("compare", "eq", 2, [](Fixture<T>& f) {
+            return [&f] { keep(f.a == f.scratch); };
+        });
+        tb.add("compare", "lt", 2, [](Fixture<T>& f) {
+            return [&f] { keep(f.a < f.scratch); };
+        });
+    }
+
+    template<typename T>
+    void benchReductions(TypeBench<T>& tb)
+    {
+        if constexpr (bml_is_math_arithmetic<T>::value)
+        {
+            tb.add("reduce", "sum", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.sum()); }; });
+        }
+        tb.add("reduce", "min", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.min()); }; });
+        tb.add("reduce", "max", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.max()); }; });
+        tb.add("reduce", "argmin", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.argmin()); }; });
+        tb.add("reduce", "argmax", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.argmax()); }; });
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            tb.add("reduce", "count_true", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.count_true()); }; });
+            tb.add("reduce", "any", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.any()); }; });
+            tb.add("reduce", "none", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.none()); }; });
+        }
+    }
+
+    template<typename T>
+    void benchArithmetic(TypeBench<T>& tb)
+    {
+        tb.add("arith", "add", 3, [](Fixture<T>& f) { return [&f] { keep(f.a + f.b); }; });
+        tb.add("arith", "sub", 3, [](Fixture<T>& f) { return [&f] { keep(f.a - f.b); }; });
+        tb.add("arith", "mul", 3, [](Fixture<T>& f) { return [&f] { keep(f.a * f.b); }; });
+        tb.add("arith", "div", 3, [](Fixture<T>& f) { return [&f] { keep(f.a / f.b); }; });
+        const T s = static_cast<T>(3);
+        tb.add("arith", "add_scalar", 2, [s](Fixture<T>& f) { return [&f, s] { keep(f.a + s); }; });
+        tb.add("arith", "sub_scalar", 2, [s](Fixture<T>& f) { return [&f, s] { keep(f.a - s); }; });
+        tb.add("arith", "mul_scalar", 2, [s](Fixture<T>& f) { return [&f, s] { keep(f.a * s); }; });
+        tb.add("arith", "div_scalar", 2, [s](Fixture<T>& f) { return [&f, s] { keep(f.a / s); }; });
+
+        // In-place forms are arranged so the values do not drift between operations:
+        // += and -= alternate, and the scalar forms use the identity element.
+        tb.add("compound", "add_sub", 3, [](Fixture<T>& f) {
+            return [&f, flip = false]() mutable {
+                if (flip) f.scratch -= f.b;
+                else f.scratch += f.b;
+                flip = !flip;
+            };
+        });
+        tb.add("compound", "mul", 3, [](Fixture<T>& f) {
+            Matrix<T> ones(f.a.numRows(), f.a.numCols());
+            ones.fill(static_cast<T>(1));
+            return [&f, ones] { f.scratch *= ones; };
+        });
+        tb.add("compound", "div", 3, [](Fixture<T>& f) {
+            Matrix<T> ones(f.a.numRows(), f.a.numCols());
+            ones.fill(static_cast<T>(1));
+            return [&f, ones] { f.scratch /= ones; };
+        });
+        tb.add("compound", "add_scalar", 2, [](Fixture<T>& f) { return [&f] { f.scratch += static_cast<T>(0); }; });
+        tb.add("compound", "mul_scalar", 2, [](Fixture<T>& f) { return [&f] { f.scratch *= static_cast<T>(1); }; });
+        tb.add("compound", "div_scalar", 2, [](Fixture<T>& f) { return [&f] { f.scratch /= static_cast<T>(1); }; });
+    }
+
+    template<typename T>
+    void benchIntegral(TypeBench<T>& tb)
+    {
+        const T mask = static_cast<T>(0x5a);
+        tb.add("arith", "mod", 3, [](Fixture<T>& f) { return [&f] { keep(f.a % f.b); }; });
+        tb.add("arith", "mod_scalar", 2, [](Fixture<T>& f) { return [&f] { keep(f.a % static_cast<T>(7)); }; });
+        tb.add("bitwise", "and", 3, [](Fixture<T>& f) { return [&f] { keep(f.a & f.b); }; });
+        tb.add("bitwise", "or", 3, [](Fixture<T>& f) { return [&f] { keep(f.a | f.b); }; });
+        tb.add("bitwise", "xor", 3, [](Fixture<T>& f) { return [&f] { keep(f.a ^ f.b); }; });
+        tb.add("bitwise", "and_scalar", 2, [mask](Fixture<T>& f) { return [&f, mask] { keep(f.a & mask); }; });
+        tb.add("bitwise", "not", 2, [](Fixture<T>& f) { return [&f] { keep(~f.a); }; });
+        tb.add("bitwise", "shl", 2, [](Fixture<T>& f) { return [&f] { keep(f.a << 1); }; });
+        tb.add("bitwise", "shr", 2, [](Fixture<T>& f) { return [&f] { keep(f.a >> 1); }; });
+        // x %= 101 keeps cells <= 100; x ^= m applied twice is the identity.
+        tb.add("compound", "mod_scalar", 2, [](Fixture<T>& f) { return [&f] { f.scratch %= static_cast<T>(101); }; });
+        tb.add("compound", "xor", 3, [](Fixture<T>& f) { return [&f] { f.scratch ^= f.b; }; });
+        tb.add("compound", "xor_scalar", 2, [mask](Fixture<T>& f) { return [&f, mask] { f.scratch ^= mask; }; });
+        // Cells below 64 survive a left shift in every type, so <<= and >>= can alternate.
+        tb.add("compound", "shl_shr", 2, [](Fixture<T>& f) {
+            f.scratch = f.a & static_cast<T>(63);
+            return [&f, flip = false]() mutable {
+                if (flip) f.scratch >>= 1;
+                else f.scratch <<= 1;
+                flip = !flip;
+            };
+        });
+    }
+
+    void benchLogical(TypeBench<bool>& tb)
+    {
+        tb.add("logical", "and", 3, [](Fixture<bool>& f) { return [&f] { keep(f.a.logical_and(f.b)); }; });
+        tb.add("logical", "or", 3, [](Fixture<bool>& f) { return [&f] { keep(f.a.logical_or(f.b)); }; });
+        tb.add("logical", "xor", 3, [](Fixture<bool>& f) { return [&f] { keep(f.a.logical_xor(f.b)); }; });
+        tb.add("logical", "not", 2, [](Fixture<bool>& f) { return [&f] { keep(f.a.logical_not()); }; });
+        tb.add("logical", "and_scalar", 2, [](Fixture<bool>& f) { return [&f] { keep(f.a.logical_and(true)); }; });
+    }
+
+    template<typename T>
+    void benchSerialization(TypeBench<T>& tb)
+    {
+        tb.add("serialize", "to_bytes", 2, [](Fixture<T>& f) { return [&f] { keep(f.a.toByteStream()); }; });
+        tb.add("serialize", "from_bytes", 2, [](Fixture<T>& f) {
+            return [&f, bytes = f.a.toByteStream()] { f.scratch.initFromByteStream(bytes); };
+        });
+        tb.add("serialize", "hash", 1, [](Fixture<T>& f) { return [&f] { keep(hash(f.a)); }; });
+        tb.add("serialize", "to_text", 1, [](Fixture<T>& f) { return [&f] { keep(f.a.toString()); }; });
+
+        TextFormat csv;
+        csv.precision = TextFormat::kShortest;
+        csv.delimiter = ',';
+        tb.add("serialize", "parse_csv", 1, [csv](Fixture<T>& f) {
+            return [text = f.a.toString(csv)] { keep(parseCsv<T>(text)); };
+        });
+
+        if constexpr (!std::is_same_v<T, std::string>)
+        {
+            tb.add("serialize", "write_npy", 2, [](Fixture<T>& f) {
+                return [&f] {
+                    std::string out;
+                    StringSink sink(out);
+                    writeNpy(f.a, sink);
+                    keep(out);
+                };
+            });
+            tb.add("serialize", "parse_npy", 2, [](Fixture<T>& f) {
+                std::string bytes;
+                StringSink sink(bytes);
+                writeNpy(f.a, sink);
+                return [bytes] { keep(parseNpy<T>(bytes.data(), bytes.size())); };
+            });
+
+            static constexpr struct { const char* encode; const char* decode; Codec codec; } codecs[] = {
+                {"encode_rle", "decode_rle", Codec::Rle},
+                {"encode_delta_bitpack", "decode_delta_bitpack", Codec::DeltaBitpack},
+                {"encode_shuffle_lz", "decode_shuffle_lz", Codec::ShuffleLz},
+                {"encode_gorilla", "decode_gorilla", Codec::Gorilla},
+            };
+            for (const auto& c : codecs)
+            {
+                if (!codecSupports<T>(c.codec)) continue;
+                const Codec codec = c.codec;
+                tb.add("codec", c.encode, 1, [codec](Fixture<T>& f) { return [&f, codec] { keep(encode(f.a, codec)); }; });
+                tb.add("codec", c.decode, 1, [codec](Fixture<T>& f) {
+                    return [bytes = encode(f.a, codec)] { keep(decode<T>(bytes)); };
+                });
+            }
+        }
+    }
+
+    template<typename T>
+    void benchType(Bench& bench, const Tier& tier)
+    {
+        TypeBench<T> tb(bench, tier);
+        benchStorage(tb);
+        benchTraversal(tb);
+        benchComparison(tb);
+        if constexpr (!std::is_same_v<T, char>) benchReductions(tb);
+        if constexpr (bml_is_math_arithmetic<T>::value) benchArithmetic(tb);
+        if constexpr (bml_is_math_integral<T>::value) benchIntegral(tb);
+        if constexpr (std::is_same_v<T, bool>) benchLogical(tb);
+        benchSerialization(tb);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options opts;
+    try
+    {
+        if (!parseOptions(argc, argv, opts))
+        {
+            printUsage();
+            return 0;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "bml_bench: " << e.what() << '\n';
+        printUsage();
+        return 2;
+    }
+    if (opts.threads) setParallelism(opts.threads);
+
+    const CacheSizes caches = detectCaches();
+    Bench bench(opts);
+    if (!opts.list)
+    {
+        std::printf("%-48s %12s %12s %14s %16s\n", "case", "median", "p90", "bytes", "elements");
+    }
+    for (const Tier& tier : selectTiers(opts, caches))
+    {
+        benchType<std::int8_t>(bench, tier);
+        benchType<std::uint8_t>(bench, tier);
+        benchType<std::int16_t>(bench, tier);
+        benchType<std::uint16_t>(bench, tier);
+        benchType<std::int32_t>(bench, tier);
+        benchType<std::uint32_t>(bench, tier);
+        benchType<std::int64_t>(bench, tier);
+        benchType<std::uint64_t>(bench, tier);
+        benchType<float>(bench, tier);
+        benchType<double>(bench, tier);
+        benchType<long double>(bench, tier);
+        benchType<char>(bench, tier);
+        benchType<bool>(bench, tier);
+        benchType<std::string>(bench, tier);
+    }
+    if (opts.list) return 0;
+
+    if (!opts.jsonPath.empty())
+    {
+        if (opts.jsonPath == "-")
+        {
+            bench.writeJson(std::cout, caches);
+        }
+        else
+        {
+            std::ofstream out(opts.jsonPath);
+            bench.writeJson(out, caches);
+            if (!out)
+            {
+                std::cerr << "bml_bench: cannot write " << opts.jsonPath << '\n';
+                return 1;
+            }
+        }
+    }
+    return bench.failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,602 @@
+#include "bml/blockFile.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+  #include <io.h>
+#else
+  #include <sys/uio.h>
+  #include <unistd.h>
+  #if defined(BML_HAVE_IO_URING)
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+  #endif
+#endif
+
+namespace bml
+{
+    namespace detail
+    {
+        // One block in flight. buffer/length/offset describe what is still to be
+        // transferred and advance when the kernel moves fewer bytes than asked.
+        struct IoRequest
+        {
+            std::uint8_t* buffer = nullptr;
+            std::size_t length = 0;
+            std::uint64_t offset = 0;
+            bool write = false;
+            bool busy = false;
+            long result = 0;   // bytes transferred, or -errno
+#if !defined(_WIN32)
+            ::iovec iov{};
+#endif
+        };
+
+        class IoQueue
+        {
+        public:
+            virtual ~IoQueue() = default;
+
+            virtual void submit(IoRequest& request) = 0;
+
+            /// @brief Block until one submitted request has completed and return it.
+            virtual IoRequest& wait() = 0;
+        };
+    }
+
+    namespace
+    {
+        constexpr std::size_t kIoThreads = 4;
+        constexpr std::size_t kMaxQueueDepth = 256;
+
+        [[noreturn]] void fail(const std::string& what, const std::string& path, int error)
+        {
+            throw std::runtime_error("BlockFile: " + what + " '" + path + "': " + std::strerror(error));
+        }
+
+        constexpr std::uint64_t roundUp(std::uint64_t n, std::uint64_t to) noexcept
+        {
+            return (n + to - 1) / to * to;
+        }
+
+        struct AlignedDelete
+        {
+            void operator()(std::uint8_t* p) const noexcept
+            {
+                ::operator delete(p, std::align_val_t{BlockFile::kAlignment});
+            }
+        };
+
+        using AlignedBytes = std::unique_ptr<std::uint8_t[], AlignedDelete>;
+
+        AlignedBytes alignedBytes(std::size_t n)
+        {
+            return AlignedBytes(static_cast<std::uint8_t*>(::operator new(n, std::align_val_t{BlockFile::kAlignment})));
+        }
+
+        // One positional read or write; returns the bytes moved or -errno.
+        long transfer(int fd, const detail::IoRequest& r) noexcept
+        {
+#if !defined(_WIN32)
+            for (;;)
+            {
+                const ::ssize_t n = r.write
+                    ? ::pwrite(fd, r.buffer, r.length, static_cast<::off_t>(r.offset))
+                    : ::pread(fd, r.buffer, r.length, static_cast<::off_t>(r.offset));
+                if (n >= 0) return static_cast<long>(n);
+                if (errno != EINTR) return -errno;
+            }
+#else
+            static std::mutex seekMutex;   // no pread/pwrite: serialise seek + transfer
+            std::lock_guard<std::mutex> lock(seekMutex);
+            if (::_lseeki64(fd, static_cast<__int64>(r.offset), SEEK_SET) < 0) return -errno;
+            const unsigned step = r.length > (1u << 30) ? (1u << 30) : static_cast<unsigned>(r.length);
+            const int n = r.write ? ::_write(fd, r.buffer, step) : ::_read(fd, r.buffer, step);
+            return n >= 0 ? n : -errno;
+#endif
+        }
+
+        // Threads that run blocking transfers for the ThreadPool backend, shared by all files.
+        class IoWorkers
+        {
+        public:
+            explicit IoWorkers(std::size_t threads)
+            {
+                workers.reserve(threads);
+                for (std::size_t i = 0; i < threads; ++i)
+                    workers.emplace_back([this] { loop(); });
+            }
+
+            ~IoWorkers()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopping = true;
+                }
+                wake.notify_all();
+                for (std::thread& t : workers) t.join();
+            }
+
+            IoWorkers(const IoWorkers&) = delete;
+            IoWorkers& operator=(const IoWorkers&) = delete;
+
+            void post(std::function<void()> task)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    tasks.push_back(std::move(task));
+                }
+                wake.notify_one();
+            }
+
+        private:
+            void loop()
+            {
+                for (;;)
+                {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+                        if (tasks.empty()) return;
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                    task();
+                }
+            }
+
+            std::vector<std::thread> workers;
+            std::deque<std::function<void()>> tasks;
+            std::mutex mutex;
+            std::condition_variable wake;
+            bool stopping = false;
+        };
+
+        IoWorkers& ioWorkers()
+        {
+            static IoWorkers pool(kIoThreads);
+            return pool;
+        }
+
+        class ThreadQueue final : public detail::IoQueue
+        {
+        public:
+            explicit ThreadQueue(int fd_) : fd(fd_) {}
+
+            void submit(detail::IoRequest& r) override
+            {
+                ioWorkers().post([this, &r] {
+                    r.result = transfer(fd, r);
+                    // Notify under the lock: the waiter may destroy this queue as soon as it wakes.
+                    std::lock_guard<std::mutex> lock(mutex);
+                    completed.push_back(&r);
+                    ready.notify_one();
+                });
+            }
+
+            detail::IoRequest& wait() override
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return !completed.empty(); });
+                detail::IoRequest* r = completed.front();
+                completed.pop_front();
+                return *r;
+            }
+
+        private:
+            int fd;
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::deque<detail::IoRequest*> completed;
+        };
+
+#if defined(BML_HAVE_IO_URING)
+        int uringSetup(unsigned entries, ::io_uring_params& params) noexcept
+        {
+            std::memset(&params, 0, sizeof params);
+            return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        }
+
+        // A private io_uring instance driven through the raw system calls (no liburing).
+        // Only the thread that owns the BlockFile touches the rings.
+        class UringQueue final : public detail::IoQueue
+        {
+        public:
+            UringQueue(int fd_, unsigned entries) : fd(fd_)
+            {
+                ::io_uring_params params;
+                ring = uringSetup(entries, params);
+                if (ring < 0) throw std::runtime_error(std::string("BlockFile: io_uring unavailable: ") + std::strerror(errno));
+
+                sqBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cqBytes = params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+                const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (singleMap) sqBytes = cqBytes = std::max(sqBytes, cqBytes);
+                sqeBytes = params.sq_entries * sizeof(::io_uring_sqe);
+
+                sqRing = map(sqBytes, IORING_OFF_SQ_RING);
+                cqRing = singleMap ? sqRing : map(cqBytes, IORING_OFF_CQ_RING);
+                sqes = static_cast<::io_uring_sqe*>(map(sqeBytes, IORING_OFF_SQES));
+                if (!sqRing || !cqRing || !sqes)
+                {
+                    const int saved = errno;
+                    release();
+                    throw std::runtime_error(std::string("BlockFile: cannot map io_uring: ") + std::strerror(saved));
+                }
+
+                sqTail = field(sqRing, params.sq_off.tail);
+                sqMask = *field(sqRing, params.sq_off.ring_mask);
+                sqArray = field(sqRing, params.sq_off.array);
+                cqHead = field(cqRing, params.cq_off.head);
+                cqTail = field(cqRing, params.cq_off.tail);
+                cqMask = *field(cqRing, params.cq_off.ring_mask);
+                cqes = reinterpret_cast<::io_uring_cqe*>(static_cast<char*>(cqRing) + params.cq_off.cqes);
+            }
+
+            ~UringQueue() override { release(); }
+
+            UringQueue(const UringQueue&) = delete;
+            UringQueue& operator=(const UringQueue&) = delete;
+
+            void submit(detail::IoRequest& r) override
+            {
+                r.iov.iov_base = r.buffer;
+                r.iov.iov_len = r.length;
+
+                const unsigned tail = *sqTail;   // only we advance the tail
+                const unsigned index = tail & sqMask;
+                ::io_uring_sqe& sqe = sqes[index];
+                std::memset(&sqe, 0, sizeof sqe);
+                sqe.opcode = r.write ? IORING_OP_WRITEV : IORING_OP_READV;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(&r.iov);
+                sqe.len = 1;
+                sqe.off = r.offset;
+                sqe.user_data = reinterpret_cast<std::uint64_t>(&r);
+                sqArray[index] = index;
+                __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+                enter(1, 0, 0);
+            }
+
+            detail::IoRequest& wait() override
+            {
+                for (;;)
+                {
+                    const unsigned head = *cqHead;
+                    if (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+                    {
+                        const ::io_uring_cqe& cqe = cqes[head & cqMask];
+                        auto& r = *reinterpret_cast<detail::IoRequest*>(static_cast<std::uintptr_t>(cqe.user_data));
+                        r.result = cqe.res;
+                        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+                        return r;
+                    }
+                    enter(0, 1, IORING_ENTER_GETEVENTS);
+                }
+            }
+
+        private:
+            void* map(std::size_t bytes, long long offset) noexcept
+            {
+                void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, offset);
+                return p == MAP_FAILED ? nullptr : p;
+            }
+
+            static unsigned* field(void* base, unsigned offset) noexcept
+            {
+                return reinterpret_cast<unsigned*>(static_cast<char*>(base) + offset);
+            }
+
+            void enter(unsigned toSubmit, unsigned minComplete, unsigned flags)
+            {
+                while (::syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, nullptr, 0) < 0)
+                {
+                    if (errno != EINTR)
+                        throw std::runtime_error(std::string("BlockFile: io_uring_enter failed: ") + std::strerror(errno));
+                }
+            }
+
+            void release() noexcept
+            {
+                if (sqes) ::munmap(sqes, sqeBytes);
+                if (cqRing && cqRing != sqRing) ::munmap(cqRing, cqBytes);
+                if (sqRing) ::munmap(sqRing, sqBytes);
+                sqes = nullptr;
+                cqRing = sqRing = nullptr;
+                if (ring >= 0) ::close(ring);
+                ring = -1;
+            }
+
+            int fd;
+            int ring = -1;
+            void* sqRing = nullptr;
+            void* cqRing = nullptr;
+            ::io_uring_sqe* sqes = nullptr;
+            std::size_t sqBytes = 0, cqBytes = 0, sqeBytes = 0;
+            unsigned* sqTail = nullptr;
+            unsigned* sqArray = nullptr;
+            unsigned sqMask = 0;
+            unsigned* cqHead = nullptr;
+            unsigned* cqTail = nullptr;
+            unsigned cqMask = 0;
+            ::io_uring_cqe* cqes = nullptr;
+        };
+#endif
+
+        void resubmit(detail::IoQueue& queue, detail::IoRequest& r)
+        {
+            try
+            {
+                queue.submit(r);
+            }
+            catch (...)
+            {
+                r.busy = false;
+                throw;
+            }
+        }
+
+        void start(detail::IoQueue& queue, detail::IoRequest& r)
+        {
+            queue.submit(r);
+            r.busy = true;
+        }
+
+        // Account for one completion: finished, resubmitted for the rest, or failed.
+        void settle(detail::IoQueue& queue, detail::IoRequest& r, const std::string& path)
+        {
+            if (r.result == -EINTR || r.result == -EAGAIN)
+                return resubmit(queue, r);
+            if (r.result < 0)
+            {
+                r.busy = false;
+                fail(r.write ? "cannot write" : "cannot read", path, static_cast<int>(-r.result));
+            }
+            if (r.result == 0)
+            {
+                r.busy = false;
+                throw std::runtime_error("BlockFile: unexpected end of file '" + path + "'");
+            }
+
+            const auto n = static_cast<std::size_t>(r.result);
+            if (n < r.length)
+            {
+                r.buffer += n;
+                r.offset += n;
+                r.length -= n;
+                return resubmit(queue, r);
+            }
+            r.busy = false;
+        }
+
+        void waitFor(detail::IoQueue& queue, detail::IoRequest& r, const std::string& path)
+        {
+            while (r.busy) settle(queue, queue.wait(), path);
+        }
+
+        // After a failure: let every outstanding request finish before its buffer goes away.
+        void drain(detail::IoQueue& queue, std::vector<detail::IoRequest>& slots) noexcept
+        {
+            try
+            {
+                for (detail::IoRequest& r : slots)
+                    while (r.busy) queue.wait().busy = false;
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
+    IoBackend availableIoBackend() noexcept
+    {
+#if defined(BML_HAVE_IO_URING)
+        static const bool uring = [] {
+            ::io_uring_params params;
+            const int ring = uringSetup(2, params);
+            if (ring < 0) return false;   // ENOSYS on old kernels, EPERM under seccomp or when disabled
+            ::close(ring);
+            return true;
+        }();
+        return uring ? IoBackend::Uring : IoBackend::ThreadPool;
+#else
+        return IoBackend::ThreadPool;
+#endif
+    }
+
+    BlockFile::BlockFile(const std::string& path_, Mode mode, const AsyncIoOptions& options)
+        : path(path_),
+          activeBackend(options.backend == IoBackend::Auto ? availableIoBackend() : options.backend),
+          blockBytes(static_cast<std::size_t>(roundUp(std::max<std::size_t>(options.blockBytes, 1), kAlignment))),
+          queueDepth(std::clamp<std::size_t>(options.queueDepth, 1, kMaxQueueDepth))
+    {
+        if (mode == Mode::Write) tempPath = path + ".part";
+        const std::string& target = mode == Mode::Write ? tempPath : path;
+
+#if !defined(_WIN32)
+        const int flags = (mode == Mode::Read ? O_RDONLY : O_WRONLY | O_CREAT | O_TRUNC) | O_CLOEXEC;
+  #if defined(O_DIRECT)
+        if (options.direct)
+        {
+            fd = ::open(target.c_str(), flags | O_DIRECT, 0644);   // EINVAL on e.g. tmpfs
+            directIo = fd >= 0;
+        }
+  #endif
+        if (fd < 0) fd = ::open(target.c_str(), flags, 0644);
+#else
+        const int flags = (mode == Mode::Read ? _O_RDONLY : _O_WRONLY | _O_CREAT | _O_TRUNC) | _O_BINARY;
+        fd = ::_open(target.c_str(), flags, _S_IREAD | _S_IWRITE);
+#endif
+        if (fd < 0) fail(mode == Mode::Read ? "cannot open" : "cannot create", target, errno);
+
+        try
+        {
+            if (mode == Mode::Read)
+            {
+#if !defined(_WIN32)
+                struct ::stat st{};
+                if (::fstat(fd, &st) != 0) fail("cannot stat", path, errno);
+#else
+                struct ::_stat64 st{};
+                if (::_fstat64(fd, &st) != 0) fail("cannot stat", path, errno);
+#endif
+                fileSize = static_cast<std::uint64_t>(st.st_size);
+            }
+
+            if (activeBackend == IoBackend::Uring)
+            {
+#if defined(BML_HAVE_IO_URING)
+                queue = std::make_unique<UringQueue>(fd, static_cast<unsigned>(queueDepth));
+#else
+                throw std::runtime_error("BlockFile: built without io_uring support.");
+#endif
+            }
+            else
+            {
+                queue = std::make_unique<ThreadQueue>(fd);
+            }
+        }
+        catch (...)
+        {
+#if !defined(_WIN32)
+            ::close(fd);
+#else
+            ::_close(fd);
+#endif
+            if (mode == Mode::Write) std::remove(tempPath.c_str());
+            throw;
+        }
+    }
+
+    BlockFile::~BlockFile()
+    {
+        queue.reset();   // nothing is in flight: every transfer completes before it returns
+        if (fd >= 0)
+        {
+#if !defined(_WIN32)
+            ::close(fd);
+#else
+            ::_close(fd);
+#endif
+        }
+        if (!tempPath.empty() && !committed) std::remove(tempPath.c_str());
+    }
+
+    void BlockFile::readBlocks(std::uint64_t offset, std::uint64_t length,
+                               const std::function<void(const std::uint8_t*, std::size_t)>& consume,
+                               std::uint8_t* destination)
+    {
+        if (offset % kAlignment != 0) throw std::invalid_argument("BlockFile: offset must be a multiple of kAlignment.");
+        if (fd < 0) throw std::logic_error("BlockFile: file is already committed.");
+        if (length == 0) return;
+
+        const std::uint64_t blocks = (length + blockBytes - 1) / blockBytes;
+        const auto depth = static_cast<std::size_t>(std::min<std::uint64_t>(queueDepth, blocks));
+        AlignedBytes buffers;
+        if (!destination) buffers = alignedBytes(depth * blockBytes);
+        std::vector<detail::IoRequest> slots(depth);
+
+        auto blockBuffer = [&](std::uint64_t block) {
+            return destination ? destination + block * blockBytes : buffers.get() + (block % depth) * blockBytes;
+        };
+        auto blockSize = [&](std::uint64_t block) {
+            return static_cast<std::size_t>(std::min<std::uint64_t>(blockBytes, length - block * blockBytes));
+        };
+        auto issue = [&](std::uint64_t block) {
+            detail::IoRequest& r = slots[block % depth];
+            r.buffer = blockBuffer(block);
+            r.length = static_cast<std::size_t>(roundUp(blockSize(block), kAlignment));
+            r.offset = offset + block * blockBytes;
+            r.write = false;
+            start(*queue, r);
+        };
+
+        try
+        {
+            for (std::uint64_t block = 0; block < depth; ++block) issue(block);
+            for (std::uint64_t block = 0; block < blocks; ++block)
+            {
+                waitFor(*queue, slots[block % depth], path);
+                consume(blockBuffer(block), blockSize(block));
+                if (block + depth < blocks) issue(block + depth);
+            }
+        }
+        catch (...)
+        {
+            drain(*queue, slots);
+            throw;
+        }
+    }
+
+    void BlockFile::writeBlocks(std::uint64_t offset, std::uint64_t length,
+                                const std::function<void(std::uint8_t*, std::size_t)>& produce)
+    {
+        if (offset % kAlignment != 0) throw std::invalid_argument("BlockFile: offset must be a multiple of kAlignment.");
+        if (fd < 0) throw std::logic_error("BlockFile: file is already committed.");
+        if (length == 0) return;
+
+        const std::uint64_t blocks = (length + blockBytes - 1) / blockBytes;
+        const auto depth = static_cast<std::size_t>(std::min<std::uint64_t>(queueDepth, blocks));
+        AlignedBytes buffers = alignedBytes(depth * blockBytes);
+        std::vector<detail::IoRequest> slots(depth);
+
+        try
+        {
+            for (std::uint64_t block = 0; block < blocks; ++block)
+            {
+                detail::IoRequest& r = slots[block % depth];
+                waitFor(*queue, r, path);
+
+                std::uint8_t* buffer = buffers.get() + (block % depth) * blockBytes;
+                const auto size = static_cast<std::size_t>(std::min<std::uint64_t>(blockBytes, length - block * blockBytes));
+                produce(buffer, size);
+                const auto padded = static_cast<std::size_t>(roundUp(size, kAlignment));
+                std::memset(buffer + size, 0, padded - size);
+
+                r.buffer = buffer;
+                r.length = padded;
+                r.offset = offset + block * blockBytes;
+                r.write = true;
+                start(*queue, r);
+            }
+            for (detail::IoRequest& r : slots) waitFor(*queue, r, path);
+        }
+        catch (...)
+        {
+            drain(*queue, slots);
+            throw;
+        }
+    }
+
+    void BlockFile::commit()
+    {
+        if (tempPath.empty()) throw std::logic_error("BlockFile: commit() requires Mode::Write.");
+        if (committed) return;
+
+#if !defined(_WIN32)
+        const int closed = ::close(fd);
+#else
+        const int closed = ::_close(fd);
+        std::remove(path.c_str());   // rename() does not replace an existing file here
+#endif
+        fd = -1;
+        if (closed != 0) fail("cannot close", tempPath, errno);
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0) fail("cannot rename to", path, errno);
+        committed = true;
+    }
+} // namespace bml
@@ -0,0 +1,152 @@
+#include "bml/byteStream.hpp"
+#include "bml/sink.hpp"
+#include "bml/source.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Largest single write handed to a sink, and the read block for string streams.
+        constexpr std::size_t kStreamChunkBytes = std::size_t{1} << 20;
+        constexpr std::size_t kStreamReadBytes = std::size_t{1} << 16;
+        // Spans gathered per writeGather() call (two per string cell).
+        constexpr std::size_t kStreamMaxSpans = 512;
+
+        [[noreturn]] inline void streamEnded(std::size_t done, std::size_t total)
+        {
+            throw std::runtime_error("Byte stream ended after " + std::to_string(done) + " of "
+                                     + std::to_string(total) + " cells.");
+        }
+    }
+
+    // ======================= ByteStreamDecoder =======================
+
+    template <typename T>
+    ByteStreamDecoder<T>::ByteStreamDecoder(Matrix<T>& target)
+        : cells(target.empty() ? nullptr : target.data_storage()), cellCount(target.size())
+    {
+    }
+
+    template <typename T>
+    std::size_t ByteStreamDecoder<T>::feed(const void* bytes, std::size_t size)
+    {
+        const auto p = static_cast<const char*>(bytes);
+        std::size_t used = 0;
+
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            while (used < size && cellIndex < cellCount)
+            {
+                std::string& cell = cells[cellIndex];
+                if (!inCell)
+                {
+                    cell.clear();
+                    inCell = true;
+                }
+                const auto nul = static_cast<const char*>(std::memchr(p + used, 0, size - used));
+                if (!nul)
+                {
+                    cell.append(p + used, size - used);
+                    used = size;
+                    break;
+                }
+                const auto n = static_cast<std::size_t>(nul - (p + used));
+                cell.append(p + used, n);
+                used += n + 1;
+                ++cellIndex;
+                inCell = false;
+            }
+        }
+        else
+        {
+            using S = typename Matrix<T>::storage_type;
+            const std::size_t want = (cellCount - cellIndex) * sizeof(S) - partialBytes;
+            used = std::min(size, want);
+            if (used != 0)
+                std::memcpy(reinterpret_cast<char*>(cells + cellIndex) + partialBytes, p, used);
+            const std::size_t filled = partialBytes + used;
+            cellIndex += filled / sizeof(S);
+            partialBytes = filled % sizeof(S);
+        }
+        return used;
+    }
+
+    template <typename T>
+    void ByteStreamDecoder<T>::finish() const
+    {
+        if (!complete()) detail::streamEnded(cellIndex, cellCount);
+    }
+
+    // ======================= Matrix streaming members =======================
+
+    template<typename T>
+    void Matrix<T>::toByteStream(ByteSink& sink) const
+    {
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            static const char terminator = '\0';
+            std::vector<ByteSpan> spans;
+            spans.reserve(detail::kStreamMaxSpans);
+            std::size_t pending = 0;
+            for (const std::string& cell : data)
+            {
+                spans.push_back({cell.data(), cell.size()});
+                spans.push_back({&terminator, 1});
+                pending += cell.size() + 1;
+                if (spans.size() >= detail::kStreamMaxSpans || pending >= detail::kStreamChunkBytes)
+                {
+                    sink.writeGather(spans.data(), spans.size());
+                    spans.clear();
+                    pending = 0;
+                }
+            }
+            if (!spans.empty()) sink.writeGather(spans.data(), spans.size());
+        }
+        else
+        {
+            const auto bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+            const std::size_t total = data.size() * sizeof(store_t);
+            for (std::size_t offset = 0; offset < total; offset += detail::kStreamChunkBytes)
+                sink.write(bytes + offset, std::min(detail::kStreamChunkBytes, total - offset));
+        }
+    }
+
+    template<typename T>
+    void Matrix<T>::initFromByteStream(ByteSource& source)
+    {
+        markAllDirty();
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            ByteStreamDecoder<T> decoder(*this);
+            std::unique_ptr<char[]> block(new char[detail::kStreamReadBytes]);
+            while (!decoder.complete())
+            {
+                const std::size_t n = source.read(block.get(), detail::kStreamReadBytes);
+                if (n == 0) break;
+                if (decoder.feed(block.get(), n) != n)
+                    throw std::runtime_error("Invalid byte stream size for Matrix<std::string>");
+            }
+            decoder.finish();
+        }
+        else
+        {
+            if (data.empty()) return;
+            auto bytes = reinterpret_cast<std::uint8_t*>(data.dataForOverwrite());
+            const std::size_t total = data.size() * sizeof(store_t);
+            for (std::size_t offset = 0; offset < total; )
+            {
+                const std::size_t n = source.read(bytes + offset, std::min(detail::kStreamChunkBytes, total - offset));
+                if (n == 0) detail::streamEnded(offset / sizeof(store_t), data.size());
+                offset += n;
+            }
+        }
+    }
+} // namespace bml
@@ -0,0 +1,705 @@
+#include "bml/codec.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Stream layout (little-endian):
+        //   "BMLC" | version u8 | codec u8 | kind u8 | cell size u8 | rows u32 | cols u32
+        //   | cells per chunk u32 | chunk count u32 | encoded chunk sizes u32[count] | chunks
+        constexpr char kCodecMagic[4] = {'B', 'M', 'L', 'C'};
+        constexpr std::uint8_t kCodecVersion = 1;
+        constexpr std::size_t kCodecHeaderSize = 24;
+        constexpr std::size_t kCodecChunkCells = std::size_t{1} << 16;
+        constexpr std::size_t kDeltaBlock = 128;
+
+        [[noreturn]] inline void codecError(const std::string& what)
+        {
+            throw std::runtime_error("decode: " + what);
+        }
+
+        inline void putU32(std::vector<std::uint8_t>& out, std::uint32_t v)
+        {
+            for (int i = 0; i < 4; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+        }
+
+        inline std::uint32_t getU32(const std::uint8_t* p) noexcept
+        {
+            return static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8
+                 | static_cast<std::uint32_t>(p[2]) << 16 | static_cast<std::uint32_t>(p[3]) << 24;
+        }
+
+        inline void putVarint(std::vector<std::uint8_t>& out, std::uint64_t v)
+        {
+            while (v >= 0x80)
+            {
+                out.push_back(static_cast<std::uint8_t>(v | 0x80));
+                v >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(v));
+        }
+
+        inline std::uint64_t getVarint(const std::uint8_t*& p, const std::uint8_t* end)
+        {
+            std::uint64_t v = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                if (p == end) codecError("truncated varint");
+                const std::uint8_t byte = *p++;
+                v |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return v;
+            }
+            codecError("varint too long");
+        }
+
+        inline unsigned leadingZeros64(std::uint64_t x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return x ? static_cast<unsigned>(__builtin_clzll(x)) : 64u;
+#else
+            unsigned n = 0;
+            for (std::uint64_t bit = std::uint64_t{1} << 63; bit && !(x & bit); bit >>= 1) ++n;
+            return n;
+#endif
+        }
+
+        inline unsigned trailingZeros64(std::uint64_t x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return x ? static_cast<unsigned>(__builtin_ctzll(x)) : 64u;
+#else
+            unsigned n = 0;
+            for (; n < 64 && !(x & (std::uint64_t{1} << n)); ++n) {}
+            return n;
+#endif
+        }
+
+        inline std::uint64_t lowBits(std::uint64_t v, unsigned bits) noexcept
+        {
+            return bits >= 64 ? v : v & ((std::uint64_t{1} << bits) - 1);
+        }
+
+        // LSB-first bit stream.
+        class BitWriter
+        {
+        public:
+            explicit BitWriter(std::vector<std::uint8_t>& out) noexcept : out(out) {}
+
+            void put(std::uint64_t v, unsigned bits)
+            {
+                while (bits > 0)
+                {
+                    const unsigned take = std::min(bits, 64u - fill);
+                    acc |= lowBits(v, take) << fill;
+                    fill += take;
+                    bits -= take;
+                    v = take >= 64 ? 0 : v >> take;
+                    if (fill == 64)
+                    {
+                        for (int i = 0; i < 8; ++i) out.push_back(static_cast<std::uint8_t>(acc >> (8 * i)));
+                        acc = 0;
+                        fill = 0;
+                    }
+                }
+            }
+
+            void finish()
+            {
+                for (unsigned i = 0; i * 8 < fill; ++i) out.push_back(static_cast<std::uint8_t>(acc >> (8 * i)));
+                acc = 0;
+                fill = 0;
+            }
+
+        private:
+            std::vector<std::uint8_t>& out;
+            std::uint64_t acc = 0;
+            unsigned fill = 0;
+        };
+
+        class BitReader
+        {
+        public:
+            BitReader(const std::uint8_t* begin, const std::uint8_t* end) noexcept : p(begin), end(end) {}
+
+            std::uint64_t get(unsigned bits)
+            {
+                std::uint64_t v = 0;
+                unsigned got = 0;
+                while (got < bits)
+                {
+                    if (avail == 0) refill();
+                    const unsigned take = std::min(bits - got, avail);
+                    v |= lowBits(acc, take) << got;
+                    acc = take >= 64 ? 0 : acc >> take;
+                    avail -= take;
+                    got += take;
+                }
+                return v;
+            }
+
+            // Whole bytes not yet pulled into the bit buffer.
+            [[nodiscard]] std::size_t unreadBytes() const noexcept { return static_cast<std::size_t>(end - p); }
+
+        private:
+            void refill()
+            {
+                if (p == end) codecError("truncated bit stream");
+                const std::size_t n = std::min<std::size_t>(8, static_cast<std::size_t>(end - p));
+                acc = 0;
+                for (std::size_t i = 0; i < n; ++i) acc |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+                p += n;
+                avail = static_cast<unsigned>(n * 8);
+            }
+
+            const std::uint8_t* p;
+            const std::uint8_t* end;
+            std::uint64_t acc = 0;
+            unsigned avail = 0;
+        };
+
+        // ---------------------------------------------------------------------
+        // Run-length
+        // ---------------------------------------------------------------------
+        template<typename T, typename S>
+        void rleEncode(const S* cells, std::size_t n, std::vector<std::uint8_t>& out)
+        {
+            if constexpr (bml_is_bool<T>::value)
+            {
+                // First value, then alternating run lengths.
+                bool current = cells[0] != 0;
+                out.push_back(current ? 1 : 0);
+                std::size_t i = 0;
+                while (i < n)
+                {
+                    std::size_t j = i;
+                    while (j < n && (cells[j] != 0) == current) ++j;
+                    putVarint(out, j - i);
+                    current = !current;
+                    i = j;
+                }
+            }
+            else
+            {
+                // (run length, value) pairs; values compare bitwise so -0.0 and NaN payloads survive.
+                std::size_t i = 0;
+                while (i < n)
+                {
+                    std::size_t j = i + 1;
+                    while (j < n && std::memcmp(cells + j, cells + i, sizeof(S)) == 0) ++j;
+                    putVarint(out, j - i);
+                    const auto bytes = reinterpret_cast<const std::uint8_t*>(cells + i);
+                    out.insert(out.end(), bytes, bytes + sizeof(S));
+                    i = j;
+                }
+            }
+        }
+
+        template<typename T, typename S>
+        void rleDecode(const std::uint8_t* p, const std::uint8_t* end, S* cells, std::size_t n)
+        {
+            std::size_t i = 0;
+            if constexpr (bml_is_bool<T>::value)
+            {
+                if (p == end) codecError("empty run-length chunk");
+                bool current = *p++ != 0;
+                while (i < n)
+                {
+                    const std::uint64_t run = getVarint(p, end);
+                    if (run > n - i) codecError("run overflows chunk");
+                    std::fill(cells + i, cells + i + run, static_cast<S>(current));
+                    i += static_cast<std::size_t>(run);
+                    current = !current;
+                }
+            }
+            else
+            {
+                while (i < n)
+                {
+                    const std::uint64_t run = getVarint(p, end);
+                    if (run == 0 || run > n - i) codecError("bad run length");
+                    if (static_cast<std::size_t>(end - p) < sizeof(S)) codecError("truncated run value");
+                    S value;
+                    std::memcpy(&value, p, sizeof(S));
+                    p += sizeof(S);
+                    std::fill(cells + i, cells + i + run, value);
+                    i += static_cast<std::size_t>(run);
+                }
+            }
+            if (p != end) codecError("trailing bytes in run-length chunk");
+        }
+
+        // ---------------------------------------------------------------------
+        // Delta + zigzag + bit-packing, in blocks of kDeltaBlock cells
+        // ---------------------------------------------------------------------
+        template<typename S>
+        void deltaEncode(const S* cells, std::size_t n, std::vector<std::uint8_t>& out)
+        {
+            using U = std::make_unsigned_t<S>;
+            using SU = std::make_signed_t<U>;
+            constexpr unsigned width = sizeof(U) * 8;
+
+            BitWriter bits(out);
+            U prev = 0;
+            U zz[kDeltaBlock];
+            for (std::size_t base = 0; base < n; base += kDeltaBlock)
+            {
+                const std::size_t len = std::min(kDeltaBlock, n - base);
+                U any = 0;
+                for (std::size_t i = 0; i < len; ++i)
+                {
+                    const U x = static_cast<U>(cells[base + i]);
+                    const U d = static_cast<U>(x - prev);
+                    prev = x;
+                    const SU sd = static_cast<SU>(d);
+                    zz[i] = static_cast<U>(static_cast<U>(d << 1) ^ static_cast<U>(sd >> (width - 1)));
+                    any |= zz[i];
+                }
+                const unsigned b = any ? 64 - leadingZeros64(any) : 0;
+                bits.put(b, 7);
+                for (std::size_t i = 0; i < len; ++i) bits.put(zz[i], b);
+            }
+            bits.finish();
+        }
+
+        template<typename S>
+        void deltaDecode(const std::uint8_t* p, const std::uint8_t* end, S* cells, std::size_t n)
+        {
+            using U = std::make_unsigned_t<S>;
+            constexpr unsigned width = sizeof(U) * 8;
+
+            BitReader bits(p, end);
+            U prev = 0;
+            for (std::size_t base = 0; base < n; base += kDeltaBlock)
+            {
+                const std::size_t len = std::min(kDeltaBlock, n - base);
+                const auto b = static_cast<unsigned>(bits.get(7));
+                if (b > width) codecError("bad bit width");
+                for (std::size_t i = 0; i < len; ++i)
+                {
+                    const auto z = static_cast<U>(bits.get(b));
+                    const U d = static_cast<U>(static_cast<U>(z >> 1) ^ static_cast<U>(0u - static_cast<U>(z & 1u)));
+                    prev = static_cast<U>(prev + d);
+                    cells[base + i] = static_cast<S>(prev);
+                }
+            }
+            if (bits.unreadBytes() != 0) codecError("trailing bytes in delta chunk");
+        }
+
+        // ---------------------------------------------------------------------
+        // LZ77 (LZ4-style sequences: token, literals, 16-bit offset, match length)
+        // ---------------------------------------------------------------------
+        constexpr unsigned kLzHashBits = 14;
+        constexpr std::size_t kLzMinMatch = 4;
+        constexpr std::size_t kLzMaxOffset = 0xFFFF;
+        constexpr std::size_t kLzTail = 12;   // trailing bytes always left as literals
+
+        inline std::uint32_t load32(const std::uint8_t* p) noexcept
+        {
+            std::uint32_t v;
+            std::memcpy(&v, p, sizeof v);
+            return v;
+        }
+
+        inline void lzPutLength(std::vector<std::uint8_t>& out, std::size_t v)
+        {
+            for (; v >= 255; v -= 255) out.push_back(255);
+            out.push_back(static_cast<std::uint8_t>(v));
+        }
+
+        inline void lzSequence(std::vector<std::uint8_t>& out, const std::uint8_t* literals, std::size_t literalLen,
+                               std::size_t offset, std::size_t matchLen)
+        {
+            const std::size_t m = matchLen ? matchLen - kLzMinMatch : 0;
+            out.push_back(static_cast<std::uint8_t>((std::min<std::size_t>(literalLen, 15) << 4) | std::min<std::size_t>(m, 15)));
+            if (literalLen >= 15) lzPutLength(out, literalLen - 15);
+            out.insert(out.end(), literals, literals + literalLen);
+            if (matchLen == 0) return;   // final sequence
+            out.push_back(static_cast<std::uint8_t>(offset));
+            out.push_back(static_cast<std::uint8_t>(offset >> 8));
+            if (m >= 15) lzPutLength(out, m - 15);
+        }
+
+        inline void lzCompress(const std::uint8_t* src, std::size_t n, std::vector<std::uint8_t>& out)
+        {
+            std::vector<std::uint32_t> table(std::size_t{1} << kLzHashBits, 0);   // position + 1
+            std::size_t ip = 0, anchor = 0;
+            const std::size_t limit = n > kLzTail ? n - kLzTail : 0;
+            std::size_t misses = 0;
+            while (ip < limit)
+            {
+                const std::uint32_t seq = load32(src + ip);
+                const std::uint32_t h = (seq * 2654435761u) >> (32 - kLzHashBits);
+                const std::size_t candidate = table[h];
+                table[h] = static_cast<std::uint32_t>(ip + 1);
+                if (candidate && ip - (candidate - 1) <= kLzMaxOffset && load32(src + candidate - 1) == seq)
+                {
+                    const std::size_t ref = candidate - 1;
+                    std::size_t len = kLzMinMatch;
+                    while (ip + len < n && src[ref + len] == src[ip + len]) ++len;
+                    lzSequence(out, src + anchor, ip - anchor, ip - ref, len);
+                    ip += len;
+                    anchor = ip;
+                    misses = 0;
+                }
+                else
+                {
+                    ip += 1 + (misses++ >> 6);   // skip faster through incompressible data
+                }
+            }
+            lzSequence(out, src + anchor, n - anchor, 0, 0);
+        }
+
+        inline std::size_t lzGetLength(const std::uint8_t*& p, const std::uint8_t* end)
+        {
+            std::size_t v = 0;
+            for (;;)
+            {
+                if (p == end) codecError("truncated LZ length");
+                const std::uint8_t byte = *p++;
+                v += byte;
+                if (byte != 255) return v;
+            }
+        }
+
+        inline void lzDecompress(const std::uint8_t* p, const std::uint8_t* end, std::uint8_t* dst, std::size_t n)
+        {
+            std::size_t op = 0;
+            for (;;)
+            {
+                if (p == end) codecError("truncated LZ stream");
+                const std::uint8_t token = *p++;
+                std::size_t literalLen = token >> 4;
+                if (literalLen == 15) literalLen += lzGetLength(p, end);
+                if (literalLen > static_cast<std::size_t>(end - p) || literalLen > n - op) codecError("LZ literals overflow");
+                std::memcpy(dst + op, p, literalLen);
+                p += literalLen;
+                op += literalLen;
+                if (p == end) break;
+
+                if (end - p < 2) codecError("truncated LZ offset");
+                const std::size_t offset = static_cast<std::size_t>(p[0]) | static_cast<std::size_t>(p[1]) << 8;
+                p += 2;
+                if (offset == 0 || offset > op) codecError("bad LZ offset");
+                std::size_t matchLen = token & 15u;
+                if (matchLen == 15) matchLen += lzGetLength(p, end);
+                matchLen += kLzMinMatch;
+                if (matchLen > n - op) codecError("LZ match overflow");
+                for (std::size_t i = 0; i < matchLen; ++i, ++op) dst[op] = dst[op - offset];   // may overlap
+            }
+            if (op != n) codecError("LZ stream is short");
+        }
+
+        // ---------------------------------------------------------------------
+        // Byte shuffle + LZ
+        // ---------------------------------------------------------------------
+        template<typename S>
+        void shuffleLzEncode(const S* cells, std::size_t n, std::vector<std::uint8_t>& out)
+        {
+            constexpr std::size_t w = sizeof(S);
+            const auto bytes = reinterpret_cast<const std::uint8_t*>(cells);
+            std::vector<std::uint8_t> planes(n * w);
+            for (std::size_t i = 0; i < n; ++i)
+                for (std::size_t k = 0; k < w; ++k) planes[k * n + i] = bytes[i * w + k];
+
+            out.push_back(1);
+            lzCompress(planes.data(), planes.size(), out);
+            if (out.size() - 1 >= planes.size())   // incompressible: store the planes
+            {
+                out.assign(1, 0);
+                out.insert(out.end(), planes.begin(), planes.end());
+            }
+        }
+
+        template<typename S>
+        void shuffleLzDecode(const std::uint8_t* p, const std::uint8_t* end, S* cells, std::size_t n)
+        {
+            constexpr std::size_t w = sizeof(S);
+            if (p == end) codecError("empty shuffle chunk");
+            const std::uint8_t mode = *p++;
+            std::vector<std::uint8_t> planes(n * w);
+            if (mode == 0)
+            {
+                if (static_cast<std::size_t>(end - p) != planes.size()) codecError("bad stored chunk size");
+                std::memcpy(planes.data(), p, planes.size());
+            }
+            else if (mode == 1)
+            {
+                lzDecompress(p, end, planes.data(), planes.size());
+            }
+            else
+            {
+                codecError("bad shuffle mode");
+            }
+            auto bytes = reinterpret_cast<std::uint8_t*>(cells);
+            for (std::size_t i = 0; i < n; ++i)
+                for (std::size_t k = 0; k < w; ++k) bytes[i * w + k] = planes[k * n + i];
+        }
+
+        // ---------------------------------------------------------------------
+        // Gorilla: XOR with the previous value, reusing the previous
+        // leading/trailing-zero window when the new XOR fits inside it
+        // ---------------------------------------------------------------------
+        template<typename S>
+        using FloatBits = std::conditional_t<sizeof(S) == 4, std::uint32_t, std::uint64_t>;
+
+        template<typename S>
+        void gorillaEncode(const S* cells, std::size_t n, std::vector<std::uint8_t>& out)
+        {
+            using U = FloatBits<S>;
+            constexpr unsigned width = sizeof(U) * 8;
+            constexpr unsigned fieldBits = width == 32 ? 5 : 6;
+
+            BitWriter bits(out);
+            U prev;
+            std::memcpy(&prev, cells, sizeof prev);
+            bits.put(prev, width);
+            unsigned prevLead = width + 1, prevTrail = 0;   // no window yet
+            for (std::size_t i = 1; i < n; ++i)
+            {
+                U cur;
+                std::memcpy(&cur, cells + i, sizeof cur);
+                const U x = static_cast<U>(cur ^ prev);
+                prev = cur;
+                if (x == 0)
+                {
+                    bits.put(0, 1);
+                    continue;
+                }
+                bits.put(1, 1);
+                const unsigned lead = leadingZeros64(x) - (64 - width);
+                const unsigned trail = trailingZeros64(x);
+                if (prevLead <= width && lead >= prevLead && trail >= prevTrail)
+                {
+                    bits.put(0, 1);
+                    bits.put(x >> prevTrail, width - prevLead - prevTrail);
+                }
+                else
+                {
+                    const unsigned len = width - lead - trail;
+                    bits.put(1, 1);
+                    bits.put(lead, fieldBits);
+                    bits.put(len - 1, fieldBits);
+                    bits.put(x >> trail, len);
+                    prevLead = lead;
+                    prevTrail = trail;
+                }
+            }
+            bits.finish();
+        }
+
+        template<typename S>
+        void gorillaDecode(const std::uint8_t* p, const std::uint8_t* end, S* cells, std::size_t n)
+        {
+            using U = FloatBits<S>;
+            constexpr unsigned width = sizeof(U) * 8;
+            constexpr unsigned fieldBits = width == 32 ? 5 : 6;
+
+            BitReader bits(p, end);
+            auto prev = static_cast<U>(bits.get(width));
+            std::memcpy(cells, &prev, sizeof prev);
+            unsigned lead = width + 1, trail = 0;
+            for (std::size_t i = 1; i < n; ++i)
+            {
+                if (bits.get(1))
+                {
+                    if (bits.get(1))
+                    {
+                        lead = static_cast<unsigned>(bits.get(fieldBits));
+                        const unsigned len = static_cast<unsigned>(bits.get(fieldBits)) + 1;
+                        if (lead + len > width) codecError("bad XOR window");
+                        trail = width - lead - len;
+                    }
+                    else if (lead > width)
+                    {
+                        codecError("XOR window reused before it was set");
+                    }
+                    const auto x = static_cast<U>(bits.get(width - lead - trail) << trail);
+                    prev = static_cast<U>(prev ^ x);
+                }
+                std::memcpy(cells + i, &prev, sizeof prev);
+            }
+            if (bits.unreadBytes() != 0) codecError("trailing bytes in XOR chunk");
+        }
+
+        // ---------------------------------------------------------------------
+        // Framing
+        // ---------------------------------------------------------------------
+        template<typename T>
+        constexpr std::uint8_t codecKind() noexcept
+        {
+            if constexpr (bml_is_bool<T>::value) return 'b';
+            else if constexpr (std::is_same_v<T, char>) return 'c';
+            else if constexpr (std::is_floating_point_v<T>) return 'f';
+            else if constexpr (std::is_signed_v<T>) return 'i';
+            else return 'u';
+        }
+
+        template<typename T, typename S>
+        void encodeChunk(Codec codec, const S* cells, std::size_t n, std::vector<std::uint8_t>& out)
+        {
+            switch (codec)
+            {
+                case Codec::None:
+                {
+                    const auto bytes = reinterpret_cast<const std::uint8_t*>(cells);
+                    out.assign(bytes, bytes + n * sizeof(S));
+                    return;
+                }
+                case Codec::Rle:
+                    rleEncode<T>(cells, n, out);
+                    return;
+                case Codec::DeltaBitpack:
+                    if constexpr (std::is_integral_v<T> && !bml_is_bool<T>::value) deltaEncode(cells, n, out);
+                    return;
+                case Codec::ShuffleLz:
+                    shuffleLzEncode(cells, n, out);
+                    return;
+                case Codec::Gorilla:
+                    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) gorillaEncode(cells, n, out);
+                    return;
+            }
+        }
+
+        template<typename T, typename S>
+        void decodeChunk(Codec codec, const std::uint8_t* p, const std::uint8_t* end, S* cells, std::size_t n)
+        {
+            switch (codec)
+            {
+                case Codec::None:
+                    if (static_cast<std::size_t>(end - p) != n * sizeof(S)) codecError("bad raw chunk size");
+                    std::memcpy(cells, p, n * sizeof(S));
+                    return;
+                case Codec::Rle:
+                    rleDecode<T>(p, end, cells, n);
+                    return;
+                case Codec::DeltaBitpack:
+                    if constexpr (std::is_integral_v<T> && !bml_is_bool<T>::value) deltaDecode(p, end, cells, n);
+                    return;
+                case Codec::ShuffleLz:
+                    shuffleLzDecode(p, end, cells, n);
+                    return;
+                case Codec::Gorilla:
+                    if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) gorillaDecode(p, end, cells, n);
+                    return;
+            }
+        }
+    } // namespace detail
+
+    template <typename T>
+    bool codecSupports(Codec codec) noexcept
+    {
+        switch (codec)
+        {
+            case Codec::None:
+            case Codec::Rle:
+            case Codec::ShuffleLz:
+                return true;
+            case Codec::DeltaBitpack:
+                return std::is_integral_v<T> && !bml_is_bool<T>::value;
+            case Codec::Gorilla:
+                return std::is_same_v<T, float> || std::is_same_v<T, double>;
+        }
+        return false;
+    }
+
+    template <typename T>
+    std::vector<std::uint8_t> encode(const Matrix<T>& m, Codec codec)
+    {
+        BML_PERF_SCOPE("encode", T);
+        using S = typename Matrix<T>::storage_type;
+        if (!codecSupports<T>(codec))
+            throw std::invalid_argument("encode: codec " + std::to_string(static_cast<int>(codec))
+                                        + " does not support this matrix type.");
+
+        const std::size_t n = m.size();
+        const std::size_t chunks = (n + detail::kCodecChunkCells - 1) / detail::kCodecChunkCells;
+        if (chunks > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("encode: matrix too large.");
+
+        const S* cells = m.data_storage();
+        std::vector<std::vector<std::uint8_t>> parts(chunks);
+        parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c)
+            {
+                const std::size_t first = c * detail::kCodecChunkCells;
+                const std::size_t len = std::min(detail::kCodecChunkCells, n - first);
+                detail::encodeChunk<T>(codec, cells + first, len, parts[c]);
+                if (parts[c].size() > std::numeric_limits<std::uint32_t>::max())
+                    throw std::length_error("encode: chunk too large.");
+            }
+        });
+
+        std::size_t total = detail::kCodecHeaderSize + 4 * chunks;
+        for (const auto& part : parts) total += part.size();
+
+        std::vector<std::uint8_t> out;
+        out.reserve(total);
+        out.insert(out.end(), detail::kCodecMagic, detail::kCodecMagic + 4);
+        out.push_back(detail::kCodecVersion);
+        out.push_back(static_cast<std::uint8_t>(codec));
+        out.push_back(detail::codecKind<T>());
+        out.push_back(static_cast<std::uint8_t>(sizeof(S)));
+        detail::putU32(out, m.numRows());
+        detail::putU32(out, m.numCols());
+        detail::putU32(out, static_cast<std::uint32_t>(detail::kCodecChunkCells));
+        detail::putU32(out, static_cast<std::uint32_t>(chunks));
+        for (const auto& part : parts) detail::putU32(out, static_cast<std::uint32_t>(part.size()));
+        for (const auto& part : parts) out.insert(out.end(), part.begin(), part.end());
+        return out;
+    }
+
+    template <typename T>
+    Matrix<T> decode(const std::uint8_t* bytes, std::size_t size)
+    {
+        BML_PERF_SCOPE("decode", T);
+        using S = typename Matrix<T>::storage_type;
+        if (size < detail::kCodecHeaderSize || std::memcmp(bytes, detail::kCodecMagic, 4) != 0)
+            detail::codecError("not an encoded matrix");
+        if (bytes[4] != detail::kCodecVersion) detail::codecError("unsupported stream version");
+        const auto codec = static_cast<Codec>(bytes[5]);
+        if (bytes[5] > static_cast<std::uint8_t>(Codec::Gorilla) || !codecSupports<T>(codec))
+            detail::codecError("unknown codec for this type");
+        if (bytes[6] != detail::codecKind<T>() || bytes[7] != sizeof(S))
+            detail::codecError("stream was encoded from a different cell type");
+
+        const std::uint32_t rows = detail::getU32(bytes + 8);
+        const std::uint32_t cols = detail::getU32(bytes + 12);
+        const std::size_t chunkCells = detail::getU32(bytes + 16);
+        const std::size_t chunks = detail::getU32(bytes + 20);
+        const std::size_t n = static_cast<std::size_t>(rows) * cols;
+        if ((n == 0 && chunks != 0) || (n != 0 && (chunkCells == 0 || chunks != (n + chunkCells - 1) / chunkCells)))
+            detail::codecError("inconsistent chunk table");
+        if (chunks > (size - detail::kCodecHeaderSize) / 4) detail::codecError("truncated chunk table");
+
+        std::vector<std::size_t> offsets(chunks + 1);
+        offsets[0] = detail::kCodecHeaderSize + 4 * chunks;
+        for (std::size_t c = 0; c < chunks; ++c)
+        {
+            offsets[c + 1] = offsets[c] + detail::getU32(bytes + detail::kCodecHeaderSize + 4 * c);
+            if (offsets[c + 1] > size) detail::codecError("truncated chunk data");
+        }
+        if (offsets[chunks] != size) detail::codecError("trailing bytes after the last chunk");
+
+        Matrix<T> m(rows, cols);
+        if (n == 0) return m;
+        S* cells = m.data_storage();
+        parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c)
+            {
+                const std::size_t first = c * chunkCells;
+                detail::decodeChunk<T>(codec, bytes + offsets[c], bytes + offsets[c + 1],
+                                       cells + first, std::min(chunkCells, n - first));
+            }
+        });
+        return m;
+    }
+} // namespace bml
@@ -0,0 +1,553 @@
+#include "bml/convolve.hpp"
+#include "bml/dispatch.hpp"
+#include "bml/gemm.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Output columns accumulated per step of correlateRow(); padded rows carry this
+        // many extra zeros so the step never needs a remainder loop.
+        constexpr std::size_t kConvTile = 64;
+
+        // Auto uses the direct window up to this many kernel cells and the FFT above. The
+        // banded GEMM multiplies about twice the taps for one kernel and never came
+        // out ahead of the register-blocked window, so it is only used on request.
+        constexpr std::size_t kConvDirectMax = 225;
+
+        // Input rows per GEMM call (bounds the row-window buffer).
+        constexpr std::size_t kConvGemmRows = 256;
+
+        // Index of the input cell that stands for position i of an n-cell axis; -1 for zero.
+        inline std::int64_t boundaryIndex(std::int64_t i, std::int64_t n, BoundaryMode mode) noexcept
+        {
+            if (i >= 0 && i < n) return i;
+            switch (mode)
+            {
+                case BoundaryMode::Wrap:
+                {
+                    const std::int64_t r = i % n;
+                    return r < 0 ? r + n : r;
+                }
+                case BoundaryMode::Reflect:
+                {
+                    if (n == 1) return 0;
+                    const std::int64_t period = 2 * (n - 1);
+                    std::int64_t r = i % period;
+                    if (r < 0) r += period;
+                    return r < n ? r : period - r;
+                }
+                case BoundaryMode::Zero:
+                    break;
+            }
+            return -1;
+        }
+
+        // Length of a row of n cells once padded for a kc-column kernel.
+        inline std::size_t paddedLength(std::size_t n, std::size_t kc) noexcept
+        {
+            return n + kc - 1 + kConvTile;
+        }
+
+        // src extended by anchor cells on the left and kc-1-anchor on the right per the
+        // boundary mode, followed by kConvTile zeros.
+        template<typename T>
+        void padRow(const T* src, std::size_t n, std::size_t kc, std::size_t anchor, BoundaryMode mode, T* dst)
+        {
+            const auto width = static_cast<std::int64_t>(n);
+            const std::size_t extended = n + kc - 1;
+            for (std::size_t j = 0; j < anchor; ++j)
+            {
+                const std::int64_t idx = boundaryIndex(static_cast<std::int64_t>(j) - static_cast<std::int64_t>(anchor), width, mode);
+                dst[j] = idx < 0 ? T{0} : src[idx];
+            }
+            std::copy(src, src + n, dst + anchor);
+            for (std::size_t j = anchor + n; j < extended; ++j)
+            {
+                const std::int64_t idx = boundaryIndex(static_cast<std::int64_t>(j) - static_cast<std::int64_t>(anchor), width, mode);
+                dst[j] = idx < 0 ? T{0} : src[idx];
+            }
+            std::fill(dst + extended, dst + extended + kConvTile, T{0});
+        }
+
+        // out[j] = sum_uv taps[u*kc + v] * rows[u][j + v] for j < width; rows are padded.
+        template<typename T>
+        BML_HOT_KERNEL void correlateRow(const T* const* rows, const T* taps, std::size_t kr, std::size_t kc,
+                          std::size_t width, T* out)
+        {
+            for (std::size_t j0 = 0; j0 < width; j0 += kConvTile)
+            {
+                T acc[kConvTile] = {};
+                for (std::size_t u = 0; u < kr; ++u)
+                {
+                    const T* src = rows[u] + j0;
+                    for (std::size_t v = 0; v < kc; ++v)
+                    {
+                        const T s = taps[u * kc + v];
+                        if (s == T{0}) continue;
+                        const T* p = src + v;
+                        for (std::size_t j = 0; j < kConvTile; ++j) acc[j] += s * p[j];
+                    }
+                }
+                std::copy(acc, acc + std::min(kConvTile, width - j0), out + j0);
+            }
+        }
+
+        // Input rows padded horizontally; rows outside the input resolve per the boundary mode.
+        template<typename T>
+        struct PaddedRows
+        {
+            PaddedRows(const Matrix<T>& input, std::size_t kc, std::size_t anchor, BoundaryMode mode)
+                : rows(input.numRows()), stride(paddedLength(input.numCols(), kc)), mode(mode),
+                  cells(rows * stride), zeros(stride, T{0})
+            {
+                const T* src = input.data_storage();
+                const std::size_t cols = input.numCols();
+                parallelFor(rows, 64, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t r = begin; r < end; ++r)
+                        padRow(src + r * cols, cols, kc, anchor, mode, cells.data() + r * stride);
+                });
+            }
+
+            const T* row(std::int64_t r) const noexcept
+            {
+                const std::int64_t idx = boundaryIndex(r, static_cast<std::int64_t>(rows), mode);
+                return idx < 0 ? zeros.data() : cells.data() + static_cast<std::size_t>(idx) * stride;
+            }
+
+            std::size_t rows;
+            std::size_t stride;
+            BoundaryMode mode;
+            std::vector<T> cells;
+            std::vector<T> zeros;
+        };
+
+        // Rank-1 test: taps == column * row^T up to rounding.
+        template<typename T>
+        bool splitSeparable(const std::vector<T>& taps, std::size_t kr, std::size_t kc,
+                            std::vector<T>& column, std::vector<T>& row)
+        {
+            std::size_t peak = 0;
+            for (std::size_t i = 1; i < taps.size(); ++i)
+                if (std::abs(taps[i]) > std::abs(taps[peak])) peak = i;
+            const std::size_t p = peak / kc, q = peak % kc;
+            const T largest = std::abs(taps[peak]);
+
+            column.resize(kr);
+            row.resize(kc);
+            if (largest == T{0})
+            {
+                std::fill(column.begin(), column.end(), T{0});
+                std::fill(row.begin(), row.end(), T{0});
+                return true;
+            }
+            for (std::size_t u = 0; u < kr; ++u) column[u] = taps[u * kc + q];
+            for (std::size_t v = 0; v < kc; ++v) row[v] = taps[p * kc + v] / taps[peak];
+
+            const T tolerance = largest * static_cast<T>(16 * (kr + kc)) * std::numeric_limits<T>::epsilon();
+            for (std::size_t u = 0; u < kr; ++u)
+                for (std::size_t v = 0; v < kc; ++v)
+                    if (std::abs(taps[u * kc + v] - column[u] * row[v]) > tolerance) return false;
+            return true;
+        }
+
+        template<typename T>
+        void correlateDirect(const PaddedRows<T>& in, const std::vector<T>& taps, std::size_t kr, std::size_t kc,
+                             std::size_t anchor, std::size_t cols, T* out)
+        {
+            parallelFor(in.rows, 4, [&](std::size_t begin, std::size_t end) {
+                std::vector<const T*> window(kr);
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    for (std::size_t u = 0; u < kr; ++u)
+                        window[u] = in.row(static_cast<std::int64_t>(i + u) - static_cast<std::int64_t>(anchor));
+                    correlateRow(window.data(), taps.data(), kr, kc, cols, out + i * cols);
+                }
+            });
+        }
+
+        // Row pass over every input row, then a column pass over the filtered rows
+        // (the vertical boundary applies to them just as to the input).
+        template<typename T>
+        void correlateSeparable(const PaddedRows<T>& in, const std::vector<T>& column, const std::vector<T>& row,
+                                std::size_t anchor, std::size_t cols, T* out)
+        {
+            const std::size_t kr = column.size();
+            const std::size_t stride = cols + kConvTile;
+            std::vector<T> filtered(in.rows * stride, T{0});
+            parallelFor(in.rows, 16, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t r = begin; r < end; ++r)
+                {
+                    const T* src = in.cells.data() + r * in.stride;
+                    correlateRow(&src, row.data(), 1, row.size(), cols, filtered.data() + r * stride);
+                }
+            });
+
+            const std::vector<T> zeros(stride, T{0});
+            parallelFor(in.rows, 8, [&](std::size_t begin, std::size_t end) {
+                std::vector<const T*> window(kr);
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    for (std::size_t u = 0; u < kr; ++u)
+                    {
+                        const std::int64_t idx = boundaryIndex(static_cast<std::int64_t>(i + u) - static_cast<std::int64_t>(anchor),
+                                                               static_cast<std::int64_t>(in.rows), in.mode);
+                        window[u] = idx < 0 ? zeros.data() : filtered.data() + static_cast<std::size_t>(idx) * stride;
+                    }
+                    correlateRow(window.data(), column.data(), kr, 1, cols, out + i * cols);
+                }
+            });
+        }
+
+        /*
+         * im2col adapted to a single kernel: for a tile of W output columns, row i of
+         * the window matrix holds the kr padded input rows around i, each cut to the
+         * W + kc - 1 cells the tile reads. The kernel becomes a banded
+         * (kr*(W+kc-1)) x W matrix whose column j holds the taps shifted by j, so a
+         * tile of output is one GEMM.
+         */
+        template<typename T>
+        void correlateGemm(const PaddedRows<T>& in, const std::vector<T>& taps, std::size_t kr, std::size_t kc,
+                           std::size_t anchor, std::size_t cols, T* out)
+        {
+            const std::size_t W = std::min(kConvTile, std::max<std::size_t>(16, 2 * kc));
+            const std::size_t span = W + kc - 1;
+            const std::size_t depth = kr * span;
+
+            std::vector<T> banded(depth * W, T{0});
+            for (std::size_t u = 0; u < kr; ++u)
+                for (std::size_t j = 0; j < W; ++j)
+                    for (std::size_t v = 0; v < kc; ++v) banded[(u * span + j + v) * W + j] = taps[u * kc + v];
+
+            std::vector<T> windows(std::min(kConvGemmRows, in.rows) * depth);
+            for (std::size_t i0 = 0; i0 < in.rows; i0 += kConvGemmRows)
+            {
+                const std::size_t rowsHere = std::min(kConvGemmRows, in.rows - i0);
+                for (std::size_t j0 = 0; j0 < cols; j0 += W)
+                {
+                    parallelFor(rowsHere, 16, [&](std::size_t begin, std::size_t end) {
+                        for (std::size_t r = begin; r < end; ++r)
+                        {
+                            T* dst = windows.data() + r * depth;
+                            for (std::size_t u = 0; u < kr; ++u)
+                            {
+                                const T* src = in.row(static_cast<std::int64_t>(i0 + r + u) - static_cast<std::int64_t>(anchor)) + j0;
+                                std::copy(src, src + span, dst + u * span);
+                            }
+                        }
+                    });
+                    gemm(false, false, rowsHere, std::min(W, cols - j0), depth, T{1}, windows.data(), depth,
+                         banded.data(), W, T{0}, out + i0 * cols + j0, cols);
+                }
+            }
+        }
+
+        // ---- FFT ----
+
+        template<typename T>
+        inline std::complex<T> complexMul(const std::complex<T>& a, const std::complex<T>& b) noexcept
+        {
+            return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+        }
+
+        // exp(-2 pi i k / n) for k < n/2.
+        template<typename T>
+        std::vector<std::complex<T>> fftTwiddles(std::size_t n)
+        {
+            std::vector<std::complex<T>> w(n / 2);
+            const T pi = std::acos(T{-1});
+            for (std::size_t k = 0; k < w.size(); ++k)
+            {
+                const T angle = -2 * pi * static_cast<T>(k) / static_cast<T>(n);
+                w[k] = {std::cos(angle), std::sin(angle)};
+            }
+            return w;
+        }
+
+        // In-place iterative radix-2 FFT of a power-of-two length (unscaled inverse).
+        template<typename T>
+        void fft(std::complex<T>* a, std::size_t n, const std::vector<std::complex<T>>& twiddles, bool inverse)
+        {
+            for (std::size_t i = 1, j = 0; i < n; ++i)
+            {
+                std::size_t bit = n >> 1;
+                for (; j & bit; bit >>= 1) j ^= bit;
+                j ^= bit;
+                if (i < j) std::swap(a[i], a[j]);
+            }
+            for (std::size_t len = 2; len <= n; len <<= 1)
+            {
+                const std::size_t half = len / 2, step = n / len;
+                for (std::size_t i = 0; i < n; i += len)
+                    for (std::size_t k = 0; k < half; ++k)
+                    {
+                        const std::complex<T> w = inverse ? std::conj(twiddles[k * step]) : twiddles[k * step];
+                        const std::complex<T> x = a[i + k];
+                        const std::complex<T> y = complexMul(a[i + k + half], w);
+                        a[i + k] = x + y;
+                        a[i + k + half] = x - y;
+                    }
+            }
+        }
+
+        // Rows, then columns (gathered a few at a time so reads stay row-contiguous).
+        template<typename T>
+        void fft2d(std::vector<std::complex<T>>& grid, std::size_t n1, std::size_t n2,
+                   const std::vector<std::complex<T>>& tw1, const std::vector<std::complex<T>>& tw2, bool inverse)
+        {
+            parallelFor(n1, 8, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t r = begin; r < end; ++r) fft(grid.data() + r * n2, n2, tw2, inverse);
+            });
+            constexpr std::size_t group = 8;
+            parallelFor((n2 + group - 1) / group, 1, [&](std::size_t begin, std::size_t end) {
+                std::vector<std::complex<T>> columns(group * n1);
+                for (std::size_t g = begin; g < end; ++g)
+                {
+                    const std::size_t c0 = g * group, width = std::min(group, n2 - c0);
+                    for (std::size_t r = 0; r < n1; ++r)
+                        for (std::size_t c = 0; c < width; ++c) columns[c * n1 + r] = grid[r * n2 + c0 + c];
+                    for (std::size_t c = 0; c < width; ++c) fft(columns.data() + c * n1, n1, tw1, inverse);
+                    for (std::size_t r = 0; r < n1; ++r)
+                        for (std::size_t c = 0; c < width; ++c) grid[r * n2 + c0 + c] = columns[c * n1 + r];
+                }
+            });
+        }
+
+        inline std::size_t nextPowerOfTwo(std::size_t n) noexcept
+        {
+            std::size_t p = 1;
+            while (p < n) p <<= 1;
+            return p;
+        }
+
+        /*
+         * Overlap-save: the output is cut into tiles of (n1 - kr + 1) x (n2 - kc + 1)
+         * cells, each obtained from one n1 x n2 circular convolution of the
+         * boundary-extended input block with the rotated kernel; the cells read back
+         * are free of wrap-around. As the kernel is real, two tiles share one complex
+         * transform (one in the real, one in the imaginary part). Tiles of about four
+         * kernel extents keep the transforms in cache and the overlap small.
+         */
+        template<typename T>
+        void correlateFft(const PaddedRows<T>& in, const std::vector<T>& taps, std::size_t kr, std::size_t kc,
+                          std::size_t anchor, std::size_t cols, T* out)
+        {
+            const std::size_t rows = in.rows;
+            const std::size_t extCols = cols + kc - 1;
+            const std::size_t n1 = std::min(nextPowerOfTwo(rows + kr - 1), std::max<std::size_t>(64, nextPowerOfTwo(4 * kr)));
+            const std::size_t n2 = std::min(nextPowerOfTwo(extCols), std::max<std::size_t>(64, nextPowerOfTwo(4 * kc)));
+            const std::size_t tileRows = n1 - kr + 1, tileCols = n2 - kc + 1;
+            const std::size_t tilesDown = (rows + tileRows - 1) / tileRows;
+            const std::size_t tilesAcross = (cols + tileCols - 1) / tileCols;
+            const std::size_t tiles = tilesDown * tilesAcross;
+            const auto tw1 = fftTwiddles<T>(n1);
+            const auto tw2 = fftTwiddles<T>(n2);
+
+            std::vector<std::complex<T>> filter(n1 * n2);
+            for (std::size_t u = 0; u < kr; ++u)
+                for (std::size_t v = 0; v < kc; ++v)
+                    filter[u * n2 + v] = taps[(kr - 1 - u) * kc + (kc - 1 - v)];
+            fft2d(filter, n1, n2, tw1, tw2, false);
+            const T scale = T{1} / static_cast<T>(n1 * n2);
+
+            parallelFor((tiles + 1) / 2, 1, [&](std::size_t begin, std::size_t end) {
+                std::vector<std::complex<T>> grid(n1 * n2);
+                for (std::size_t pair = begin; pair < end; ++pair)
+                {
+                    std::fill(grid.begin(), grid.end(), std::complex<T>{});
+                    const std::size_t count = std::min<std::size_t>(2, tiles - 2 * pair);
+                    for (std::size_t t = 0; t < count; ++t)
+                    {
+                        const std::size_t tile = 2 * pair + t;
+                        const std::size_t i0 = tile / tilesAcross * tileRows, j0 = tile % tilesAcross * tileCols;
+                        const std::size_t width = std::min(n2, extCols - j0);
+                        const std::size_t height = std::min(n1, rows - i0 + kr - 1);
+                        for (std::size_t r = 0; r < height; ++r)
+                        {
+                            const T* src = in.row(static_cast<std::int64_t>(i0 + r) - static_cast<std::int64_t>(anchor)) + j0;
+                            std::complex<T>* dst = grid.data() + r * n2;
+                            if (t == 0)
+                                for (std::size_t c = 0; c < width; ++c) dst[c] = {src[c], T{0}};
+                            else
+                                for (std::size_t c = 0; c < width; ++c) dst[c].imag(src[c]);
+                        }
+                    }
+
+                    fft2d(grid, n1, n2, tw1, tw2, false);
+                    for (std::size_t i = 0; i < grid.size(); ++i) grid[i] = complexMul(grid[i], filter[i]);
+                    fft2d(grid, n1, n2, tw1, tw2, true);
+
+                    for (std::size_t t = 0; t < count; ++t)
+                    {
+                        const std::size_t tile = 2 * pair + t;
+                        const std::size_t i0 = tile / tilesAcross * tileRows, j0 = tile % tilesAcross * tileCols;
+                        const std::size_t height = std::min(tileRows, rows - i0), width = std::min(tileCols, cols - j0);
+                        for (std::size_t i = 0; i < height; ++i)
+                        {
+                            const std::complex<T>* src = grid.data() + (i + kr - 1) * n2 + kc - 1;
+                            T* dst = out + (i0 + i) * cols + j0;
+                            if (t == 0)
+                                for (std::size_t j = 0; j < width; ++j) dst[j] = src[j].real() * scale;
+                            else
+                                for (std::size_t j = 0; j < width; ++j) dst[j] = src[j].imag() * scale;
+                        }
+                    }
+                }
+            });
+        }
+
+        // Correlation with taps (kr x kc, row-major) anchored at (anchorRow, anchorCol).
+        template<typename T>
+        Matrix<T> correlateTaps(const Matrix<T>& input, const std::vector<T>& taps, std::size_t kr, std::size_t kc,
+                                std::size_t anchorRow, std::size_t anchorCol, const ConvolutionOptions& options)
+        {
+            Matrix<T> result(input.numRows(), input.numCols());
+            if (result.empty()) return result;
+
+            std::vector<T> column, row;
+            const bool separable = splitSeparable(taps, kr, kc, column, row);
+            ConvolutionMethod method = options.method;
+            if (method == ConvolutionMethod::Auto)
+            {
+                if (separable && kr > 1 && kc > 1) method = ConvolutionMethod::Separable;
+                else if (kr * kc <= kConvDirectMax) method = ConvolutionMethod::Direct;
+                else method = ConvolutionMethod::Fft;
+            }
+            if (method == ConvolutionMethod::Separable && !separable)
+                throw std::invalid_argument("Kernel is not separable.");
+
+            const PaddedRows<T> padded(input, kc, anchorCol, options.boundary);
+            const std::size_t cols = input.numCols();
+            T* out = result.data_storage();
+            switch (method)
+            {
+                case ConvolutionMethod::Separable: correlateSeparable(padded, column, row, anchorRow, cols, out); break;
+                case ConvolutionMethod::Gemm: correlateGemm(padded, taps, kr, kc, anchorRow, cols, out); break;
+                case ConvolutionMethod::Fft: correlateFft(padded, taps, kr, kc, anchorRow, cols, out); break;
+                default: correlateDirect(padded, taps, kr, kc, anchorRow, cols, out); break;
+            }
+            return result;
+        }
+
+        template<typename T>
+        std::vector<T> kernelTaps(const Matrix<T>& kernel, bool rotate)
+        {
+            if (kernel.empty()) throw std::invalid_argument("Convolution kernel must not be empty.");
+            const T* k = kernel.data_storage();
+            std::vector<T> taps(k, k + kernel.size());
+            if (rotate) std::reverse(taps.begin(), taps.end());
+            return taps;
+        }
+    }
+
+    template<typename T>
+    Matrix<T> correlate2d(const Matrix<T>& input, const Matrix<T>& kernel, const ConvolutionOptions& options)
+    {
+        BML_PERF_SCOPE("correlate2d", T);
+        BML_TRACE_SCOPE("correlate2d", T, input.numRows(), input.numCols(), (2 * input.size() + kernel.size()) * sizeof(T));
+        const std::size_t kr = kernel.numRows(), kc = kernel.numCols();
+        return detail::correlateTaps(input, detail::kernelTaps(kernel, false), kr, kc, kr / 2, kc / 2, options);
+    }
+
+    template<typename T>
+    Matrix<T> convolve2d(const Matrix<T>& input, const Matrix<T>& kernel, const ConvolutionOptions& options)
+    {
+        BML_PERF_SCOPE("convolve2d", T);
+        BML_TRACE_SCOPE("convolve2d", T, input.numRows(), input.numCols(), (2 * input.size() + kernel.size()) * sizeof(T));
+        // Rotating the kernel by 180 degrees mirrors its anchor as well.
+        const std::size_t kr = kernel.numRows(), kc = kernel.numCols();
+        return detail::correlateTaps(input, detail::kernelTaps(kernel, true), kr, kc,
+                                     kr - 1 - kr / 2, kc - 1 - kc / 2, options);
+    }
+
+    // ---------------------------------------------------------------------------------
+    // StreamingConvolver
+    // ---------------------------------------------------------------------------------
+
+    template<typename T>
+    StreamingConvolver<T>::StreamingConvolver(const Matrix<T>& kernel, std::uint32_t width, RowSink sink,
+                                              BoundaryMode boundary, bool correlate)
+        : cols(width), kernelRows(kernel.numRows()), kernelCols(kernel.numCols()),
+          anchorRow(correlate ? kernelRows / 2 : kernelRows - 1 - kernelRows / 2),
+          anchorCol(correlate ? kernelCols / 2 : kernelCols - 1 - kernelCols / 2),
+          taps(detail::kernelTaps(kernel, !correlate)), sink(std::move(sink)), boundary(boundary),
+          stride(detail::paddedLength(width, kernelCols)),
+          head(kernelRows * stride), ring(kernelRows * stride), zeros(stride, T{0}), output(width),
+          window(kernelRows)
+    {
+        // Wrap: the top rows read the last input rows and wait for finish().
+        if (boundary == BoundaryMode::Wrap) nextOut = static_cast<std::uint32_t>(anchorRow);
+    }
+
+    template<typename T>
+    void StreamingConvolver<T>::push(const T* row)
+    {
+        if (finished) throw std::logic_error("StreamingConvolver: push() after finish().");
+        T* slot = ring.data() + (received % kernelRows) * stride;
+        detail::padRow(row, cols, kernelCols, anchorCol, boundary, slot);
+        if (received < kernelRows) std::copy(slot, slot + stride, head.data() + received * stride);
+        ++received;
+        while (ready(nextOut)) emit(nextOut++);
+    }
+
+    template<typename T>
+    void StreamingConvolver<T>::push(const std::vector<T>& row)
+    {
+        if (row.size() != cols) throw std::invalid_argument("StreamingConvolver: row length must equal width().");
+        push(row.data());
+    }
+
+    template<typename T>
+    void StreamingConvolver<T>::finish()
+    {
+        if (finished) return;
+        finished = true;
+        for (; nextOut < received; ++nextOut) emit(nextOut);
+        if (boundary == BoundaryMode::Wrap)
+            for (std::uint32_t i = 0; i < std::min<std::size_t>(anchorRow, received); ++i) emit(i);
+    }
+
+    template<typename T>
+    bool StreamingConvolver<T>::ready(std::uint32_t row) const noexcept
+    {
+        const std::int64_t first = static_cast<std::int64_t>(row) - static_cast<std::int64_t>(anchorRow);
+        const std::int64_t last = first + static_cast<std::int64_t>(kernelRows) - 1;
+        if (row >= received || last >= received) return false;
+        // A reflected top row must have arrived already.
+        return !(first < 0 && boundary == BoundaryMode::Reflect && -first >= received);
+    }
+
+    template<typename T>
+    const T* StreamingConvolver<T>::sourceRow(std::int64_t index) const noexcept
+    {
+        std::int64_t idx = index;
+        if (idx < 0 || idx >= received)
+        {
+            if (finished) idx = detail::boundaryIndex(idx, received, boundary);
+            else idx = (idx < 0 && boundary == BoundaryMode::Reflect) ? -idx : -1;
+        }
+        if (idx < 0) return zeros.data();
+        const auto i = static_cast<std::size_t>(idx);
+        return i < kernelRows ? head.data() + i * stride : ring.data() + (i % kernelRows) * stride;
+    }
+
+    template<typename T>
+    void StreamingConvolver<T>::emit(std::uint32_t row)
+    {
+        for (std::size_t u = 0; u < kernelRows; ++u)
+            window[u] = sourceRow(static_cast<std::int64_t>(row + u) - static_cast<std::int64_t>(anchorRow));
+        detail::correlateRow(window.data(), taps.data(), kernelRows, kernelCols, cols, output.data());
+        sink(row, output.data());
+    }
+} // namespace bml
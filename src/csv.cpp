@@ -0,0 +1,307 @@
+#include "bml/csv.hpp"
+#include "bml/mappedFile.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Smallest slice of input worth handing to another thread.
+        constexpr std::size_t kCsvMinChunkBytes = std::size_t{1} << 20;
+
+        struct CsvField
+        {
+            std::string_view text;
+            bool escaped = false;   // quoted field containing "" pairs
+        };
+
+        [[noreturn]] inline void csvError(std::size_t row, std::size_t col, const std::string& what)
+        {
+            throw std::runtime_error("CSV parse error at row " + std::to_string(row) + ", column "
+                                     + std::to_string(col) + ": " + what);
+        }
+
+        inline bool isCsvSpace(char ch, char delimiter) noexcept
+        {
+            return (ch == ' ' || ch == '\t') && ch != delimiter;
+        }
+
+        // End of the line starting at p (pointing at '\n' or end), and the start of the next one.
+        inline const char* lineEnd(const char* p, const char* end, const char*& next) noexcept
+        {
+            auto nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+            next = nl ? nl + 1 : end;
+            const char* e = nl ? nl : end;
+            if (e > p && e[-1] == '\r') --e;
+            return e;
+        }
+
+        // Splits one line (without its terminator) into fields.
+        class CsvLineSplitter
+        {
+        public:
+            CsvLineSplitter(const char* begin, const char* end, const CsvOptions& options, std::size_t row) noexcept
+                : p(begin), end(end), opt(options), row(row)
+            {
+            }
+
+            bool next(CsvField& field)
+            {
+                if (done) return false;
+                const char* q = p;
+                if (opt.trimSpaces)
+                    while (q < end && isCsvSpace(*q, opt.delimiter)) ++q;
+
+                if (opt.quoted && q < end && *q == '"')
+                {
+                    const char* start = ++q;
+                    bool escaped = false;
+                    for (;;)
+                    {
+                        q = static_cast<const char*>(std::memchr(q, '"', static_cast<std::size_t>(end - q)));
+                        if (!q) csvError(row, col, "unterminated quoted field");
+                        if (q + 1 < end && q[1] == '"')
+                        {
+                            escaped = true;
+                            q += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    field.text = std::string_view(start, static_cast<std::size_t>(q - start));
+                    field.escaped = escaped;
+                    ++q;
+                    if (opt.trimSpaces)
+                        while (q < end && isCsvSpace(*q, opt.delimiter)) ++q;
+                    if (q == end)
+                        done = true;
+                    else if (*q == opt.delimiter)
+                        p = q + 1;
+                    else
+                        csvError(row, col, "unexpected character after quoted field");
+                }
+                else
+                {
+                    auto d = q < end
+                        ? static_cast<const char*>(std::memchr(q, opt.delimiter, static_cast<std::size_t>(end - q)))
+                        : nullptr;
+                    const char* fieldEnd = d ? d : end;
+                    const char* t = fieldEnd;
+                    if (opt.trimSpaces)
+                        while (t > q && isCsvSpace(t[-1], opt.delimiter)) --t;
+                    field.text = std::string_view(q, static_cast<std::size_t>(t - q));
+                    field.escaped = false;
+                    if (d)
+                        p = d + 1;
+                    else
+                        done = true;
+                }
+                ++col;
+                return true;
+            }
+
+            [[nodiscard]] std::size_t fields() const noexcept { return col; }
+
+        private:
+            const char* p;
+            const char* end;
+            const CsvOptions& opt;
+            std::size_t row;
+            std::size_t col = 0;
+            bool done = false;
+        };
+
+        inline bool equalsIgnoreCase(std::string_view a, const char* b) noexcept
+        {
+            const std::size_t n = std::strlen(b);
+            if (a.size() != n) return false;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                char ch = a[i];
+                if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>(ch - 'A' + 'a');
+                if (ch != b[i]) return false;
+            }
+            return true;
+        }
+
+        template<typename T, typename S>
+        void parseCsvCell(const CsvField& field, S& out, std::size_t row, std::size_t col)
+        {
+            std::string_view text = field.text;
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                if (!field.escaped)
+                {
+                    out.assign(text.data(), text.size());
+                    return;
+                }
+                out.clear();
+                out.reserve(text.size());
+                for (std::size_t i = 0; i < text.size(); ++i)
+                {
+                    out.push_back(text[i]);
+                    if (text[i] == '"') ++i;   // "" -> "
+                }
+            }
+            else if constexpr (std::is_same_v<T, char>)
+            {
+                if (text.size() != 1) csvError(row, col, "expected a single character");
+                out = text[0];
+            }
+            else if constexpr (bml_is_bool<T>::value)
+            {
+                if (text == "1" || equalsIgnoreCase(text, "true"))
+                    out = 1;
+                else if (text == "0" || equalsIgnoreCase(text, "false"))
+                    out = 0;
+                else
+                    csvError(row, col, "expected a boolean, got '" + std::string(text) + "'");
+            }
+            else
+            {
+                if (text.size() > 1 && text[0] == '+' && text[1] != '-') text.remove_prefix(1);
+                const char* first = text.data();
+                const char* last = first + text.size();
+                std::from_chars_result r;
+                if constexpr (std::is_floating_point_v<T>)
+                    r = std::from_chars(first, last, out, std::chars_format::general);
+                else
+                    r = std::from_chars(first, last, out);
+                if (r.ec == std::errc::result_out_of_range)
+                    csvError(row, col, "value out of range: '" + std::string(field.text) + "'");
+                if (r.ec != std::errc() || r.ptr != last)
+                    csvError(row, col, "not a number: '" + std::string(field.text) + "'");
+            }
+        }
+
+        // Number of non-empty lines in [p, end).
+        inline std::size_t countCsvRows(const char* p, const char* end) noexcept
+        {
+            std::size_t n = 0;
+            while (p < end)
+            {
+                const char* next;
+                const char* e = lineEnd(p, end, next);
+                if (e > p) ++n;
+                p = next;
+            }
+            return n;
+        }
+
+        template<typename T, typename S>
+        void parseCsvRows(const char* p, const char* end, S* out, std::size_t firstRow,
+                          std::size_t cols, const CsvOptions& options)
+        {
+            std::size_t row = firstRow;
+            while (p < end)
+            {
+                const char* next;
+                const char* e = lineEnd(p, end, next);
+                if (e > p)
+                {
+                    S* cells = out + row * cols;
+                    CsvLineSplitter split(p, e, options, row);
+                    CsvField field;
+                    while (split.next(field))
+                    {
+                        const std::size_t c = split.fields() - 1;
+                        if (c >= cols) csvError(row, c, "row has more than " + std::to_string(cols) + " fields");
+                        parseCsvCell<T>(field, cells[c], row, c);
+                    }
+                    if (split.fields() != cols)
+                        csvError(row, split.fields(), "row has " + std::to_string(split.fields())
+                                                      + " fields, expected " + std::to_string(cols));
+                    ++row;
+                }
+                p = next;
+            }
+        }
+    } // namespace detail
+
+    template <typename T>
+    Matrix<T> parseCsv(std::string_view text, const CsvOptions& options)
+    {
+        BML_PERF_SCOPE("parseCsv", T);
+        using S = typename Matrix<T>::storage_type;
+
+        if (options.delimiter == '\n' || options.delimiter == '\r' || (options.quoted && options.delimiter == '"'))
+            throw std::invalid_argument("CsvOptions: delimiter cannot be a line break or the quote character.");
+
+        const char* p = text.data();
+        const char* const end = p + text.size();
+        for (std::size_t skipped = 0; skipped < options.skipRows && p < end; ++skipped)
+        {
+            const char* next;
+            detail::lineEnd(p, end, next);
+            p = next;
+        }
+
+        // Shape: columns from the first data line.
+        std::size_t cols = 0;
+        for (const char* q = p; q < end; )
+        {
+            const char* next;
+            const char* e = detail::lineEnd(q, end, next);
+            if (e > q)
+            {
+                detail::CsvLineSplitter split(q, e, options, 0);
+                detail::CsvField field;
+                while (split.next(field)) {}
+                cols = split.fields();
+                break;
+            }
+            q = next;
+        }
+        if (cols == 0) return Matrix<T>(0, 0);
+
+        // Newline-aligned chunks.
+        const std::size_t bytes = static_cast<std::size_t>(end - p);
+        const std::size_t chunks = std::clamp<std::size_t>(bytes / detail::kCsvMinChunkBytes, 1, parallelism() * 4);
+        std::vector<const char*> bounds(chunks + 1, end);
+        bounds[0] = p;
+        for (std::size_t i = 1; i < chunks; ++i)
+        {
+            const char* guess = std::max(bounds[i - 1], p + bytes / chunks * i);
+            auto nl = static_cast<const char*>(std::memchr(guess, '\n', static_cast<std::size_t>(end - guess)));
+            bounds[i] = nl ? nl + 1 : end;
+        }
+
+        // Counting pass, then each chunk's first row.
+        std::vector<std::size_t> firstRow(chunks + 1, 0);
+        parallelFor(chunks, 1, [&](std::size_t begin, std::size_t stop) {
+            for (std::size_t i = begin; i < stop; ++i)
+                firstRow[i + 1] = detail::countCsvRows(bounds[i], bounds[i + 1]);
+        });
+        for (std::size_t i = 0; i < chunks; ++i) firstRow[i + 1] += firstRow[i];
+
+        const std::size_t rows = firstRow[chunks];
+        constexpr std::size_t maxExtent = std::numeric_limits<std::uint32_t>::max();
+        if (rows > maxExtent || cols > maxExtent)
+            throw std::runtime_error("CSV input exceeds the maximum matrix extent.");
+
+        Matrix<T> result(static_cast<std::uint32_t>(rows), static_cast<std::uint32_t>(cols));
+        S* out = result.data_storage();
+        parallelFor(chunks, 1, [&](std::size_t begin, std::size_t stop) {
+            for (std::size_t i = begin; i < stop; ++i)
+                detail::parseCsvRows<T>(bounds[i], bounds[i + 1], out, firstRow[i], cols, options);
+        });
+        return result;
+    }
+
+    template <typename T>
+    Matrix<T> readCsv(const std::string& path, const CsvOptions& options)
+    {
+        const MappedFile file(path);
+        return parseCsv<T>(std::string_view(file.data(), file.size()), options);
+    }
+} // namespace bml
@@ -0,0 +1,25 @@
+#include "bml/dispatch.hpp"
+
+namespace bml
+{
+    bool multiversioningCompiledIn() noexcept
+    {
+#if defined(BML_MULTIVERSIONING) && BML_MULTIVERSIONING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const char* kernelIsa() noexcept
+    {
+#if defined(BML_MULTIVERSIONING) && BML_MULTIVERSIONING
+        // Same order of preference as the target_clones resolvers.
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("x86-64-v4")) return "x86-64-v4";
+        if (__builtin_cpu_supports("x86-64-v3")) return "x86-64-v3";
+        if (__builtin_cpu_supports("x86-64-v2")) return "x86-64-v2";
+#endif
+        return "default";
+    }
+} // namespace bml
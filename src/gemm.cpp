@@ -0,0 +1,231 @@
+#include "bml/gemm.hpp"
+#include "bml/dispatch.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Register tile (MR x NR accumulators) and cache blocks: a KC x NR sliver of B
+        // stays in L1, an MC x KC block of A in L2, a KC x NC panel of B in L3.
+        template<typename T>
+        struct GemmBlocking
+        {
+            static constexpr std::size_t MR = 4;
+            static constexpr std::size_t NR = sizeof(T) <= 4 ? 16 : 8;
+            static constexpr std::size_t KC = 256;
+            static constexpr std::size_t MC = 96;
+            static constexpr std::size_t NC = 2048;
+            // Columns of one parallel task; A is re-packed once per task.
+            static constexpr std::size_t TaskCols = 32 * NR;
+        };
+
+        // Below this many multiply-adds the packing is not worth it.
+        constexpr std::size_t kGemmSmallWork = std::size_t{1} << 15;
+
+        template<typename T>
+        inline T gemmLoad(const T* p, std::size_t ld, bool trans, std::size_t row, std::size_t col) noexcept
+        {
+            return trans ? p[col * ld + row] : p[row * ld + col];
+        }
+
+        template<typename T>
+        void scaleC(std::size_t m, std::size_t n, T beta, T* c, std::size_t ldc)
+        {
+            if (beta == T{1}) return;
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                T* row = c + i * ldc;
+                if (beta == T{0})
+                    std::fill(row, row + n, T{0});
+                else
+                    for (std::size_t j = 0; j < n; ++j) row[j] = static_cast<T>(row[j] * beta);
+            }
+        }
+
+        // op(A) rows [i0, i0+mc) x cols [p0, p0+kc) as MR-row slivers, zero-padded.
+        template<typename T>
+        void packA(const T* a, std::size_t lda, bool trans, std::size_t i0, std::size_t mc,
+                   std::size_t p0, std::size_t kc, T* out)
+        {
+            constexpr std::size_t MR = GemmBlocking<T>::MR;
+            for (std::size_t ir = 0; ir < mc; ir += MR)
+            {
+                const std::size_t mr = std::min(MR, mc - ir);
+                for (std::size_t p = 0; p < kc; ++p)
+                {
+                    for (std::size_t i = 0; i < mr; ++i) out[i] = gemmLoad(a, lda, trans, i0 + ir + i, p0 + p);
+                    for (std::size_t i = mr; i < MR; ++i) out[i] = T{0};
+                    out += MR;
+                }
+            }
+        }
+
+        // op(B) rows [p0, p0+kc) x cols [j0, j0+nc) as NR-column slivers, zero-padded.
+        template<typename T>
+        void packB(const T* b, std::size_t ldb, bool trans, std::size_t p0, std::size_t kc,
+                   std::size_t j0, std::size_t nc, T* out)
+        {
+            constexpr std::size_t NR = GemmBlocking<T>::NR;
+            const std::size_t slivers = (nc + NR - 1) / NR;
+            parallelFor(slivers, 4, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t s = begin; s < end; ++s)
+                {
+                    const std::size_t jr = s * NR;
+                    const std::size_t nr = std::min(NR, nc - jr);
+                    T* dst = out + s * NR * kc;
+                    for (std::size_t p = 0; p < kc; ++p)
+                    {
+                        if (!trans && nr == NR)
+                        {
+                            std::memcpy(dst, b + (p0 + p) * ldb + j0 + jr, NR * sizeof(T));
+                        }
+                        else
+                        {
+                            for (std::size_t j = 0; j < nr; ++j) dst[j] = gemmLoad(b, ldb, trans, p0 + p, j0 + jr + j);
+                            for (std::size_t j = nr; j < NR; ++j) dst[j] = T{0};
+                        }
+                        dst += NR;
+                    }
+                }
+            });
+        }
+
+        // C[mr x nr] += alpha * (packed A sliver) * (packed B sliver); the MR x NR
+        // accumulator block is small enough to live in vector registers.
+        template<typename T>
+        BML_HOT_KERNEL void gemmMicroKernel(std::size_t kc, const T* pa, const T* pb, T alpha,
+                             T* c, std::size_t ldc, std::size_t mr, std::size_t nr)
+        {
+            constexpr std::size_t MR = GemmBlocking<T>::MR;
+            constexpr std::size_t NR = GemmBlocking<T>::NR;
+
+            T acc[MR][NR] = {};
+            for (std::size_t p = 0; p < kc; ++p)
+            {
+                for (std::size_t i = 0; i < MR; ++i)
+                {
+                    const T ai = pa[i];
+                    for (std::size_t j = 0; j < NR; ++j) acc[i][j] += ai * pb[j];
+                }
+                pa += MR;
+                pb += NR;
+            }
+
+            for (std::size_t i = 0; i < mr; ++i)
+            {
+                T* row = c + i * ldc;
+                if (alpha == T{1})
+                    for (std::size_t j = 0; j < nr; ++j) row[j] += acc[i][j];
+                else
+                    for (std::size_t j = 0; j < nr; ++j) row[j] += static_cast<T>(alpha * acc[i][j]);
+            }
+        }
+
+        // C += alpha * op(A) * op(B) without packing, for products too small to amortise it.
+        template<typename T>
+        BML_HOT_KERNEL void gemmSmall(bool transA, bool transB, std::size_t m, std::size_t n, std::size_t k,
+                                      T alpha, const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                                      T* c, std::size_t ldc)
+        {
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                T* row = c + i * ldc;
+                for (std::size_t p = 0; p < k; ++p)
+                {
+                    const T s = static_cast<T>(alpha * gemmLoad(a, lda, transA, i, p));
+                    if (s == T{0}) continue;
+                    for (std::size_t j = 0; j < n; ++j) row[j] += s * gemmLoad(b, ldb, transB, p, j);
+                }
+            }
+        }
+    }
+
+    template<typename T>
+    void gemm(bool transA, bool transB, std::size_t m, std::size_t n, std::size_t k,
+              T alpha, const T* a, std::size_t lda, const T* b, std::size_t ldb,
+              T beta, T* c, std::size_t ldc)
+    {
+        BML_PERF_SCOPE("gemm", T);
+        using B = detail::GemmBlocking<T>;
+        if (m == 0 || n == 0) return;
+
+        detail::scaleC(m, n, beta, c, ldc);
+        if (k == 0 || alpha == T{0}) return;
+
+        if (m * n * k <= detail::kGemmSmallWork)
+        {
+            detail::gemmSmall(transA, transB, m, n, k, alpha, a, lda, b, ldb, c, ldc);
+            return;
+        }
+
+        std::vector<T> packedB(B::KC * ((std::min(n, B::NC) + B::NR - 1) / B::NR * B::NR));
+        for (std::size_t jc = 0; jc < n; jc += B::NC)
+        {
+            const std::size_t nc = std::min(B::NC, n - jc);
+            for (std::size_t pc = 0; pc < k; pc += B::KC)
+            {
+                const std::size_t kc = std::min(B::KC, k - pc);
+                detail::packB(b, ldb, transB, pc, kc, jc, nc, packedB.data());
+
+                // One task per (MC row block, TaskCols column group) of this C panel.
+                const std::size_t rowBlocks = (m + B::MC - 1) / B::MC;
+                const std::size_t colGroups = (nc + B::TaskCols - 1) / B::TaskCols;
+                parallelFor(rowBlocks * colGroups, 1, [&](std::size_t begin, std::size_t end) {
+                    std::vector<T> packedA(B::MC * kc);
+                    std::size_t packedRowBlock = rowBlocks;   // none yet
+                    for (std::size_t task = begin; task < end; ++task)
+                    {
+                        const std::size_t rb = task / colGroups;
+                        const std::size_t ic = rb * B::MC;
+                        const std::size_t mc = std::min(B::MC, m - ic);
+                        if (rb != packedRowBlock)
+                        {
+                            detail::packA(a, lda, transA, ic, mc, pc, kc, packedA.data());
+                            packedRowBlock = rb;
+                        }
+
+                        const std::size_t jBegin = (task % colGroups) * B::TaskCols;
+                        const std::size_t jEnd = std::min(nc, jBegin + B::TaskCols);
+                        for (std::size_t jr = jBegin; jr < jEnd; jr += B::NR)
+                        {
+                            const std::size_t nr = std::min(B::NR, nc - jr);
+                            const T* pb = packedB.data() + (jr / B::NR) * B::NR * kc;
+                            for (std::size_t ir = 0; ir < mc; ir += B::MR)
+                            {
+                                const std::size_t mr = std::min(B::MR, mc - ir);
+                                detail::gemmMicroKernel(kc, packedA.data() + ir * kc, pb, alpha,
+                                                        c + (ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                            }
+                        }
+                    }
+                });
+            }
+        }
+    }
+
+    template<typename T>
+    Matrix<T> matmul(const Matrix<T>& a, const Matrix<T>& b)
+    {
+        BML_PERF_SCOPE("matmul", T);
+        BML_TRACE_SCOPE("matmul", T, a.numRows(), b.numCols(),
+                        (a.size() + b.size() + std::size_t{a.numRows()} * b.numCols()) * sizeof(T));
+        if (a.numCols() != b.numRows())
+            throw std::invalid_argument("Matrix dimensions must match for multiplication.");
+
+        Matrix<T> out(a.numRows(), b.numCols());
+        if (out.empty() || a.numCols() == 0) return out;
+        gemm(false, false, a.numRows(), b.numCols(), a.numCols(),
+             T{1}, a.data_storage(), a.numCols(), b.data_storage(), b.numCols(),
+             T{0}, out.data_storage(), out.numCols());
+        return out;
+    }
+} // namespace bml
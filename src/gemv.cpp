@@ -0,0 +1,237 @@
+#include "bml/gemv.hpp"
+#include "bml/dispatch.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Independent partial sums of one dot product: a 512-bit vector of lanes, at most 16.
+        template<typename T>
+        constexpr std::size_t kDotLanes = std::min<std::size_t>(16, 64 / sizeof(T));
+
+        // Multiply-adds per task below which GEMV stays on fewer threads.
+        constexpr std::size_t kGemvTaskWork = std::size_t{1} << 14;
+
+        // Bytes of A a batched task keeps in cache while the batch streams past (about L2).
+        constexpr std::size_t kGemvBatchBlockBytes = std::size_t{1} << 18;
+
+        // Vectors of a batch multiplied against each row of A per pass.
+        constexpr std::size_t kGemvBatchGroup = 4;
+
+        template<typename T>
+        void checkEpilogue(const GemvEpilogue<T>& e)
+        {
+            if constexpr (!std::is_floating_point_v<T>)
+                if (e.activation == Activation::Sigmoid)
+                    throw std::invalid_argument("Sigmoid activation requires a floating-point element type.");
+            if (e.activation == Activation::Clamp && e.clampHigh < e.clampLow)
+                throw std::invalid_argument("Clamp bounds must satisfy clampLow <= clampHigh.");
+        }
+
+        template<typename T>
+        inline T gemvFinish(T dot, std::size_t i, const GemvEpilogue<T>& e) noexcept
+        {
+            T v = static_cast<T>(e.scale * dot);
+            if (e.bias) v = static_cast<T>(v + e.bias[i]);
+            switch (e.activation)
+            {
+                case Activation::None:
+                    return v;
+                case Activation::Relu:
+                    return v > T{0} ? v : T{0};
+                case Activation::Clamp:
+                    return std::min(std::max(v, e.clampLow), e.clampHigh);
+                case Activation::Sigmoid:
+                    if constexpr (std::is_floating_point_v<T>) return T{1} / (T{1} + std::exp(-v));
+                    else return v;   // rejected by checkEpilogue()
+            }
+            return v;
+        }
+
+        // Pairwise sum of the lanes, the same tree whichever clone runs.
+        template<typename T, std::size_t L>
+        inline T reduceLanes(T (&acc)[L]) noexcept
+        {
+            for (std::size_t w = L / 2; w > 0; w /= 2)
+                for (std::size_t l = 0; l < w; ++l) acc[l] = static_cast<T>(acc[l] + acc[l + w]);
+            return acc[0];
+        }
+
+        // y[i] = epilogue(row i of A . x) for rows [r0, r1).
+        template<typename T>
+        BML_HOT_KERNEL void gemvRows(std::size_t r0, std::size_t r1, std::size_t n, const T* a, std::size_t lda,
+                                     const T* x, T* y, const GemvEpilogue<T>& e)
+        {
+            constexpr std::size_t L = kDotLanes<T>;
+            const std::size_t body = n / L * L;
+            for (std::size_t i = r0; i < r1; ++i)
+            {
+                const T* row = a + i * lda;
+                T acc[L] = {};
+                for (std::size_t j = 0; j < body; j += L)
+                    for (std::size_t l = 0; l < L; ++l) acc[l] = static_cast<T>(acc[l] + row[j + l] * x[j + l]);
+                T tail{};
+                for (std::size_t j = body; j < n; ++j) tail = static_cast<T>(tail + row[j] * x[j]);
+                y[i] = gemvFinish(static_cast<T>(reduceLanes(acc) + tail), i, e);
+            }
+        }
+
+        // y[c] = epilogue(sum_i x[i] * A[i][c]) for columns [c0, c1); A is n x m here.
+        template<typename T>
+        BML_HOT_KERNEL void gemvColumns(std::size_t c0, std::size_t c1, std::size_t n, const T* BML_RESTRICT a,
+                                        std::size_t lda, const T* BML_RESTRICT x, T* BML_RESTRICT y,
+                                        const GemvEpilogue<T>& e)
+        {
+            T* out = y + c0;
+            const std::size_t width = c1 - c0;
+            std::fill(out, out + width, T{0});
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const T s = x[i];
+                const T* row = a + i * lda + c0;
+                for (std::size_t j = 0; j < width; ++j) out[j] = static_cast<T>(out[j] + s * row[j]);
+            }
+            for (std::size_t j = 0; j < width; ++j) out[j] = gemvFinish(out[j], c0 + j, e);
+        }
+
+        // Rows [r0, r1) of A against every vector of the batch; y is batch x ldy.
+        template<typename T>
+        BML_HOT_KERNEL void gemvBatchRows(std::size_t r0, std::size_t r1, std::size_t n, const T* a, std::size_t lda,
+                                          const T* xs, std::size_t batch, T* y, std::size_t ldy,
+                                          const GemvEpilogue<T>& e)
+        {
+            constexpr std::size_t L = kDotLanes<T>;
+            constexpr std::size_t G = kGemvBatchGroup;
+            const std::size_t body = n / L * L;
+            for (std::size_t b0 = 0; b0 < batch; b0 += G)
+            {
+                // A short last group repeats its final vector rather than branching in the loop.
+                const T* x[G];
+                for (std::size_t q = 0; q < G; ++q) x[q] = xs + std::min(b0 + q, batch - 1) * n;
+                const std::size_t groupSize = std::min(G, batch - b0);
+
+                for (std::size_t i = r0; i < r1; ++i)
+                {
+                    const T* row = a + i * lda;
+                    T acc[G][L] = {};
+                    for (std::size_t j = 0; j < body; j += L)
+                        for (std::size_t q = 0; q < G; ++q)
+                            for (std::size_t l = 0; l < L; ++l)
+                                acc[q][l] = static_cast<T>(acc[q][l] + row[j + l] * x[q][j + l]);
+                    for (std::size_t q = 0; q < groupSize; ++q)
+                    {
+                        T tail{};
+                        for (std::size_t j = body; j < n; ++j) tail = static_cast<T>(tail + row[j] * x[q][j]);
+                        y[(b0 + q) * ldy + i] = gemvFinish(static_cast<T>(reduceLanes(acc[q]) + tail), i, e);
+                    }
+                }
+            }
+        }
+    }
+
+    template<typename T>
+    void gemv(bool transA, std::size_t m, std::size_t n, const T* a, std::size_t lda,
+              const T* x, T* y, const GemvEpilogue<T>& epilogue)
+    {
+        BML_PERF_SCOPE("gemv", T);
+        detail::checkEpilogue(epilogue);
+        if (m == 0) return;
+
+        const std::size_t work = std::max<std::size_t>(n, 1);
+        if (!transA)
+        {
+            const std::size_t grain = std::max<std::size_t>(1, detail::kGemvTaskWork / work);
+            parallelFor(m, grain, [&](std::size_t begin, std::size_t end) {
+                detail::gemvRows(begin, end, n, a, lda, x, y, epilogue);
+            });
+            return;
+        }
+
+        // Column blocks of y: narrow enough to give every thread one, wide enough to stream A rows.
+        const std::size_t perThread = (m + parallelism() - 1) / parallelism();
+        const std::size_t width = std::clamp<std::size_t>((perThread + 15) / 16 * 16, 64, 1024);
+        const std::size_t blocks = (m + width - 1) / width;
+        const std::size_t grain = std::max<std::size_t>(1, detail::kGemvTaskWork / (work * width));
+        parallelFor(blocks, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t blk = begin; blk < end; ++blk)
+                detail::gemvColumns(blk * width, std::min(m, (blk + 1) * width), n, a, lda, x, y, epilogue);
+        });
+    }
+
+    template<typename T>
+    std::vector<T> matvec(const Matrix<T>& a, const std::vector<T>& x, const GemvEpilogue<T>& epilogue)
+    {
+        BML_PERF_SCOPE("matvec", T);
+        BML_TRACE_SCOPE("matvec", T, a.numRows(), a.numCols(), (a.size() + x.size() + a.numRows()) * sizeof(T));
+        if (x.size() != a.numCols())
+            throw std::invalid_argument("Vector length must match the number of matrix columns.");
+
+        std::vector<T> y(a.numRows());
+        gemv(false, a.numRows(), a.numCols(), a.data_storage(), a.numCols(), x.data(), y.data(), epilogue);
+        return y;
+    }
+
+    template<typename T>
+    Matrix<T> matvec(const Matrix<T>& a, const Matrix<T>& x, const GemvEpilogue<T>& epilogue)
+    {
+        BML_PERF_SCOPE("matvec", T);
+        BML_TRACE_SCOPE("matvec", T, a.numRows(), a.numCols(), (a.size() + x.size() + a.numRows()) * sizeof(T));
+        const bool column = x.numCols() == 1 && x.numRows() == a.numCols();
+        const bool row = x.numRows() == 1 && x.numCols() == a.numCols();
+        if (!column && !row)
+            throw std::invalid_argument("Vector must be numCols x 1 or 1 x numCols of the matrix.");
+
+        Matrix<T> y = column ? Matrix<T>(a.numRows(), 1) : Matrix<T>(1, a.numRows());
+        gemv(false, a.numRows(), a.numCols(), a.data_storage(), a.numCols(), x.data_storage(),
+             y.data_storage(), epilogue);
+        return y;
+    }
+
+    template<typename T>
+    std::vector<T> vecmat(const std::vector<T>& x, const Matrix<T>& a, const GemvEpilogue<T>& epilogue)
+    {
+        BML_PERF_SCOPE("vecmat", T);
+        BML_TRACE_SCOPE("vecmat", T, a.numRows(), a.numCols(), (a.size() + x.size() + a.numCols()) * sizeof(T));
+        if (x.size() != a.numRows())
+            throw std::invalid_argument("Vector length must match the number of matrix rows.");
+
+        std::vector<T> y(a.numCols());
+        gemv(true, a.numCols(), a.numRows(), a.data_storage(), a.numCols(), x.data(), y.data(), epilogue);
+        return y;
+    }
+
+    template<typename T>
+    Matrix<T> matvecBatch(const Matrix<T>& a, const Matrix<T>& xs, const GemvEpilogue<T>& epilogue)
+    {
+        BML_PERF_SCOPE("matvecBatch", T);
+        BML_TRACE_SCOPE("matvecBatch", T, a.numRows(), a.numCols(),
+                        (a.size() + xs.size() + std::size_t{xs.numRows()} * a.numRows()) * sizeof(T));
+        if (xs.numCols() != a.numCols())
+            throw std::invalid_argument("Batch vectors must have one entry per matrix column.");
+        detail::checkEpilogue(epilogue);
+
+        const std::size_t m = a.numRows(), n = a.numCols(), batch = xs.numRows();
+        Matrix<T> y(xs.numRows(), a.numRows());
+        if (y.empty()) return y;
+
+        const T* pa = a.data_storage();
+        const T* px = xs.data_storage();
+        T* py = y.data_storage();
+        const std::size_t blockRows = std::max<std::size_t>(1, detail::kGemvBatchBlockBytes / (std::max<std::size_t>(n, 1) * sizeof(T)));
+        const std::size_t grain = std::max<std::size_t>(1, detail::kGemvTaskWork / (std::max<std::size_t>(n, 1) * batch));
+        parallelFor(m, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; r += blockRows)
+                detail::gemvBatchRows(r, std::min(end, r + blockRows), n, pa, n, px, batch, py, m, epilogue);
+        });
+        return y;
+    }
+} // namespace bml
@@ -0,0 +1,208 @@
+#include "bml/hash.hpp"
+#include "bml/perfCounters.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace bml
+{
+    namespace detail
+    {
+        constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+        constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+        constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+        inline std::uint64_t rotl64(std::uint64_t x, int r) noexcept
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        inline std::uint64_t read64(const unsigned char* p) noexcept
+        {
+            std::uint64_t v;
+            std::memcpy(&v, p, sizeof v);   // little-endian host assumed (x86-64 / AArch64)
+            return v;
+        }
+
+        inline std::uint32_t read32(const unsigned char* p) noexcept
+        {
+            std::uint32_t v;
+            std::memcpy(&v, p, sizeof v);
+            return v;
+        }
+
+        inline std::uint64_t round(std::uint64_t acc, std::uint64_t input) noexcept
+        {
+            acc += input * kPrime2;
+            acc = rotl64(acc, 31);
+            return acc * kPrime1;
+        }
+
+        inline std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t val) noexcept
+        {
+            acc ^= round(0, val);
+            return acc * kPrime1 + kPrime4;
+        }
+
+        // Bytes of a long double that carry its value (x87 extended precision keeps
+        // 10 significant bytes inside a 16-byte slot; the rest is padding).
+        constexpr std::size_t kLongDoubleValueBytes =
+            std::numeric_limits<long double>::digits == 64 ? 10 : sizeof(long double);
+    }
+
+    Hasher64::Hasher64(std::uint64_t seed_) noexcept
+        : acc{seed_ + detail::kPrime1 + detail::kPrime2, seed_ + detail::kPrime2, seed_, seed_ - detail::kPrime1},
+          seed(seed_), pending{}
+    {
+    }
+
+    void Hasher64::update(const void* bytes, std::size_t size) noexcept
+    {
+        auto p = static_cast<const unsigned char*>(bytes);
+        const unsigned char* const end = p + size;
+        totalLength += size;
+
+        if (pendingSize + size < 32)
+        {
+            if (size) std::memcpy(pending + pendingSize, p, size);
+            pendingSize += size;
+            return;
+        }
+
+        if (pendingSize)
+        {
+            const std::size_t fillBytes = 32 - pendingSize;
+            std::memcpy(pending + pendingSize, p, fillBytes);
+            p += fillBytes;
+            for (int lane = 0; lane < 4; ++lane)
+                acc[lane] = detail::round(acc[lane], detail::read64(pending + 8 * lane));
+            pendingSize = 0;
+        }
+
+        std::uint64_t v1 = acc[0], v2 = acc[1], v3 = acc[2], v4 = acc[3];
+        while (end - p >= 32)
+        {
+            v1 = detail::round(v1, detail::read64(p));
+            v2 = detail::round(v2, detail::read64(p + 8));
+            v3 = detail::round(v3, detail::read64(p + 16));
+            v4 = detail::round(v4, detail::read64(p + 24));
+            p += 32;
+        }
+        acc[0] = v1; acc[1] = v2; acc[2] = v3; acc[3] = v4;
+
+        pendingSize = static_cast<std::size_t>(end - p);
+        if (pendingSize) std::memcpy(pending, p, pendingSize);
+    }
+
+    std::uint64_t Hasher64::digest() const noexcept
+    {
+        using namespace detail;
+
+        std::uint64_t h;
+        if (totalLength >= 32)
+        {
+            h = rotl64(acc[0], 1) + rotl64(acc[1], 7) + rotl64(acc[2], 12) + rotl64(acc[3], 18);
+            h = mergeRound(h, acc[0]);
+            h = mergeRound(h, acc[1]);
+            h = mergeRound(h, acc[2]);
+            h = mergeRound(h, acc[3]);
+        }
+        else
+        {
+            h = seed + kPrime5;
+        }
+        h += totalLength;
+
+        const unsigned char* p = pending;
+        const unsigned char* const end = pending + pendingSize;
+        while (end - p >= 8)
+        {
+            h ^= round(0, read64(p));
+            h = rotl64(h, 27) * kPrime1 + kPrime4;
+            p += 8;
+        }
+        if (end - p >= 4)
+        {
+            h ^= static_cast<std::uint64_t>(read32(p)) * kPrime1;
+            h = rotl64(h, 23) * kPrime2 + kPrime3;
+            p += 4;
+        }
+        while (p < end)
+        {
+            h ^= static_cast<std::uint64_t>(*p) * kPrime5;
+            h = rotl64(h, 11) * kPrime1;
+            ++p;
+        }
+
+        h ^= h >> 33;
+        h *= kPrime2;
+        h ^= h >> 29;
+        h *= kPrime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    std::uint64_t hashBytes(const void* bytes, std::size_t size, std::uint64_t seed) noexcept
+    {
+        Hasher64 h(seed);
+        h.update(bytes, size);
+        return h.digest();
+    }
+
+    template <typename T>
+    std::uint64_t hash(const Matrix<T>& m, std::uint64_t seed)
+    {
+        BML_PERF_SCOPE("hash", T);
+        using S = typename Matrix<T>::storage_type;
+
+        Hasher64 h(seed);
+        const std::uint32_t shape[2] = {m.numRows(), m.numCols()};
+        h.update(shape, sizeof shape);
+
+        const S* cells = m.data_storage();
+        const std::size_t n = m.size();
+
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const std::uint64_t len = cells[i].size();
+                h.update(&len, sizeof len);
+                h.update(cells[i].data(), cells[i].size());
+            }
+        }
+        else if constexpr (bml_is_bool<T>::value || std::is_floating_point_v<T>)
+        {
+            // Canonicalise through a small stack block: bool -> 0/1, -0.0 -> 0.0,
+            // long double -> value bytes only.
+            constexpr std::size_t valueBytes =
+                std::is_same_v<T, long double> ? detail::kLongDoubleValueBytes : sizeof(S);
+            constexpr std::size_t block = 512;
+            unsigned char scratch[block * valueBytes];
+            for (std::size_t base = 0; base < n; base += block)
+            {
+                const std::size_t len = std::min(block, n - base);
+                for (std::size_t i = 0; i < len; ++i)
+                {
+                    S v = cells[base + i];
+                    if constexpr (bml_is_bool<T>::value)
+                        v = static_cast<S>(v != 0);
+                    else if (v == S{0})
+                        v = S{0};
+                    std::memcpy(scratch + i * valueBytes, &v, valueBytes);
+                }
+                h.update(scratch, len * valueBytes);
+            }
+        }
+        else
+        {
+            h.update(cells, n * sizeof(S));
+        }
+        return h.digest();
+    }
+} // namespace bml
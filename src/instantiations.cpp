@@ -1,6 +1,6 @@
 // instantiations.cpp
 // Single TU that pulls in template *definitions* and emits explicit instantiations.
-// IMPORTANT: Do NOT compile matrix.cpp / iterator.cpp / rowView.cpp separately.
+// IMPORTANT: Do NOT compile matrix.cpp / iterator.cpp / rowView.cpp / hash.cpp / csv.cpp / npy.cpp / codec.cpp / byteStream.cpp / asyncIo.cpp / sparse.cpp / gemm.cpp / gemv.cpp / matrixBatch.cpp / lazy.cpp / linalg.cpp / integerGemm.cpp / convolve.cpp / scan.cpp separately.
 
 #include <cstdint>
 #include <cstddef>
@@ -14,6 +14,21 @@
 #include "matrix.cpp"
 #include "iterator.cpp"
 #include "rowView.cpp"
+#include "hash.cpp"
+#include "csv.cpp"
+#include "npy.cpp"
+#include "codec.cpp"
+#include "byteStream.cpp"
+#include "asyncIo.cpp"
+#include "sparse.cpp"
+#include "gemm.cpp"
+#include "gemv.cpp"
+#include "matrixBatch.cpp"
+#include "lazy.cpp"
+#include "linalg.cpp"
+#include "integerGemm.cpp"
+#include "convolve.cpp"
+#include "scan.cpp"
 
 namespace bml
 {
@@ -227,6 +242,201 @@ namespace bml
 #undef X
 #undef BML_INSTANTIATE_COMPARISONS
 
+    // -----------------------------------------------------------------------------
+    // Content hash
+    // -----------------------------------------------------------------------------
+#define X(T) template BML_API std::uint64_t hash<T>(const Matrix<T>&, std::uint64_t);
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+    BML_CHARLIKE_TYPES(X)
+    BML_BOOL_TYPES(X)
+    BML_SPECIAL_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Delimited text import
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API Matrix<T> parseCsv<T>(std::string_view, const CsvOptions&); \
+    template BML_API Matrix<T> readCsv<T>(const std::string&, const CsvOptions&);
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+    BML_CHARLIKE_TYPES(X)
+    BML_BOOL_TYPES(X)
+    BML_SPECIAL_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // NumPy .npy / .npz (POD types only)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API Matrix<T> parseNpy<T>(const void*, std::size_t); \
+    template BML_API Matrix<T> loadNpy<T>(const std::string&); \
+    template BML_API Matrix<T> mapNpy<T>(const std::string&); \
+    template BML_API void writeNpy<T>(const Matrix<T>&, ByteSink&); \
+    template BML_API void saveNpy<T>(const Matrix<T>&, const std::string&); \
+    template BML_API void NpzWriter::add<T>(const std::string&, const Matrix<T>&); \
+    template BML_API Matrix<T> NpzReader::get<T>(const std::string&) const;
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+    BML_CHARLIKE_TYPES(X)
+    BML_BOOL_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Compression codecs (POD types only)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API bool codecSupports<T>(Codec) noexcept; \
+    template BML_API std::vector<std::uint8_t> encode<T>(const Matrix<T>&, Codec); \
+    template BML_API Matrix<T> decode<T>(const std::uint8_t*, std::size_t);
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+    BML_CHARLIKE_TYPES(X)
+    BML_BOOL_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Incremental byte-stream decoder (all types)
+    // -----------------------------------------------------------------------------
+#define X(T) template class BML_API ByteStreamDecoder<T>;
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+    BML_CHARLIKE_TYPES(X)
+    BML_BOOL_TYPES(X)
+    BML_SPECIAL_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Asynchronous snapshots (all types)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API std::future<void> saveAsync<T>(const Matrix<T>&, const std::string&, const AsyncIoOptions&); \
+    template BML_API std::future<Matrix<T>> loadAsync<T>(const std::string&, const AsyncIoOptions&);
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+    BML_CHARLIKE_TYPES(X)
+    BML_BOOL_TYPES(X)
+    BML_SPECIAL_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Sparse matrices (math types only)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template class BML_API SparseMatrix<T>; \
+    template class BML_API CooBuilder<T>; \
+    template BML_API std::vector<T> matvec<T>(const SparseMatrix<T>&, const std::vector<T>&); \
+    template BML_API Matrix<T> matmul<T>(const SparseMatrix<T>&, const Matrix<T>&); \
+    template BML_API Matrix<T> matmul<T>(const Matrix<T>&, const SparseMatrix<T>&);
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Dense GEMM (math types only)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API void gemm<T>(bool, bool, std::size_t, std::size_t, std::size_t, T, const T*, std::size_t, \
+                                  const T*, std::size_t, T, T*, std::size_t); \
+    template BML_API Matrix<T> matmul<T>(const Matrix<T>&, const Matrix<T>&);
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Matrix-vector products with fused epilogues (math types only)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API void gemv<T>(bool, std::size_t, std::size_t, const T*, std::size_t, const T*, T*, \
+                                  const GemvEpilogue<T>&); \
+    template BML_API std::vector<T> matvec<T>(const Matrix<T>&, const std::vector<T>&, const GemvEpilogue<T>&); \
+    template BML_API Matrix<T> matvec<T>(const Matrix<T>&, const Matrix<T>&, const GemvEpilogue<T>&); \
+    template BML_API std::vector<T> vecmat<T>(const std::vector<T>&, const Matrix<T>&, const GemvEpilogue<T>&); \
+    template BML_API Matrix<T> matvecBatch<T>(const Matrix<T>&, const Matrix<T>&, const GemvEpilogue<T>&);
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Batches of same-shaped matrices (math types; solves floating point only)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template class BML_API MatrixBatch<T>; \
+    template BML_API MatrixBatch<T> matmul<T>(const MatrixBatch<T>&, const MatrixBatch<T>&);
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+#undef X
+#define X(T) \
+    template BML_API MatrixBatch<T> solve<T>(const MatrixBatch<T>&, const MatrixBatch<T>&);
+    BML_FLOAT_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Deferred element-wise expressions (math types)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template class BML_API LazyExpr<T>; \
+    template class BML_API LazyGraph<T>;
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Dense factorizations (floating point only)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template class BML_API LuFactorization<T>; \
+    template class BML_API CholeskyFactorization<T>; \
+    template class BML_API QrFactorization<T>; \
+    template BML_API Matrix<T> solve<T>(const Matrix<T>&, const Matrix<T>&); \
+    template BML_API Matrix<T> inverse<T>(const Matrix<T>&); \
+    template BML_API T determinant<T>(const Matrix<T>&); \
+    template BML_API Matrix<T> lstsq<T>(const Matrix<T>&, const Matrix<T>&);
+    BML_FLOAT_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Widened integer GEMM (8/16-bit cells) and requantization (8-bit outputs)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API void gemmWidened<T>(bool, bool, std::size_t, std::size_t, std::size_t, const T*, std::size_t, \
+                                         const T*, std::size_t, widened_accumulator_t<T>*, std::size_t, bool); \
+    template BML_API Matrix<widened_accumulator_t<T>> matmulWidened<T>(const Matrix<T>&, const Matrix<T>&, \
+                                                                       std::int32_t, std::int32_t);
+    X(std::int8_t)
+    X(std::uint8_t)
+    X(std::int16_t)
+#undef X
+#define X(T) \
+    template BML_API Matrix<T> requantize<T>(const Matrix<std::int32_t>&, const Requantization&); \
+    template BML_API Matrix<T> matmulQuantized<T>(const Matrix<T>&, const Matrix<T>&, std::int32_t, std::int32_t, \
+                                                  const Requantization&);
+    X(std::int8_t)
+    X(std::uint8_t)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // 2D convolution / correlation (floating point only)
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API Matrix<T> correlate2d<T>(const Matrix<T>&, const Matrix<T>&, const ConvolutionOptions&); \
+    template BML_API Matrix<T> convolve2d<T>(const Matrix<T>&, const Matrix<T>&, const ConvolutionOptions&); \
+    template class BML_API StreamingConvolver<T>;
+    BML_FLOAT_TYPES(X)
+#undef X
+
+    // -----------------------------------------------------------------------------
+    // Prefix sums and summed-area tables
+    // -----------------------------------------------------------------------------
+#define X(T) \
+    template BML_API Matrix<scan_accumulator_t<T>> inclusiveScan<T>(const Matrix<T>&, ScanAxis, Summation); \
+    template BML_API Matrix<scan_accumulator_t<T>> exclusiveScan<T>(const Matrix<T>&, ScanAxis, Summation); \
+    template class BML_API SummedAreaTable<T>;
+    BML_INTEGRAL_MATH_TYPES(X)
+    BML_FLOAT_TYPES(X)
+#undef X
+
     // -----------------------------------------------------------------------------
     // Sanity checks for operator[] result types (requires BoolRef from rowView.hpp)
     // -----------------------------------------------------------------------------
@@ -0,0 +1,408 @@
+#include "bml/integerGemm.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BML_X86_INT_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace bml
+{
+    namespace detail
+    {
+        // NR columns of B per sliver fill one 512-bit / two 256-bit vectors of 32-bit lanes.
+        template<typename T>
+        struct IntGemmShape
+        {
+            static constexpr std::size_t NR = sizeof(T) == 1 ? 16 : 8;
+            static constexpr std::size_t KC = sizeof(T) == 1 ? 1024 : 256;
+            static constexpr std::size_t MC = 96;
+            static constexpr std::size_t NC = 2048;
+            static constexpr std::size_t TaskCols = 16 * NR;
+        };
+
+        constexpr std::size_t kIntGemmSmallWork = std::size_t{1} << 15;
+
+        /*
+         * Multiply a packed mr-row sliver of A by a packed NR-column sliver of B over
+         * @p groups k-groups and add the tile to C. The SIMD kernels take k in groups
+         * of four (4 bytes = one 32-bit lane), the portable one a single k per step. When the kernel wants unsigned A
+         * (flipA), A was packed as a + 128 and @p correction holds 128 * column sums
+         * of B, which are subtracted again.
+         */
+        template<typename T>
+        using IntKernelFn = void (*)(std::size_t groups, const T* pa, const T* pb, widened_accumulator_t<T>* c,
+                                     std::size_t ldc, std::size_t mr, std::size_t nr,
+                                     const widened_accumulator_t<T>* correction);
+
+        template<typename T>
+        struct IntGemmKernel
+        {
+            IntKernelFn<T> run;
+            std::size_t mr;
+            std::size_t group;
+            bool flipA;
+        };
+
+        template<typename T, std::size_t MR>
+        void portableIntKernel(std::size_t groups, const T* pa, const T* pb, widened_accumulator_t<T>* c,
+                               std::size_t ldc, std::size_t mr, std::size_t nr, const widened_accumulator_t<T>*)
+        {
+            using Acc = widened_accumulator_t<T>;
+            constexpr std::size_t NR = IntGemmShape<T>::NR;
+
+            Acc acc[MR][NR] = {};
+            for (std::size_t p = 0; p < groups; ++p)
+            {
+                for (std::size_t i = 0; i < MR; ++i)
+                {
+                    const Acc ai = pa[i];
+                    for (std::size_t j = 0; j < NR; ++j) acc[i][j] += ai * static_cast<Acc>(pb[j]);
+                }
+                pa += MR;
+                pb += NR;
+            }
+            for (std::size_t i = 0; i < mr; ++i)
+                for (std::size_t j = 0; j < nr; ++j) c[i * ldc + j] += acc[i][j];
+        }
+
+#if BML_X86_INT_KERNELS
+        // AVX2: each 32-bit lane holds four k values of one column. Even and odd bytes
+        // are widened to 16 bits and combined with vpmaddwd, which is exact (unlike
+        // vpmaddubsw, whose 16-bit pair sums saturate for int8 x int8).
+        template<bool Signed>
+        __attribute__((target("avx2")))
+        void avx2IntKernel(std::size_t groups, const std::uint8_t* pa, const std::uint8_t* pb, std::int32_t* c,
+                           std::size_t ldc, std::size_t mr, std::size_t nr)
+        {
+            const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+            __m256i acc[4][2];
+#pragma GCC unroll 4
+            for (int i = 0; i < 4; ++i) acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+
+            for (std::size_t g = 0; g < groups; ++g)
+            {
+                const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pb));
+                const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pb + 32));
+                const __m256i b0e = Signed ? _mm256_srai_epi16(_mm256_slli_epi16(b0, 8), 8) : _mm256_and_si256(b0, lowBytes);
+                const __m256i b0o = Signed ? _mm256_srai_epi16(b0, 8) : _mm256_srli_epi16(b0, 8);
+                const __m256i b1e = Signed ? _mm256_srai_epi16(_mm256_slli_epi16(b1, 8), 8) : _mm256_and_si256(b1, lowBytes);
+                const __m256i b1o = Signed ? _mm256_srai_epi16(b1, 8) : _mm256_srli_epi16(b1, 8);
+#pragma GCC unroll 4
+                for (int i = 0; i < 4; ++i)
+                {
+                    std::int32_t quad;
+                    std::memcpy(&quad, pa + 4 * i, sizeof quad);
+                    const __m256i av = _mm256_set1_epi32(quad);
+                    const __m256i ae = Signed ? _mm256_srai_epi16(_mm256_slli_epi16(av, 8), 8) : _mm256_and_si256(av, lowBytes);
+                    const __m256i ao = Signed ? _mm256_srai_epi16(av, 8) : _mm256_srli_epi16(av, 8);
+                    acc[i][0] = _mm256_add_epi32(acc[i][0], _mm256_add_epi32(_mm256_madd_epi16(ae, b0e), _mm256_madd_epi16(ao, b0o)));
+                    acc[i][1] = _mm256_add_epi32(acc[i][1], _mm256_add_epi32(_mm256_madd_epi16(ae, b1e), _mm256_madd_epi16(ao, b1o)));
+                }
+                pa += 16;
+                pb += 64;
+            }
+
+            alignas(32) std::int32_t tile[16];
+            for (std::size_t i = 0; i < mr; ++i)
+            {
+                _mm256_store_si256(reinterpret_cast<__m256i*>(tile), acc[i][0]);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(tile + 8), acc[i][1]);
+                for (std::size_t j = 0; j < nr; ++j) c[i * ldc + j] += tile[j];
+            }
+        }
+
+        // AVX-512 VNNI: vpdpbusd multiplies unsigned A bytes by signed B bytes and adds
+        // each group of four into a 32-bit lane in one instruction.
+        __attribute__((target("avx512f,avx512bw,avx512vnni")))
+        inline void vnniIntKernel(std::size_t groups, const std::uint8_t* pa, const std::uint8_t* pb, std::int32_t* c,
+                                  std::size_t ldc, std::size_t mr, std::size_t nr, const std::int32_t* correction)
+        {
+            __m512i acc[8];
+#pragma GCC unroll 8
+            for (int i = 0; i < 8; ++i) acc[i] = _mm512_setzero_si512();
+
+            for (std::size_t g = 0; g < groups; ++g)
+            {
+                const __m512i bv = _mm512_loadu_si512(pb);
+#pragma GCC unroll 8
+                for (int i = 0; i < 8; ++i)
+                {
+                    std::int32_t quad;
+                    std::memcpy(&quad, pa + 4 * i, sizeof quad);
+                    acc[i] = _mm512_dpbusd_epi32(acc[i], _mm512_set1_epi32(quad), bv);
+                }
+                pa += 32;
+                pb += 64;
+            }
+
+            alignas(64) std::int32_t tile[16];
+            for (std::size_t i = 0; i < mr; ++i)
+            {
+                _mm512_store_si512(tile, acc[i]);
+                for (std::size_t j = 0; j < nr; ++j) c[i * ldc + j] += tile[j] - correction[j];
+            }
+        }
+
+        template<typename T>
+        void avx2Kernel(std::size_t groups, const T* pa, const T* pb, std::int32_t* c,
+                        std::size_t ldc, std::size_t mr, std::size_t nr, const std::int32_t*)
+        {
+            avx2IntKernel<std::is_signed_v<T>>(groups, reinterpret_cast<const std::uint8_t*>(pa),
+                                               reinterpret_cast<const std::uint8_t*>(pb), c, ldc, mr, nr);
+        }
+
+        inline void vnniKernel(std::size_t groups, const std::int8_t* pa, const std::int8_t* pb, std::int32_t* c,
+                               std::size_t ldc, std::size_t mr, std::size_t nr, const std::int32_t* correction)
+        {
+            vnniIntKernel(groups, reinterpret_cast<const std::uint8_t*>(pa),
+                          reinterpret_cast<const std::uint8_t*>(pb), c, ldc, mr, nr, correction);
+        }
+
+        enum class IntIsa { Portable, Avx2, Vnni };
+
+        inline IntIsa detectIntIsa() noexcept
+        {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) return IntIsa::Vnni;
+            if (__builtin_cpu_supports("avx2")) return IntIsa::Avx2;
+            return IntIsa::Portable;
+        }
+#endif
+
+        template<typename T>
+        IntGemmKernel<T> selectIntKernel() noexcept
+        {
+#if BML_X86_INT_KERNELS
+            if constexpr (sizeof(T) == 1)
+            {
+                static const IntIsa isa = detectIntIsa();
+                if constexpr (std::is_signed_v<T>)
+                    if (isa == IntIsa::Vnni) return {&vnniKernel, 8, 4, true};
+                if (isa != IntIsa::Portable) return {&avx2Kernel<T>, 4, 4, false};
+            }
+#endif
+            return {&portableIntKernel<T, 4>, 4, 1, false};
+        }
+
+        template<typename T>
+        inline T intLoad(const T* p, std::size_t ld, bool trans, std::size_t row, std::size_t col) noexcept
+        {
+            return trans ? p[col * ld + row] : p[row * ld + col];
+        }
+
+        // int8 x -> the byte of x + 128 (the unsigned operand of vpdpbusd).
+        template<typename T>
+        inline T flipSign(T v) noexcept
+        {
+            return static_cast<T>(static_cast<std::uint8_t>(v) ^ 0x80u);
+        }
+
+        // op(A) rows [i0, i0+mc) x k [p0, p0+kc) as mr-row slivers of k-groups, zero-padded.
+        template<typename T>
+        void packIntA(const T* a, std::size_t lda, bool trans, std::size_t i0, std::size_t mc,
+                      std::size_t p0, std::size_t kc, std::size_t mr, std::size_t G, bool flip, T* out)
+        {
+            const std::size_t groups = (kc + G - 1) / G;
+            for (std::size_t ir = 0; ir < mc; ir += mr)
+            {
+                const std::size_t rows = std::min(mr, mc - ir);
+                for (std::size_t g = 0; g < groups; ++g)
+                    for (std::size_t i = 0; i < mr; ++i)
+                        for (std::size_t u = 0; u < G; ++u)
+                        {
+                            const std::size_t p = g * G + u;
+                            T v = (i < rows && p < kc) ? intLoad(a, lda, trans, i0 + ir + i, p0 + p) : T{0};
+                            if constexpr (sizeof(T) == 1)
+                                if (flip) v = flipSign(v);
+                            *out++ = v;
+                        }
+            }
+        }
+
+        // op(B) k [p0, p0+kc) x cols [j0, j0+nc) as NR-column slivers of k-groups,
+        // zero-padded; with @p flip also 128 * the column sums for the VNNI correction.
+        template<typename T>
+        void packIntB(const T* b, std::size_t ldb, bool trans, std::size_t p0, std::size_t kc,
+                      std::size_t j0, std::size_t nc, std::size_t G, bool flip, T* out,
+                      widened_accumulator_t<T>* correction)
+        {
+            using Acc = widened_accumulator_t<T>;
+            constexpr std::size_t NR = IntGemmShape<T>::NR;
+            const std::size_t groups = (kc + G - 1) / G;
+            const std::size_t slivers = (nc + NR - 1) / NR;
+            parallelFor(slivers, 4, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t s = begin; s < end; ++s)
+                {
+                    const std::size_t jr = s * NR;
+                    const std::size_t cols = std::min(NR, nc - jr);
+                    T* dst = out + s * NR * groups * G;
+                    Acc sums[NR] = {};
+                    for (std::size_t g = 0; g < groups; ++g)
+                        for (std::size_t j = 0; j < NR; ++j)
+                            for (std::size_t u = 0; u < G; ++u)
+                            {
+                                const std::size_t p = g * G + u;
+                                const T v = (j < cols && p < kc) ? intLoad(b, ldb, trans, p0 + p, j0 + jr + j) : T{0};
+                                sums[j] += v;
+                                *dst++ = v;
+                            }
+                    if (flip)
+                        for (std::size_t j = 0; j < NR; ++j) correction[jr + j] = 128 * sums[j];
+                }
+            });
+        }
+    }
+
+    template<typename T>
+    void gemmWidened(bool transA, bool transB, std::size_t m, std::size_t n, std::size_t k,
+                     const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                     widened_accumulator_t<T>* c, std::size_t ldc, bool accumulate)
+    {
+        BML_PERF_SCOPE("gemmWidened", T);
+        using Acc = widened_accumulator_t<T>;
+        using S = detail::IntGemmShape<T>;
+        if (m == 0 || n == 0) return;
+
+        if (!accumulate)
+            for (std::size_t i = 0; i < m; ++i) std::fill(c + i * ldc, c + i * ldc + n, Acc{0});
+        if (k == 0) return;
+
+        if (m * n * k <= detail::kIntGemmSmallWork)
+        {
+            for (std::size_t i = 0; i < m; ++i)
+                for (std::size_t p = 0; p < k; ++p)
+                {
+                    const Acc s = detail::intLoad(a, lda, transA, i, p);
+                    if (s == 0) continue;
+                    for (std::size_t j = 0; j < n; ++j)
+                        c[i * ldc + j] += s * static_cast<Acc>(detail::intLoad(b, ldb, transB, p, j));
+                }
+            return;
+        }
+
+        static const detail::IntGemmKernel<T> kernel = detail::selectIntKernel<T>();
+        const std::size_t mr = kernel.mr;
+        const std::size_t G = kernel.group;
+        const std::size_t panelCols = (std::min(n, S::NC) + S::NR - 1) / S::NR * S::NR;
+        const std::size_t maxGroups = (std::min(k, S::KC) + G - 1) / G;
+        std::vector<T> packedB(maxGroups * G * panelCols);
+        std::vector<Acc> correction(panelCols);
+
+        for (std::size_t jc = 0; jc < n; jc += S::NC)
+        {
+            const std::size_t nc = std::min(S::NC, n - jc);
+            for (std::size_t pc = 0; pc < k; pc += S::KC)
+            {
+                const std::size_t kc = std::min(S::KC, k - pc);
+                const std::size_t groups = (kc + G - 1) / G;
+                detail::packIntB(b, ldb, transB, pc, kc, jc, nc, G, kernel.flipA, packedB.data(), correction.data());
+
+                const std::size_t rowBlocks = (m + S::MC - 1) / S::MC;
+                const std::size_t colGroups = (nc + S::TaskCols - 1) / S::TaskCols;
+                parallelFor(rowBlocks * colGroups, 1, [&](std::size_t begin, std::size_t end) {
+                    std::vector<T> packedA(S::MC * groups * G);
+                    std::size_t packedRowBlock = rowBlocks;   // none yet
+                    for (std::size_t task = begin; task < end; ++task)
+                    {
+                        const std::size_t rb = task / colGroups;
+                        const std::size_t ic = rb * S::MC;
+                        const std::size_t mc = std::min(S::MC, m - ic);
+                        if (rb != packedRowBlock)
+                        {
+                            detail::packIntA(a, lda, transA, ic, mc, pc, kc, mr, G, kernel.flipA, packedA.data());
+                            packedRowBlock = rb;
+                        }
+
+                        const std::size_t jBegin = (task % colGroups) * S::TaskCols;
+                        const std::size_t jEnd = std::min(nc, jBegin + S::TaskCols);
+                        for (std::size_t jr = jBegin; jr < jEnd; jr += S::NR)
+                        {
+                            const std::size_t nr = std::min(S::NR, nc - jr);
+                            const T* pb = packedB.data() + jr * groups * G;
+                            for (std::size_t ir = 0; ir < mc; ir += mr)
+                                kernel.run(groups, packedA.data() + ir * groups * G, pb,
+                                           c + (ic + ir) * ldc + jc + jr, ldc, std::min(mr, mc - ir), nr,
+                                           correction.data() + jr);
+                        }
+                    }
+                });
+            }
+        }
+    }
+
+    template<typename T>
+    Matrix<widened_accumulator_t<T>> matmulWidened(const Matrix<T>& a, const Matrix<T>& b,
+                                                   std::int32_t aZeroPoint, std::int32_t bZeroPoint)
+    {
+        BML_PERF_SCOPE("matmulWidened", T);
+        using Acc = widened_accumulator_t<T>;
+        if (a.numCols() != b.numRows())
+            throw std::invalid_argument("Matrix dimensions must match for multiplication.");
+
+        const std::size_t m = a.numRows(), n = b.numCols(), k = a.numCols();
+        Matrix<Acc> out(a.numRows(), b.numCols());
+        if (out.empty()) return out;
+        Acc* c = out.data_storage();
+        const T* pa = a.data_storage();
+        const T* pb = b.data_storage();
+        gemmWidened(false, false, m, n, k, pa, k, pb, n, c, n);
+
+        if (aZeroPoint == 0 && bZeroPoint == 0) return out;
+        // sum (a - za)(b - zb) = sum ab - zb * rowSum(a) - za * colSum(b) + k * za * zb
+        std::vector<Acc> colSums(n, Acc{0});
+        for (std::size_t p = 0; p < k; ++p)
+            for (std::size_t j = 0; j < n; ++j) colSums[j] += pb[p * n + j];
+        const Acc za = aZeroPoint, zb = bZeroPoint;
+        const Acc constant = static_cast<Acc>(k) * za * zb;
+        parallelFor(m, 16, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                Acc rowSum = 0;
+                for (std::size_t p = 0; p < k; ++p) rowSum += pa[i * k + p];
+                const Acc rowTerm = constant - zb * rowSum;
+                Acc* row = c + i * n;
+                for (std::size_t j = 0; j < n; ++j) row[j] += rowTerm - za * colSums[j];
+            }
+        });
+        return out;
+    }
+
+    template<typename Out>
+    Matrix<Out> requantize(const Matrix<std::int32_t>& acc, const Requantization& q)
+    {
+        BML_PERF_SCOPE("requantize", Out);
+        static_assert(std::is_integral_v<Out> && sizeof(Out) == 1, "bml::requantize: Out must be an 8-bit integer");
+        Matrix<Out> out(acc.numRows(), acc.numCols());
+        if (out.empty()) return out;
+        const std::int32_t* src = acc.data_storage();
+        Out* dst = out.data_storage();
+        const double scale = q.scale;
+        constexpr double lo = std::numeric_limits<Out>::min();
+        constexpr double hi = std::numeric_limits<Out>::max();
+        parallelFor(acc.size(), std::size_t{1} << 14, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const double v = std::round(src[i] * scale) + q.zeroPoint;
+                dst[i] = static_cast<Out>(std::clamp(v, lo, hi));
+            }
+        });
+        return out;
+    }
+
+    template<typename T>
+    Matrix<T> matmulQuantized(const Matrix<T>& a, const Matrix<T>& b, std::int32_t aZeroPoint,
+                              std::int32_t bZeroPoint, const Requantization& out)
+    {
+        return requantize<T>(matmulWidened(a, b, aZeroPoint, bZeroPoint), out);
+    }
+} // namespace bml
@@ -0,0 +1,475 @@
+#include "bml/lazy.hpp"
+#include "bml/dispatch.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Bytes of one tile of one node: a handful of live tiles stay in L1.
+        constexpr std::size_t kLazyTileBytes = 4096;
+
+        // Cells of a tile; a constant, so full tiles run fixed-length loops that vectorize.
+        template<typename T>
+        constexpr std::size_t kLazyTileCells = kLazyTileBytes / sizeof(T);
+
+        // Tile-operations per parallel task at least.
+        constexpr std::size_t kLazyTaskWork = 64;
+
+        // One operation of an evaluation plan, in dependency order.
+        template<typename T>
+        struct LazyStep
+        {
+            LazyOp op;
+            std::uint32_t node;
+            std::uint32_t lhs;          // operand node ids
+            std::uint32_t rhs;
+            bool scalarRhs;             // rhs is a Constant: use scalar
+            T scalar;
+            std::size_t slot;           // scratch tile of the result, or kResultSlot
+            std::size_t result;         // index into the results when slot == kResultSlot
+        };
+
+        constexpr std::size_t kResultSlot = static_cast<std::size_t>(-1);
+
+        inline const char* lazyOpName(LazyOp op) noexcept
+        {
+            switch (op)
+            {
+                case LazyOp::Add: return "addition";
+                case LazyOp::Sub: return "subtraction";
+                case LazyOp::Mul: return "multiplication";
+                case LazyOp::Div: return "division";
+                default: return "this operation";
+            }
+        }
+
+        // out = a op b over one tile (b may be a scalar); false, with out untouched, if a divisor is zero.
+        template<bool Full, typename T>
+        BML_HOT_KERNEL bool lazyTile(LazyOp op, const T* BML_RESTRICT a, const T* BML_RESTRICT b, T s,
+                                     T* BML_RESTRICT out, std::size_t n)
+        {
+            const std::size_t len = Full ? kLazyTileCells<T> : n;
+            if (b)
+            {
+                switch (op)
+                {
+                    case LazyOp::Add:
+                        for (std::size_t i = 0; i < len; ++i) out[i] = static_cast<T>(a[i] + b[i]);
+                        return true;
+                    case LazyOp::Sub:
+                        for (std::size_t i = 0; i < len; ++i) out[i] = static_cast<T>(a[i] - b[i]);
+                        return true;
+                    case LazyOp::Mul:
+                        for (std::size_t i = 0; i < len; ++i) out[i] = static_cast<T>(a[i] * b[i]);
+                        return true;
+                    case LazyOp::Div:
+                    {
+                        bool zero = false;
+                        for (std::size_t i = 0; i < len; ++i) zero |= b[i] == T{0};
+                        if (zero) return false;
+                        for (std::size_t i = 0; i < len; ++i) out[i] = static_cast<T>(a[i] / b[i]);
+                        return true;
+                    }
+                    default:
+                        return true;
+                }
+            }
+            switch (op)
+            {
+                case LazyOp::Add:
+                    for (std::size_t i = 0; i < len; ++i) out[i] = static_cast<T>(a[i] + s);
+                    break;
+                case LazyOp::Sub:
+                    for (std::size_t i = 0; i < len; ++i) out[i] = static_cast<T>(a[i] - s);
+                    break;
+                case LazyOp::Mul:
+                    for (std::size_t i = 0; i < len; ++i) out[i] = static_cast<T>(a[i] * s);
+                    break;
+                case LazyOp::Div:   // zero scalars are rejected when recorded
+                    for (std::size_t i = 0; i < len; ++i) out[i] = static_cast<T>(a[i] / s);
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        }
+
+        // Kahan sum of one tile, as Matrix::sum() does for floating point.
+        template<typename T>
+        T lazyTileSum(const T* a, std::size_t n) noexcept
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                T s = T{0}, c = T{0};
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    const T y = a[i] - c;
+                    const T t = s + y;
+                    c = (t - s) - y;
+                    s = t;
+                }
+                return s;
+            }
+            else
+            {
+                T s = T{0};
+                for (std::size_t i = 0; i < n; ++i) s = static_cast<T>(s + a[i]);
+                return s;
+            }
+        }
+    }
+
+    // ---------- LazyExpr ----------
+
+    template<typename T>
+    std::uint32_t LazyExpr<T>::numRows() const { return owner->numRows(node); }
+
+    template<typename T>
+    std::uint32_t LazyExpr<T>::numCols() const { return owner->numCols(node); }
+
+    template<typename T>
+    LazyExpr<T> LazyExpr<T>::operator+(const LazyExpr& other) const { return owner->binary(LazyOp::Add, *this, other); }
+
+    template<typename T>
+    LazyExpr<T> LazyExpr<T>::operator-(const LazyExpr& other) const { return owner->binary(LazyOp::Sub, *this, other); }
+
+    template<typename T>
+    LazyExpr<T> LazyExpr<T>::operator*(const LazyExpr& other) const { return owner->binary(LazyOp::Mul, *this, other); }
+
+    template<typename T>
+    LazyExpr<T> LazyExpr<T>::operator/(const LazyExpr& other) const { return owner->binary(LazyOp::Div, *this, other); }
+
+    template<typename T>
+    LazyExpr<T> LazyExpr<T>::operator+(const T& scalar) const { return owner->binary(LazyOp::Add, *this, scalar); }
+
+    template<typename T>
+    LazyExpr<T> LazyExpr<T>::operator-(const T& scalar) const { return owner->binary(LazyOp::Sub, *this, scalar); }
+
+    template<typename T>
+    LazyExpr<T> LazyExpr<T>::operator*(const T& scalar) const { return owner->binary(LazyOp::Mul, *this, scalar); }
+
+    template<typename T>
+    LazyExpr<T> LazyExpr<T>::operator/(const T& scalar) const { return owner->binary(LazyOp::Div, *this, scalar); }
+
+    template<typename T>
+    Matrix<T> LazyExpr<T>::eval() const { return owner->evaluate(*this); }
+
+    template<typename T>
+    T LazyExpr<T>::sum() const { return owner->sum(*this); }
+
+    template<typename T>
+    T LazyExpr<T>::min() const { return owner->min(*this); }
+
+    template<typename T>
+    T LazyExpr<T>::max() const { return owner->max(*this); }
+
+    // ---------- recording ----------
+
+    template<typename T>
+    void LazyGraph<T>::checkOwn(const LazyExpr<T>& expr) const
+    {
+        if (expr.owner != this || expr.node >= nodes.size())
+            throw std::invalid_argument("LazyExpr does not belong to this LazyGraph.");
+    }
+
+    template<typename T>
+    std::uint32_t LazyGraph<T>::record(LazyOp op, std::uint32_t lhs, std::uint32_t rhs)
+    {
+        // + and * commute exactly, so one order serves both spellings.
+        const bool scalar = nodes[rhs].op == LazyOp::Constant;
+        if ((op == LazyOp::Add || op == LazyOp::Mul) && !scalar && rhs < lhs) std::swap(lhs, rhs);
+        const auto key = std::make_tuple(op, lhs, rhs);
+        const auto found = memo.find(key);
+        if (found != memo.end()) return found->second;
+
+        const std::uint32_t rows = nodes[lhs].rows, cols = nodes[lhs].cols;
+        nodes.push_back(Node{op, lhs, rhs, rows, cols, T{0}});
+        const auto id = static_cast<std::uint32_t>(nodes.size() - 1);
+        memo.emplace(key, id);
+        return id;
+    }
+
+    template<typename T>
+    std::uint32_t LazyGraph<T>::constant(const T& value)
+    {
+        // Bit-for-bit equal values only: 0.0 and -0.0 divide differently, and NaN never compares equal.
+        for (std::uint32_t id = 0; id < nodes.size(); ++id)
+        {
+            const Node& n = nodes[id];
+            if (n.op != LazyOp::Constant || !(n.value == value)) continue;
+            if constexpr (std::is_floating_point_v<T>)
+                if (std::signbit(n.value) != std::signbit(value)) continue;
+            return id;
+        }
+        nodes.push_back(Node{LazyOp::Constant, 0, 0, 0, 0, value});
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    }
+
+    template<typename T>
+    LazyExpr<T> LazyGraph<T>::input(const Matrix<T>& matrix)
+    {
+        for (std::uint32_t id = 0; id < nodes.size(); ++id)
+        {
+            const Node& n = nodes[id];
+            if (n.op == LazyOp::Input && n.rows == matrix.numRows() && n.cols == matrix.numCols() &&
+                inputs[n.lhs].sharesStorageWith(matrix))
+                return LazyExpr<T>(this, id);
+        }
+        inputs.push_back(matrix);
+        nodes.push_back(Node{LazyOp::Input, static_cast<std::uint32_t>(inputs.size() - 1), 0,
+                             matrix.numRows(), matrix.numCols(), T{0}});
+        return LazyExpr<T>(this, static_cast<std::uint32_t>(nodes.size() - 1));
+    }
+
+    template<typename T>
+    LazyExpr<T> LazyGraph<T>::binary(LazyOp op, const LazyExpr<T>& lhs, const LazyExpr<T>& rhs)
+    {
+        checkOwn(lhs);
+        checkOwn(rhs);
+        if (op == LazyOp::Input || op == LazyOp::Constant)
+            throw std::invalid_argument("LazyGraph::binary() needs an arithmetic operation.");
+        const Node& a = nodes[lhs.node];
+        const Node& b = nodes[rhs.node];
+        if (a.rows != b.rows || a.cols != b.cols)
+            throw std::invalid_argument(std::string("Matrix dimensions must match for ") + detail::lazyOpName(op) + ".");
+        return LazyExpr<T>(this, record(op, lhs.node, rhs.node));
+    }
+
+    template<typename T>
+    LazyExpr<T> LazyGraph<T>::binary(LazyOp op, const LazyExpr<T>& lhs, const T& scalar)
+    {
+        checkOwn(lhs);
+        if (op == LazyOp::Input || op == LazyOp::Constant)
+            throw std::invalid_argument("LazyGraph::binary() needs an arithmetic operation.");
+        if (op == LazyOp::Div && scalar == T{0})
+            throw std::runtime_error("Division by zero encountered.");
+        return LazyExpr<T>(this, record(op, lhs.node, constant(scalar)));
+    }
+
+    template<typename T>
+    void LazyGraph<T>::clear() noexcept
+    {
+        nodes.clear();
+        inputs.clear();
+        memo.clear();
+    }
+
+    // ---------- evaluation ----------
+
+    template<typename T>
+    void LazyGraph<T>::sweep(const std::vector<std::uint32_t>& roots, std::vector<Matrix<T>>& results,
+                             Reduction reduction, std::vector<T>& partials)
+    {
+        constexpr std::size_t Tile = detail::kLazyTileCells<T>;
+        const std::size_t cells = std::size_t{nodes[roots.front()].rows} * nodes[roots.front()].cols;
+        const std::size_t tiles = (cells + Tile - 1) / Tile;
+
+        // Nodes the roots depend on; ids are already in dependency order.
+        std::vector<bool> needed(nodes.size(), false);
+        for (std::uint32_t r : roots) needed[r] = true;
+        for (std::size_t id = nodes.size(); id-- > 0;)
+        {
+            const Node& n = nodes[id];
+            if (!needed[id] || n.op == LazyOp::Input || n.op == LazyOp::Constant) continue;
+            needed[n.lhs] = true;
+            needed[n.rhs] = true;
+        }
+
+        std::vector<std::size_t> lastUse(nodes.size(), 0);
+        std::vector<std::uint32_t> order;
+        for (std::uint32_t id = 0; id < nodes.size(); ++id)
+        {
+            const Node& n = nodes[id];
+            if (!needed[id] || n.op == LazyOp::Input || n.op == LazyOp::Constant) continue;
+            lastUse[n.lhs] = lastUse[n.rhs] = order.size();
+            order.push_back(id);
+        }
+
+        // Scratch tiles by linear scan: a node's tile is reused once its last reader has run.
+        // A result tile is taken before the operands' are freed, so no step writes what it reads.
+        std::vector<std::size_t> resultOf(nodes.size(), detail::kResultSlot);
+        if (reduction == Reduction::None)
+            for (std::size_t r = 0; r < roots.size(); ++r) resultOf[roots[r]] = r;
+        std::vector<std::size_t> slotOf(nodes.size(), detail::kResultSlot);
+        std::vector<std::size_t> freeSlots;
+        std::size_t slots = 0;
+        std::vector<detail::LazyStep<T>> steps;
+        for (std::size_t k = 0; k < order.size(); ++k)
+        {
+            const std::uint32_t id = order[k];
+            const Node& n = nodes[id];
+            detail::LazyStep<T> step{n.op, id, n.lhs, n.rhs, nodes[n.rhs].op == LazyOp::Constant, nodes[n.rhs].value,
+                                     detail::kResultSlot, resultOf[id]};
+            if (step.result == detail::kResultSlot)
+            {
+                if (freeSlots.empty()) freeSlots.push_back(slots++);
+                step.slot = slotOf[id] = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            for (std::uint32_t operand : {n.lhs, n.rhs})
+                if (slotOf[operand] != detail::kResultSlot && lastUse[operand] == k &&
+                    (reduction == Reduction::None || operand != roots.front()))
+                {
+                    freeSlots.push_back(slotOf[operand]);
+                    slotOf[operand] = detail::kResultSlot;
+                }
+            steps.push_back(step);
+        }
+
+        std::vector<T*> out(roots.size(), nullptr);
+        for (std::size_t r = 0; r < roots.size() && reduction == Reduction::None; ++r)
+            out[r] = results[r].data_storage();
+        if (reduction != Reduction::None) partials.assign(tiles, T{0});
+        // Read through const: the non-const accessor would detach buffers shared with the caller.
+        std::vector<const T*> inputAt(nodes.size(), nullptr);
+        for (std::uint32_t id = 0; id < nodes.size(); ++id)
+            if (needed[id] && nodes[id].op == LazyOp::Input)
+                inputAt[id] = std::as_const(inputs[nodes[id].lhs]).data_storage();
+
+        const std::size_t grain = std::max<std::size_t>(1, detail::kLazyTaskWork / std::max<std::size_t>(1, steps.size()));
+        parallelFor(tiles, grain, [&](std::size_t begin, std::size_t end) {
+            std::vector<T> scratch(slots * Tile);
+            std::vector<const T*> at(nodes.size(), nullptr);
+            for (std::size_t t = begin; t < end; ++t)
+            {
+                const std::size_t offset = t * Tile;
+                const std::size_t n = std::min(Tile, cells - offset);
+                for (std::uint32_t id = 0; id < nodes.size(); ++id)
+                    if (inputAt[id]) at[id] = inputAt[id] + offset;
+
+                for (const auto& step : steps)
+                {
+                    T* dst = step.slot == detail::kResultSlot ? out[step.result] + offset : scratch.data() + step.slot * Tile;
+                    const T* b = step.scalarRhs ? nullptr : at[step.rhs];
+                    const bool ok = n == Tile ? detail::lazyTile<true>(step.op, at[step.lhs], b, step.scalar, dst, n)
+                                              : detail::lazyTile<false>(step.op, at[step.lhs], b, step.scalar, dst, n);
+                    if (!ok) throw std::runtime_error("Division by zero encountered.");
+                    at[step.node] = dst;
+                }
+
+                if (reduction == Reduction::None) continue;
+                const T* r = at[roots.front()];
+                if (reduction == Reduction::Sum)
+                {
+                    partials[t] = detail::lazyTileSum(r, n);
+                }
+                else
+                {
+                    T m = r[0];
+                    for (std::size_t i = 1; i < n; ++i)
+                        if (reduction == Reduction::Min ? r[i] < m : m < r[i]) m = r[i];
+                    partials[t] = m;
+                }
+            }
+        });
+    }
+
+    template<typename T>
+    std::vector<Matrix<T>> LazyGraph<T>::evaluate(const std::vector<LazyExpr<T>>& exprs)
+    {
+        BML_PERF_SCOPE("lazy evaluate", T);
+        std::vector<Matrix<T>> results;
+        if (exprs.empty()) return results;
+        for (const auto& e : exprs) checkOwn(e);
+        const Node& first = nodes[exprs.front().node];
+        for (const auto& e : exprs)
+            if (nodes[e.node].rows != first.rows || nodes[e.node].cols != first.cols)
+                throw std::invalid_argument("Expressions evaluated together must have the same dimensions.");
+        BML_TRACE_SCOPE("lazy evaluate", T, first.rows, first.cols,
+                        (inputs.size() + exprs.size()) * std::size_t{first.rows} * first.cols * sizeof(T));
+
+        // Computed once each, in a single sweep; inputs and kept results are returned as they are.
+        std::vector<std::uint32_t> roots;
+        for (const auto& e : exprs)
+            if (nodes[e.node].op != LazyOp::Input &&
+                std::find(roots.begin(), roots.end(), e.node) == roots.end())
+                roots.push_back(e.node);
+
+        if (!roots.empty())
+        {
+            std::vector<Matrix<T>> computed;
+            computed.reserve(roots.size());
+            for (std::size_t r = 0; r < roots.size(); ++r) computed.emplace_back(first.rows, first.cols);
+            std::vector<T> unused;
+            sweep(roots, computed, Reduction::None, unused);
+
+            // Keep the results: later evaluations read them instead of recomputing.
+            for (std::size_t r = 0; r < roots.size(); ++r)
+            {
+                inputs.push_back(std::move(computed[r]));
+                Node& n = nodes[roots[r]];
+                n.op = LazyOp::Input;
+                n.lhs = static_cast<std::uint32_t>(inputs.size() - 1);
+                n.rhs = 0;
+            }
+        }
+
+        results.reserve(exprs.size());
+        for (const auto& e : exprs) results.push_back(inputs[nodes[e.node].lhs]);
+        return results;
+    }
+
+    template<typename T>
+    Matrix<T> LazyGraph<T>::evaluate(const LazyExpr<T>& expr)
+    {
+        return std::move(evaluate(std::vector<LazyExpr<T>>{expr}).front());
+    }
+
+    template<typename T>
+    T LazyGraph<T>::reduce(const LazyExpr<T>& expr, Reduction reduction)
+    {
+        checkOwn(expr);
+        const Node& root = nodes[expr.node];
+        if (reduction != Reduction::Sum && std::size_t{root.rows} * root.cols == 0)
+            throw std::runtime_error(reduction == Reduction::Min ? "LazyGraph::min() on empty matrix"
+                                                                 : "LazyGraph::max() on empty matrix");
+
+        std::vector<T> partials;
+        if (root.op == LazyOp::Input)
+        {
+            const Matrix<T>& m = inputs[root.lhs];
+            if (reduction == Reduction::Sum) return m.sum();
+            return reduction == Reduction::Min ? m.min() : m.max();
+        }
+        std::vector<Matrix<T>> unused;
+        sweep({expr.node}, unused, reduction, partials);
+
+        if (reduction == Reduction::Sum) return detail::lazyTileSum(partials.data(), partials.size());
+        T m = partials.front();
+        for (const T& p : partials)
+            if (reduction == Reduction::Min ? p < m : m < p) m = p;
+        return m;
+    }
+
+    template<typename T>
+    T LazyGraph<T>::sum(const LazyExpr<T>& expr)
+    {
+        BML_PERF_SCOPE("lazy sum", T);
+        return reduce(expr, Reduction::Sum);
+    }
+
+    template<typename T>
+    T LazyGraph<T>::min(const LazyExpr<T>& expr)
+    {
+        BML_PERF_SCOPE("lazy min", T);
+        return reduce(expr, Reduction::Min);
+    }
+
+    template<typename T>
+    T LazyGraph<T>::max(const LazyExpr<T>& expr)
+    {
+        BML_PERF_SCOPE("lazy max", T);
+        return reduce(expr, Reduction::Max);
+    }
+} // namespace bml
@@ -0,0 +1,543 @@
+#include "bml/linalg.hpp"
+#include "bml/gemm.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Panel width of the blocked factorizations; the GEMM updates dominate above it.
+        constexpr std::size_t kLinalgBlock = 64;
+
+        /*
+         * Solve op(T) * X = X in place: T is n x n triangular (stride ldt), X is
+         * n x cols (stride ldx). @p lower describes T as stored; op(T) = T^T when
+         * @p trans. Diagonal blocks are substituted directly (split over columns of
+         * X), the off-diagonal contributions are applied with GEMM.
+         */
+        template<typename T>
+        void triangularSolve(bool lower, bool trans, bool unit, std::size_t n, const T* t, std::size_t ldt,
+                             std::size_t cols, T* x, std::size_t ldx)
+        {
+            if (n == 0 || cols == 0) return;
+            constexpr std::size_t nb = kLinalgBlock;
+            const bool forward = lower != trans;   // op(T) is lower triangular
+            auto at = [&](std::size_t i, std::size_t p) { return trans ? t[p * ldt + i] : t[i * ldt + p]; };
+            auto block = [&](std::size_t i0, std::size_t p0) { return trans ? t + p0 * ldt + i0 : t + i0 * ldt + p0; };
+
+            auto solveDiagonal = [&](std::size_t k0, std::size_t kb) {
+                parallelFor(cols, 256, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t step = 0; step < kb; ++step)
+                    {
+                        const std::size_t i = forward ? k0 + step : k0 + kb - 1 - step;
+                        T* xi = x + i * ldx;
+                        const std::size_t pBegin = forward ? k0 : i + 1;
+                        const std::size_t pEnd = forward ? i : k0 + kb;
+                        for (std::size_t p = pBegin; p < pEnd; ++p)
+                        {
+                            const T s = at(i, p);
+                            if (s == T{0}) continue;
+                            const T* xp = x + p * ldx;
+                            for (std::size_t c = begin; c < end; ++c) xi[c] -= s * xp[c];
+                        }
+                        if (!unit)
+                        {
+                            const T d = at(i, i);
+                            for (std::size_t c = begin; c < end; ++c) xi[c] /= d;
+                        }
+                    }
+                });
+            };
+
+            const std::size_t blocks = (n + nb - 1) / nb;
+            for (std::size_t step = 0; step < blocks; ++step)
+            {
+                const std::size_t k0 = (forward ? step : blocks - 1 - step) * nb;
+                const std::size_t kb = std::min(nb, n - k0);
+                solveDiagonal(k0, kb);
+                if (forward && k0 + kb < n)
+                    gemm(trans, false, n - k0 - kb, cols, kb, T{-1}, block(k0 + kb, k0), ldt,
+                         x + k0 * ldx, ldx, T{1}, x + (k0 + kb) * ldx, ldx);
+                else if (!forward && k0 > 0)
+                    gemm(trans, false, k0, cols, kb, T{-1}, block(0, k0), ldt,
+                         x + k0 * ldx, ldx, T{1}, x, ldx);
+            }
+        }
+
+        template<typename T>
+        Matrix<T> identityMatrix(std::size_t n)
+        {
+            Matrix<T> out(static_cast<std::uint32_t>(n), static_cast<std::uint32_t>(n));
+            T* p = out.data_storage();
+            for (std::size_t i = 0; i < n; ++i) p[i * n + i] = T{1};
+            return out;
+        }
+
+        template<typename T>
+        Matrix<T> columnMatrix(const std::vector<T>& v)
+        {
+            Matrix<T> out(static_cast<std::uint32_t>(v.size()), 1);
+            std::copy(v.begin(), v.end(), out.data_storage());
+            return out;
+        }
+
+        template<typename T>
+        std::vector<T> columnVector(const Matrix<T>& m)
+        {
+            const T* p = m.data_storage();
+            return std::vector<T>(p, p + m.size());
+        }
+
+        inline void requireSquare(std::size_t rows, std::size_t cols, const char* what)
+        {
+            if (rows != cols) throw std::invalid_argument(std::string(what) + " requires a square matrix.");
+        }
+
+        inline void requireRhsRows(std::size_t expected, std::size_t rows)
+        {
+            if (expected != rows) throw std::invalid_argument("Matrix dimensions must match for solve.");
+        }
+
+        // ||p[first..last) (stride ld)||_2 without intermediate overflow.
+        template<typename T>
+        T columnNorm(const T* p, std::size_t ld, std::size_t first, std::size_t last)
+        {
+            T scale = T{0};
+            for (std::size_t i = first; i < last; ++i) scale = std::max(scale, std::abs(p[i * ld]));
+            if (scale == T{0}) return T{0};
+            T ssq = T{0};
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const T v = p[i * ld] / scale;
+                ssq += v * v;
+            }
+            return scale * std::sqrt(ssq);
+        }
+    }
+
+    // ---------------------------------------------------------------------------------
+    // LU
+    // ---------------------------------------------------------------------------------
+
+    template<typename T>
+    LuFactorization<T>::LuFactorization(const Matrix<T>& a)
+        : n(a.numRows()), lu(a), piv(a.numRows())
+    {
+        BML_PERF_SCOPE("lu", T);
+        BML_TRACE_SCOPE("lu", T, a.numRows(), a.numCols(), 2 * a.size() * sizeof(T));
+        detail::requireSquare(a.numRows(), a.numCols(), "LU factorization");
+        constexpr std::size_t nb = detail::kLinalgBlock;
+        T* A = lu.data_storage();
+
+        for (std::size_t k0 = 0; k0 < n; k0 += nb)
+        {
+            const std::size_t kb = std::min(nb, n - k0);
+            const std::size_t panelEnd = k0 + kb;
+
+            // Unblocked factorization of columns [k0, panelEnd); pivoting swaps whole rows.
+            for (std::size_t j = k0; j < panelEnd; ++j)
+            {
+                std::size_t p = j;
+                T best = std::abs(A[j * n + j]);
+                for (std::size_t i = j + 1; i < n; ++i)
+                {
+                    const T v = std::abs(A[i * n + j]);
+                    if (v > best) { best = v; p = i; }
+                }
+                piv[j] = static_cast<std::uint32_t>(p);
+                if (p != j)
+                {
+                    std::swap_ranges(A + j * n, A + j * n + n, A + p * n);
+                    oddSwaps = !oddSwaps;
+                }
+
+                const T pivot = A[j * n + j];
+                if (pivot == T{0})
+                {
+                    isSingular = true;
+                    continue;
+                }
+                const T* rowJ = A + j * n;
+                parallelFor(n - j - 1, 64, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t r = begin; r < end; ++r)
+                    {
+                        T* row = A + (j + 1 + r) * n;
+                        const T l = row[j] /= pivot;
+                        if (l == T{0}) continue;
+                        for (std::size_t c = j + 1; c < panelEnd; ++c) row[c] -= l * rowJ[c];
+                    }
+                });
+            }
+
+            if (panelEnd < n)
+            {
+                const std::size_t rest = n - panelEnd;
+                // U12 = L11^-1 * A12, then A22 -= L21 * U12.
+                detail::triangularSolve(true, false, true, kb, A + k0 * n + k0, n, rest, A + k0 * n + panelEnd, n);
+                gemm(false, false, rest, rest, kb, T{-1}, A + panelEnd * n + k0, n,
+                     A + k0 * n + panelEnd, n, T{1}, A + panelEnd * n + panelEnd, n);
+            }
+        }
+    }
+
+    template<typename T>
+    T LuFactorization<T>::determinant() const
+    {
+        if (isSingular) return T{0};
+        const T* A = lu.data_storage();
+        T det = T{1};
+        for (std::size_t i = 0; i < n; ++i) det *= A[i * n + i];
+        return oddSwaps ? -det : det;
+    }
+
+    template<typename T>
+    Matrix<T> LuFactorization<T>::solve(const Matrix<T>& b) const
+    {
+        BML_PERF_SCOPE("lu_solve", T);
+        detail::requireRhsRows(n, b.numRows());
+        if (isSingular) throw std::runtime_error("LuFactorization::solve() on singular matrix.");
+
+        Matrix<T> x = b;
+        const std::size_t cols = b.numCols();
+        if (x.empty()) return x;
+        T* X = x.data_storage();
+        for (std::size_t i = 0; i < n; ++i)
+            if (piv[i] != i) std::swap_ranges(X + i * cols, X + (i + 1) * cols, X + piv[i] * cols);
+
+        const T* A = lu.data_storage();
+        detail::triangularSolve(true, false, true, n, A, n, cols, X, cols);
+        detail::triangularSolve(false, false, false, n, A, n, cols, X, cols);
+        return x;
+    }
+
+    template<typename T>
+    std::vector<T> LuFactorization<T>::solve(const std::vector<T>& b) const
+    {
+        return detail::columnVector(solve(detail::columnMatrix(b)));
+    }
+
+    template<typename T>
+    Matrix<T> LuFactorization<T>::inverse() const
+    {
+        return solve(detail::identityMatrix<T>(n));
+    }
+
+    // ---------------------------------------------------------------------------------
+    // Cholesky
+    // ---------------------------------------------------------------------------------
+
+    template<typename T>
+    CholeskyFactorization<T>::CholeskyFactorization(const Matrix<T>& a)
+        : n(a.numRows()), l(a)
+    {
+        BML_PERF_SCOPE("cholesky", T);
+        BML_TRACE_SCOPE("cholesky", T, a.numRows(), a.numCols(), 2 * a.size() * sizeof(T));
+        detail::requireSquare(a.numRows(), a.numCols(), "Cholesky factorization");
+        constexpr std::size_t nb = detail::kLinalgBlock;
+        T* L = l.data_storage();
+
+        // Row i of L against row j over columns [k0, j) -- the part not yet folded
+        // into the trailing matrix by earlier panels.
+        auto reduce = [&](const T* ri, const T* rj, std::size_t k0, std::size_t j) {
+            T s = ri[j];
+            for (std::size_t p = k0; p < j; ++p) s -= ri[p] * rj[p];
+            return s;
+        };
+
+        for (std::size_t k0 = 0; k0 < n; k0 += nb)
+        {
+            const std::size_t kb = std::min(nb, n - k0);
+            const std::size_t end = k0 + kb;
+
+            for (std::size_t j = k0; j < end; ++j)
+            {
+                T* rj = L + j * n;
+                const T d = reduce(rj, rj, k0, j);
+                if (!(d > T{0})) throw std::runtime_error("Matrix is not positive definite.");
+                rj[j] = std::sqrt(d);
+                for (std::size_t i = j + 1; i < end; ++i)
+                {
+                    T* ri = L + i * n;
+                    ri[j] = reduce(ri, rj, k0, j) / rj[j];
+                }
+            }
+
+            if (end == n) break;
+            // L21 = A21 * L11^-T, one row at a time.
+            parallelFor(n - end, 32, [&](std::size_t begin, std::size_t stop) {
+                for (std::size_t r = begin; r < stop; ++r)
+                {
+                    T* ri = L + (end + r) * n;
+                    for (std::size_t j = k0; j < end; ++j)
+                    {
+                        const T* rj = L + j * n;
+                        ri[j] = reduce(ri, rj, k0, j) / rj[j];
+                    }
+                }
+            });
+            // A22 -= L21 * L21^T, lower triangle only (per row block, up to its diagonal).
+            for (std::size_t i0 = end; i0 < n; i0 += nb)
+            {
+                const std::size_t ib = std::min(nb, n - i0);
+                gemm(false, true, ib, i0 + ib - end, kb, T{-1}, L + i0 * n + k0, n,
+                     L + end * n + k0, n, T{1}, L + i0 * n + end, n);
+            }
+        }
+
+        for (std::size_t i = 0; i < n; ++i) std::fill(L + i * n + i + 1, L + (i + 1) * n, T{0});
+    }
+
+    template<typename T>
+    T CholeskyFactorization<T>::determinant() const
+    {
+        const T* L = l.data_storage();
+        T det = T{1};
+        for (std::size_t i = 0; i < n; ++i) det *= L[i * n + i];
+        return det * det;
+    }
+
+    template<typename T>
+    Matrix<T> CholeskyFactorization<T>::solve(const Matrix<T>& b) const
+    {
+        BML_PERF_SCOPE("cholesky_solve", T);
+        detail::requireRhsRows(n, b.numRows());
+        Matrix<T> x = b;
+        const std::size_t cols = b.numCols();
+        if (x.empty()) return x;
+        T* X = x.data_storage();
+        const T* L = l.data_storage();
+        detail::triangularSolve(true, false, false, n, L, n, cols, X, cols);
+        detail::triangularSolve(true, true, false, n, L, n, cols, X, cols);
+        return x;
+    }
+
+    template<typename T>
+    std::vector<T> CholeskyFactorization<T>::solve(const std::vector<T>& b) const
+    {
+        return detail::columnVector(solve(detail::columnMatrix(b)));
+    }
+
+    template<typename T>
+    Matrix<T> CholeskyFactorization<T>::inverse() const
+    {
+        return solve(detail::identityMatrix<T>(n));
+    }
+
+    // ---------------------------------------------------------------------------------
+    // Householder QR
+    // ---------------------------------------------------------------------------------
+
+    template<typename T>
+    QrFactorization<T>::QrFactorization(const Matrix<T>& a)
+        : m(a.numRows()), n(a.numCols()), qr(a), tau(a.numCols())
+    {
+        BML_PERF_SCOPE("qr", T);
+        BML_TRACE_SCOPE("qr", T, a.numRows(), a.numCols(), 2 * a.size() * sizeof(T));
+        if (m < n) throw std::invalid_argument("QR factorization requires rows >= cols.");
+        constexpr std::size_t nb = detail::kLinalgBlock;
+        T* A = qr.data_storage();
+        tBlocks.assign((n + nb - 1) / nb * nb * nb, T{0});
+        std::vector<T> w(nb), z(nb);
+
+        for (std::size_t k0 = 0; k0 < n; k0 += nb)
+        {
+            const std::size_t kb = std::min(nb, n - k0);
+            const std::size_t end = k0 + kb;
+
+            // Unblocked panel: reflector H_j = I - tau_j v v^T with v_j = 1 annihilates
+            // column j below the diagonal, then is applied to the rest of the panel.
+            for (std::size_t j = k0; j < end; ++j)
+            {
+                const T xnorm = detail::columnNorm(A + j, n, j + 1, m);
+                const T alpha = A[j * n + j];
+                if (xnorm == T{0})
+                {
+                    tau[j] = T{0};
+                    continue;
+                }
+                const T beta = -std::copysign(std::hypot(alpha, xnorm), alpha);
+                tau[j] = (beta - alpha) / beta;
+                const T scale = T{1} / (alpha - beta);
+                for (std::size_t i = j + 1; i < m; ++i) A[i * n + j] *= scale;
+                A[j * n + j] = beta;
+
+                const std::size_t width = end - j - 1;
+                if (width == 0) continue;
+                // w = tau * v^T * A[j:, j+1:end]
+                std::copy(A + j * n + j + 1, A + j * n + end, w.begin());
+                for (std::size_t i = j + 1; i < m; ++i)
+                {
+                    const T v = A[i * n + j];
+                    const T* row = A + i * n + j + 1;
+                    for (std::size_t c = 0; c < width; ++c) w[c] += v * row[c];
+                }
+                for (std::size_t c = 0; c < width; ++c) w[c] *= tau[j];
+                for (std::size_t c = 0; c < width; ++c) A[j * n + j + 1 + c] -= w[c];
+                for (std::size_t i = j + 1; i < m; ++i)
+                {
+                    const T v = A[i * n + j];
+                    T* row = A + i * n + j + 1;
+                    for (std::size_t c = 0; c < width; ++c) row[c] -= v * w[c];
+                }
+            }
+
+            // T factor (forward, column-wise): H_k0 ... H_end-1 = I - V T V^T with
+            // T(0:i, i) = -tau_i * T(0:i, 0:i) * V(:, 0:i)^T v_i.
+            T* tb = tBlocks.data() + k0 * nb;
+            for (std::size_t i = 0; i < kb; ++i)
+            {
+                const std::size_t ci = k0 + i;
+                for (std::size_t j = 0; j < i; ++j) z[j] = A[ci * n + k0 + j];
+                for (std::size_t r = ci + 1; r < m; ++r)
+                {
+                    const T v = A[r * n + ci];
+                    const T* row = A + r * n + k0;
+                    for (std::size_t j = 0; j < i; ++j) z[j] += row[j] * v;
+                }
+                for (std::size_t j = 0; j < i; ++j)
+                {
+                    T s = T{0};
+                    for (std::size_t q = j; q < i; ++q) s += tb[j * nb + q] * z[q];
+                    tb[j * nb + i] = -tau[ci] * s;
+                }
+                tb[i * nb + i] = tau[ci];
+            }
+
+            if (end < n) applyBlock(k0, kb, true, A + k0 * n + end, n, n - end);
+        }
+    }
+
+    // C (rows k0.. of an m-row matrix) = (I - V T V^T)^[T] C for the panel at k0.
+    template<typename T>
+    void QrFactorization<T>::applyBlock(std::size_t k0, std::size_t kb, bool transpose,
+                                        T* c, std::size_t ldc, std::size_t cols) const
+    {
+        constexpr std::size_t nb = detail::kLinalgBlock;
+        if (cols == 0) return;
+        const T* A = qr.data_storage();
+        const std::size_t rows = m - k0;
+
+        std::vector<T> v(rows * kb, T{0});
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            const T* src = A + (k0 + r) * n + k0;
+            T* dst = v.data() + r * kb;
+            const std::size_t below = std::min(r, kb);
+            std::copy(src, src + below, dst);
+            if (r < kb) dst[r] = T{1};
+        }
+
+        std::vector<T> w(kb * cols), tw(kb * cols);
+        gemm(true, false, kb, cols, rows, T{1}, v.data(), kb, c, ldc, T{0}, w.data(), cols);
+        gemm(transpose, false, kb, cols, kb, T{1}, tBlocks.data() + k0 * nb, nb, w.data(), cols, T{0}, tw.data(), cols);
+        gemm(false, false, rows, cols, kb, T{-1}, v.data(), kb, tw.data(), cols, T{1}, c, ldc);
+    }
+
+    template<typename T>
+    Matrix<T> QrFactorization<T>::applyQt(const Matrix<T>& b) const
+    {
+        detail::requireRhsRows(m, b.numRows());
+        constexpr std::size_t nb = detail::kLinalgBlock;
+        Matrix<T> out = b;
+        if (out.empty()) return out;
+        const std::size_t cols = b.numCols();
+        T* C = out.data_storage();
+        for (std::size_t k0 = 0; k0 < n; k0 += nb)
+            applyBlock(k0, std::min(nb, n - k0), true, C + k0 * cols, cols, cols);
+        return out;
+    }
+
+    template<typename T>
+    Matrix<T> QrFactorization<T>::R() const
+    {
+        Matrix<T> r(static_cast<std::uint32_t>(n), static_cast<std::uint32_t>(n));
+        const T* A = qr.data_storage();
+        T* out = r.data_storage();
+        for (std::size_t i = 0; i < n; ++i) std::copy(A + i * n + i, A + (i + 1) * n, out + i * n + i);
+        return r;
+    }
+
+    template<typename T>
+    Matrix<T> QrFactorization<T>::Q() const
+    {
+        constexpr std::size_t nb = detail::kLinalgBlock;
+        Matrix<T> q(static_cast<std::uint32_t>(m), static_cast<std::uint32_t>(n));
+        if (q.empty()) return q;
+        T* C = q.data_storage();
+        for (std::size_t i = 0; i < n; ++i) C[i * n + i] = T{1};
+        const std::size_t blocks = (n + nb - 1) / nb;
+        for (std::size_t b = blocks; b-- > 0;)
+        {
+            const std::size_t k0 = b * nb;
+            applyBlock(k0, std::min(nb, n - k0), false, C + k0 * n, n, n);
+        }
+        return q;
+    }
+
+    template<typename T>
+    Matrix<T> QrFactorization<T>::solve(const Matrix<T>& b) const
+    {
+        BML_PERF_SCOPE("qr_solve", T);
+        detail::requireRhsRows(m, b.numRows());
+        const T* A = qr.data_storage();
+        T largest = T{0};
+        for (std::size_t i = 0; i < n; ++i) largest = std::max(largest, std::abs(A[i * n + i]));
+        const T tolerance = largest * static_cast<T>(m) * std::numeric_limits<T>::epsilon();
+        for (std::size_t i = 0; i < n; ++i)
+            if (!(std::abs(A[i * n + i]) > tolerance))
+                throw std::runtime_error("QrFactorization::solve() on rank-deficient matrix.");
+
+        const std::size_t cols = b.numCols();
+        Matrix<T> x(static_cast<std::uint32_t>(n), static_cast<std::uint32_t>(cols));
+        if (x.empty()) return x;
+        const Matrix<T> y = applyQt(b);
+        T* X = x.data_storage();
+        std::copy(y.data_storage(), y.data_storage() + n * cols, X);
+        detail::triangularSolve(false, false, false, n, A, n, cols, X, cols);
+        return x;
+    }
+
+    template<typename T>
+    std::vector<T> QrFactorization<T>::solve(const std::vector<T>& b) const
+    {
+        return detail::columnVector(solve(detail::columnMatrix(b)));
+    }
+
+    // ---------------------------------------------------------------------------------
+    // One-shot helpers
+    // ---------------------------------------------------------------------------------
+
+    template<typename T>
+    Matrix<T> solve(const Matrix<T>& a, const Matrix<T>& b)
+    {
+        return LuFactorization<T>(a).solve(b);
+    }
+
+    template<typename T>
+    Matrix<T> inverse(const Matrix<T>& a)
+    {
+        return LuFactorization<T>(a).inverse();
+    }
+
+    template<typename T>
+    T determinant(const Matrix<T>& a)
+    {
+        return LuFactorization<T>(a).determinant();
+    }
+
+    template<typename T>
+    Matrix<T> lstsq(const Matrix<T>& a, const Matrix<T>& b)
+    {
+        return QrFactorization<T>(a).solve(b);
+    }
+} // namespace bml
@@ -0,0 +1,127 @@
+#include "bml/mappedFile.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#if !defined(_WIN32)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace bml
+{
+    namespace
+    {
+        [[noreturn]] void fail(const std::string& what, const std::string& path)
+        {
+            throw std::runtime_error("MappedFile: " + what + " '" + path + "': " + std::strerror(errno));
+        }
+    }
+
+    MappedFile::MappedFile(const std::string& path, Access access)
+        : writable(access == Access::Private)
+    {
+#if !defined(_WIN32)
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) fail("cannot open", path);
+
+        struct ::stat st{};
+        if (::fstat(fd, &st) != 0)
+        {
+            const int saved = errno;
+            ::close(fd);
+            errno = saved;
+            fail("cannot stat", path);
+        }
+
+        length = static_cast<std::size_t>(st.st_size);
+        if (length > 0)
+        {
+            const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+            void* p = ::mmap(nullptr, length, protection, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                const int saved = errno;
+                ::close(fd);
+                errno = saved;
+                fail("cannot map", path);
+            }
+            ::madvise(p, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char*>(p);
+            mapped = true;
+        }
+        ::close(fd);   // the mapping keeps the file alive
+#else
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) fail("cannot open", path);
+        std::unique_ptr<std::FILE, int (*)(std::FILE*)> guard(f, &std::fclose);
+
+        if (std::fseek(f, 0, SEEK_END) != 0) fail("cannot seek", path);
+        const long end = std::ftell(f);
+        if (end < 0) fail("cannot size", path);
+        std::rewind(f);
+
+        length = static_cast<std::size_t>(end);
+        if (length > 0)
+        {
+            std::unique_ptr<char[]> buffer(new char[length]);
+            if (std::fread(buffer.get(), 1, length, f) != length) fail("cannot read", path);
+            bytes = buffer.release();
+        }
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+        release();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : bytes(std::exchange(other.bytes, nullptr)),
+          length(std::exchange(other.length, 0)),
+          mapped(std::exchange(other.mapped, false)),
+          writable(std::exchange(other.writable, false))
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            bytes = std::exchange(other.bytes, nullptr);
+            length = std::exchange(other.length, 0);
+            mapped = std::exchange(other.mapped, false);
+            writable = std::exchange(other.writable, false);
+        }
+        return *this;
+    }
+
+    char* MappedFile::mutableData() const
+    {
+        if (!writable) throw std::logic_error("MappedFile: mutableData() requires Access::Private.");
+        return const_cast<char*>(bytes);
+    }
+
+    void MappedFile::release() noexcept
+    {
+        if (!bytes) return;
+#if !defined(_WIN32)
+        if (mapped)
+            ::munmap(const_cast<char*>(bytes), length);
+        else
+            delete[] bytes;
+#else
+        delete[] bytes;
+#endif
+        bytes = nullptr;
+        length = 0;
+        mapped = false;
+    }
+} // namespace bml
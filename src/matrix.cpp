@@ -1,15 +1,122 @@
 #include "bml/matrix.hpp"
 
+#include <algorithm>
+#include <charconv>
 #include <cstring>
 #include <limits>
-#include <sstream>
 #include <stdexcept>
 #include <cstdint>
+#include "bml/byteStream.hpp"
 #include "bml/iterator.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/sink.hpp"
+#include "bml/trace.hpp"
 
 
 namespace bml
 {
+    namespace detail
+    {
+        // Nominal bytes an operation reads and writes: @p buffers passes over @p cells cells.
+        template<typename T>
+        constexpr std::uint64_t traceBytes(std::size_t cells, unsigned buffers) noexcept
+        {
+            return static_cast<std::uint64_t>(cells) * buffers * sizeof(storage_of_t<T>);
+        }
+
+        // Regions at least this large are split across the thread pool by rows.
+        constexpr std::size_t kParallelCopyBytes = std::size_t{1} << 22;
+
+        // Move n cells within one buffer; the ranges may overlap.
+        template<typename S>
+        void moveCells(S* dst, S* src, std::size_t n)
+        {
+            if (n == 0 || dst == src) return;
+            if constexpr (std::is_trivially_copyable_v<S>)
+                std::memmove(dst, src, n * sizeof(S));
+            else if (dst < src)
+                std::move(src, src + n, dst);
+            else
+                std::move_backward(src, src + n, dst + n);
+        }
+
+        // Default size of a reduction-cache block: rescanning one costs about an L2 miss burst.
+        constexpr std::size_t kReductionBlockBytes = std::size_t{1} << 16;
+
+        // Recompute partials[b] = reduceBlock(firstCell, cellCount) for every block whose
+        // @p bit is clear, in parallel, and set the bit again.
+        template<typename T, typename S, typename F>
+        void refreshPartials(ReductionCache<T>& cache, std::uint8_t bit, std::size_t cols, std::size_t cells,
+                             std::vector<S>& partials, F reduceBlock)
+        {
+            std::vector<std::size_t> stale;
+            for (std::size_t b = 0; b < cache.valid.size(); ++b)
+                if (!(cache.valid[b] & bit)) stale.push_back(b);
+            if (stale.empty()) return;
+
+            const std::size_t blockCells = std::size_t{cache.blockRows} * cols;
+            const std::size_t grain = std::max<std::size_t>(1, kParallelCopyBytes / 4 / (blockCells * sizeof(S)));
+            parallelFor(stale.size(), grain, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t k = begin; k < end; ++k)
+                {
+                    const std::size_t first = stale[k] * blockCells;
+                    partials[stale[k]] = reduceBlock(first, std::min(blockCells, cells - first));
+                }
+            });
+            for (std::size_t b : stale) cache.valid[b] |= bit;
+        }
+
+        // Copy an h x w block between two row-major buffers with the given row strides.
+        // Trivially copyable cells go row-by-row through memcpy (one call when both
+        // blocks are contiguous); anything else uses element assignment. Passing a
+        // mutable source (Src = S) moves the cells instead.
+        template<typename S, typename Src>
+        void copyBlock(S* dst, std::size_t dstStride,
+                       Src* src, std::size_t srcStride,
+                       std::size_t h, std::size_t w)
+        {
+            static_assert(std::is_same_v<std::remove_const_t<Src>, S>, "copyBlock: cell type mismatch");
+
+            if (h == 0 || w == 0) return;
+
+            const bool contiguous = (w == dstStride && w == srcStride);
+            const std::size_t items = contiguous ? h * w : h;   // unit of work: cells or rows
+            const std::size_t unitBytes = (contiguous ? 1 : w) * sizeof(S);
+            const std::size_t grain = std::max<std::size_t>(1, kParallelCopyBytes / 4 / unitBytes);
+
+            auto run = [&](std::size_t begin, std::size_t end)
+            {
+                if (contiguous)
+                {
+                    if constexpr (std::is_trivially_copyable_v<S>)
+                        std::memcpy(dst + begin, src + begin, (end - begin) * sizeof(S));
+                    else if constexpr (!std::is_const_v<Src>)
+                        std::move(src + begin, src + end, dst + begin);
+                    else
+                        std::copy(src + begin, src + end, dst + begin);
+                    return;
+                }
+                for (std::size_t r = begin; r < end; ++r)
+                {
+                    S* d = dst + r * dstStride;
+                    Src* s = src + r * srcStride;
+                    if constexpr (std::is_trivially_copyable_v<S>)
+                        std::memcpy(d, s, w * sizeof(S));
+                    else if constexpr (!std::is_const_v<Src>)
+                        std::move(s, s + w, d);
+                    else
+                        std::copy(s, s + w, d);
+                }
+            };
+
+            if (h * w * sizeof(S) < kParallelCopyBytes)
+                run(0, items);
+            else
+                parallelFor(items, grain, run);
+        }
+    }
+
     template<typename T>
     std::size_t Matrix<T>::toIdx(std::uint32_t r, std::uint32_t c) const noexcept
     {
@@ -30,6 +137,7 @@ namespace bml
     template<typename T>
     MatrixIterator<T> Matrix<T>::begin(TraversalType t)
     {
+        markAllDirty();
         switch (t)
         {
         case TraversalType::Row:
@@ -66,6 +174,7 @@ namespace bml
     template<typename T>
     MatrixIterator<T> Matrix<T>::end(TraversalType t)
     {
+        markAllDirty();
         const long R   = static_cast<long>(numRows());
         const long C   = static_cast<long>(numCols());
         const long len = std::min(R, C);
@@ -175,16 +284,25 @@ namespace bml
 
     template<typename T>
     Matrix<T>::Matrix(std::uint32_t numRows, std::uint32_t numCols)
-        : rows(numRows), cols(numCols)
+        : data(static_cast<std::size_t>(numRows) * static_cast<std::size_t>(numCols)),
+          rows(numRows), cols(numCols)
+    {
+    }
+
+    template<typename T>
+    Matrix<T>::Matrix(std::uint32_t numRows, std::uint32_t numCols, SharedBuffer<storage_type> cells)
+        : data(std::move(cells)), rows(numRows), cols(numCols)
     {
-        data.resize(static_cast<std::size_t>(numRows)* static_cast<std::size_t>(numCols));
+        if (data.size() != static_cast<std::size_t>(numRows) * static_cast<std::size_t>(numCols))
+            throw std::invalid_argument("Matrix dimensions must match the adopted buffer size.");
     }
 
     template<class T>
     Matrix<T>::Matrix(Matrix<T>&& other) noexcept
         : data(std::move(other.data)),  // <-- rename to your vector member
           rows(other.rows),
-          cols(other.cols)
+          cols(other.cols),
+          reductionCache(std::move(other.reductionCache))
     {
         other.rows = other.cols = 0;
         other.data.clear();             // optional: make moved-from visibly empty
@@ -196,6 +314,7 @@ namespace bml
             data = std::move(other.data);   // <-- rename to your vector member
             rows = other.rows;
             cols = other.cols;
+            reductionCache = std::move(other.reductionCache);
             other.rows = other.cols = 0;
             other.data.clear();             // optional
         }
@@ -218,6 +337,7 @@ namespace bml
     template<typename T>
     RowView<T> Matrix<T>::operator[](std::uint32_t row)
     {
+        markRowsDirty(row, row + 1);
         return RowView<T>(data.data()+ toIdx(row, 0), cols);
     }
 
@@ -227,12 +347,27 @@ namespace bml
         return RowView<const T>(data.data()+ toIdx(row, 0), cols);
     }
 
+    template<typename T>
+    const typename Matrix<T>::storage_type* Matrix<T>::data_storage() const noexcept
+    {
+        return data.data();
+    }
+
+    template<typename T>
+    typename Matrix<T>::storage_type* Matrix<T>::data_storage()
+    {
+        return writableCells();
+    }
+
     template<typename T>
     void Matrix<T>::initFromByteStream(const std::uint8_t* byteStream, size_t byteSize)
     {
+        BML_PERF_SCOPE("initFromByteStream", T);
+        BML_TRACE_SCOPE("initFromByteStream", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         if (byteSize != (rows * cols)*sizeof(T))throw std::runtime_error("Invalid byte stream size");
 
-        std::memcpy(data.data(), byteStream, byteSize);
+        markAllDirty();
+        std::memcpy(data.dataForOverwrite(), byteStream, byteSize);
     }
     template<typename T>
     void Matrix<T>::initFromByteStream(const std::vector<std::uint8_t>& bytes)
@@ -245,6 +380,8 @@ namespace bml
     template<typename T>
     std::vector<uint8_t> Matrix<T>::toByteStream() const
     {
+        BML_PERF_SCOPE("toByteStream", T);
+        BML_TRACE_SCOPE("toByteStream", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         std::vector<uint8_t> byteStream(rows * cols * sizeof(T));
 
 
@@ -256,59 +393,44 @@ namespace bml
     template<>
     void Matrix<std::string>::initFromByteStream(const uint8_t* byteStream, size_t byteSize)
     {
-        //finding the stat locations in the stream
-        std::vector<size_t> startLocations;
-        startLocations.push_back(0);
-        for (size_t i = 0; i < byteSize; ++i)
-        {
-            if(byteStream[i] == 0) startLocations.push_back(i+1);
-        }
-        //check if the amount of strings is right
-        if((startLocations.size()-1) != rows * cols)throw std::runtime_error("Invalid byte stream size for Matrix<std::string>");
-        if(startLocations[startLocations.size()-1]-0 != byteSize)throw std::runtime_error("Invalid byte stream format for Matrix<std::string>, does not end with a null");
-
-        // setting the matrix strings
-        size_t counter = 0;
-        for (const auto& [row, col, _ ] : *this)
-        {
-            char* currentCStr = new char [startLocations[counter+1] - startLocations[counter]];
-            std::memcpy(currentCStr, byteStream + startLocations[counter], startLocations[counter+1] - startLocations[counter]);
-            try
-            {
-                (*this)[row][col] = std::string(currentCStr);
-            }
-            catch (const std::exception&)
-            {
-                delete[] currentCStr;
-                throw;
-            }
-            delete[] currentCStr;
-            counter++;
-        }
+        BML_PERF_SCOPE("initFromByteStream", std::string);
+        BML_TRACE_SCOPE("initFromByteStream", std::string, rows, cols, detail::traceBytes<std::string>(data.size(), 2));
+        // Validate the framing before touching any cell: one NUL per cell, last byte NUL.
+        const auto terminators = static_cast<std::size_t>(std::count(byteStream, byteStream + byteSize, std::uint8_t{0}));
+        if (terminators != size()) throw std::runtime_error("Invalid byte stream size for Matrix<std::string>");
+        if (byteSize != 0 && byteStream[byteSize - 1] != 0)
+            throw std::runtime_error("Invalid byte stream format for Matrix<std::string>, does not end with a null");
 
+        ByteStreamDecoder<std::string> decoder(*this);
+        decoder.feed(byteStream, byteSize);
     }
 
     template<>
     std::vector<uint8_t> Matrix<std::string>::toByteStream() const
     {
-        std::vector<uint8_t> result;
-
+        BML_PERF_SCOPE("toByteStream", std::string);
+        BML_TRACE_SCOPE("toByteStream", std::string, rows, cols, detail::traceBytes<std::string>(data.size(), 2));
+        std::size_t total = 0;
+        for (const std::string& cell : data) total += cell.size() + 1;
 
-        for (const auto& [r, c, cell] : *this)
+        std::vector<uint8_t> result(total);
+        std::uint8_t* out = result.data();
+        for (const std::string& cell : data)
         {
-            // append the string bytes
-            result.insert(result.end(), cell.begin(), cell.end());
-            // append NUL terminator so the parser can find the end
-            result.push_back('\0');
+            // string bytes followed by a NUL terminator so the parser can find the end
+            std::memcpy(out, cell.data(), cell.size());
+            out += cell.size();
+            *out++ = 0;
         }
-
         return result;
     }
+
     template<typename T>
     Matrix<T> Matrix<T>::copy(std::uint32_t startRow,
                               std::uint32_t startCol,
                               int endRow, int endCol) const
     {
+        BML_PERF_SCOPE("copy", T);
         if (endRow < -1)
             throw std::out_of_range("endRow < -1");
 
@@ -328,10 +450,13 @@ namespace bml
         if (startRow > rEnd)                throw std::out_of_range("startRow > endRow");
         if (startCol > cEnd)                throw std::out_of_range("startCol > endCol");
 
+        BML_TRACE_SCOPE("copy", T, rEnd - startRow, cEnd - startCol,
+                        detail::traceBytes<T>(std::size_t{rEnd - startRow} * (cEnd - startCol), 2));
         Matrix<T> out(rEnd - startRow, cEnd - startCol);
-        for (std::uint32_t i = startRow, r = 0; i < rEnd; ++i, ++r)
-            for (std::uint32_t j = startCol, c = 0; j < cEnd; ++j, ++c)
-                out[r][c] = (*this)[i][j];
+        if (out.data.empty()) return out;
+        detail::copyBlock(out.data.dataForOverwrite(), out.cols,
+                          data.data() + toIdx(startRow, startCol), cols,
+                          out.rows, out.cols);
         return out;
     }
 
@@ -339,6 +464,8 @@ namespace bml
     template<typename T>
     void Matrix<T>::paste(const Matrix& src, std::uint32_t destRow, std::uint32_t destCol)
     {
+        BML_PERF_SCOPE("paste", T);
+        BML_TRACE_SCOPE("paste", T, src.numRows(), src.numCols(), detail::traceBytes<T>(src.size(), 2));
         const std::uint32_t h = src.numRows();
         const std::uint32_t w = src.numCols();
 
@@ -350,25 +477,267 @@ namespace bml
         if (h > rows - destRow || w > cols - destCol)
             throw std::out_of_range("Invalid paste extent");
 
-        // Guard self-paste (same object) — make a temp copy once
-        if (&src == this)
+        // Self-paste: the bounds above force destRow == destCol == 0, i.e. the identity.
+        if (&src == this) return;
+
+        // If src shares our buffer, data() detaches us first; src keeps the old block alive.
+        markRowsDirty(destRow, destRow + h);
+        store_t* dst = data.data() + toIdx(destRow, destCol);
+        detail::copyBlock(dst, cols, src.data.data(), w, h, w);
+    }
+
+    template<typename T>
+    void Matrix<T>::paste(Matrix&& src, std::uint32_t destRow, std::uint32_t destCol)
+    {
+        // Moving cells out only pays off for non-trivial T and a buffer nobody else sees.
+        if (std::is_trivially_copyable_v<store_t> || src.data.shared() || &src == this)
         {
-            Matrix<T> tmp = src; // cheap for small, correct for all
-            for (std::uint32_t i = 0; i < h; ++i)
-                for (std::uint32_t j = 0; j < w; ++j)
-                    (*this)[destRow + i][destCol + j] = tmp[i][j];
+            paste(static_cast<const Matrix&>(src), destRow, destCol);
             return;
         }
+        BML_PERF_SCOPE("paste", T);
+        BML_TRACE_SCOPE("paste", T, src.numRows(), src.numCols(), detail::traceBytes<T>(src.size(), 2));
+
+        const std::uint32_t h = src.numRows();
+        const std::uint32_t w = src.numCols();
+
+        if (h == 0 || w == 0) return;
+
+        if (destRow > rows || destCol > cols)
+            throw std::out_of_range("Invalid paste start");
+        if (h > rows - destRow || w > cols - destCol)
+            throw std::out_of_range("Invalid paste extent");
+
+        markRowsDirty(destRow, destRow + h);
+        store_t* dst = data.data() + toIdx(destRow, destCol);
+        detail::copyBlock(dst, cols, src.data.data(), w, h, w);   // mutable source: cells are moved
+    }
+
+    // ======================= Changing the shape =======================
 
-        for (std::uint32_t i = 0; i < h; ++i)
-            for (std::uint32_t j = 0; j < w; ++j)
-                (*this)[destRow + i][destCol + j] = src[i][j];
+    template<typename T>
+    void Matrix<T>::shapeChanged()
+    {
+        if (const auto* cache = reductionCache.get())
+            reductionCache.reset(std::make_unique<detail::ReductionCache<T>>(cache->blockRows, rows));
+    }
+
+    template<typename T>
+    void Matrix<T>::growTo(std::size_t cells)
+    {
+        if (cells > data.capacity()) data.reserve(std::max(cells, data.capacity() * 2));
+        data.resize(cells);
+    }
+
+    template<typename T>
+    void Matrix<T>::reserve(std::uint32_t rowCapacity)
+    {
+        data.reserve(static_cast<std::size_t>(rowCapacity) * cols);
+    }
+
+    template<typename T>
+    std::uint32_t Matrix<T>::rowCapacity() const noexcept
+    {
+        return cols == 0 ? rows : static_cast<std::uint32_t>(data.capacity() / cols);
+    }
+
+    template<typename T>
+    void Matrix<T>::shrinkToFit()
+    {
+        if (data.capacity() == data.size()) return;
+        SharedBuffer<store_t> fitted(data.size());
+        const SharedBuffer<store_t>& cells = data;   // read without detaching
+        std::copy(cells.begin(), cells.end(), fitted.data());
+        data = std::move(fitted);
+    }
+
+    template<typename T>
+    void Matrix<T>::appendRow(const T* values, std::uint32_t count)
+    {
+        // A row of this matrix itself would move when the buffer grows.
+        const SharedBuffer<store_t>& cells = data;
+        const std::less<const void*> before;
+        if (cells.data() && !before(values, cells.data()) && before(values, cells.data() + cells.size()))
+        {
+            appendRow(std::vector<T>(values, values + count));
+            return;
+        }
+
+        if (rows == 0 && cols == 0) cols = count;
+        if (count != cols)
+            throw std::invalid_argument("Appended row must have numCols() values.");
+        if (rows == std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("Matrix row count overflow");
+
+        growTo(data.size() + cols);
+        store_t* dst = data.data() + toIdx(rows, 0);
+        for (std::uint32_t c = 0; c < count; ++c) dst[c] = static_cast<store_t>(values[c]);
+        ++rows;
+        shapeChanged();
+    }
+
+    template<typename T>
+    void Matrix<T>::appendRow(const std::vector<T>& values)
+    {
+        if (values.size() > std::numeric_limits<std::uint32_t>::max())
+            throw std::invalid_argument("Appended row must have numCols() values.");
+        const auto count = static_cast<std::uint32_t>(values.size());
+        if (rows == 0 && cols == 0) cols = count;
+        if (count != cols)
+            throw std::invalid_argument("Appended row must have numCols() values.");
+        if (rows == std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("Matrix row count overflow");
+
+        growTo(data.size() + cols);
+        store_t* dst = data.data() + toIdx(rows, 0);
+        for (std::uint32_t c = 0; c < count; ++c) dst[c] = static_cast<store_t>(values[c]);   // vector<bool> has no data()
+        ++rows;
+        shapeChanged();
+    }
+
+    template<typename T>
+    void Matrix<T>::appendRows(const Matrix& block)
+    {
+        insertRows(rows, block);
+    }
+
+    template<typename T>
+    void Matrix<T>::insertRows(std::uint32_t at, const Matrix& block)
+    {
+        BML_PERF_SCOPE("insertRows", T);
+        BML_TRACE_SCOPE("insertRows", T, block.rows, block.cols, detail::traceBytes<T>(block.size(), 2));
+        if (at > rows)
+            throw std::out_of_range("Invalid row index");
+        if (block.rows == 0) return;
+        if (rows == 0 && cols == 0) cols = block.cols;
+        if (block.cols != cols)
+            throw std::invalid_argument("Inserted rows must have numCols() columns.");
+        if (block.rows > std::numeric_limits<std::uint32_t>::max() - rows)
+            throw std::length_error("Matrix row count overflow");
+
+        // A block that is (or shares the buffer of) this matrix keeps its cells: growing detaches us.
+        const Matrix source(block);
+        const std::uint32_t h = source.rows;
+        growTo(data.size() + static_cast<std::size_t>(h) * cols);
+        store_t* base = data.data();
+        detail::moveCells(base + toIdx(at + h, 0), base + toIdx(at, 0), static_cast<std::size_t>(rows - at) * cols);
+        detail::copyBlock(base + toIdx(at, 0), cols, source.data.data(), cols, h, cols);
+        rows += h;
+        shapeChanged();
+    }
+
+    template<typename T>
+    void Matrix<T>::eraseRows(std::uint32_t first, std::uint32_t count)
+    {
+        BML_PERF_SCOPE("eraseRows", T);
+        BML_TRACE_SCOPE("eraseRows", T, rows, cols, detail::traceBytes<T>(static_cast<std::size_t>(rows - std::min(rows, first)) * cols, 2));
+        if (first > rows || count > rows - first)
+            throw std::out_of_range("Invalid row range");
+        if (count == 0) return;
+
+        store_t* base = data.data();
+        detail::moveCells(base + toIdx(first, 0), base + toIdx(first + count, 0),
+                          static_cast<std::size_t>(rows - first - count) * cols);
+        rows -= count;
+        data.resize(static_cast<std::size_t>(rows) * cols);
+        shapeChanged();
+    }
+
+    template<typename T>
+    void Matrix<T>::insertCols(std::uint32_t at, const Matrix& block)
+    {
+        BML_PERF_SCOPE("insertCols", T);
+        BML_TRACE_SCOPE("insertCols", T, block.rows, block.cols, detail::traceBytes<T>(size() + block.size(), 2));
+        if (at > cols)
+            throw std::out_of_range("Invalid column index");
+        if (block.cols == 0) return;
+        if (rows == 0 && cols == 0) rows = block.rows;
+        if (block.rows != rows)
+            throw std::invalid_argument("Inserted columns must have numRows() rows.");
+        if (block.cols > std::numeric_limits<std::uint32_t>::max() - cols)
+            throw std::length_error("Matrix column count overflow");
+
+        const Matrix source(block);
+        const std::uint32_t w = source.cols;
+        const std::size_t newCols = std::size_t{cols} + w;
+        growTo(rows * newCols);
+
+        // Last row first: every row moves to a higher offset, so nothing unread is overwritten.
+        store_t* base = data.data();
+        const store_t* src = source.data.data();
+        for (std::size_t r = rows; r-- > 0;)
+        {
+            store_t* row = base + r * newCols;
+            detail::moveCells(row + at + w, base + r * cols + at, cols - at);
+            detail::moveCells(row, base + r * cols, at);
+            std::copy(src + r * w, src + (r + 1) * w, row + at);
+        }
+        cols = static_cast<std::uint32_t>(newCols);
+        shapeChanged();
+    }
+
+    template<typename T>
+    void Matrix<T>::eraseCols(std::uint32_t first, std::uint32_t count)
+    {
+        BML_PERF_SCOPE("eraseCols", T);
+        BML_TRACE_SCOPE("eraseCols", T, rows, cols, detail::traceBytes<T>(size(), 2));
+        if (first > cols || count > cols - first)
+            throw std::out_of_range("Invalid column range");
+        if (count == 0) return;
+
+        // First row first: every row moves to a lower offset.
+        const std::size_t newCols = cols - count;
+        store_t* base = data.data();
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            store_t* row = base + r * newCols;
+            detail::moveCells(row, base + r * cols, first);
+            detail::moveCells(row + first, base + r * cols + first + count, cols - first - count);
+        }
+        data.resize(rows * newCols);
+        cols = static_cast<std::uint32_t>(newCols);
+        shapeChanged();
+    }
+
+    template<typename T>
+    void Matrix<T>::resize(std::uint32_t numRows, std::uint32_t numCols)
+    {
+        BML_PERF_SCOPE("resize", T);
+        BML_TRACE_SCOPE("resize", T, numRows, numCols, detail::traceBytes<T>(std::max<std::size_t>(size(), std::size_t{numRows} * numCols), 2));
+        if (numRows == rows && numCols == cols) return;
+
+        const std::size_t newCount = static_cast<std::size_t>(numRows) * numCols;
+        const std::size_t keepRows = std::min(rows, numRows);
+        const std::size_t keepCols = std::min(cols, numCols);
+        if (newCount > data.size()) growTo(newCount);
+        store_t* base = data.data();
+
+        // Narrower rows move down front to back, wider ones up back to front.
+        if (numCols <= cols)
+        {
+            for (std::size_t r = 0; r < keepRows; ++r) detail::moveCells(base + r * numCols, base + r * cols, keepCols);
+        }
+        else
+        {
+            for (std::size_t r = keepRows; r-- > 0;)
+            {
+                detail::moveCells(base + r * numCols, base + r * cols, keepCols);
+                std::fill(base + r * numCols + keepCols, base + (r + 1) * numCols, store_t{});
+            }
+        }
+        // Cells past the kept rows may hold moved-from or old values.
+        if (newCount > keepRows * numCols) std::fill(base + keepRows * numCols, base + newCount, store_t{});
+        data.resize(newCount);
+        rows = numRows;
+        cols = numCols;
+        shapeChanged();
     }
 
 
     template<typename T>
     bool Matrix<T>::all(std::function<bool(T)> condition) const
     {
+        BML_TRACE_SCOPE("all", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         for (const auto& element : data)
             if (!condition(element)) return false;
         return true;
@@ -377,6 +746,7 @@ namespace bml
     template<typename T>
     Matrix<T> Matrix<T>::where(std::function<bool(T)> condition, T trueValue, T falseValue) const
     {
+        BML_TRACE_SCOPE("where", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
         for (std::uint32_t i = 0; i < rows; ++i)
             for (std::uint32_t j = 0; j < cols; ++j)
@@ -387,19 +757,144 @@ namespace bml
     template<typename T>
     std::string Matrix<T>::toString() const
     {
+        BML_PERF_SCOPE("toString", T);
+        BML_TRACE_SCOPE("toString", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
+        TextFormat legacy;
+        legacy.trailingDelimiter = true;
+        return toString(legacy);
+    }
+
+    namespace detail
+    {
+        // Bytes buffered before a writer hands them to its sink.
+        constexpr std::size_t kTextChunkBytes = std::size_t{1} << 16;
+
+        constexpr int kMaxTextPrecision = 100;
+
+        template<typename T, typename S>
+        void appendCell(std::string& out, const S& v, int precision)
+        {
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                out.append(v);
+            }
+            else if constexpr (bml_is_bool<T>::value)
+            {
+                out.push_back(v ? '1' : '0');
+            }
+            else if constexpr (std::is_same_v<T, char>)
+            {
+                out.push_back(v);
+            }
+            else
+            {
+                // Longest cell: kMaxTextPrecision digits plus sign, point and exponent.
+                char cell[kMaxTextPrecision + 32];
+                std::to_chars_result r;
+                if constexpr (std::is_floating_point_v<T>)
+                {
+                    if (precision == TextFormat::kShortest)
+                        r = std::to_chars(cell, cell + sizeof cell, v);
+                    else
+                        r = std::to_chars(cell, cell + sizeof cell, v, std::chars_format::general, precision);
+                }
+                else
+                {
+                    (void)precision;
+                    r = std::to_chars(cell, cell + sizeof cell, v);
+                }
+                out.append(cell, r.ptr);
+            }
+        }
 
-        std::stringstream ss;
-        for(std::uint32_t row = 0; row < rows; row++)
+        // Format rows [r0, r1) onto out. With a sink, out is drained every kTextChunkBytes.
+        template<typename T, typename S>
+        void appendRows(std::string& out, const S* cells, std::uint32_t cols,
+                        std::uint32_t r0, std::uint32_t r1, const TextFormat& format, ByteSink* sink)
         {
-            for(std::uint32_t col = 0; col < cols; col++)
+            for (std::uint32_t r = r0; r < r1; ++r)
             {
-                ss << (*this)[row][col];
-                ss << " ";
+                const S* row = cells + static_cast<std::size_t>(r) * cols;
+                for (std::uint32_t c = 0; c < cols; ++c)
+                {
+                    appendCell<T>(out, row[c], format.precision);
+                    if (c + 1 < cols || format.trailingDelimiter) out.push_back(format.delimiter);
+                }
+                out.push_back(format.lineEnd);
 
+                if (sink && out.size() >= kTextChunkBytes)
+                {
+                    sink->write(out.data(), out.size());
+                    out.clear();
+                }
             }
-            ss << "\n";
         }
-        return ss.str();
+
+        inline void checkTextFormat(const TextFormat& format)
+        {
+            if (format.precision != TextFormat::kShortest
+                && (format.precision < 0 || format.precision > kMaxTextPrecision))
+                throw std::invalid_argument("TextFormat precision must be kShortest or in [0, 100].");
+        }
+    }
+
+    template<typename T>
+    std::string Matrix<T>::toString(const TextFormat& format) const
+    {
+        std::string out;
+        StringSink sink(out);
+        writeText(sink, format);
+        return out;
+    }
+
+    template<typename T>
+    void Matrix<T>::writeText(ByteSink& sink, const TextFormat& format) const
+    {
+        BML_PERF_SCOPE("writeText", T);
+        BML_TRACE_SCOPE("writeText", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
+        detail::checkTextFormat(format);
+
+        const store_t* cells = data.data();
+        const std::size_t threads = parallelism();
+        // Small or single-threaded: one pass through a single chunk buffer.
+        if (threads <= 1 || size() * 8 < detail::kTextChunkBytes * 4 || rows < 2)
+        {
+            std::string chunk;
+            chunk.reserve(detail::kTextChunkBytes + 256);
+            detail::appendRows<T>(chunk, cells, cols, 0, rows, format, &sink);
+            if (!chunk.empty()) sink.write(chunk.data(), chunk.size());
+            return;
+        }
+
+        // Rows are formatted in rounds: each round gives every task a row slice of
+        // about four chunks, formats the slices in parallel, then writes them in order.
+        // Memory stays bounded by one round regardless of the matrix size.
+        const std::size_t rowBytesGuess = std::max<std::size_t>(1, std::size_t{cols} * 8);
+        const std::uint32_t rowsPerTask = static_cast<std::uint32_t>(
+            std::clamp<std::size_t>(4 * detail::kTextChunkBytes / rowBytesGuess, 1, rows));
+        const std::size_t tasksPerRound = threads * 2;
+
+        std::vector<std::string> pieces(tasksPerRound);
+        for (std::uint32_t roundStart = 0; roundStart < rows; )
+        {
+            const std::size_t remaining = rows - roundStart;
+            const std::size_t tasks = std::min(tasksPerRound, (remaining + rowsPerTask - 1) / rowsPerTask);
+
+            parallelFor(tasks, 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t t = begin; t < end; ++t)
+                {
+                    const auto r0 = static_cast<std::uint32_t>(roundStart + t * rowsPerTask);
+                    const auto r1 = static_cast<std::uint32_t>(std::min<std::size_t>(rows, std::size_t{r0} + rowsPerTask));
+                    pieces[t].clear();
+                    detail::appendRows<T>(pieces[t], cells, cols, r0, r1, format, nullptr);
+                }
+            });
+
+            for (std::size_t t = 0; t < tasks; ++t)
+                sink.write(pieces[t].data(), pieces[t].size());
+
+            roundStart = static_cast<std::uint32_t>(std::min<std::size_t>(rows, roundStart + tasks * rowsPerTask));
+        }
     }
     template<typename T>
     std::vector<T> Matrix<T>::getRow(std::uint32_t row, int startCol, int endCol) const
@@ -412,6 +907,7 @@ namespace bml
         const auto s = static_cast<std::uint32_t>(startCol);
         const auto e = static_cast<std::uint32_t>(endCol);
         if (s > e || e > cols) throw std::out_of_range("Invalid column slice indices");
+        BML_TRACE_SCOPE("getRow", T, rows, cols, detail::traceBytes<T>(e - s, 2));
 
         const T* first = data.data() + toIdx(row, s);
         const T* last  = data.data() + toIdx(row, e);
@@ -433,6 +929,7 @@ namespace bml
         const auto e = static_cast<std::uint32_t>(endCol);
         if (s > e || e > cols)
             throw std::out_of_range("Invalid column slice indices");
+        BML_TRACE_SCOPE("getRow", bool, rows, cols, detail::traceBytes<bool>(e - s, 2));
 
         std::vector<bool> out;
         out.reserve(static_cast<std::size_t>(e - s));
@@ -461,6 +958,7 @@ namespace bml
 
         if (s > e || e > static_cast<std::uint32_t>(rows))
             throw std::out_of_range("Invalid row slice indices");
+        BML_TRACE_SCOPE("getColumn", T, rows, cols, detail::traceBytes<T>(e - s, 2));
 
         std::vector<T> result;
         result.reserve(static_cast<size_t>(e - s));
@@ -485,6 +983,7 @@ namespace bml
 
         if (s > e || e > limit)
             throw std::out_of_range("Invalid diagonal indices");
+        BML_TRACE_SCOPE("getDiagonal", T, rows, cols, detail::traceBytes<T>(e - s, 2));
 
         std::vector<T> result;
         result.reserve(static_cast<size_t>(e - s));
@@ -510,6 +1009,7 @@ namespace bml
 
         if (s > e || e > limit)
             throw std::out_of_range("Invalid anti-diagonal indices");
+        BML_TRACE_SCOPE("getAntiDiagonal", T, rows, cols, detail::traceBytes<T>(e - s, 2));
 
         // Empty matrix or zero-width => empty result
         if (cols == 0 || rows == 0 || s == e)
@@ -531,16 +1031,20 @@ namespace bml
     template<typename T>
     void Matrix<T>::fill(const T& value)
     {
-
-        for (T& cell : data)
-            cell = value;
+        BML_PERF_SCOPE("fill", T);
+        BML_TRACE_SCOPE("fill", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
+        markAllDirty();
+        T* cells = data.dataForOverwrite();
+        std::fill(cells, cells + data.size(), value);
     }
     template<>
     void Matrix<bool>::fill(const bool& value)
     {
-
-        for (uint8_t& cell : data)
-            cell = value;
+        BML_PERF_SCOPE("fill", bool);
+        BML_TRACE_SCOPE("fill", bool, rows, cols, detail::traceBytes<bool>(data.size(), 1));
+        markAllDirty();
+        std::uint8_t* cells = data.dataForOverwrite();
+        std::fill(cells, cells + data.size(), static_cast<std::uint8_t>(value ? 1 : 0));
     }
 
     // ======================= Arithmetic (with refined SFINAE) =======================
@@ -551,13 +1055,16 @@ namespace bml
     typename std::enable_if<bml_is_math_arithmetic<U>::value, Matrix<T>>::type
             Matrix<T>::operator+(const Matrix<T>& other) const
     {
+        BML_PERF_SCOPE("operator+", T);
+        BML_TRACE_SCOPE("operator+", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match for addition.");
 
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data.data()[i] = data.data()[i] + other.data.data()[i];
+            out[i] = data[i] + other.data[i];
         }
         return result;
     }
@@ -568,14 +1075,17 @@ namespace bml
     typename std::enable_if<bml_is_math_arithmetic<U>::value, Matrix<T>>::type
             Matrix<T>::operator-(const Matrix<T>& other) const
     {
+        BML_PERF_SCOPE("operator-", T);
+        BML_TRACE_SCOPE("operator-", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match for subtraction.");
 
 
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data.data()[i] = data.data()[i] - other.data.data()[i];
+            out[i] = data[i] - other.data[i];
         }
         return result;
     }
@@ -586,14 +1096,17 @@ namespace bml
     typename std::enable_if<bml_is_math_arithmetic<U>::value, Matrix<T>>::type
             Matrix<T>::operator*(const Matrix<T>& other) const
     {
+        BML_PERF_SCOPE("operator*", T);
+        BML_TRACE_SCOPE("operator*", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match for multiplication.");
 
 
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data.data()[i] = data.data()[i] * other.data.data()[i];
+            out[i] = data[i] * other.data[i];
         }
         return result;
     }
@@ -604,17 +1117,20 @@ namespace bml
     typename std::enable_if<bml_is_math_arithmetic<U>::value, Matrix<T>>::type
             Matrix<T>::operator/(const Matrix<T>& other) const
     {
+        BML_PERF_SCOPE("operator/", T);
+        BML_TRACE_SCOPE("operator/", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match for division.");
 
 
 
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            if (other.data.data()[i] == 0)
+            if (other.data[i] == 0)
                 throw std::runtime_error("Division by zero encountered.");
-            result.data.data()[i] = data.data()[i] / other.data.data()[i];
+            out[i] = data[i] / other.data[i];
         }
         return result;
     }
@@ -625,14 +1141,17 @@ namespace bml
     typename std::enable_if<bml_is_math_integral<U>::value, Matrix<T>>::type
             Matrix<T>::operator%(const Matrix<T>& other) const
     {
+        BML_PERF_SCOPE("operator%", T);
+        BML_TRACE_SCOPE("operator%", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match for modulus.");
 
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
             if (other.data[i] == 0) throw std::runtime_error("Modulus by zero encountered.");
-            result.data.data()[i] = data.data()[i] % other.data.data()[i];
+            out[i] = data[i] % other.data[i];
         }
 
         return result;
@@ -644,10 +1163,13 @@ namespace bml
     typename std::enable_if<bml_is_math_arithmetic<U>::value, Matrix<T>>::type
             Matrix<T>::operator+(const T& scalar) const
     {
+        BML_PERF_SCOPE("operator+", T);
+        BML_TRACE_SCOPE("operator+", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data.data()[i] = data.data()[i] + scalar;
+            out[i] = data[i] + scalar;
         }
         return result;
     }
@@ -658,10 +1180,13 @@ namespace bml
     typename std::enable_if<bml_is_math_arithmetic<U>::value, Matrix<T>>::type
             Matrix<T>::operator-(const T& scalar) const
     {
+        BML_PERF_SCOPE("operator-", T);
+        BML_TRACE_SCOPE("operator-", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data.data()[i] = data.data()[i] - scalar;
+            out[i] = data[i] - scalar;
         }
         return result;
     }
@@ -672,11 +1197,14 @@ namespace bml
     typename std::enable_if<bml_is_math_arithmetic<U>::value, Matrix<T>>::type
             Matrix<T>::operator*(const T& scalar) const
     {
+        BML_PERF_SCOPE("operator*", T);
+        BML_TRACE_SCOPE("operator*", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
 
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data.data()[i] = data.data()[i] * scalar;
+            out[i] = data[i] * scalar;
         }
         return result;
     }
@@ -687,13 +1215,16 @@ namespace bml
     typename std::enable_if<bml_is_math_arithmetic<U>::value, Matrix<T>>::type
             Matrix<T>::operator/(const T& scalar) const
     {
+        BML_PERF_SCOPE("operator/", T);
+        BML_TRACE_SCOPE("operator/", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         if (scalar == 0)
             throw std::runtime_error("Division by zero encountered.");
 
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data.data()[i] = data.data()[i] / scalar;
+            out[i] = data[i] / scalar;
         }
         return result;
 
@@ -705,29 +1236,89 @@ namespace bml
     typename std::enable_if<bml_is_math_integral<U>::value, Matrix<T>>::type
             Matrix<T>::operator%(const T& scalar) const
     {
+        BML_PERF_SCOPE("operator%", T);
+        BML_TRACE_SCOPE("operator%", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         if (scalar == 0)
             throw std::runtime_error("Modulus by zero encountered.");
 
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data.data()[i] = data.data()[i] % scalar;
+            out[i] = data[i] % scalar;
         }
         return result;
     }
 
     // ======================= Comparisons =======================
 
+    namespace detail
+    {
+        // Cells per block for the comparison scans: long enough to vectorise,
+        // short enough that a mismatch near the front stops the scan early.
+        constexpr std::size_t kCompareBlock = 256;
+
+        template<typename T, typename S>
+        bool cellsEqual(const S& a, const S& b)
+        {
+            if constexpr (bml_is_bool<T>::value)
+                return (a != 0) == (b != 0);
+            else
+                return a == b;
+        }
+
+        // Index of the first cell where lhs and rhs differ (by T's ==), or n if none.
+        template<typename T, typename S>
+        std::size_t firstMismatch(const S* a, const S* b, std::size_t n)
+        {
+            constexpr bool bytewise = std::is_integral_v<S> && !bml_is_bool<T>::value;
+
+            std::size_t base = 0;
+            for (; base < n; base += kCompareBlock)
+            {
+                const std::size_t len = std::min(kCompareBlock, n - base);
+                bool same;
+                if constexpr (bytewise)
+                {
+                    same = std::memcmp(a + base, b + base, len * sizeof(S)) == 0;
+                }
+                else if constexpr (std::is_arithmetic_v<S>)
+                {
+                    // Branch-free AND over the block; NaN != NaN and -0.0 == 0.0 come from ==.
+                    same = true;
+                    for (std::size_t i = 0; i < len; ++i)
+                        same &= cellsEqual<T>(a[base + i], b[base + i]);
+                }
+                else
+                {
+                    same = std::equal(a + base, a + base + len, b + base);
+                }
+                if (!same) break;
+            }
+            if (base >= n) return n;
+
+            const std::size_t end = std::min(n, base + kCompareBlock);
+            for (std::size_t i = base; i < end; ++i)
+                if (!cellsEqual<T>(a[i], b[i])) return i;
+            return n;
+        }
+    }
+
     // Equality
     template<typename T>
     bool operator==(const Matrix<T>& lhs, const Matrix<T>& rhs)
     {
+        BML_PERF_SCOPE("operator==", T);
+        BML_TRACE_SCOPE("operator==", T, lhs.numRows(), lhs.numCols(), detail::traceBytes<T>(lhs.size(), 2));
         if (lhs.numRows() != rhs.numRows() || lhs.numCols() != rhs.numCols())
             return false;
-        for (std::uint32_t i = 0; i < lhs.numRows(); ++i)
-            for (std::uint32_t j = 0; j < lhs.numCols(); ++j)
-                if (lhs[i][j] != rhs[i][j]) return false;
-        return true;
+        if (lhs.sharesStorageWith(rhs))
+        {
+            // Same cells; only NaN can make a float matrix unequal to itself.
+            if constexpr (!std::is_floating_point_v<T>) return true;
+        }
+        const std::size_t n = lhs.size();
+        return detail::firstMismatch<T>(lhs.data_storage(), rhs.data_storage(), n) == n;
     }
 
     // Inequality
@@ -741,15 +1332,22 @@ namespace bml
     template<typename T, typename Enable>
     bool operator<(const Matrix<T>& lhs, const Matrix<T>& rhs)
     {
+        BML_PERF_SCOPE("operator<", T);
+        BML_TRACE_SCOPE("operator<", T, lhs.numRows(), lhs.numCols(), detail::traceBytes<T>(lhs.size(), 2));
         if (lhs.numRows() != rhs.numRows())
             return lhs.numRows() < rhs.numRows();
         if (lhs.numCols() != rhs.numCols())
             return lhs.numCols() < rhs.numCols();
-        for (std::uint32_t i = 0; i < lhs.numRows(); ++i)
-            for (std::uint32_t j = 0; j < lhs.numCols(); ++j)
-                if (lhs[i][j] != rhs[i][j])
-                    return lhs[i][j] < rhs[i][j];
-        return false; // equal
+
+        const std::size_t n = lhs.size();
+        const auto* a = lhs.data_storage();
+        const auto* b = rhs.data_storage();
+        const std::size_t i = detail::firstMismatch<T>(a, b, n);
+        if (i == n) return false; // equal
+        if constexpr (bml_is_bool<T>::value)
+            return (a[i] != 0) < (b[i] != 0);
+        else
+            return a[i] < b[i];
     }
 
     template<typename T, typename Enable>
@@ -777,8 +1375,30 @@ namespace bml
     std::enable_if_t<std::is_floating_point<U>::value, T>
     Matrix<T>::sum() const
     {
+        BML_PERF_SCOPE("sum", T);
+        BML_TRACE_SCOPE("sum", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         if (data.empty()) return T{0}; // policy: 0 for empty
 
+        auto kahan = [](const store_t* cells, std::size_t n) {
+            T s = T{0};
+            T c = T{0};
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                T y = static_cast<T>(cells[i]) - c;
+                T t = s + y;
+                c = (t - s) - y;
+                s = t;
+            }
+            return s;
+        };
+        if (auto* cache = reductionCache.get())
+        {
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            detail::refreshPartials(*cache, detail::kCachedSum, cols, data.size(), cache->sums,
+                                    [&](std::size_t first, std::size_t n) { return kahan(data.data() + first, n); });
+            return kahan(cache->sums.data(), cache->sums.size());
+        }
+
         T s = T{0};
         T c = T{0};
 
@@ -798,8 +1418,22 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value && !std::is_floating_point<U>::value, T>
     Matrix<T>::sum() const
     {
+        BML_PERF_SCOPE("sum", T);
+        BML_TRACE_SCOPE("sum", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         if (data.empty()) return T{0}; // policy: 0 for empty
 
+        if (auto* cache = reductionCache.get())
+        {
+            auto add = [](const store_t* cells, std::size_t n) {
+                T total = T{0};
+                for (std::size_t i = 0; i < n; ++i) total += static_cast<T>(cells[i]);
+                return total;
+            };
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            detail::refreshPartials(*cache, detail::kCachedSum, cols, data.size(), cache->sums,
+                                    [&](std::size_t first, std::size_t n) { return add(data.data() + first, n); });
+            return add(cache->sums.data(), cache->sums.size());
+        }
 
         T sumValue = T{0};
         for (const store_t& cell : data)
@@ -815,8 +1449,24 @@ namespace bml
     typename std::enable_if<!std::is_pointer<U>::value, T>::type
     Matrix<T>::min() const
     {
+        BML_PERF_SCOPE("min", T);
+        BML_TRACE_SCOPE("min", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         if (data.empty())
             throw std::runtime_error("Matrix::min() on empty matrix");
+        if (auto* cache = reductionCache.get())
+        {
+            // Each block starts from its first cell, so the combined result equals the plain scan's.
+            auto smallest = [](const store_t* cells, std::size_t n) {
+                store_t m = cells[0];
+                for (std::size_t i = 1; i < n; ++i)
+                    if (cells[i] < m) m = cells[i];
+                return m;
+            };
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            detail::refreshPartials(*cache, detail::kCachedMin, cols, data.size(), cache->mins,
+                                    [&](std::size_t first, std::size_t n) { return smallest(data.data() + first, n); });
+            return static_cast<T>(smallest(cache->mins.data(), cache->mins.size()));
+        }
         T minimalValue = data[0];
         for(auto& cell: data)
         {
@@ -830,8 +1480,23 @@ namespace bml
     typename std::enable_if<!std::is_pointer<U>::value, T>::type
     Matrix<T>::max() const
     {
+        BML_PERF_SCOPE("max", T);
+        BML_TRACE_SCOPE("max", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         if (data.empty())
             throw std::runtime_error("Matrix::min() on empty matrix");
+        if (auto* cache = reductionCache.get())
+        {
+            auto largest = [](const store_t* cells, std::size_t n) {
+                store_t m = cells[0];
+                for (std::size_t i = 1; i < n; ++i)
+                    if (cells[i] > m) m = cells[i];
+                return m;
+            };
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            detail::refreshPartials(*cache, detail::kCachedMax, cols, data.size(), cache->maxs,
+                                    [&](std::size_t first, std::size_t n) { return largest(data.data() + first, n); });
+            return static_cast<T>(largest(cache->maxs.data(), cache->maxs.size()));
+        }
         T maxValue = data[0];
         for(auto& cell: data)
         {
@@ -843,6 +1508,7 @@ namespace bml
     template<typename T>
     bool Matrix<T>::any_of(std::function<bool(T)> p) const
     {
+        BML_TRACE_SCOPE("any_of", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         for (const store_t& cell : data)
         {
             if (p(static_cast<T>(cell))) return true;
@@ -853,6 +1519,7 @@ namespace bml
     template<typename T>
     bool Matrix<T>::none_of(std::function<bool(T)> p) const
     {
+        BML_TRACE_SCOPE("none_of", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         for (const store_t& cell : data)
         {
             if (p(static_cast<T>(cell))) return false;
@@ -866,6 +1533,25 @@ namespace bml
         return static_cast<size_t>(rows) * static_cast<size_t>(cols);
     }
 
+    template<typename T>
+    std::size_t Matrix<T>::memoryUsage() const noexcept
+    {
+        std::size_t bytes = sizeof(*this) + data.capacity() * sizeof(store_t);
+        if (const auto* cache = reductionCache.get()) bytes += cache->bytes();
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            for (const std::string& cell : data)
+            {
+                // Payloads inside the object itself (small-string optimisation) cost nothing extra.
+                const char* object = reinterpret_cast<const char*>(&cell);
+                const bool small = !std::less<const char*>()(cell.data(), object)
+                                     && std::less<const char*>()(cell.data(), object + sizeof(cell));
+                if (!small) bytes += cell.capacity() + 1;
+            }
+        }
+        return bytes;
+    }
+
     template<typename T>
     bool Matrix<T>::empty() const noexcept
     {
@@ -873,6 +1559,57 @@ namespace bml
         return rows == 0u || cols == 0u;
     }
 
+    template<typename T>
+    bool Matrix<T>::sharesStorageWith(const Matrix& other) const noexcept
+    {
+        return data.sameBlock(other.data);
+    }
+
+    // ---------- incremental reductions ----------
+
+    template<typename T>
+    void Matrix<T>::enableReductionCache(std::uint32_t blockRows)
+    {
+        if (blockRows == 0)
+        {
+            const std::size_t rowBytes = std::max<std::size_t>(1, std::size_t{cols} * sizeof(store_t));
+            blockRows = static_cast<std::uint32_t>(std::clamp<std::size_t>(detail::kReductionBlockBytes / rowBytes, 1,
+                                                                            std::max<std::uint32_t>(rows, 1)));
+        }
+        reductionCache.reset(std::make_unique<detail::ReductionCache<T>>(blockRows, rows));
+    }
+
+    template<typename T>
+    void Matrix<T>::disableReductionCache() noexcept
+    {
+        reductionCache.reset();
+    }
+
+    template<typename T>
+    bool Matrix<T>::reductionCacheEnabled() const noexcept
+    {
+        return reductionCache.get() != nullptr;
+    }
+
+    template<typename T>
+    void Matrix<T>::markRowsDirty(std::uint32_t first, std::uint32_t last) noexcept
+    {
+        if (auto* cache = reductionCache.get()) cache->markRows(first, last);
+    }
+
+    template<typename T>
+    void Matrix<T>::markAllDirty() noexcept
+    {
+        if (auto* cache = reductionCache.get()) cache->markAll();
+    }
+
+    template<typename T>
+    typename Matrix<T>::store_t* Matrix<T>::writableCells()
+    {
+        markAllDirty();
+        return data.data();
+    }
+
     // ---------- argmin / argmax ----------
 
     template<typename T>
@@ -881,6 +1618,8 @@ namespace bml
         std::pair<std::uint32_t, std::uint32_t>>
         Matrix<T>::argmin() const
     {
+        BML_PERF_SCOPE("argmin", T);
+        BML_TRACE_SCOPE("argmin", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         if (data.empty())
             throw std::runtime_error("Matrix::argmin() on empty matrix");
 
@@ -907,6 +1646,8 @@ namespace bml
         std::pair<std::uint32_t, std::uint32_t>>
         Matrix<T>::argmax() const
     {
+        BML_PERF_SCOPE("argmax", T);
+        BML_TRACE_SCOPE("argmax", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
         if (data.empty())
             throw std::runtime_error("Matrix::argmax() on empty matrix");
 
@@ -933,11 +1674,14 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value, Matrix<T>&>
     Matrix<T>::operator+=(const Matrix& other)
     {
+        BML_PERF_SCOPE("operator+=", T);
+        BML_TRACE_SCOPE("operator+=", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match.");
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
-            data[i] += other.data[i];
+            dst[i] += other.data[i];
         }
         return *this;
     }
@@ -946,11 +1690,14 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value, Matrix<T>&>
     Matrix<T>::operator-=(const Matrix& other)
     {
+        BML_PERF_SCOPE("operator-=", T);
+        BML_TRACE_SCOPE("operator-=", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match.");
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
-            data[i] -= other.data[i];
+            dst[i] -= other.data[i];
         }
         return *this;
     }
@@ -959,11 +1706,14 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value, Matrix<T>&>
     Matrix<T>::operator*=(const Matrix& other)
     {
+        BML_PERF_SCOPE("operator*=", T);
+        BML_TRACE_SCOPE("operator*=", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match.");
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
-            data[i] *= other.data[i];
+            dst[i] *= other.data[i];
         }
         return *this;
     }
@@ -972,12 +1722,15 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value, Matrix<T>&>
     Matrix<T>::operator/=(const Matrix& other)
     {
+        BML_PERF_SCOPE("operator/=", T);
+        BML_TRACE_SCOPE("operator/=", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match.");
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
             if (other.data[i] == 0) throw std::runtime_error("Division by zero encountered.");
-            data[i] /= other.data[i];
+            dst[i] /= other.data[i];
         }
         return *this;
     }
@@ -986,12 +1739,15 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator%=(const Matrix& other)
     {
+        BML_PERF_SCOPE("operator%=", T);
+        BML_TRACE_SCOPE("operator%=", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match.");
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
             if (other.data[i] == 0) throw std::runtime_error("Modulus by zero encountered.");
-            data[i] %= other.data[i];
+            dst[i] %= other.data[i];
         }
         return *this;
     }
@@ -1001,9 +1757,12 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value, Matrix<T>&>
     Matrix<T>::operator+=(const T& s)
     {
+        BML_PERF_SCOPE("operator+=", T);
+        BML_TRACE_SCOPE("operator+=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
-            data[i] += s;
+            dst[i] += s;
         }
         return *this;
     }
@@ -1012,9 +1771,12 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value, Matrix<T>&>
     Matrix<T>::operator-=(const T& s)
     {
+        BML_PERF_SCOPE("operator-=", T);
+        BML_TRACE_SCOPE("operator-=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
-            data[i] -= s;
+            dst[i] -= s;
         }
         return *this;
     }
@@ -1023,9 +1785,12 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value, Matrix<T>&>
     Matrix<T>::operator*=(const T& s)
     {
+        BML_PERF_SCOPE("operator*=", T);
+        BML_TRACE_SCOPE("operator*=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
-            data[i] *= s;
+            dst[i] *= s;
         }
         return *this;
     }
@@ -1034,11 +1799,14 @@ namespace bml
     std::enable_if_t<bml_is_math_arithmetic<U>::value, Matrix<T>&>
     Matrix<T>::operator/=(const T& s)
     {
+        BML_PERF_SCOPE("operator/=", T);
+        BML_TRACE_SCOPE("operator/=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         if (s == 0)
             throw std::runtime_error("Division by zero encountered.");
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
-            data[i] /= s;
+            dst[i] /= s;
         }
         return *this;
     }
@@ -1047,11 +1815,14 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator%=(const T& s)
     {
+        BML_PERF_SCOPE("operator%=", T);
+        BML_TRACE_SCOPE("operator%=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         if (s == 0)
             throw std::runtime_error("Modulus by zero encountered.");
+        store_t* dst = writableCells();
         for(size_t i = 0; i < data.size(); i++)
         {
-            data[i] %= s;
+            dst[i] %= s;
         }
         return *this;
     }
@@ -1061,10 +1832,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator&(const Matrix& other) const
     {
+        BML_PERF_SCOPE("operator&", T);
+        BML_TRACE_SCOPE("operator&", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] & other.data[i];
+            out[i] = data[i] & other.data[i];
         }
         return result;
     }
@@ -1073,10 +1847,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator|(const Matrix& other) const
     {
+        BML_PERF_SCOPE("operator|", T);
+        BML_TRACE_SCOPE("operator|", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] | other.data[i];
+            out[i] = data[i] | other.data[i];
         }
         return result;
     }
@@ -1085,10 +1862,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator^(const Matrix& other) const
     {
+        BML_PERF_SCOPE("operator^", T);
+        BML_TRACE_SCOPE("operator^", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] ^ other.data[i];
+            out[i] = data[i] ^ other.data[i];
         }
         return result;
     }
@@ -1099,10 +1879,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator&(const T& s) const
     {
+        BML_PERF_SCOPE("operator&", T);
+        BML_TRACE_SCOPE("operator&", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] & s;
+            out[i] = data[i] & s;
         }
         return result;
     }
@@ -1111,10 +1894,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator|(const T& s) const
     {
+        BML_PERF_SCOPE("operator|", T);
+        BML_TRACE_SCOPE("operator|", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] | s;
+            out[i] = data[i] | s;
         }
         return result;
     }
@@ -1123,10 +1909,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator^(const T& s) const
     {
+        BML_PERF_SCOPE("operator^", T);
+        BML_TRACE_SCOPE("operator^", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] ^ s;
+            out[i] = data[i] ^ s;
         }
         return result;
     }
@@ -1136,11 +1925,14 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator&=(const Matrix& other)
     {
+        BML_PERF_SCOPE("operator&=", T);
+        BML_TRACE_SCOPE("operator&=", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match.");
 
+        store_t* dst = writableCells();
         for (size_t i = 0; i < data.size(); ++i)
-            data[i] &= other.data[i];
+            dst[i] &= other.data[i];
 
         return *this;
     }
@@ -1149,11 +1941,14 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator|=(const Matrix& other)
     {
+        BML_PERF_SCOPE("operator|=", T);
+        BML_TRACE_SCOPE("operator|=", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match.");
 
+        store_t* dst = writableCells();
         for (size_t i = 0; i < data.size(); ++i)
-            data[i] |= other.data[i];
+            dst[i] |= other.data[i];
 
         return *this;
     }
@@ -1163,11 +1958,14 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator^=(const Matrix& other)
     {
+        BML_PERF_SCOPE("operator^=", T);
+        BML_TRACE_SCOPE("operator^=", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         if (rows != other.rows || cols != other.cols)
             throw std::invalid_argument("Matrix dimensions must match.");
 
+        store_t* dst = writableCells();
         for (size_t i = 0; i < data.size(); ++i)
-            data[i] ^= other.data[i];
+            dst[i] ^= other.data[i];
 
         return *this;
     }
@@ -1177,10 +1975,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator&=(const T& s)
     {
+        BML_PERF_SCOPE("operator&=", T);
+        BML_TRACE_SCOPE("operator&=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
 
 
+        store_t* dst = writableCells();
         for (size_t i = 0; i < data.size(); ++i)
-            data[i] &= s;
+            dst[i] &= s;
 
         return *this;
     }
@@ -1189,10 +1990,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator|=(const T& s)
     {
+        BML_PERF_SCOPE("operator|=", T);
+        BML_TRACE_SCOPE("operator|=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
 
 
+        store_t* dst = writableCells();
         for (size_t i = 0; i < data.size(); ++i)
-            data[i] |= s;
+            dst[i] |= s;
 
         return *this;
     }
@@ -1201,10 +2005,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator^=(const T& s)
     {
+        BML_PERF_SCOPE("operator^=", T);
+        BML_TRACE_SCOPE("operator^=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
 
 
+        store_t* dst = writableCells();
         for (size_t i = 0; i < data.size(); ++i)
-            data[i] ^= s;
+            dst[i] ^= s;
 
         return *this;
     }
@@ -1214,10 +2021,13 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator~() const
     {
+        BML_PERF_SCOPE("operator~", T);
+        BML_TRACE_SCOPE("operator~", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for (size_t i = 0; i < data.size(); ++i)
         {
-            result.data[i] = static_cast<T>(~data[i]);
+            out[i] = static_cast<T>(~data[i]);
         }
         return result;
     }
@@ -1228,6 +2038,8 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator<<(int k) const
     {
+        BML_PERF_SCOPE("operator<<", T);
+        BML_TRACE_SCOPE("operator<<", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         using Uns = std::make_unsigned_t<U>;
         Matrix<T> out(rows, cols);
 
@@ -1239,6 +2051,7 @@ namespace bml
         }
 
         const auto w = static_cast<unsigned>(std::numeric_limits<Uns>::digits);
+        store_t* dst = out.data.data();
 
         if (k < 0)
         {
@@ -1247,7 +2060,7 @@ namespace bml
             {
                 Uns u = static_cast<Uns>(data[i]);
                 u >>= s; // logical right shift
-                out.data[i] = static_cast<T>(u);
+                dst[i] = static_cast<T>(u);
             }
             return out;
         }
@@ -1257,7 +2070,7 @@ namespace bml
         {
             Uns u = static_cast<Uns>(data[i]);
             u <<= s; // logical left shift on Uns
-            out.data[i] = static_cast<T>(u);
+            dst[i] = static_cast<T>(u);
         }
         return out;
     }
@@ -1266,6 +2079,8 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>>
             Matrix<T>::operator>>(int k) const
     {
+        BML_PERF_SCOPE("operator>>", T);
+        BML_TRACE_SCOPE("operator>>", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         using Uns = std::make_unsigned_t<U>;
         using Sig = std::make_signed_t<U>;
 
@@ -1278,6 +2093,7 @@ namespace bml
         }
 
         const auto w = static_cast<unsigned>(std::numeric_limits<Uns>::digits);
+        store_t* dst = out.data.data();
 
         if (k < 0)
         {
@@ -1287,7 +2103,7 @@ namespace bml
             {
                 Uns u = static_cast<Uns>(data[i]);
                 u <<= s;
-                out.data[i] = static_cast<T>(u);
+                dst[i] = static_cast<T>(u);
             }
             return out;
         }
@@ -1299,13 +2115,13 @@ namespace bml
             {
                 Sig v = static_cast<Sig>(data[i]);
                 v >>= s; // arithmetic right shift
-                out.data[i] = static_cast<T>(v);
+                dst[i] = static_cast<T>(v);
             }
             else
             {
                 Uns u = static_cast<Uns>(data[i]);
                 u >>= s; // logical right shift
-                out.data[i] = static_cast<T>(u);
+                dst[i] = static_cast<T>(u);
             }
         }
         return out;
@@ -1314,19 +2130,22 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator<<=(int k)
     {
+        BML_PERF_SCOPE("operator<<=", T);
+        BML_TRACE_SCOPE("operator<<=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         using Uns = std::make_unsigned_t<U>;
         if (data.empty() || k == 0) return *this;
 
         const auto w = static_cast<unsigned>(std::numeric_limits<Uns>::digits);
+        store_t* dst = writableCells();
 
         if (k < 0)
         {
             const unsigned s = static_cast<unsigned>(-k) % w;
             for (std::size_t i = 0; i < data.size(); ++i)
             {
-                Uns u = static_cast<Uns>(data[i]);
+                Uns u = static_cast<Uns>(dst[i]);
                 u >>= s;
-                data[i] = static_cast<T>(u);
+                dst[i] = static_cast<T>(u);
             }
             return *this;
         }
@@ -1334,9 +2153,9 @@ namespace bml
         const unsigned s = static_cast<unsigned>(k) % w;
         for (std::size_t i = 0; i < data.size(); ++i)
         {
-            Uns u = static_cast<Uns>(data[i]);
+            Uns u = static_cast<Uns>(dst[i]);
             u <<= s;
-            data[i] = static_cast<T>(u);
+            dst[i] = static_cast<T>(u);
         }
         return *this;
     }
@@ -1345,12 +2164,15 @@ namespace bml
     std::enable_if_t<bml_is_math_integral<U>::value, Matrix<T>&>
     Matrix<T>::operator>>=(int k)
     {
+        BML_PERF_SCOPE("operator>>=", T);
+        BML_TRACE_SCOPE("operator>>=", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         using Uns = std::make_unsigned_t<U>;
         using Sig = std::make_signed_t<U>;
 
         if (data.empty() || k == 0) return *this;
 
         const auto w = static_cast<unsigned>(std::numeric_limits<Uns>::digits);
+        store_t* dst = writableCells();
 
         if (k < 0)
         {
@@ -1358,9 +2180,9 @@ namespace bml
             // negative k => left shift
             for (std::size_t i = 0; i < data.size(); ++i)
             {
-                Uns u = static_cast<Uns>(data[i]);
+                Uns u = static_cast<Uns>(dst[i]);
                 u <<= s;
-                data[i] = static_cast<T>(u);
+                dst[i] = static_cast<T>(u);
             }
             return *this;
         }
@@ -1370,15 +2192,15 @@ namespace bml
         {
             if constexpr (std::is_signed<U>::value)
             {
-                Sig v = static_cast<Sig>(data[i]);
+                Sig v = static_cast<Sig>(dst[i]);
                 v >>= s; // arithmetic
-                data[i] = static_cast<T>(v);
+                dst[i] = static_cast<T>(v);
             }
             else
             {
-                Uns u = static_cast<Uns>(data[i]);
+                Uns u = static_cast<Uns>(dst[i]);
                 u >>= s; // logical
-                data[i] = static_cast<T>(u);
+                dst[i] = static_cast<T>(u);
             }
         }
         return *this;
@@ -1391,10 +2213,13 @@ namespace bml
     std::enable_if_t<bml_is_bool<U>::value, Matrix<T>>
             Matrix<T>::logical_and(const Matrix& other) const
     {
+        BML_PERF_SCOPE("logical_and", T);
+        BML_TRACE_SCOPE("logical_and", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] && other.data[i];
+            out[i] = data[i] && other.data[i];
         }
         return result;
     }
@@ -1403,10 +2228,13 @@ namespace bml
     std::enable_if_t<bml_is_bool<U>::value, Matrix<T>>
             Matrix<T>::logical_or(const Matrix& other) const
     {
+        BML_PERF_SCOPE("logical_or", T);
+        BML_TRACE_SCOPE("logical_or", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] || other.data[i];
+            out[i] = data[i] || other.data[i];
         }
         return result;
     }
@@ -1415,10 +2243,13 @@ namespace bml
     std::enable_if_t<bml_is_bool<U>::value, Matrix<T>>
             Matrix<T>::logical_xor(const Matrix& other) const
     {
+        BML_PERF_SCOPE("logical_xor", T);
+        BML_TRACE_SCOPE("logical_xor", T, rows, cols, detail::traceBytes<T>(data.size(), 3));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] != other.data[i];
+            out[i] = data[i] != other.data[i];
         }
         return result;
     }
@@ -1427,10 +2258,13 @@ namespace bml
     std::enable_if_t<bml_is_bool<U>::value, Matrix<T>>
             Matrix<T>::logical_not() const
     {
+        BML_PERF_SCOPE("logical_not", T);
+        BML_TRACE_SCOPE("logical_not", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = !data[i];
+            out[i] = !data[i];
         }
         return result;
     }
@@ -1440,11 +2274,14 @@ namespace bml
     std::enable_if_t<bml_is_bool<U>::value, Matrix<T>>
             Matrix<T>::logical_and(bool s) const
     {
+        BML_PERF_SCOPE("logical_and", T);
+        BML_TRACE_SCOPE("logical_and", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         {
             Matrix<T> result(rows, cols);
+            store_t* out = result.data.data();
             for(size_t i = 0; i < data.size(); i++)
             {
-                result.data[i] = data[i] && s;
+                out[i] = data[i] && s;
             }
             return result;
         }
@@ -1455,10 +2292,13 @@ namespace bml
             Matrix<T>::logical_or(bool s) const
 
     {
+        BML_PERF_SCOPE("logical_or", T);
+        BML_TRACE_SCOPE("logical_or", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] || s;
+            out[i] = data[i] || s;
         }
         return result;
     }
@@ -1468,10 +2308,13 @@ namespace bml
     std::enable_if_t<bml_is_bool<U>::value, Matrix<T>>
             Matrix<T>::logical_xor(bool s) const
     {
+        BML_PERF_SCOPE("logical_xor", T);
+        BML_TRACE_SCOPE("logical_xor", T, rows, cols, detail::traceBytes<T>(data.size(), 2));
         Matrix<T> result(rows, cols);
+        store_t* out = result.data.data();
         for(size_t i = 0; i < data.size(); i++)
         {
-            result.data[i] = data[i] != s;
+            out[i] = data[i] != s;
         }
         return result;
     }
@@ -1480,6 +2323,20 @@ namespace bml
     std::enable_if_t<bml_is_bool<U>::value, std::size_t>
     Matrix<T>::count_true() const noexcept
     {
+        BML_PERF_SCOPE("count_true", T);
+        BML_TRACE_SCOPE("count_true", T, rows, cols, detail::traceBytes<T>(data.size(), 1));
+        if (auto* cache = reductionCache.get())
+        {
+            std::lock_guard<std::mutex> lock(cache->mutex);
+            detail::refreshPartials(*cache, detail::kCachedTrue, cols, data.size(), cache->trues,
+                                    [&](std::size_t first, std::size_t n) {
+                                        return static_cast<std::size_t>(std::count_if(data.data() + first, data.data() + first + n,
+                                                                                      [](store_t cell) { return cell != 0; }));
+                                    });
+            std::size_t total = 0;
+            for (std::size_t partial : cache->trues) total += partial;
+            return total;
+        }
         size_t result = 0;
         for(size_t i = 0; i < data.size(); i++)if(data[i])result++;
         return result;
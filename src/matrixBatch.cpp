@@ -0,0 +1,598 @@
+#include "bml/matrixBatch.hpp"
+#include "bml/dispatch.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Cells one parallel task should touch at least.
+        constexpr std::size_t kBatchGrainCells = std::size_t{1} << 14;
+
+        // Runs f(group, active) for every group of W matrices on the worker pool;
+        // active < W only for the last group of an Interleaved batch.
+        template<std::size_t W, typename F>
+        void forGroups(std::size_t count, std::size_t matrixCells, F&& f)
+        {
+            const std::size_t groups = (count + W - 1) / W;
+            const std::size_t grain = std::max<std::size_t>(1, kBatchGrainCells / std::max<std::size_t>(1, matrixCells * W));
+            parallelFor(groups, grain, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t g = begin; g < end; ++g) f(g, std::min(W, count - g * W));
+            });
+        }
+
+        // Runs f(offset, chunks, active) over a flat run of @p total cells on the worker pool:
+        // chunks of W cells from offset, then at most one partial chunk (active < W) at the end.
+        // Element-wise work on a Contiguous batch goes this way, so it vectorizes across matrices.
+        template<std::size_t W, typename F>
+        void forChunks(std::size_t total, F&& f)
+        {
+            const std::size_t chunks = total / W;
+            parallelFor(chunks, std::max<std::size_t>(1, kBatchGrainCells / W), [&](std::size_t begin, std::size_t end) {
+                f(begin * W, end - begin, W);
+            });
+            if (total % W != 0) f(chunks * W, 1, total % W);
+        }
+
+        // Calls f(std::integral_constant<std::size_t, lanes>) for the layout of @p m, so the
+        // kernels see the lane count as a constant.
+        template<typename T, typename F>
+        void withLanes(const MatrixBatch<T>& m, F&& f)
+        {
+            if (m.layout() == BatchLayout::Interleaved)
+                f(std::integral_constant<std::size_t, MatrixBatch<T>::InterleavedLanes>{});
+            else
+                f(std::integral_constant<std::size_t, 1>{});
+        }
+
+        // In every kernel below a group holds W matrices, cell c of lane l at [c * W + l];
+        // Full groups loop over all W lanes with a constant bound, the last one over @p active.
+
+        template<std::size_t W, bool Full, typename T, typename Op>
+        BML_HOT_KERNEL void batchZip(const T* BML_RESTRICT a, const T* BML_RESTRICT b, T* BML_RESTRICT out,
+                                     std::size_t cells, std::size_t active, Op op)
+        {
+            const std::size_t L = Full ? W : active;
+            for (std::size_t c = 0; c < cells; ++c)
+                for (std::size_t l = 0; l < L; ++l) out[c * W + l] = op(a[c * W + l], b[c * W + l]);
+        }
+
+        template<std::size_t W, bool Full, typename T, typename Op>
+        BML_HOT_KERNEL void batchMap(const T* BML_RESTRICT a, T* BML_RESTRICT out, std::size_t cells, std::size_t active,
+                                     Op op)
+        {
+            const std::size_t L = Full ? W : active;
+            for (std::size_t c = 0; c < cells; ++c)
+                for (std::size_t l = 0; l < L; ++l) out[c * W + l] = op(a[c * W + l]);
+        }
+
+        template<std::size_t W, bool Full, typename T>
+        BML_HOT_KERNEL void batchSum(const T* a, std::size_t cells, std::size_t active, T* out)
+        {
+            const std::size_t L = Full ? W : active;
+            T s[W] = {};
+            T comp[W] = {};
+            for (std::size_t c = 0; c < cells; ++c)
+                for (std::size_t l = 0; l < L; ++l)
+                {
+                    if constexpr (std::is_floating_point_v<T>)
+                    {
+                        const T y = a[c * W + l] - comp[l];
+                        const T t = s[l] + y;
+                        comp[l] = (t - s[l]) - y;
+                        s[l] = t;
+                    }
+                    else
+                    {
+                        s[l] = static_cast<T>(s[l] + a[c * W + l]);
+                    }
+                }
+            for (std::size_t l = 0; l < L; ++l) out[l] = s[l];
+        }
+
+        template<std::size_t W, bool Full, bool Max, typename T>
+        BML_HOT_KERNEL void batchExtreme(const T* a, std::size_t cells, std::size_t active, T* out)
+        {
+            const std::size_t L = Full ? W : active;
+            T m[W] = {};
+            for (std::size_t l = 0; l < L; ++l) m[l] = a[l];
+            for (std::size_t c = 1; c < cells; ++c)
+                for (std::size_t l = 0; l < L; ++l)
+                {
+                    const T v = a[c * W + l];
+                    if constexpr (Max) m[l] = m[l] < v ? v : m[l];
+                    else m[l] = v < m[l] ? v : m[l];
+                }
+            for (std::size_t l = 0; l < L; ++l) out[l] = m[l];
+        }
+
+        template<std::size_t W, bool Full, typename T>
+        BML_HOT_KERNEL void batchTranspose(const T* BML_RESTRICT a, T* BML_RESTRICT out, std::size_t rows, std::size_t cols,
+                                           std::size_t active)
+        {
+            const std::size_t L = Full ? W : active;
+            for (std::size_t i = 0; i < rows; ++i)
+                for (std::size_t j = 0; j < cols; ++j)
+                    for (std::size_t l = 0; l < L; ++l) out[(j * rows + i) * W + l] = a[(i * cols + j) * W + l];
+        }
+
+        // c (n x m, zeroed) = a (n x k) * b (k x m). With W == 1 the inner loop runs along
+        // a row of b; otherwise across the batch.
+        template<std::size_t W, bool Full, typename T>
+        BML_HOT_KERNEL void batchMatmul(const T* BML_RESTRICT a, const T* BML_RESTRICT b, T* BML_RESTRICT c,
+                                        std::size_t n, std::size_t k, std::size_t m, std::size_t active)
+        {
+            const std::size_t L = Full ? W : active;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                T* ci = c + i * m * W;
+                for (std::size_t p = 0; p < k; ++p)
+                {
+                    const T* ap = a + (i * k + p) * W;
+                    const T* bp = b + p * m * W;
+                    for (std::size_t j = 0; j < m; ++j)
+                        for (std::size_t l = 0; l < L; ++l)
+                            ci[j * W + l] = static_cast<T>(ci[j * W + l] + ap[l] * bp[j * W + l]);
+                }
+            }
+        }
+
+        /*
+         * In-place Gaussian elimination of a (n x n) with partial pivoting, applied to
+         * x (n x rhs, holding b on entry and the solution on return). Each lane picks its
+         * own pivots; the row updates then run across the lanes. Returns the first
+         * singular lane, or W if there is none.
+         */
+        template<std::size_t W, bool Full, typename T>
+        BML_HOT_KERNEL std::size_t batchSolve(T* BML_RESTRICT a, T* BML_RESTRICT x, std::size_t n, std::size_t rhs,
+                                              std::size_t active)
+        {
+            const std::size_t L = Full ? W : active;
+            for (std::size_t col = 0; col < n; ++col)
+            {
+                for (std::size_t l = 0; l < L; ++l)
+                {
+                    std::size_t pivot = col;
+                    T best = std::abs(a[(col * n + col) * W + l]);
+                    for (std::size_t i = col + 1; i < n; ++i)
+                    {
+                        const T v = std::abs(a[(i * n + col) * W + l]);
+                        if (v > best)
+                        {
+                            best = v;
+                            pivot = i;
+                        }
+                    }
+                    if (!(best > T{0})) return l;
+                    if (pivot == col) continue;
+                    for (std::size_t j = col; j < n; ++j) std::swap(a[(col * n + j) * W + l], a[(pivot * n + j) * W + l]);
+                    for (std::size_t j = 0; j < rhs; ++j) std::swap(x[(col * rhs + j) * W + l], x[(pivot * rhs + j) * W + l]);
+                }
+
+                const T* pivotRow = a + col * n * W;
+                const T* pivotRhs = x + col * rhs * W;
+                for (std::size_t i = col + 1; i < n; ++i)
+                {
+                    T* row = a + i * n * W;
+                    T* rowRhs = x + i * rhs * W;
+                    T f[W] = {};
+                    for (std::size_t l = 0; l < L; ++l) f[l] = row[col * W + l] / pivotRow[col * W + l];
+                    for (std::size_t j = col + 1; j < n; ++j)
+                        for (std::size_t l = 0; l < L; ++l) row[j * W + l] -= f[l] * pivotRow[j * W + l];
+                    for (std::size_t j = 0; j < rhs; ++j)
+                        for (std::size_t l = 0; l < L; ++l) rowRhs[j * W + l] -= f[l] * pivotRhs[j * W + l];
+                }
+            }
+
+            for (std::size_t i = n; i-- > 0;)
+            {
+                T* xi = x + i * rhs * W;
+                for (std::size_t q = i + 1; q < n; ++q)
+                {
+                    const T* aiq = a + (i * n + q) * W;
+                    const T* xq = x + q * rhs * W;
+                    for (std::size_t j = 0; j < rhs; ++j)
+                        for (std::size_t l = 0; l < L; ++l) xi[j * W + l] -= aiq[l] * xq[j * W + l];
+                }
+                const T* aii = a + (i * n + i) * W;
+                for (std::size_t j = 0; j < rhs; ++j)
+                    for (std::size_t l = 0; l < L; ++l) xi[j * W + l] /= aii[l];
+            }
+            return W;
+        }
+    }
+
+    // ---------- construction and access ----------
+
+    template<typename T>
+    MatrixBatch<T>::MatrixBatch(std::size_t count, std::uint32_t numRows, std::uint32_t numCols, BatchLayout layout)
+        : count(count), rows(numRows), cols(numCols), order(layout)
+    {
+        cells.assign(groups() * lanes() * matrixCells(), T{0});
+    }
+
+    template<typename T>
+    MatrixBatch<T>::MatrixBatch(const std::vector<Matrix<T>>& matrices, BatchLayout layout)
+        : MatrixBatch(matrices.size(), matrices.empty() ? 0 : matrices.front().numRows(),
+                      matrices.empty() ? 0 : matrices.front().numCols(), layout)
+    {
+        for (std::size_t b = 0; b < count; ++b) set(b, matrices[b]);
+    }
+
+    template<typename T>
+    void MatrixBatch<T>::checkIndex(std::size_t index, std::uint32_t row, std::uint32_t col) const
+    {
+        if (index >= count) throw std::out_of_range("MatrixBatch index out of range.");
+        if (row >= rows || col >= cols) throw std::out_of_range("MatrixBatch cell out of range.");
+    }
+
+    template<typename T>
+    T& MatrixBatch<T>::at(std::size_t index, std::uint32_t row, std::uint32_t col)
+    {
+        checkIndex(index, row, col);
+        return (*this)(index, row, col);
+    }
+
+    template<typename T>
+    const T& MatrixBatch<T>::at(std::size_t index, std::uint32_t row, std::uint32_t col) const
+    {
+        checkIndex(index, row, col);
+        return (*this)(index, row, col);
+    }
+
+    template<typename T>
+    Matrix<T> MatrixBatch<T>::get(std::size_t index) const
+    {
+        if (index >= count) throw std::out_of_range("MatrixBatch index out of range.");
+        Matrix<T> out(rows, cols);
+        T* dst = out.data_storage();
+        if (order == BatchLayout::Contiguous)
+        {
+            std::copy_n(cells.data() + index * matrixCells(), matrixCells(), dst);
+            return out;
+        }
+        const T* src = cells.data() + offset(index, 0, 0);
+        for (std::size_t c = 0; c < matrixCells(); ++c) dst[c] = src[c * InterleavedLanes];
+        return out;
+    }
+
+    template<typename T>
+    void MatrixBatch<T>::set(std::size_t index, const Matrix<T>& matrix)
+    {
+        if (index >= count) throw std::out_of_range("MatrixBatch index out of range.");
+        if (matrix.numRows() != rows || matrix.numCols() != cols)
+            throw std::invalid_argument("Matrix shape must match the batch.");
+        const T* src = matrix.data_storage();
+        if (order == BatchLayout::Contiguous)
+        {
+            std::copy_n(src, matrixCells(), cells.data() + index * matrixCells());
+            return;
+        }
+        T* dst = cells.data() + offset(index, 0, 0);
+        for (std::size_t c = 0; c < matrixCells(); ++c) dst[c * InterleavedLanes] = src[c];
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::toLayout(BatchLayout layout) const
+    {
+        if (layout == order) return *this;
+        BML_PERF_SCOPE("batch toLayout", T);
+        MatrixBatch out(count, rows, cols, layout);
+        const bool toInterleaved = layout == BatchLayout::Interleaved;
+        const T* src = cells.data();
+        T* dst = out.cells.data();
+        const std::size_t n = matrixCells();
+        constexpr std::size_t W = InterleavedLanes;
+        detail::forGroups<W>(count, n, [&](std::size_t g, std::size_t active) {
+            for (std::size_t l = 0; l < active; ++l)
+            {
+                const std::size_t flat = (g * W + l) * n;   // matrix in the Contiguous layout
+                const std::size_t lane = g * n * W + l;     // its lane in the Interleaved one
+                for (std::size_t c = 0; c < n; ++c)
+                {
+                    if (toInterleaved) dst[lane + c * W] = src[flat + c];
+                    else dst[flat + c] = src[lane + c * W];
+                }
+            }
+        });
+        return out;
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::transpose() const
+    {
+        BML_PERF_SCOPE("batch transpose", T);
+        MatrixBatch out(count, cols, rows, order);
+        const std::size_t n = matrixCells();
+        detail::withLanes(*this, [&](auto lanesConstant) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            detail::forGroups<W>(count, n, [&](std::size_t g, std::size_t active) {
+                const T* a = cells.data() + g * n * W;
+                T* o = out.cells.data() + g * n * W;
+                if (active == W) detail::batchTranspose<W, true>(a, o, rows, cols, active);
+                else detail::batchTranspose<W, false>(a, o, rows, cols, active);
+            });
+        });
+        return out;
+    }
+
+    // ---------- element-wise ----------
+
+    template<typename T>
+    void MatrixBatch<T>::checkSameShape(const MatrixBatch& other, const char* what) const
+    {
+        if (count != other.count || rows != other.rows || cols != other.cols)
+            throw std::invalid_argument(std::string("MatrixBatch sizes and shapes must match for ") + what + ".");
+    }
+
+    template<typename T>
+    template<typename Op>
+    MatrixBatch<T> MatrixBatch<T>::zip(const MatrixBatch& other, Op op) const
+    {
+        const MatrixBatch converted = other.order == order ? MatrixBatch(0, 0, 0, order) : other.toLayout(order);
+        const MatrixBatch& rhs = other.order == order ? other : converted;
+        MatrixBatch out(count, rows, cols, order);
+        if (order == BatchLayout::Contiguous)
+        {
+            constexpr std::size_t W = InterleavedLanes;
+            detail::forChunks<W>(cells.size(), [&](std::size_t base, std::size_t chunks, std::size_t active) {
+                if (active == W)
+                    detail::batchZip<W, true>(cells.data() + base, rhs.cells.data() + base, out.cells.data() + base, chunks, active, op);
+                else
+                    detail::batchZip<W, false>(cells.data() + base, rhs.cells.data() + base, out.cells.data() + base, chunks, active, op);
+            });
+            return out;
+        }
+        const std::size_t n = matrixCells();
+        detail::withLanes(*this, [&](auto lanesConstant) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            detail::forGroups<W>(count, n, [&](std::size_t g, std::size_t active) {
+                const std::size_t base = g * n * W;
+                if (active == W)
+                    detail::batchZip<W, true>(cells.data() + base, rhs.cells.data() + base, out.cells.data() + base, n, active, op);
+                else
+                    detail::batchZip<W, false>(cells.data() + base, rhs.cells.data() + base, out.cells.data() + base, n, active, op);
+            });
+        });
+        return out;
+    }
+
+    template<typename T>
+    template<typename Op>
+    MatrixBatch<T> MatrixBatch<T>::map(Op op) const
+    {
+        MatrixBatch out(count, rows, cols, order);
+        if (order == BatchLayout::Contiguous)
+        {
+            constexpr std::size_t W = InterleavedLanes;
+            detail::forChunks<W>(cells.size(), [&](std::size_t base, std::size_t chunks, std::size_t active) {
+                if (active == W) detail::batchMap<W, true>(cells.data() + base, out.cells.data() + base, chunks, active, op);
+                else detail::batchMap<W, false>(cells.data() + base, out.cells.data() + base, chunks, active, op);
+            });
+            return out;
+        }
+        const std::size_t n = matrixCells();
+        detail::withLanes(*this, [&](auto lanesConstant) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            detail::forGroups<W>(count, n, [&](std::size_t g, std::size_t active) {
+                const std::size_t base = g * n * W;
+                if (active == W) detail::batchMap<W, true>(cells.data() + base, out.cells.data() + base, n, active, op);
+                else detail::batchMap<W, false>(cells.data() + base, out.cells.data() + base, n, active, op);
+            });
+        });
+        return out;
+    }
+
+    template<typename T>
+    bool MatrixBatch<T>::hasZero() const
+    {
+        // Padding lanes are zero, so look at the real matrices only.
+        std::atomic<bool> found{false};
+        const std::size_t n = matrixCells();
+        const std::size_t W = lanes();
+        detail::forGroups<1>(groups(), n * W, [&](std::size_t g, std::size_t) {
+            const std::size_t active = std::min(W, count - g * W);
+            const T* a = cells.data() + g * n * W;
+            bool zero = false;
+            for (std::size_t c = 0; c < n; ++c)
+                for (std::size_t l = 0; l < active; ++l) zero |= a[c * W + l] == T{0};
+            if (zero) found.store(true, std::memory_order_relaxed);
+        });
+        return found.load(std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::operator+(const MatrixBatch& other) const
+    {
+        BML_PERF_SCOPE("batch operator+", T);
+        checkSameShape(other, "addition");
+        return zip(other, [](T a, T b) { return static_cast<T>(a + b); });
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::operator-(const MatrixBatch& other) const
+    {
+        BML_PERF_SCOPE("batch operator-", T);
+        checkSameShape(other, "subtraction");
+        return zip(other, [](T a, T b) { return static_cast<T>(a - b); });
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::operator*(const MatrixBatch& other) const
+    {
+        BML_PERF_SCOPE("batch operator*", T);
+        checkSameShape(other, "multiplication");
+        return zip(other, [](T a, T b) { return static_cast<T>(a * b); });
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::operator/(const MatrixBatch& other) const
+    {
+        BML_PERF_SCOPE("batch operator/", T);
+        checkSameShape(other, "division");
+        if (other.hasZero()) throw std::runtime_error("Division by zero encountered.");
+        return zip(other, [](T a, T b) { return static_cast<T>(a / b); });
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::operator+(const T& scalar) const
+    {
+        BML_PERF_SCOPE("batch operator+", T);
+        const T s = scalar;
+        return map([s](T a) { return static_cast<T>(a + s); });
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::operator-(const T& scalar) const
+    {
+        BML_PERF_SCOPE("batch operator-", T);
+        const T s = scalar;
+        return map([s](T a) { return static_cast<T>(a - s); });
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::operator*(const T& scalar) const
+    {
+        BML_PERF_SCOPE("batch operator*", T);
+        const T s = scalar;
+        return map([s](T a) { return static_cast<T>(a * s); });
+    }
+
+    template<typename T>
+    MatrixBatch<T> MatrixBatch<T>::operator/(const T& scalar) const
+    {
+        BML_PERF_SCOPE("batch operator/", T);
+        if (scalar == T{0}) throw std::runtime_error("Division by zero encountered.");
+        const T s = scalar;
+        return map([s](T a) { return static_cast<T>(a / s); });
+    }
+
+    // ---------- reductions ----------
+
+    template<typename T>
+    template<typename Reduce>
+    std::vector<T> MatrixBatch<T>::reduce(Reduce reduceGroup) const
+    {
+        // Padded to whole groups so the kernels can write a full group.
+        std::vector<T> out(groups() * lanes());
+        const std::size_t n = matrixCells();
+        detail::withLanes(*this, [&](auto lanesConstant) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            detail::forGroups<W>(count, n, [&](std::size_t g, std::size_t active) {
+                reduceGroup(lanesConstant, cells.data() + g * n * W, n, active, out.data() + g * W);
+            });
+        });
+        out.resize(count);
+        return out;
+    }
+
+    template<typename T>
+    std::vector<T> MatrixBatch<T>::sums() const
+    {
+        BML_PERF_SCOPE("batch sums", T);
+        return reduce([](auto lanesConstant, const T* a, std::size_t n, std::size_t active, T* out) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            if (active == W) detail::batchSum<W, true>(a, n, active, out);
+            else detail::batchSum<W, false>(a, n, active, out);
+        });
+    }
+
+    template<typename T>
+    std::vector<T> MatrixBatch<T>::mins() const
+    {
+        BML_PERF_SCOPE("batch mins", T);
+        if (matrixCells() == 0 && count > 0) throw std::runtime_error("MatrixBatch::mins() on empty matrices");
+        return reduce([](auto lanesConstant, const T* a, std::size_t n, std::size_t active, T* out) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            if (active == W) detail::batchExtreme<W, true, false>(a, n, active, out);
+            else detail::batchExtreme<W, false, false>(a, n, active, out);
+        });
+    }
+
+    template<typename T>
+    std::vector<T> MatrixBatch<T>::maxs() const
+    {
+        BML_PERF_SCOPE("batch maxs", T);
+        if (matrixCells() == 0 && count > 0) throw std::runtime_error("MatrixBatch::maxs() on empty matrices");
+        return reduce([](auto lanesConstant, const T* a, std::size_t n, std::size_t active, T* out) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            if (active == W) detail::batchExtreme<W, true, true>(a, n, active, out);
+            else detail::batchExtreme<W, false, true>(a, n, active, out);
+        });
+    }
+
+    // ---------- products and solves ----------
+
+    template<typename T>
+    MatrixBatch<T> matmul(const MatrixBatch<T>& a, const MatrixBatch<T>& b)
+    {
+        BML_PERF_SCOPE("batch matmul", T);
+        BML_TRACE_SCOPE("batch matmul", T, a.numRows(), b.numCols(),
+                        a.size() * (std::size_t{a.numRows()} * a.numCols() + std::size_t{b.numRows()} * b.numCols()
+                                    + std::size_t{a.numRows()} * b.numCols()) * sizeof(T));
+        if (a.size() != b.size() || a.numCols() != b.numRows())
+            throw std::invalid_argument("MatrixBatch sizes and dimensions must match for multiplication.");
+
+        const MatrixBatch<T> converted = b.layout() == a.layout() ? MatrixBatch<T>(0, 0, 0, a.layout()) : b.toLayout(a.layout());
+        const MatrixBatch<T>& rhs = b.layout() == a.layout() ? b : converted;
+        MatrixBatch<T> out(a.size(), a.numRows(), b.numCols(), a.layout());
+        const std::size_t n = a.numRows(), k = a.numCols(), m = b.numCols();
+        detail::withLanes(a, [&](auto lanesConstant) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            detail::forGroups<W>(a.size(), n * k * m, [&](std::size_t g, std::size_t active) {
+                const T* pa = a.data() + g * n * k * W;
+                const T* pb = rhs.data() + g * k * m * W;
+                T* pc = out.data() + g * n * m * W;
+                if (active == W) detail::batchMatmul<W, true>(pa, pb, pc, n, k, m, active);
+                else detail::batchMatmul<W, false>(pa, pb, pc, n, k, m, active);
+            });
+        });
+        return out;
+    }
+
+    template<typename T>
+    MatrixBatch<T> solve(const MatrixBatch<T>& a, const MatrixBatch<T>& b)
+    {
+        static_assert(std::is_floating_point_v<T>, "bml::solve(MatrixBatch): T must be floating point");
+        BML_PERF_SCOPE("batch solve", T);
+        BML_TRACE_SCOPE("batch solve", T, a.numRows(), b.numCols(),
+                        a.size() * (std::size_t{a.numRows()} * a.numCols() + 2 * std::size_t{b.numRows()} * b.numCols())
+                            * sizeof(T));
+        if (a.numRows() != a.numCols()) throw std::invalid_argument("Batched solve requires square matrices.");
+        if (a.size() != b.size() || b.numRows() != a.numRows())
+            throw std::invalid_argument("MatrixBatch sizes and dimensions must match for solve.");
+
+        MatrixBatch<T> work = a;   // eliminated in place
+        MatrixBatch<T> x = b.toLayout(a.layout());
+        const std::size_t n = a.numRows(), rhs = b.numCols();
+        std::atomic<std::size_t> singular{std::numeric_limits<std::size_t>::max()};
+        detail::withLanes(a, [&](auto lanesConstant) {
+            constexpr std::size_t W = decltype(lanesConstant)::value;
+            detail::forGroups<W>(a.size(), n * (n + rhs), [&](std::size_t g, std::size_t active) {
+                T* pa = work.data() + g * n * n * W;
+                T* px = x.data() + g * n * rhs * W;
+                const std::size_t lane = active == W ? detail::batchSolve<W, true>(pa, px, n, rhs, active)
+                                                     : detail::batchSolve<W, false>(pa, px, n, rhs, active);
+                if (lane == W) return;
+                std::size_t index = g * W + lane;
+                std::size_t seen = singular.load(std::memory_order_relaxed);
+                while (index < seen && !singular.compare_exchange_weak(seen, index, std::memory_order_relaxed)) {}
+            });
+        });
+        const std::size_t index = singular.load(std::memory_order_relaxed);
+        if (index != std::numeric_limits<std::size_t>::max())
+            throw std::runtime_error("Batched solve: matrix " + std::to_string(index) + " is singular.");
+        return x;
+    }
+} // namespace bml
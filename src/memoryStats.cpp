@@ -0,0 +1,207 @@
+#include "bml/memoryStats.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace bml
+{
+    namespace detail
+    {
+        namespace
+        {
+            struct GlobalCounters
+            {
+                std::atomic<std::uint64_t> liveMatrices{0};
+                std::atomic<std::uint64_t> liveBuffers{0};
+                std::atomic<std::uint64_t> liveBytes{0};
+                std::atomic<std::uint64_t> peakBytes{0};
+                std::atomic<std::uint64_t> allocations{0};
+                std::atomic<std::uint64_t> bytesAllocated{0};
+                std::atomic<std::uint64_t> deallocations{0};
+                std::atomic<std::uint64_t> bytesFreed{0};
+                std::atomic<std::uint64_t> temporaries{0};
+                std::atomic<std::uint64_t> temporaryBytes{0};
+                std::atomic<std::uint64_t> nextSerial{0};
+            };
+
+            // Constant-initialised, so matrices in static storage of other TUs can count safely.
+            GlobalCounters globals;
+
+            // Only the owning thread touches these. Live values are signed: a thread may
+            // free buffers another thread allocated.
+            struct ThreadCounters
+            {
+                std::int64_t liveMatrices = 0;
+                std::int64_t liveBuffers = 0;
+                std::int64_t liveBytes = 0;
+                std::int64_t peakBytes = 0;
+                std::uint64_t allocations = 0;
+                std::uint64_t bytesAllocated = 0;
+                std::uint64_t deallocations = 0;
+                std::uint64_t bytesFreed = 0;
+                std::uint64_t temporaries = 0;
+                std::uint64_t temporaryBytes = 0;
+            };
+
+            thread_local ThreadCounters local;
+            thread_local AllocationScope* innermostScope = nullptr;
+
+            std::uint64_t clampLive(std::int64_t v) noexcept
+            {
+                return v > 0 ? static_cast<std::uint64_t>(v) : 0;
+            }
+
+            AllocationStats threadSnapshot() noexcept
+            {
+                AllocationStats s;
+                s.liveMatrices = clampLive(local.liveMatrices);
+                s.liveBuffers = clampLive(local.liveBuffers);
+                s.liveBytes = clampLive(local.liveBytes);
+                s.peakBytes = clampLive(local.peakBytes);
+                s.allocations = local.allocations;
+                s.bytesAllocated = local.bytesAllocated;
+                s.deallocations = local.deallocations;
+                s.bytesFreed = local.bytesFreed;
+                s.temporaries = local.temporaries;
+                s.temporaryBytes = local.temporaryBytes;
+                return s;
+            }
+        } // namespace
+
+        AllocationTicket noteAllocation(std::size_t bytes) noexcept
+        {
+            const std::uint64_t b = bytes;
+            const std::uint64_t live = globals.liveBytes.fetch_add(b, std::memory_order_relaxed) + b;
+            std::uint64_t peak = globals.peakBytes.load(std::memory_order_relaxed);
+            while (live > peak && !globals.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+            globals.liveBuffers.fetch_add(1, std::memory_order_relaxed);
+            globals.allocations.fetch_add(1, std::memory_order_relaxed);
+            globals.bytesAllocated.fetch_add(b, std::memory_order_relaxed);
+
+            local.liveBuffers += 1;
+            local.liveBytes += static_cast<std::int64_t>(b);
+            local.peakBytes = std::max(local.peakBytes, local.liveBytes);
+            local.allocations += 1;
+            local.bytesAllocated += b;
+
+            return AllocationTicket{b, globals.nextSerial.fetch_add(1, std::memory_order_relaxed)};
+        }
+
+        void noteRelease(const AllocationTicket& ticket) noexcept
+        {
+            globals.liveBytes.fetch_sub(ticket.bytes, std::memory_order_relaxed);
+            globals.liveBuffers.fetch_sub(1, std::memory_order_relaxed);
+            globals.deallocations.fetch_add(1, std::memory_order_relaxed);
+            globals.bytesFreed.fetch_add(ticket.bytes, std::memory_order_relaxed);
+
+            local.liveBuffers -= 1;
+            local.liveBytes -= static_cast<std::int64_t>(ticket.bytes);
+            local.deallocations += 1;
+            local.bytesFreed += ticket.bytes;
+
+            // Outer scopes opened earlier, so once one scope saw the allocation all
+            // scopes around it did too.
+            AllocationScope* scope = innermostScope;
+            while (scope && ticket.serial < scope->firstSerial) scope = scope->outer;
+            if (!scope) return;
+            for (; scope; scope = scope->outer)
+            {
+                scope->temporaries += 1;
+                scope->temporaryBytes += ticket.bytes;
+            }
+            globals.temporaries.fetch_add(1, std::memory_order_relaxed);
+            globals.temporaryBytes.fetch_add(ticket.bytes, std::memory_order_relaxed);
+            local.temporaries += 1;
+            local.temporaryBytes += ticket.bytes;
+        }
+
+        void noteMatrixCreated() noexcept
+        {
+            globals.liveMatrices.fetch_add(1, std::memory_order_relaxed);
+            local.liveMatrices += 1;
+        }
+
+        void noteMatrixDestroyed() noexcept
+        {
+            globals.liveMatrices.fetch_sub(1, std::memory_order_relaxed);
+            local.liveMatrices -= 1;
+        }
+    } // namespace detail
+
+    AllocationStats allocationStats() noexcept
+    {
+        const detail::GlobalCounters& g = detail::globals;
+        AllocationStats s;
+        s.liveMatrices = g.liveMatrices.load(std::memory_order_relaxed);
+        s.liveBuffers = g.liveBuffers.load(std::memory_order_relaxed);
+        s.liveBytes = g.liveBytes.load(std::memory_order_relaxed);
+        s.peakBytes = std::max(g.peakBytes.load(std::memory_order_relaxed), s.liveBytes);
+        s.allocations = g.allocations.load(std::memory_order_relaxed);
+        s.bytesAllocated = g.bytesAllocated.load(std::memory_order_relaxed);
+        s.deallocations = g.deallocations.load(std::memory_order_relaxed);
+        s.bytesFreed = g.bytesFreed.load(std::memory_order_relaxed);
+        s.temporaries = g.temporaries.load(std::memory_order_relaxed);
+        s.temporaryBytes = g.temporaryBytes.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    AllocationStats threadAllocationStats() noexcept
+    {
+        return detail::threadSnapshot();
+    }
+
+    void resetAllocationStats() noexcept
+    {
+        detail::GlobalCounters& g = detail::globals;
+        g.peakBytes.store(g.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        g.allocations.store(0, std::memory_order_relaxed);
+        g.bytesAllocated.store(0, std::memory_order_relaxed);
+        g.deallocations.store(0, std::memory_order_relaxed);
+        g.bytesFreed.store(0, std::memory_order_relaxed);
+        g.temporaries.store(0, std::memory_order_relaxed);
+        g.temporaryBytes.store(0, std::memory_order_relaxed);
+
+        detail::ThreadCounters& t = detail::local;
+        t.peakBytes = t.liveBytes;
+        t.allocations = 0;
+        t.bytesAllocated = 0;
+        t.deallocations = 0;
+        t.bytesFreed = 0;
+        t.temporaries = 0;
+        t.temporaryBytes = 0;
+    }
+
+    AllocationScope::AllocationScope() noexcept
+        : outer(detail::innermostScope),
+          start(detail::threadSnapshot()),
+          startLive{detail::local.liveMatrices, detail::local.liveBuffers, detail::local.liveBytes},
+          savedPeak(detail::local.peakBytes),
+          firstSerial(detail::globals.nextSerial.load(std::memory_order_relaxed))
+    {
+        detail::local.peakBytes = detail::local.liveBytes;   // peak within the scope
+        detail::innermostScope = this;
+    }
+
+    AllocationScope::~AllocationScope()
+    {
+        detail::innermostScope = outer;
+        detail::local.peakBytes = std::max(detail::local.peakBytes, savedPeak);
+    }
+
+    AllocationStats AllocationScope::stats() const noexcept
+    {
+        const detail::ThreadCounters& t = detail::local;
+        AllocationStats s;
+        s.liveMatrices = detail::clampLive(t.liveMatrices - startLive[0]);
+        s.liveBuffers = detail::clampLive(t.liveBuffers - startLive[1]);
+        s.liveBytes = detail::clampLive(t.liveBytes - startLive[2]);
+        s.peakBytes = detail::clampLive(t.peakBytes - startLive[2]);
+        s.allocations = t.allocations - start.allocations;
+        s.bytesAllocated = t.bytesAllocated - start.bytesAllocated;
+        s.deallocations = t.deallocations - start.deallocations;
+        s.bytesFreed = t.bytesFreed - start.bytesFreed;
+        s.temporaries = temporaries;
+        s.temporaryBytes = temporaryBytes;
+        return s;
+    }
+} // namespace bml
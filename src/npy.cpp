@@ -0,0 +1,671 @@
+#include "bml/npy.hpp"
+#include "bml/mappedFile.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/sink.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace bml
+{
+    namespace detail
+    {
+        // ---------------------------------------------------------------------
+        // Little-endian field access (the library assumes a little-endian host)
+        // ---------------------------------------------------------------------
+        template<typename U>
+        U readLE(const unsigned char* p) noexcept
+        {
+            U v;
+            std::memcpy(&v, p, sizeof v);
+            return v;
+        }
+
+        template<typename U>
+        void appendLE(std::string& out, U v)
+        {
+            char bytes[sizeof v];
+            std::memcpy(bytes, &v, sizeof v);
+            out.append(bytes, sizeof v);
+        }
+
+        // ---------------------------------------------------------------------
+        // CRC-32 (zip polynomial), slicing-by-8
+        // ---------------------------------------------------------------------
+        using CrcTables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+        constexpr CrcTables makeCrcTables()
+        {
+            CrcTables t{};
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+                std::uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[0][i] = c;
+            }
+            for (std::size_t s = 1; s < 8; ++s)
+                for (std::size_t i = 0; i < 256; ++i)
+                    t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFFu];
+            return t;
+        }
+
+        constexpr CrcTables kCrcTables = makeCrcTables();
+
+        // Running CRC: start with crc = 0 and feed consecutive pieces.
+        inline std::uint32_t crc32Update(std::uint32_t crc, const void* bytes, std::size_t size) noexcept
+        {
+            auto p = static_cast<const unsigned char*>(bytes);
+            crc = ~crc;
+            for (; size >= 8; size -= 8, p += 8)
+            {
+                const std::uint32_t lo = readLE<std::uint32_t>(p) ^ crc;
+                const std::uint32_t hi = readLE<std::uint32_t>(p + 4);
+                crc = kCrcTables[7][lo & 0xFFu] ^ kCrcTables[6][(lo >> 8) & 0xFFu]
+                    ^ kCrcTables[5][(lo >> 16) & 0xFFu] ^ kCrcTables[4][lo >> 24]
+                    ^ kCrcTables[3][hi & 0xFFu] ^ kCrcTables[2][(hi >> 8) & 0xFFu]
+                    ^ kCrcTables[1][(hi >> 16) & 0xFFu] ^ kCrcTables[0][hi >> 24];
+            }
+            for (; size > 0; --size, ++p) crc = kCrcTables[0][(crc ^ *p) & 0xFFu] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        // ---------------------------------------------------------------------
+        // .npy header
+        // ---------------------------------------------------------------------
+        constexpr char kNpyMagic[] = "\x93NUMPY";
+        constexpr std::size_t kNpyMagicSize = 6;
+        constexpr std::size_t kNpyAlign = 64;
+
+        // dtype of T without the byte-order character, e.g. "f8".
+        template<typename T>
+        std::string npyKind()
+        {
+            using S = storage_of_t<T>;
+            if constexpr (bml_is_bool<T>::value) return "b1";
+            else if constexpr (std::is_same_v<T, char>) return "S1";
+            else if constexpr (std::is_floating_point_v<T>) return "f" + std::to_string(sizeof(S));
+            else if constexpr (std::is_signed_v<T>) return "i" + std::to_string(sizeof(S));
+            else return "u" + std::to_string(sizeof(S));
+        }
+
+        template<typename T>
+        std::string npyDescr()
+        {
+            return (sizeof(storage_of_t<T>) == 1 ? "|" : "<") + npyKind<T>();
+        }
+
+        struct NpyHeader
+        {
+            std::string descr;
+            bool fortranOrder = false;
+            std::vector<std::uint64_t> shape;
+            std::size_t dataOffset = 0;   // from the start of the image
+        };
+
+        [[noreturn]] inline void npyError(const std::string& what)
+        {
+            throw std::runtime_error("npy: " + what);
+        }
+
+        // Position just after "'key':" (single or double quoted key), or npos.
+        inline std::size_t npyValueAt(const std::string& dict, const char* key)
+        {
+            for (const char quote : {'\'', '"'})
+            {
+                const std::string quoted = quote + std::string(key) + quote;
+                std::size_t k = dict.find(quoted);
+                if (k == std::string::npos) continue;
+                k = dict.find(':', k + quoted.size());
+                if (k == std::string::npos) return k;
+                ++k;
+                while (k < dict.size() && dict[k] == ' ') ++k;
+                return k;
+            }
+            return std::string::npos;
+        }
+
+        inline NpyHeader parseNpyHeader(const unsigned char* p, std::size_t size)
+        {
+            if (size < kNpyMagicSize + 4 || std::memcmp(p, kNpyMagic, kNpyMagicSize) != 0)
+                npyError("missing magic string");
+
+            const unsigned major = p[6];
+            std::size_t headerLen, prefix;
+            if (major == 1)
+            {
+                headerLen = readLE<std::uint16_t>(p + 8);
+                prefix = 10;
+            }
+            else if (major == 2 || major == 3)
+            {
+                if (size < 12) npyError("truncated header");
+                headerLen = readLE<std::uint32_t>(p + 8);
+                prefix = 12;
+            }
+            else
+            {
+                npyError("unsupported format version " + std::to_string(major));
+            }
+            if (prefix + headerLen > size) npyError("truncated header");
+
+            const std::string dict(reinterpret_cast<const char*>(p + prefix), headerLen);
+            NpyHeader h;
+            h.dataOffset = prefix + headerLen;
+
+            std::size_t at = npyValueAt(dict, "descr");
+            if (at == std::string::npos || at >= dict.size() || (dict[at] != '\'' && dict[at] != '"'))
+                npyError("header has no 'descr' string (structured dtypes are not supported)");
+            const std::size_t close = dict.find(dict[at], at + 1);
+            if (close == std::string::npos) npyError("unterminated 'descr'");
+            h.descr = dict.substr(at + 1, close - at - 1);
+
+            at = npyValueAt(dict, "fortran_order");
+            if (at == std::string::npos) npyError("header has no 'fortran_order'");
+            if (dict.compare(at, 4, "True") == 0) h.fortranOrder = true;
+            else if (dict.compare(at, 5, "False") != 0) npyError("bad 'fortran_order' value");
+
+            at = npyValueAt(dict, "shape");
+            if (at == std::string::npos || at >= dict.size() || dict[at] != '(') npyError("header has no 'shape' tuple");
+            for (++at; at < dict.size() && dict[at] != ')'; )
+            {
+                if (dict[at] == ' ' || dict[at] == ',') { ++at; continue; }
+                if (dict[at] < '0' || dict[at] > '9') npyError("bad 'shape' tuple");
+                std::uint64_t v = 0;
+                while (at < dict.size() && dict[at] >= '0' && dict[at] <= '9')
+                {
+                    if (v > (std::numeric_limits<std::uint64_t>::max() - 9) / 10) npyError("shape overflow");
+                    v = v * 10 + static_cast<std::uint64_t>(dict[at++] - '0');
+                }
+                if (at < dict.size() && dict[at] == 'L') ++at;   // Python 2 longs
+                h.shape.push_back(v);
+            }
+            if (at >= dict.size()) npyError("unterminated 'shape' tuple");
+            return h;
+        }
+
+        // Magic, version 1.0, dict and padding so the data starts 64-byte aligned.
+        template<typename T>
+        std::string npyPreamble(std::uint32_t rows, std::uint32_t cols)
+        {
+            std::string dict = "{'descr': '" + npyDescr<T>() + "', 'fortran_order': False, 'shape': ("
+                             + std::to_string(rows) + ", " + std::to_string(cols) + "), }";
+            const std::size_t unpadded = kNpyMagicSize + 4 + dict.size() + 1;
+            dict.append((kNpyAlign - unpadded % kNpyAlign) % kNpyAlign, ' ');
+            dict.push_back('\n');
+
+            std::string out(kNpyMagic, kNpyMagicSize);
+            out.push_back('\x01');
+            out.push_back('\x00');
+            appendLE(out, static_cast<std::uint16_t>(dict.size()));
+            out += dict;
+            return out;
+        }
+
+        struct NpyLayout
+        {
+            std::uint32_t rows = 0;
+            std::uint32_t cols = 0;
+            bool swap = false;        // big-endian data
+            bool transpose = false;   // Fortran order with both extents > 1
+        };
+
+        template<typename T>
+        NpyLayout npyLayout(const NpyHeader& h, std::size_t imageSize)
+        {
+            using S = storage_of_t<T>;
+            NpyLayout l;
+
+            const std::string kind = npyKind<T>();
+            const char order = h.descr.empty() ? '\0' : h.descr[0];
+            const bool hasOrder = order == '<' || order == '>' || order == '|' || order == '=';
+            if (h.descr.compare(hasOrder ? 1 : 0, std::string::npos, kind) != 0)
+                npyError("dtype '" + h.descr + "' does not match the matrix type ('" + npyDescr<T>() + "')");
+            l.swap = order == '>' && sizeof(S) > 1;
+
+            std::uint64_t r = 1, c = 1;
+            if (h.shape.size() == 1) c = h.shape[0];
+            else if (h.shape.size() == 2) { r = h.shape[0]; c = h.shape[1]; }
+            else if (!h.shape.empty()) npyError(std::to_string(h.shape.size()) + "-d arrays are not supported");
+
+            constexpr std::uint64_t maxExtent = std::numeric_limits<std::uint32_t>::max();
+            if (r > maxExtent || c > maxExtent) npyError("shape exceeds the maximum matrix extent");
+            l.rows = static_cast<std::uint32_t>(r);
+            l.cols = static_cast<std::uint32_t>(c);
+            l.transpose = h.fortranOrder && r > 1 && c > 1;
+
+            const std::uint64_t bytes = r * c * sizeof(S);
+            if (r != 0 && bytes / r / sizeof(S) != c) npyError("shape overflow");
+            if (h.dataOffset > imageSize || bytes > imageSize - h.dataOffset) npyError("truncated data");
+            return l;
+        }
+
+        // dst (rows x cols, row-major) from column-major src bytes, in square tiles
+        // so both sides stay in cache. src may be unaligned.
+        template<typename S>
+        void transposeFromColumnMajor(const unsigned char* src, S* dst, std::size_t rows, std::size_t cols)
+        {
+            constexpr std::size_t tile = 64 / sizeof(S) < 8 ? 8 : 64 / sizeof(S) * 2;
+            const std::size_t rowTiles = (rows + tile - 1) / tile;
+            parallelFor(rowTiles, 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t rt = begin; rt < end; ++rt)
+                {
+                    const std::size_t r0 = rt * tile, r1 = std::min(rows, r0 + tile);
+                    for (std::size_t c0 = 0; c0 < cols; c0 += tile)
+                    {
+                        const std::size_t c1 = std::min(cols, c0 + tile);
+                        for (std::size_t r = r0; r < r1; ++r)
+                            for (std::size_t c = c0; c < c1; ++c)
+                                std::memcpy(dst + r * cols + c, src + (c * rows + r) * sizeof(S), sizeof(S));
+                    }
+                }
+            });
+        }
+
+        template<typename S>
+        void byteSwapCells(S* cells, std::size_t n) noexcept
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto b = reinterpret_cast<unsigned char*>(cells + i);
+                std::reverse(b, b + sizeof(S));
+            }
+        }
+
+        template<typename T>
+        Matrix<T> decodeNpy(const unsigned char* image, std::size_t size, const NpyHeader& h)
+        {
+            using S = storage_of_t<T>;
+            const NpyLayout l = npyLayout<T>(h, size);
+
+            Matrix<T> m(l.rows, l.cols);
+            if (m.empty()) return m;
+            S* dst = m.data_storage();
+            const unsigned char* src = image + h.dataOffset;
+            if (l.transpose)
+                transposeFromColumnMajor(src, dst, l.rows, l.cols);
+            else
+                std::memcpy(dst, src, m.size() * sizeof(S));
+            if (l.swap) byteSwapCells(dst, m.size());
+            return m;
+        }
+
+        // .npy image at [offset, offset + size) of a private mapping; shares the
+        // mapping when no conversion is needed.
+        template<typename T>
+        Matrix<T> npyFromMapping(const std::shared_ptr<MappedFile>& file, std::size_t offset, std::size_t size)
+        {
+            using S = storage_of_t<T>;
+            const auto image = reinterpret_cast<const unsigned char*>(file->data()) + offset;
+            const NpyHeader h = parseNpyHeader(image, size);
+            const NpyLayout l = npyLayout<T>(h, size);
+
+            const std::size_t count = static_cast<std::size_t>(l.rows) * l.cols;
+            char* cells = file->mutableData() + offset + h.dataOffset;
+            if (count == 0 || l.swap || l.transpose || reinterpret_cast<std::uintptr_t>(cells) % alignof(S) != 0)
+                return decodeNpy<T>(image, size, h);
+
+            std::shared_ptr<S[]> block(file, reinterpret_cast<S*>(cells));   // keeps the mapping alive
+            return Matrix<T>(l.rows, l.cols, SharedBuffer<S>(std::move(block), count));
+        }
+
+        // ---------------------------------------------------------------------
+        // Zip records
+        // ---------------------------------------------------------------------
+        constexpr std::uint32_t kZipLocalSig = 0x04034b50;
+        constexpr std::uint32_t kZipCentralSig = 0x02014b50;
+        constexpr std::uint32_t kZipEndSig = 0x06054b50;
+        constexpr std::uint32_t kZip64EndSig = 0x06064b50;
+        constexpr std::uint32_t kZip64LocatorSig = 0x07064b50;
+        constexpr std::uint16_t kZip64ExtraId = 0x0001;
+        constexpr std::uint16_t kZipPaddingExtraId = 0xB3A1;   // private: alignment filler
+        constexpr std::uint32_t kZip32Max = 0xFFFFFFFFu;
+        constexpr std::uint16_t kZipDosDate = 0x21;            // 1980-01-01
+    } // namespace detail
+
+    // =========================================================================
+    // .npy
+    // =========================================================================
+
+    template <typename T>
+    Matrix<T> parseNpy(const void* bytes, std::size_t size)
+    {
+        BML_PERF_SCOPE("parseNpy", T);
+        const auto image = static_cast<const unsigned char*>(bytes);
+        return detail::decodeNpy<T>(image, size, detail::parseNpyHeader(image, size));
+    }
+
+    template <typename T>
+    Matrix<T> loadNpy(const std::string& path)
+    {
+        const MappedFile file(path);
+        return parseNpy<T>(file.data(), file.size());
+    }
+
+    template <typename T>
+    Matrix<T> mapNpy(const std::string& path)
+    {
+        const auto file = std::make_shared<MappedFile>(path, MappedFile::Access::Private);
+        return detail::npyFromMapping<T>(file, 0, file->size());
+    }
+
+    template <typename T>
+    void writeNpy(const Matrix<T>& m, ByteSink& sink)
+    {
+        BML_PERF_SCOPE("writeNpy", T);
+        const std::string preamble = detail::npyPreamble<T>(m.numRows(), m.numCols());
+        sink.write(preamble.data(), preamble.size());
+        sink.write(m.data_storage(), m.size() * sizeof(typename Matrix<T>::storage_type));
+    }
+
+    template <typename T>
+    void saveNpy(const Matrix<T>& m, const std::string& path)
+    {
+        std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+        if (!file) throw std::runtime_error("saveNpy: cannot open '" + path + "' for writing.");
+        FileSink sink(file.get());
+        writeNpy(m, sink);
+        if (std::fclose(file.release()) != 0) throw std::runtime_error("saveNpy: cannot finish '" + path + "'.");
+    }
+
+    // =========================================================================
+    // .npz writer
+    // =========================================================================
+
+    NpzWriter::NpzWriter(const std::string& path)
+        : ownedFile(std::fopen(path.c_str(), "wb"))
+    {
+        if (!ownedFile) throw std::runtime_error("NpzWriter: cannot open '" + path + "' for writing.");
+        fileSink = std::make_unique<FileSink>(ownedFile);
+        sink = fileSink.get();
+    }
+
+    NpzWriter::NpzWriter(ByteSink& target) : sink(&target)
+    {
+    }
+
+    NpzWriter::~NpzWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+        if (ownedFile) std::fclose(ownedFile);
+    }
+
+    void NpzWriter::put(const void* bytes, std::size_t size)
+    {
+        sink->write(bytes, size);
+        written += size;
+    }
+
+    void NpzWriter::beginEntry(const std::string& name, std::uint32_t crc, std::uint64_t size)
+    {
+        using namespace detail;
+        if (closed) throw std::logic_error("NpzWriter: add() after close().");
+        if (name.empty()) throw std::invalid_argument("NpzWriter: empty array name.");
+
+        Entry e{name + ".npy", crc, size, written};
+        if (e.fileName.size() > 0xFFFF) throw std::invalid_argument("NpzWriter: array name too long.");
+
+        const bool zip64 = size >= kZip32Max;
+        std::string extra;
+        if (zip64)
+        {
+            appendLE(extra, kZip64ExtraId);
+            appendLE(extra, std::uint16_t{16});
+            appendLE(extra, size);   // uncompressed
+            appendLE(extra, size);   // compressed (stored)
+        }
+        const std::uint64_t dataStart = written + 30 + e.fileName.size() + extra.size();
+        std::size_t pad = static_cast<std::size_t>((kNpyAlign - dataStart % kNpyAlign) % kNpyAlign);
+        if (pad != 0 && pad < 4) pad += kNpyAlign;
+        if (pad != 0)
+        {
+            appendLE(extra, kZipPaddingExtraId);
+            appendLE(extra, static_cast<std::uint16_t>(pad - 4));
+            extra.append(pad - 4, '\0');
+        }
+
+        std::string header;
+        appendLE(header, kZipLocalSig);
+        appendLE(header, static_cast<std::uint16_t>(zip64 ? 45 : 20));   // version needed
+        appendLE(header, std::uint16_t{0});                 // flags
+        appendLE(header, std::uint16_t{0});                 // method: stored
+        appendLE(header, std::uint16_t{0});                 // time
+        appendLE(header, kZipDosDate);
+        appendLE(header, crc);
+        const std::uint32_t size32 = zip64 ? kZip32Max : static_cast<std::uint32_t>(size);
+        appendLE(header, size32);
+        appendLE(header, size32);
+        appendLE(header, static_cast<std::uint16_t>(e.fileName.size()));
+        appendLE(header, static_cast<std::uint16_t>(extra.size()));
+        header += e.fileName;
+        header += extra;
+        put(header.data(), header.size());
+
+        entries.push_back(std::move(e));
+    }
+
+    template <typename T>
+    void NpzWriter::add(const std::string& name, const Matrix<T>& m)
+    {
+        using S = typename Matrix<T>::storage_type;
+        const std::string preamble = detail::npyPreamble<T>(m.numRows(), m.numCols());
+        const std::size_t dataBytes = m.size() * sizeof(S);
+
+        std::uint32_t crc = detail::crc32Update(0, preamble.data(), preamble.size());
+        crc = detail::crc32Update(crc, m.data_storage(), dataBytes);
+
+        beginEntry(name, crc, preamble.size() + dataBytes);
+        put(preamble.data(), preamble.size());
+        put(m.data_storage(), dataBytes);
+    }
+
+    void NpzWriter::close()
+    {
+        using namespace detail;
+        if (closed) return;
+        closed = true;
+
+        const std::uint64_t centralStart = written;
+        for (const Entry& e : entries)
+        {
+            const bool bigSize = e.size >= kZip32Max;
+            const bool bigOffset = e.offset >= kZip32Max;
+            std::string extra;
+            if (bigSize || bigOffset)
+            {
+                appendLE(extra, kZip64ExtraId);
+                appendLE(extra, static_cast<std::uint16_t>((bigSize ? 16 : 0) + (bigOffset ? 8 : 0)));
+                if (bigSize)
+                {
+                    appendLE(extra, e.size);
+                    appendLE(extra, e.size);
+                }
+                if (bigOffset) appendLE(extra, e.offset);
+            }
+
+            std::string record;
+            appendLE(record, kZipCentralSig);
+            appendLE(record, static_cast<std::uint16_t>(extra.empty() ? 20 : 45));   // made by
+            appendLE(record, static_cast<std::uint16_t>(extra.empty() ? 20 : 45));   // needed
+            appendLE(record, std::uint16_t{0});
+            appendLE(record, std::uint16_t{0});
+            appendLE(record, std::uint16_t{0});
+            appendLE(record, kZipDosDate);
+            appendLE(record, e.crc);
+            const std::uint32_t size32 = bigSize ? kZip32Max : static_cast<std::uint32_t>(e.size);
+            appendLE(record, size32);
+            appendLE(record, size32);
+            appendLE(record, static_cast<std::uint16_t>(e.fileName.size()));
+            appendLE(record, static_cast<std::uint16_t>(extra.size()));
+            appendLE(record, std::uint16_t{0});   // comment
+            appendLE(record, std::uint16_t{0});   // disk
+            appendLE(record, std::uint16_t{0});   // internal attributes
+            appendLE(record, std::uint32_t{0});   // external attributes
+            appendLE(record, bigOffset ? kZip32Max : static_cast<std::uint32_t>(e.offset));
+            record += e.fileName;
+            record += extra;
+            put(record.data(), record.size());
+        }
+        const std::uint64_t centralSize = written - centralStart;
+
+        std::string tail;
+        const bool zip64 = entries.size() >= 0xFFFF || centralStart >= kZip32Max || centralSize >= kZip32Max;
+        if (zip64)
+        {
+            const std::uint64_t recordStart = written;
+            appendLE(tail, kZip64EndSig);
+            appendLE(tail, std::uint64_t{44});
+            appendLE(tail, std::uint16_t{45});
+            appendLE(tail, std::uint16_t{45});
+            appendLE(tail, std::uint32_t{0});
+            appendLE(tail, std::uint32_t{0});
+            appendLE(tail, static_cast<std::uint64_t>(entries.size()));
+            appendLE(tail, static_cast<std::uint64_t>(entries.size()));
+            appendLE(tail, centralSize);
+            appendLE(tail, centralStart);
+
+            appendLE(tail, kZip64LocatorSig);
+            appendLE(tail, std::uint32_t{0});
+            appendLE(tail, recordStart);
+            appendLE(tail, std::uint32_t{1});
+        }
+        const auto count16 = static_cast<std::uint16_t>(zip64 ? 0xFFFF : entries.size());
+        appendLE(tail, kZipEndSig);
+        appendLE(tail, std::uint16_t{0});
+        appendLE(tail, std::uint16_t{0});
+        appendLE(tail, count16);
+        appendLE(tail, count16);
+        appendLE(tail, zip64 ? kZip32Max : static_cast<std::uint32_t>(centralSize));
+        appendLE(tail, zip64 ? kZip32Max : static_cast<std::uint32_t>(centralStart));
+        appendLE(tail, std::uint16_t{0});
+        put(tail.data(), tail.size());
+
+        sink->flush();
+        if (ownedFile)
+        {
+            std::FILE* f = std::exchange(ownedFile, nullptr);
+            if (std::fclose(f) != 0) throw std::runtime_error("NpzWriter: cannot finish the archive.");
+        }
+    }
+
+    // =========================================================================
+    // .npz reader
+    // =========================================================================
+
+    NpzReader::NpzReader(const std::string& path)
+        : file(std::make_shared<MappedFile>(path, MappedFile::Access::Private))
+    {
+        using namespace detail;
+        const auto base = reinterpret_cast<const unsigned char*>(file->data());
+        const std::uint64_t size = file->size();
+        auto malformed = [&]() -> std::runtime_error {
+            return std::runtime_error("NpzReader: '" + path + "' is not a valid zip archive.");
+        };
+
+        // End of central directory: the last signature within the final 64 KiB + 22 bytes.
+        if (size < 22) throw malformed();
+        std::uint64_t end = size - 22;
+        const std::uint64_t floor = size > 0xFFFF + 22 ? size - 0xFFFF - 22 : 0;
+        while (readLE<std::uint32_t>(base + end) != kZipEndSig)
+        {
+            if (end == floor) throw malformed();
+            --end;
+        }
+
+        std::uint64_t count = readLE<std::uint16_t>(base + end + 10);
+        std::uint64_t centralSize = readLE<std::uint32_t>(base + end + 12);
+        std::uint64_t centralStart = readLE<std::uint32_t>(base + end + 16);
+        if (count == 0xFFFF || centralSize == kZip32Max || centralStart == kZip32Max)
+        {
+            if (end < 20 || readLE<std::uint32_t>(base + end - 20) != kZip64LocatorSig) throw malformed();
+            const std::uint64_t record = readLE<std::uint64_t>(base + end - 20 + 8);
+            if (record > size - 56 || readLE<std::uint32_t>(base + record) != kZip64EndSig) throw malformed();
+            count = readLE<std::uint64_t>(base + record + 32);
+            centralSize = readLE<std::uint64_t>(base + record + 40);
+            centralStart = readLE<std::uint64_t>(base + record + 48);
+        }
+        if (centralStart > size || centralSize > size - centralStart) throw malformed();
+
+        std::uint64_t at = centralStart;
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            if (at + 46 > size || readLE<std::uint32_t>(base + at) != kZipCentralSig) throw malformed();
+            const std::uint16_t method = readLE<std::uint16_t>(base + at + 10);
+            std::uint64_t stored = readLE<std::uint32_t>(base + at + 20);
+            std::uint64_t plain = readLE<std::uint32_t>(base + at + 24);
+            const std::size_t nameLen = readLE<std::uint16_t>(base + at + 28);
+            const std::size_t extraLen = readLE<std::uint16_t>(base + at + 30);
+            const std::size_t commentLen = readLE<std::uint16_t>(base + at + 32);
+            std::uint64_t local = readLE<std::uint32_t>(base + at + 42);
+            if (at + 46 + nameLen + extraLen + commentLen > size) throw malformed();
+
+            std::string name(reinterpret_cast<const char*>(base + at + 46), nameLen);
+            for (std::size_t x = 0; x + 4 <= extraLen; )
+            {
+                const unsigned char* field = base + at + 46 + nameLen + x;
+                const std::uint16_t id = readLE<std::uint16_t>(field);
+                const std::uint16_t len = readLE<std::uint16_t>(field + 2);
+                if (x + 4 + len > extraLen) throw malformed();
+                if (id == kZip64ExtraId)
+                {
+                    std::size_t f = 4;
+                    auto next = [&]() {
+                        if (f + 8 > 4u + len) throw malformed();
+                        const std::uint64_t v = readLE<std::uint64_t>(field + f);
+                        f += 8;
+                        return v;
+                    };
+                    if (plain == kZip32Max) plain = next();
+                    if (stored == kZip32Max) stored = next();
+                    if (local == kZip32Max) local = next();
+                }
+                x += 4 + len;
+            }
+            at += 46 + nameLen + extraLen + commentLen;
+
+            if (name.size() < 4 || name.compare(name.size() - 4, 4, ".npy") != 0) continue;
+            if (method != 0)
+                throw std::runtime_error("NpzReader: '" + name + "' is compressed; only stored .npz archives are supported.");
+
+            if (local + 30 > size || readLE<std::uint32_t>(base + local) != kZipLocalSig) throw malformed();
+            const std::uint64_t dataStart = local + 30 + readLE<std::uint16_t>(base + local + 26)
+                                          + readLE<std::uint16_t>(base + local + 28);
+            if (dataStart > size || stored > size - dataStart) throw malformed();
+
+            name.resize(name.size() - 4);
+            arrayNames.push_back(std::move(name));
+            entries.push_back({dataStart, stored});
+        }
+    }
+
+    bool NpzReader::contains(const std::string& name) const noexcept
+    {
+        return std::find(arrayNames.begin(), arrayNames.end(), name) != arrayNames.end();
+    }
+
+    const NpzReader::Entry& NpzReader::find(const std::string& name) const
+    {
+        const auto it = std::find(arrayNames.begin(), arrayNames.end(), name);
+        if (it == arrayNames.end()) throw std::out_of_range("NpzReader: no array named '" + name + "'.");
+        return entries[static_cast<std::size_t>(it - arrayNames.begin())];
+    }
+
+    template <typename T>
+    Matrix<T> NpzReader::get(const std::string& name) const
+    {
+        const Entry& e = find(name);
+        return detail::npyFromMapping<T>(file, static_cast<std::size_t>(e.offset), static_cast<std::size_t>(e.size));
+    }
+} // namespace bml
@@ -0,0 +1,232 @@
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bml
+{
+    namespace
+    {
+        // One parallelFor() call, shared between the caller and the workers that help with it.
+        struct Job
+        {
+            const std::function<void(std::size_t, std::size_t)>* body = nullptr;
+            std::size_t count = 0;
+            std::size_t blockSize = 0;
+            std::size_t blocks = 0;
+            std::atomic<std::size_t> next{0};
+            std::atomic<std::size_t> done{0};
+            std::mutex errorMutex;
+            std::exception_ptr error;
+#if defined(BML_PERF_COUNTERS) && BML_PERF_COUNTERS
+            const detail::PerfScope* perfScope = nullptr;   // caller's innermost counter scope, if any
+#endif
+        };
+
+        thread_local bool insideParallelRegion = false;
+
+        class ThreadPool
+        {
+        public:
+            explicit ThreadPool(std::size_t threads) { start(threads); }
+
+            ~ThreadPool() { stop(); }
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            [[nodiscard]] std::size_t threads() const noexcept { return workers.size() + 1; }
+
+            void resize(std::size_t threads)
+            {
+                stop();
+                start(threads);
+            }
+
+            void run(const std::shared_ptr<Job>& job)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    current = job;
+                    ++generation;
+                }
+                wake.notify_all();
+
+                work(*job, false);
+
+                std::unique_lock<std::mutex> lock(mutex);
+                finished.wait(lock, [&] { return job->done.load(std::memory_order_acquire) == job->blocks; });
+                current.reset();
+            }
+
+        private:
+            void start(std::size_t threads)
+            {
+                shuttingDown = false;
+                const std::size_t extra = threads > 1 ? threads - 1 : 0;
+                workers.reserve(extra);
+                for (std::size_t i = 0; i < extra; ++i)
+                    workers.emplace_back([this] { loop(); });
+            }
+
+            void stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    shuttingDown = true;
+                }
+                wake.notify_all();
+                for (std::thread& t : workers) t.join();
+                workers.clear();
+            }
+
+            void loop()
+            {
+                insideParallelRegion = true;
+                std::uint64_t seen = 0;
+                for (;;)
+                {
+                    std::shared_ptr<Job> job;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        wake.wait(lock, [&] { return shuttingDown || generation != seen; });
+                        if (shuttingDown) return;
+                        seen = generation;
+                        job = current;
+                    }
+                    if (job) work(*job, true);
+                }
+            }
+
+            void work(Job& job, [[maybe_unused]] bool worker)
+            {
+                for (;;)
+                {
+                    const std::size_t b = job.next.fetch_add(1, std::memory_order_relaxed);
+                    if (b >= job.blocks) return;
+
+                    const std::size_t begin = b * job.blockSize;
+                    const std::size_t end = std::min(job.count, begin + job.blockSize);
+                    try
+                    {
+#if defined(BML_PERF_COUNTERS) && BML_PERF_COUNTERS
+                        // Before the block counts as done: the caller's scopes end once all are.
+                        const detail::PerfWorkerScope counters(worker ? job.perfScope : nullptr);
+#endif
+                        (*job.body)(begin, end);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(job.errorMutex);
+                        if (!job.error) job.error = std::current_exception();
+                    }
+
+                    if (job.done.fetch_add(1, std::memory_order_acq_rel) + 1 == job.blocks)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        finished.notify_all();
+                    }
+                }
+            }
+
+            std::vector<std::thread> workers;
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::condition_variable finished;
+            std::shared_ptr<Job> current;
+            std::uint64_t generation = 0;
+            bool shuttingDown = false;
+        };
+
+        std::size_t detectParallelism() noexcept
+        {
+            if (const char* env = std::getenv("BML_NUM_THREADS"))
+            {
+                const long v = std::strtol(env, nullptr, 10);
+                if (v > 0) return static_cast<std::size_t>(v);
+            }
+            const unsigned hw = std::thread::hardware_concurrency();
+            return hw == 0 ? 1 : hw;
+        }
+
+        std::size_t defaultParallelism() noexcept
+        {
+            static const std::size_t detected = detectParallelism();
+            return detected;
+        }
+
+        std::mutex poolMutex;           // serialises parallelFor() calls from different threads
+        std::atomic<std::size_t> requestedThreads{0};
+
+        ThreadPool& pool()
+        {
+            static ThreadPool instance(defaultParallelism());
+            return instance;
+        }
+    } // namespace
+
+    std::size_t parallelism() noexcept
+    {
+        const std::size_t requested = requestedThreads.load(std::memory_order_relaxed);
+        return requested != 0 ? requested : defaultParallelism();
+    }
+
+    void setParallelism(std::size_t threads)
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        requestedThreads.store(threads, std::memory_order_relaxed);
+        pool().resize(parallelism());
+    }
+
+    void parallelFor(std::size_t count, std::size_t grain,
+                     const std::function<void(std::size_t, std::size_t)>& body)
+    {
+        if (count == 0) return;
+        if (grain == 0) grain = 1;
+
+        const std::size_t threads = parallelism();
+        const std::size_t maxBlocks = (count + grain - 1) / grain;
+        if (threads <= 1 || maxBlocks <= 1 || insideParallelRegion)
+        {
+            body(0, count);
+            return;
+        }
+
+        // A few blocks per thread smooths out uneven rows without much scheduling overhead.
+        const std::size_t blocks = std::min(maxBlocks, threads * 4);
+        auto job = std::make_shared<Job>();
+        job->body = &body;
+        job->count = count;
+        job->blockSize = (count + blocks - 1) / blocks;
+        job->blocks = (count + job->blockSize - 1) / job->blockSize;
+#if defined(BML_PERF_COUNTERS) && BML_PERF_COUNTERS
+        job->perfScope = detail::currentPerfScope();
+#endif
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            insideParallelRegion = true;
+            try
+            {
+                pool().run(job);
+            }
+            catch (...)
+            {
+                insideParallelRegion = false;
+                throw;
+            }
+            insideParallelRegion = false;
+        }
+
+        if (job->error) std::rethrow_exception(job->error);
+    }
+} // namespace bml
@@ -0,0 +1,353 @@
+#include "bml/perfCounters.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+namespace bml
+{
+    namespace detail
+    {
+        namespace
+        {
+            bool enabledFromEnvironment() noexcept
+            {
+#if defined(BML_PERF_COUNTERS) && BML_PERF_COUNTERS
+                const char* env = std::getenv("BML_PERF_COUNTERS");
+                return env != nullptr && std::strtol(env, nullptr, 10) != 0;
+#else
+                return false;
+#endif
+            }
+
+            std::uint64_t nowNs() noexcept
+            {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count());
+            }
+
+            // This thread's counters: one perf_event group, so all events are read with
+            // a single read() and are scheduled onto the PMU together. Opened on first use.
+            class CounterGroup
+            {
+            public:
+                CounterGroup() { slot.fill(-1); }
+
+                ~CounterGroup()
+                {
+#if defined(__linux__)
+                    for (std::size_t i = 0; i < opened; ++i) close(fds[i]);
+#endif
+                }
+
+                CounterGroup(const CounterGroup&) = delete;
+                CounterGroup& operator=(const CounterGroup&) = delete;
+
+                [[nodiscard]] bool available(PerfEvent e)
+                {
+                    open();
+                    return slot[static_cast<std::size_t>(e)] >= 0;
+                }
+
+                // Running totals of this thread's user-space events since the group was
+                // opened, scaled up if the kernel multiplexed the group with other users.
+                void read(std::array<std::uint64_t, kPerfEventCount>& out) noexcept
+                {
+                    out.fill(0);
+                    open();
+#if defined(__linux__)
+                    if (opened == 0) return;
+
+                    // PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING layout.
+                    std::uint64_t buffer[3 + kPerfEventCount];
+                    const ssize_t got = ::read(fds[0], buffer, sizeof(buffer));
+                    if (got < static_cast<ssize_t>(3 * sizeof(std::uint64_t))) return;
+
+                    const std::uint64_t count = buffer[0];
+                    const std::uint64_t enabled = buffer[1];
+                    const std::uint64_t running = buffer[2];
+                    if (running == 0) return;
+                    const double scale = running < enabled ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+
+                    for (std::size_t e = 0; e < kPerfEventCount; ++e)
+                    {
+                        const int s = slot[e];
+                        if (s < 0 || static_cast<std::uint64_t>(s) >= count) continue;
+                        const std::uint64_t raw = buffer[3 + s];
+                        out[e] = scale == 1.0 ? raw : static_cast<std::uint64_t>(static_cast<double>(raw) * scale);
+                    }
+#endif
+                }
+
+            private:
+                void open() noexcept
+                {
+                    if (tried) return;
+                    tried = true;
+#if defined(__linux__)
+                    constexpr auto cacheMiss = [](std::uint64_t cache) {
+                        return cache | (std::uint64_t{PERF_COUNT_HW_CACHE_OP_READ} << 8)
+                                     | (std::uint64_t{PERF_COUNT_HW_CACHE_RESULT_MISS} << 16);
+                    };
+                    const std::pair<std::uint32_t, std::uint64_t> events[kPerfEventCount] = {
+                        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                        {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+                        {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB)},
+                        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+                    };
+
+                    for (std::size_t e = 0; e < kPerfEventCount; ++e)
+                    {
+                        perf_event_attr attr;
+                        std::memset(&attr, 0, sizeof(attr));
+                        attr.size = sizeof(attr);
+                        attr.type = events[e].first;
+                        attr.config = events[e].second;
+                        attr.exclude_kernel = 1;
+                        attr.exclude_hv = 1;
+                        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                                           | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                        // The first event that opens leads the group; unsupported events are skipped.
+                        const int leader = opened == 0 ? -1 : fds[0];
+                        const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+                        if (fd < 0) continue;
+                        slot[e] = static_cast<int>(opened);
+                        fds[opened++] = static_cast<int>(fd);
+                    }
+#endif
+                }
+
+                std::array<int, kPerfEventCount> fds{};
+                std::array<int, kPerfEventCount> slot;   // position in the group read, -1 if not counted
+                std::size_t opened = 0;
+                bool tried = false;
+            };
+
+            CounterGroup& threadCounters()
+            {
+                thread_local CounterGroup group;
+                return group;
+            }
+
+            thread_local PerfScope* innermostScope = nullptr;
+
+            std::mutex& registryMutex()
+            {
+                static std::mutex m;
+                return m;
+            }
+
+            std::vector<PerfSite*>& registry()
+            {
+                static std::vector<PerfSite*> sites;
+                return sites;
+            }
+
+            void addEvents(PerfSite& site, const std::array<std::uint64_t, kPerfEventCount>& start,
+                           const std::array<std::uint64_t, kPerfEventCount>& end) noexcept
+            {
+                for (std::size_t e = 0; e < kPerfEventCount; ++e)
+                    if (end[e] > start[e])
+                        site.events[e].fetch_add(end[e] - start[e], std::memory_order_relaxed);
+            }
+        } // namespace
+
+        std::atomic<bool> perfEnabled{enabledFromEnvironment()};
+
+        void PerfScope::open(PerfSite& s) noexcept
+        {
+            site = &s;
+            outer = innermostScope;
+            innermostScope = this;
+            threadCounters().read(start);
+            startNs = nowNs();
+        }
+
+        void PerfScope::close() noexcept
+        {
+            const std::uint64_t endNs = nowNs();
+            std::array<std::uint64_t, kPerfEventCount> end;
+            threadCounters().read(end);
+
+            addEvents(*site, start, end);
+            site->nanoseconds.fetch_add(endNs - startNs, std::memory_order_relaxed);
+            site->calls.fetch_add(1, std::memory_order_relaxed);
+            innermostScope = outer;
+
+            if (!site->registered.exchange(true, std::memory_order_acq_rel))
+            {
+                try
+                {
+                    std::lock_guard<std::mutex> lock(registryMutex());
+                    registry().push_back(site);
+                }
+                catch (...)
+                {
+                    site->registered.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        const PerfScope* currentPerfScope() noexcept
+        {
+            return innermostScope;
+        }
+
+        PerfWorkerScope::PerfWorkerScope(const PerfScope* s) noexcept : scope(s)
+        {
+            if (scope) threadCounters().read(start);
+        }
+
+        PerfWorkerScope::~PerfWorkerScope()
+        {
+            if (!scope) return;
+            std::array<std::uint64_t, kPerfEventCount> end;
+            threadCounters().read(end);
+            for (const PerfScope* s = scope; s != nullptr; s = s->outer)
+                addEvents(*s->site, start, end);
+        }
+    } // namespace detail
+
+    const char* perfEventName(PerfEvent e) noexcept
+    {
+        switch (e)
+        {
+            case PerfEvent::Cycles: return "cycles";
+            case PerfEvent::Instructions: return "instructions";
+            case PerfEvent::LlcMisses: return "llc-misses";
+            case PerfEvent::DtlbMisses: return "dtlb-misses";
+            case PerfEvent::BranchMisses: return "branch-misses";
+        }
+        return "unknown";
+    }
+
+    bool perfCountersCompiledIn() noexcept
+    {
+#if defined(BML_PERF_COUNTERS) && BML_PERF_COUNTERS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool perfEventAvailable(PerfEvent e)
+    {
+        return detail::threadCounters().available(e);
+    }
+
+    void setPerfCountersEnabled(bool enabled) noexcept
+    {
+        detail::perfEnabled.store(enabled && perfCountersCompiledIn(), std::memory_order_relaxed);
+    }
+
+    bool perfCountersEnabled() noexcept
+    {
+        return detail::perfEnabled.load(std::memory_order_relaxed);
+    }
+
+    std::vector<PerfRecord> perfCounterSnapshot()
+    {
+        // Several call sites may report under the same (operation, type), e.g. the
+        // overloads of one operator; they are merged here.
+        std::map<std::pair<std::string, std::string>, PerfCounts> merged;
+        {
+            std::lock_guard<std::mutex> lock(detail::registryMutex());
+            for (const detail::PerfSite* site : detail::registry())
+            {
+                const std::uint64_t calls = site->calls.load(std::memory_order_relaxed);
+                if (calls == 0) continue;
+                PerfCounts& c = merged[{site->operation, site->type}];
+                c.calls += calls;
+                c.nanoseconds += site->nanoseconds.load(std::memory_order_relaxed);
+                for (std::size_t e = 0; e < kPerfEventCount; ++e)
+                    c.events[e] += site->events[e].load(std::memory_order_relaxed);
+            }
+        }
+
+        std::vector<PerfRecord> records;
+        records.reserve(merged.size());
+        for (auto& [key, counts] : merged)
+            records.push_back(PerfRecord{key.first, key.second, counts});
+        return records;
+    }
+
+    void resetPerfCounters() noexcept
+    {
+        std::lock_guard<std::mutex> lock(detail::registryMutex());
+        for (detail::PerfSite* site : detail::registry())
+        {
+            site->calls.store(0, std::memory_order_relaxed);
+            site->nanoseconds.store(0, std::memory_order_relaxed);
+            for (auto& e : site->events) e.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void dumpPerfCounters(std::ostream& out)
+    {
+        if (!perfCountersCompiledIn())
+        {
+            out << "perf counters: not compiled in (BML_ENABLE_PERF_COUNTERS=OFF)\n";
+            return;
+        }
+
+        std::array<bool, kPerfEventCount> counted;
+        for (std::size_t e = 0; e < kPerfEventCount; ++e)
+            counted[e] = perfEventAvailable(static_cast<PerfEvent>(e));
+
+        const std::vector<PerfRecord> records = perfCounterSnapshot();
+        std::size_t opWidth = 9;
+        for (const PerfRecord& r : records) opWidth = std::max(opWidth, r.operation.size());
+
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-*s %-11s %10s %12s %10s", static_cast<int>(opWidth),
+                      "operation", "type", "calls", "total_ms", "us/call");
+        out << line;
+        for (std::size_t e = 0; e < kPerfEventCount; ++e)
+        {
+            std::snprintf(line, sizeof(line), " %14s", perfEventName(static_cast<PerfEvent>(e)));
+            out << line;
+        }
+        out << "    IPC\n";
+
+        for (const PerfRecord& r : records)
+        {
+            const PerfCounts& c = r.counts;
+            const double ms = static_cast<double>(c.nanoseconds) / 1e6;
+            std::snprintf(line, sizeof(line), "%-*s %-11s %10llu %12.3f %10.3f", static_cast<int>(opWidth),
+                          r.operation.c_str(), r.type.c_str(), static_cast<unsigned long long>(c.calls), ms,
+                          ms * 1e3 / static_cast<double>(c.calls));
+            out << line;
+            for (std::size_t e = 0; e < kPerfEventCount; ++e)
+            {
+                if (counted[e])
+                    std::snprintf(line, sizeof(line), " %14llu", static_cast<unsigned long long>(c.events[e]));
+                else
+                    std::snprintf(line, sizeof(line), " %14s", "-");
+                out << line;
+            }
+            const std::uint64_t cycles = c[PerfEvent::Cycles];
+            if (counted[0] && counted[1] && cycles != 0)
+                std::snprintf(line, sizeof(line), " %6.2f\n",
+                              static_cast<double>(c[PerfEvent::Instructions]) / static_cast<double>(cycles));
+            else
+                std::snprintf(line, sizeof(line), " %6s\n", "-");
+            out << line;
+        }
+        if (records.empty())
+            out << "(no instrumented operations recorded" << (perfCountersEnabled() ? ")\n" : "; counters are disabled)\n");
+    }
+} // namespace bml
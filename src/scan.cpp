@@ -0,0 +1,427 @@
+#include "bml/scan.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+#include "bml/trace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Rows scanned side by side by a row scan; their additions do not depend on each other.
+        // More lanes put too many streams in one cache set when the row length is a power of two.
+        constexpr std::size_t kScanLanes = 4;
+
+        // Columns per task of a column scan.
+        constexpr std::size_t kScanStrip = 512;
+
+        // Cells per task below which scans stay on the calling thread, and the smallest
+        // chunk a long line is split into.
+        constexpr std::size_t kScanGrainCells = std::size_t{1} << 15;
+
+        // a + b, wrapping for integers (the tables are meant to be used modulo 2^64).
+        template<typename A>
+        inline A scanAdd(A a, A b) noexcept
+        {
+            if constexpr (std::is_integral_v<A>)
+            {
+                using U = std::make_unsigned_t<A>;
+                return static_cast<A>(static_cast<U>(a) + static_cast<U>(b));
+            }
+            else
+            {
+                return a + b;
+            }
+        }
+
+        template<typename A>
+        inline A scanSub(A a, A b) noexcept
+        {
+            if constexpr (std::is_integral_v<A>)
+            {
+                using U = std::make_unsigned_t<A>;
+                return static_cast<A>(static_cast<U>(a) - static_cast<U>(b));
+            }
+            else
+            {
+                return a - b;
+            }
+        }
+
+        // Running sum of one line; when compensated the exact value is about sum + err.
+        template<typename A>
+        struct ScanCarry
+        {
+            A sum{};
+            A err{};
+        };
+
+        // carry += v + verr in double-word arithmetic: Knuth's branch-free TwoSum, then a
+        // renormalization that keeps |err| within half an ulp of sum. Neither operand
+        // has to dominate, which the table's corner differences rely on.
+        template<typename A>
+        inline void compensatedAdd(ScanCarry<A>& carry, A v, A verr) noexcept
+        {
+            const A t = carry.sum + v;
+            const A bv = t - carry.sum;
+            const A e = ((carry.sum - (t - bv)) + (v - bv)) + (carry.err + verr);
+            carry.sum = t + e;
+            carry.err = e - (carry.sum - t);
+        }
+
+        // carry += v; interleaved lines and neighbouring columns still run in lockstep.
+        template<bool Compensated, typename A>
+        inline void scanStep(ScanCarry<A>& carry, A v) noexcept
+        {
+            if constexpr (Compensated) compensatedAdd(carry, v, A{0});
+            else carry.sum = scanAdd(carry.sum, v);
+        }
+
+        // carry += the whole of another carry (the total of an earlier chunk).
+        template<bool Compensated, typename A>
+        inline void scanMerge(ScanCarry<A>& carry, const ScanCarry<A>& more) noexcept
+        {
+            if constexpr (Compensated) compensatedAdd(carry, more.sum, more.err);
+            else carry.sum = scanAdd(carry.sum, more.sum);
+        }
+
+        template<bool Compensated, typename A>
+        inline A scanValue(const ScanCarry<A>& carry) noexcept
+        {
+            if constexpr (Compensated) return carry.sum + carry.err;
+            else return carry.sum;
+        }
+
+        // What a kernel writes: nothing (chunk totals only), or the inclusive/exclusive sums.
+        enum class ScanOut
+        {
+            None,
+            Inclusive,
+            Exclusive
+        };
+
+        // L consecutive rows from row r, columns [c0, c1), continuing the carries of those
+        // rows in sum[0..L) and err[0..L).
+        template<std::size_t L, bool Compensated, ScanOut Out, typename T, typename A>
+        inline void scanRowGroup(const T* src, A* dst, std::size_t cols, std::size_t r,
+                                 std::size_t c0, std::size_t c1, A* sum, A* err) noexcept
+        {
+            ScanCarry<A> lane[L];
+            for (std::size_t q = 0; q < L; ++q) lane[q] = {sum[q], err[q]};
+            const T* in = src + r * cols;
+            for (std::size_t j = c0; j < c1; ++j)
+            {
+                for (std::size_t q = 0; q < L; ++q)
+                {
+                    const A v = static_cast<A>(in[q * cols + j]);
+                    if constexpr (Out == ScanOut::Exclusive) dst[(r + q) * cols + j] = scanValue<Compensated>(lane[q]);
+                    scanStep<Compensated>(lane[q], v);
+                    if constexpr (Out == ScanOut::Inclusive) dst[(r + q) * cols + j] = scanValue<Compensated>(lane[q]);
+                }
+            }
+            for (std::size_t q = 0; q < L; ++q)
+            {
+                sum[q] = lane[q].sum;
+                err[q] = lane[q].err;
+            }
+        }
+
+        // Rows [r0, r1), columns [c0, c1), continuing the carry of column j in sum[j - c0] and
+        // err[j - c0]. Separate arrays keep the loop over j unit-stride, so it vectorizes.
+        template<bool Compensated, ScanOut Out, typename T, typename A>
+        void scanColsKernel(const T* src, A* dst, std::size_t cols, std::size_t r0, std::size_t r1,
+                            std::size_t c0, std::size_t c1, A* sum, A* err) noexcept
+        {
+            const std::size_t n = c1 - c0;
+            for (std::size_t i = r0; i < r1; ++i)
+            {
+                const T* in = src + i * cols + c0;
+                A* out = Out == ScanOut::None ? nullptr : dst + i * cols + c0;
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    ScanCarry<A> c{sum[j], err[j]};
+                    if constexpr (Out == ScanOut::Exclusive) out[j] = scanValue<Compensated>(c);
+                    scanStep<Compensated>(c, static_cast<A>(in[j]));
+                    if constexpr (Out == ScanOut::Inclusive) out[j] = scanValue<Compensated>(c);
+                    sum[j] = c.sum;
+                    if constexpr (Compensated) err[j] = c.err;
+                }
+            }
+        }
+
+        // Replace each chunk total by the sum of the chunks before it; chunk k of line l is
+        // at sum/err[l * lineStep + k * chunkStep].
+        template<bool Compensated, typename A>
+        void scanChunkOffsets(A* sum, A* err, std::size_t lines, std::size_t lineStep,
+                              std::size_t chunks, std::size_t chunkStep) noexcept
+        {
+            for (std::size_t l = 0; l < lines; ++l)
+            {
+                ScanCarry<A> running{};
+                for (std::size_t k = 0; k < chunks; ++k)
+                {
+                    const std::size_t at = l * lineStep + k * chunkStep;
+                    const ScanCarry<A> total{sum[at], err[at]};
+                    sum[at] = running.sum;
+                    err[at] = running.err;
+                    scanMerge<Compensated>(running, total);
+                }
+            }
+        }
+
+        template<bool Compensated, ScanOut Out, typename T, typename A>
+        void scanAlongRows(const T* src, A* dst, std::size_t rows, std::size_t cols)
+        {
+            const std::size_t threads = parallelism();
+            const std::size_t chunks = rows >= threads ? 1 : std::min(threads, cols / kScanGrainCells);
+            if (chunks <= 1)
+            {
+                const std::size_t groups = (rows + kScanLanes - 1) / kScanLanes;
+                const std::size_t grain = std::max<std::size_t>(1, kScanGrainCells / (cols * kScanLanes));
+                parallelFor(groups, grain, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t g = begin; g < end; ++g)
+                    {
+                        A sum[kScanLanes] = {};
+                        A err[kScanLanes] = {};
+                        const std::size_t r = g * kScanLanes;
+                        if (r + kScanLanes <= rows)
+                        {
+                            scanRowGroup<kScanLanes, Compensated, Out>(src, dst, cols, r, 0, cols, sum, err);
+                            continue;
+                        }
+                        for (std::size_t q = r; q < rows; ++q)
+                            scanRowGroup<1, Compensated, Out>(src, dst, cols, q, 0, cols, sum + (q - r), err + (q - r));
+                    }
+                });
+                return;
+            }
+
+            // Few long rows: total every chunk, then rescan each chunk from the sum of those before it.
+            const std::size_t width = (cols + chunks - 1) / chunks;
+            std::vector<A> sum(rows * chunks), err(rows * chunks);
+            auto chunkPass = [&](auto out) {
+                constexpr ScanOut Pass = decltype(out)::value;
+                parallelFor(rows * chunks, 1, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t t = begin; t < end; ++t)
+                    {
+                        const std::size_t c0 = std::min(cols, (t % chunks) * width);
+                        const std::size_t c1 = std::min(cols, c0 + width);
+                        scanRowGroup<1, Compensated, Pass>(src, dst, cols, t / chunks, c0, c1, &sum[t], &err[t]);
+                    }
+                });
+            };
+            chunkPass(std::integral_constant<ScanOut, ScanOut::None>());
+            scanChunkOffsets<Compensated>(sum.data(), err.data(), rows, chunks, chunks, 1);
+            chunkPass(std::integral_constant<ScanOut, Out>());
+        }
+
+        template<bool Compensated, ScanOut Out, typename T, typename A>
+        void scanAlongCols(const T* src, A* dst, std::size_t rows, std::size_t cols)
+        {
+            const std::size_t threads = parallelism();
+            const std::size_t strips = (cols + kScanStrip - 1) / kScanStrip;
+            const std::size_t chunks = strips >= threads ? 1 : std::min(threads, rows * cols / kScanGrainCells);
+            if (chunks <= 1)
+            {
+                const std::size_t grain = std::max<std::size_t>(1, kScanGrainCells / (rows * kScanStrip));
+                parallelFor(strips, grain, [&](std::size_t begin, std::size_t end) {
+                    std::vector<A> sum(kScanStrip), err(kScanStrip);
+                    for (std::size_t s = begin; s < end; ++s)
+                    {
+                        std::fill(sum.begin(), sum.end(), A{0});
+                        std::fill(err.begin(), err.end(), A{0});
+                        const std::size_t c0 = s * kScanStrip;
+                        scanColsKernel<Compensated, Out>(src, dst, cols, 0, rows, c0,
+                                                         std::min(cols, c0 + kScanStrip), sum.data(), err.data());
+                    }
+                });
+                return;
+            }
+
+            // Few columns: split the rows into chunks instead, as scanAlongRows() does.
+            const std::size_t height = (rows + chunks - 1) / chunks;
+            std::vector<A> sum(chunks * cols), err(chunks * cols);
+            auto chunkPass = [&](auto out) {
+                constexpr ScanOut Pass = decltype(out)::value;
+                parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t k = begin; k < end; ++k)
+                    {
+                        const std::size_t r0 = std::min(rows, k * height);
+                        scanColsKernel<Compensated, Pass>(src, dst, cols, r0, std::min(rows, r0 + height), 0, cols,
+                                                          &sum[k * cols], &err[k * cols]);
+                    }
+                });
+            };
+            chunkPass(std::integral_constant<ScanOut, ScanOut::None>());
+            scanChunkOffsets<Compensated>(sum.data(), err.data(), cols, 1, chunks, cols);
+            chunkPass(std::integral_constant<ScanOut, Out>());
+        }
+
+        template<bool Compensated, ScanOut Out, typename T, typename A>
+        void scanMatrix(const T* src, A* dst, std::size_t rows, std::size_t cols, ScanAxis axis)
+        {
+            if (axis == ScanAxis::Rows) scanAlongRows<Compensated, Out>(src, dst, rows, cols);
+            else scanAlongCols<Compensated, Out>(src, dst, rows, cols);
+        }
+
+        template<typename T>
+        Matrix<scan_accumulator_t<T>> scan(const Matrix<T>& m, ScanAxis axis, Summation summation, bool exclusive)
+        {
+            using A = scan_accumulator_t<T>;
+            Matrix<A> out(m.numRows(), m.numCols());
+            if (m.numRows() == 0 || m.numCols() == 0) return out;
+
+            const T* src = m.data_storage();
+            A* dst = out.data_storage();
+            const std::size_t rows = m.numRows();
+            const std::size_t cols = m.numCols();
+            if constexpr (std::is_floating_point_v<A>)
+            {
+                if (summation == Summation::Compensated)
+                {
+                    if (exclusive) scanMatrix<true, ScanOut::Exclusive>(src, dst, rows, cols, axis);
+                    else scanMatrix<true, ScanOut::Inclusive>(src, dst, rows, cols, axis);
+                    return out;
+                }
+            }
+            if (exclusive) scanMatrix<false, ScanOut::Exclusive>(src, dst, rows, cols, axis);
+            else scanMatrix<false, ScanOut::Inclusive>(src, dst, rows, cols, axis);
+            return out;
+        }
+    } // namespace detail
+
+    template<typename T>
+    Matrix<scan_accumulator_t<T>> inclusiveScan(const Matrix<T>& m, ScanAxis axis, Summation summation)
+    {
+        BML_PERF_SCOPE("inclusiveScan", T);
+        BML_TRACE_SCOPE("inclusiveScan", T, m.numRows(), m.numCols(), m.size() * (sizeof(T) + sizeof(scan_accumulator_t<T>)));
+        return detail::scan(m, axis, summation, false);
+    }
+
+    template<typename T>
+    Matrix<scan_accumulator_t<T>> exclusiveScan(const Matrix<T>& m, ScanAxis axis, Summation summation)
+    {
+        BML_PERF_SCOPE("exclusiveScan", T);
+        BML_TRACE_SCOPE("exclusiveScan", T, m.numRows(), m.numCols(), m.size() * (sizeof(T) + sizeof(scan_accumulator_t<T>)));
+        return detail::scan(m, axis, summation, true);
+    }
+
+    // ---------- SummedAreaTable ----------
+    template<typename T>
+    SummedAreaTable<T>::SummedAreaTable(const Matrix<T>& m, Summation summation)
+        : rows(m.numRows()), cols(m.numCols())
+    {
+        BML_PERF_SCOPE("SummedAreaTable", T);
+        BML_TRACE_SCOPE("SummedAreaTable", T, rows, cols, m.size() * (sizeof(T) + sizeof(value_type)));
+        using A = value_type;
+        const std::size_t stride = static_cast<std::size_t>(cols) + 1;
+        const bool compensated = std::is_floating_point_v<A> && summation == Summation::Compensated;
+        hi.assign((static_cast<std::size_t>(rows) + 1) * stride, A{0});
+        if (compensated) lo.assign(hi.size(), A{0});
+        if (rows == 0 || cols == 0) return;
+
+        const T* src = m.data_storage();
+        A* sums = hi.data();
+        A* errs = lo.data();
+
+        // Pass 1: prefix sums of each row into rows 1.. of the table (column 0 stays 0).
+        parallelFor(rows, std::max<std::size_t>(1, detail::kScanGrainCells / cols), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const T* in = src + i * cols;
+                A* out = sums + (i + 1) * stride + 1;
+                detail::ScanCarry<A> carry{};
+                if (compensated)
+                {
+                    A* outErr = errs + (i + 1) * stride + 1;
+                    for (std::size_t j = 0; j < cols; ++j)
+                    {
+                        detail::scanStep<true>(carry, static_cast<A>(in[j]));
+                        out[j] = carry.sum;
+                        outErr[j] = carry.err;
+                    }
+                }
+                else
+                {
+                    for (std::size_t j = 0; j < cols; ++j)
+                    {
+                        detail::scanStep<false>(carry, static_cast<A>(in[j]));
+                        out[j] = carry.sum;
+                    }
+                }
+            }
+        });
+
+        // Pass 2: add each table row to the one below, a strip of columns per task.
+        const std::size_t strips = (stride + detail::kScanStrip - 1) / detail::kScanStrip;
+        parallelFor(strips, std::max<std::size_t>(1, detail::kScanGrainCells / (rows * detail::kScanStrip)),
+                    [&](std::size_t begin, std::size_t end) {
+            for (std::size_t s = begin; s < end; ++s)
+            {
+                const std::size_t c0 = s * detail::kScanStrip;
+                const std::size_t c1 = std::min(stride, c0 + detail::kScanStrip);
+                for (std::size_t i = 2; i <= rows; ++i)
+                {
+                    const A* above = sums + (i - 1) * stride;
+                    A* row = sums + i * stride;
+                    if (compensated)
+                    {
+                        const A* aboveErr = errs + (i - 1) * stride;
+                        A* rowErr = errs + i * stride;
+                        for (std::size_t j = c0; j < c1; ++j)
+                        {
+                            detail::ScanCarry<A> carry{row[j], rowErr[j]};
+                            detail::compensatedAdd(carry, above[j], aboveErr[j]);
+                            row[j] = carry.sum;
+                            rowErr[j] = carry.err;
+                        }
+                    }
+                    else
+                    {
+                        for (std::size_t j = c0; j < c1; ++j) row[j] = detail::scanAdd(row[j], above[j]);
+                    }
+                }
+            }
+        });
+    }
+
+    template<typename T>
+    typename SummedAreaTable<T>::value_type
+    SummedAreaTable<T>::rectSum(std::uint32_t r0, std::uint32_t c0, std::uint32_t r1, std::uint32_t c1) const
+    {
+        if (r1 > rows) throw std::out_of_range("row range");
+        if (c1 > cols) throw std::out_of_range("col range");
+        if (r0 > r1)   throw std::out_of_range("startRow > endRow");
+        if (c0 > c1)   throw std::out_of_range("startCol > endCol");
+
+        const std::size_t stride = static_cast<std::size_t>(cols) + 1;
+        const std::size_t a = r0 * stride + c0;   // above-left
+        const std::size_t b = r0 * stride + c1;   // above-right
+        const std::size_t c = r1 * stride + c0;   // below-left
+        const std::size_t d = r1 * stride + c1;   // below-right
+        if constexpr (std::is_floating_point_v<value_type>)
+        {
+            if (!lo.empty())
+            {
+                // d - b + a - c on (hi, lo) pairs; the large parts cancel exactly.
+                detail::ScanCarry<value_type> carry{hi[d], lo[d]};
+                detail::compensatedAdd(carry, -hi[b], -lo[b]);
+                detail::compensatedAdd(carry, hi[a], lo[a]);
+                detail::compensatedAdd(carry, -hi[c], -lo[c]);
+                return detail::scanValue<true>(carry);
+            }
+        }
+        return detail::scanAdd(detail::scanSub(hi[d], hi[b]), detail::scanSub(hi[a], hi[c]));
+    }
+
+    template<typename T>
+    typename SummedAreaTable<T>::value_type SummedAreaTable<T>::total() const noexcept
+    {
+        const std::size_t last = hi.size() - 1;
+        return lo.empty() ? hi[last] : static_cast<value_type>(hi[last] + lo[last]);
+    }
+} // namespace bml
@@ -0,0 +1,110 @@
+#include "bml/sink.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_WIN32)
+  #include <io.h>
+#else
+  #include <climits>
+  #include <sys/uio.h>
+  #include <unistd.h>
+#endif
+
+namespace bml
+{
+    FileSink::FileSink(std::FILE* file_) : file(file_)
+    {
+        if (!file) throw std::invalid_argument("FileSink: null FILE*.");
+    }
+
+    void FileSink::write(const void* bytes, std::size_t size)
+    {
+        if (size == 0) return;
+        if (std::fwrite(bytes, 1, size, file) != size)
+            throw std::runtime_error("FileSink: write failed.");
+    }
+
+    void FileSink::flush()
+    {
+        if (std::fflush(file) != 0)
+            throw std::runtime_error("FileSink: flush failed.");
+    }
+
+    FdSink::FdSink(int fd_) : fd(fd_)
+    {
+        if (fd < 0) throw std::invalid_argument("FdSink: invalid file descriptor.");
+    }
+
+    void FdSink::write(const void* bytes, std::size_t size)
+    {
+        auto p = static_cast<const char*>(bytes);
+        while (size > 0)
+        {
+#if defined(_WIN32)
+            const unsigned step = size > (1u << 30) ? (1u << 30) : static_cast<unsigned>(size);
+            const int n = ::_write(fd, p, step);
+#else
+            const ::ssize_t n = ::write(fd, p, size);
+#endif
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("FdSink: write failed: ") + std::strerror(errno));
+            }
+            p += n;
+            size -= static_cast<std::size_t>(n);
+        }
+    }
+
+    void FdSink::writeGather(const ByteSpan* spans, std::size_t count)
+    {
+#if defined(_WIN32)
+        ByteSink::writeGather(spans, count);
+#else
+  #if defined(IOV_MAX)
+        constexpr std::size_t maxIov = IOV_MAX;
+  #else
+        constexpr std::size_t maxIov = 1024;
+  #endif
+        ::iovec iov[64];
+        constexpr std::size_t batch = sizeof iov / sizeof iov[0] < maxIov ? sizeof iov / sizeof iov[0] : maxIov;
+
+        std::size_t next = 0;        // first span not yet queued
+        std::size_t skip = 0;        // bytes of spans[next] already written
+        while (next < count)
+        {
+            std::size_t n = 0;
+            for (std::size_t i = next; i < count && n < batch; ++i, ++n)
+            {
+                const std::size_t offset = i == next ? skip : 0;
+                iov[n].iov_base = const_cast<char*>(static_cast<const char*>(spans[i].data) + offset);
+                iov[n].iov_len = spans[i].size - offset;
+            }
+
+            ::ssize_t done = ::writev(fd, iov, static_cast<int>(n));
+            if (done < 0)
+            {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("FdSink: write failed: ") + std::strerror(errno));
+            }
+
+            // Advance past fully written spans, remember how far into the next one we got.
+            auto left = static_cast<std::size_t>(done);
+            while (next < count && left >= spans[next].size - skip)
+            {
+                left -= spans[next].size - skip;
+                skip = 0;
+                ++next;
+            }
+            skip += left;
+        }
+#endif
+    }
+
+    void StringSink::write(const void* bytes, std::size_t size)
+    {
+        out.append(static_cast<const char*>(bytes), size);
+    }
+} // namespace bml
@@ -0,0 +1,59 @@
+#include "bml/source.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+namespace bml
+{
+    FileSource::FileSource(std::FILE* file_) : file(file_)
+    {
+        if (!file) throw std::invalid_argument("FileSource: null FILE*.");
+    }
+
+    std::size_t FileSource::read(void* dst, std::size_t maxBytes)
+    {
+        const std::size_t n = std::fread(dst, 1, maxBytes, file);
+        if (n == 0 && maxBytes != 0 && std::ferror(file))
+            throw std::runtime_error("FileSource: read failed.");
+        return n;
+    }
+
+    FdSource::FdSource(int fd_) : fd(fd_)
+    {
+        if (fd < 0) throw std::invalid_argument("FdSource: invalid file descriptor.");
+    }
+
+    std::size_t FdSource::read(void* dst, std::size_t maxBytes)
+    {
+        for (;;)
+        {
+#if defined(_WIN32)
+            const unsigned step = maxBytes > (1u << 30) ? (1u << 30) : static_cast<unsigned>(maxBytes);
+            const int n = ::_read(fd, dst, step);
+#else
+            const ::ssize_t n = ::read(fd, dst, maxBytes);
+#endif
+            if (n >= 0) return static_cast<std::size_t>(n);
+            if (errno != EINTR)
+                throw std::runtime_error(std::string("FdSource: read failed: ") + std::strerror(errno));
+        }
+    }
+
+    std::size_t MemorySource::read(void* dst, std::size_t maxBytes)
+    {
+        const std::size_t n = std::min(maxBytes, remaining);
+        if (n) std::memcpy(dst, p, n);
+        p += n;
+        remaining -= n;
+        return n;
+    }
+} // namespace bml
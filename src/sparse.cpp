@@ -0,0 +1,704 @@
+#include "bml/sparse.hpp"
+#include "bml/parallel.hpp"
+#include "bml/perfCounters.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bml
+{
+    namespace detail
+    {
+        // Stored entries one parallel block should touch, and the reduction chunk
+        // (fixed, so sums do not depend on the thread count).
+        constexpr std::size_t kSparseGrainEntries = std::size_t{1} << 14;
+        constexpr std::size_t kSparseReduceChunk = std::size_t{1} << 16;
+
+        inline std::size_t sparseGrain(std::size_t outer, std::size_t entries, std::size_t workPerEntry = 1) noexcept
+        {
+            const std::size_t perOuter = (entries / std::max<std::size_t>(outer, 1) + 1) * workPerEntry;
+            return std::max<std::size_t>(1, kSparseGrainEntries / perOuter);
+        }
+
+        // offsets[i + 1] holds the count of slot i on entry and its end on return.
+        inline void countsToOffsets(std::vector<std::size_t>& offsets)
+        {
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        }
+
+        template<typename T>
+        T sparseAbs(T v) noexcept
+        {
+            if constexpr (std::is_unsigned_v<T>) return v;
+            else return v < T{0} ? static_cast<T>(-v) : v;
+        }
+
+        // Running sum; Kahan-compensated for floating point like Matrix::sum().
+        template<typename T>
+        struct SparseSum
+        {
+            T s{0};
+            T c{0};
+
+            void add(T v) noexcept
+            {
+                if constexpr (std::is_floating_point_v<T>)
+                {
+                    const T y = v - c;
+                    const T t = s + y;
+                    c = (t - s) - y;
+                    s = t;
+                }
+                else
+                {
+                    s += v;
+                }
+            }
+        };
+
+        // Per-slot sums along the compressed dimension: independent, so split across threads.
+        template<typename T>
+        std::vector<T> outerSums(const std::vector<std::size_t>& starts, const std::vector<T>& vals)
+        {
+            const std::size_t outer = starts.size() - 1;
+            std::vector<T> sums(outer, T{0});
+            parallelFor(outer, sparseGrain(outer, vals.size()), [&](std::size_t begin, std::size_t end) {
+                for (std::size_t o = begin; o < end; ++o)
+                {
+                    SparseSum<T> acc;
+                    for (std::size_t k = starts[o]; k < starts[o + 1]; ++k) acc.add(vals[k]);
+                    sums[o] = acc.s;
+                }
+            });
+            return sums;
+        }
+
+        // Sums along the other dimension: a scatter, done in one pass on the calling thread.
+        template<typename T>
+        std::vector<T> innerSums(const std::vector<std::uint32_t>& inner, const std::vector<T>& vals, std::size_t n)
+        {
+            std::vector<SparseSum<T>> acc(n);
+            for (std::size_t k = 0; k < vals.size(); ++k) acc[inner[k]].add(vals[k]);
+            std::vector<T> sums(n);
+            for (std::size_t i = 0; i < n; ++i) sums[i] = acc[i].s;
+            return sums;
+        }
+
+        constexpr SparseLayout otherLayout(SparseLayout layout) noexcept
+        {
+            return layout == SparseLayout::CSR ? SparseLayout::CSC : SparseLayout::CSR;
+        }
+    }
+
+    // ======================= SparseMatrix =======================
+
+    template<typename T>
+    SparseMatrix<T>::SparseMatrix(std::uint32_t numRows, std::uint32_t numCols, SparseLayout layout)
+        : rows(numRows), cols(numCols), order(layout), starts(outerSize() + 1, 0)
+    {
+    }
+
+    template<typename T>
+    SparseMatrix<T>::SparseMatrix(std::uint32_t numRows, std::uint32_t numCols, SparseLayout layout,
+                                  std::vector<std::size_t> offsets, std::vector<std::uint32_t> indices,
+                                  std::vector<T> values)
+        : rows(numRows), cols(numCols), order(layout),
+          starts(std::move(offsets)), inner(std::move(indices)), vals(std::move(values))
+    {
+        const std::size_t outer = outerSize();
+        if (starts.size() != outer + 1 || starts.front() != 0 || starts.back() != inner.size()
+            || inner.size() != vals.size())
+            throw std::invalid_argument("SparseMatrix: offsets, indices and values are inconsistent.");
+
+        for (std::size_t o = 0; o < outer; ++o)
+        {
+            if (starts[o] > starts[o + 1])
+                throw std::invalid_argument("SparseMatrix: offsets must not decrease.");
+            for (std::size_t k = starts[o]; k < starts[o + 1]; ++k)
+                if (inner[k] >= innerSize() || (k > starts[o] && inner[k] <= inner[k - 1]))
+                    throw std::invalid_argument("SparseMatrix: indices must be in range and increasing within each row or column.");
+        }
+    }
+
+    template<typename T>
+    SparseMatrix<T>::SparseMatrix(const Matrix<T>& dense, SparseLayout layout)
+        : SparseMatrix(dense.numRows(), dense.numCols(), SparseLayout::CSR)
+    {
+        const T* cells = dense.data_storage();
+        const std::size_t width = cols;
+        const std::size_t grain = std::max<std::size_t>(1, detail::kSparseGrainEntries / std::max<std::size_t>(width, 1));
+
+        parallelFor(rows, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; ++r)
+            {
+                const T* row = cells + r * width;
+                starts[r + 1] = static_cast<std::size_t>(std::count_if(row, row + width, [](T v) { return v != T{0}; }));
+            }
+        });
+        detail::countsToOffsets(starts);
+
+        inner.resize(starts.back());
+        vals.resize(starts.back());
+        parallelFor(rows, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; ++r)
+            {
+                const T* row = cells + r * width;
+                std::size_t k = starts[r];
+                for (std::size_t c = 0; c < width; ++c)
+                {
+                    if (row[c] == T{0}) continue;
+                    inner[k] = static_cast<std::uint32_t>(c);
+                    vals[k] = row[c];
+                    ++k;
+                }
+            }
+        });
+
+        if (layout != SparseLayout::CSR) *this = toLayout(layout);
+    }
+
+    template<typename T>
+    double SparseMatrix<T>::density() const noexcept
+    {
+        const double cells = static_cast<double>(rows) * static_cast<double>(cols);
+        return cells == 0.0 ? 0.0 : static_cast<double>(vals.size()) / cells;
+    }
+
+    template<typename T>
+    T SparseMatrix<T>::at(std::uint32_t row, std::uint32_t col) const
+    {
+        if (row >= rows || col >= cols) throw std::out_of_range("SparseMatrix index out of range.");
+
+        const std::size_t o = order == SparseLayout::CSR ? row : col;
+        const std::uint32_t i = order == SparseLayout::CSR ? col : row;
+        const auto first = inner.begin() + static_cast<std::ptrdiff_t>(starts[o]);
+        const auto last = inner.begin() + static_cast<std::ptrdiff_t>(starts[o + 1]);
+        const auto it = std::lower_bound(first, last, i);
+        return it != last && *it == i ? vals[static_cast<std::size_t>(it - inner.begin())] : T{0};
+    }
+
+    template<typename T>
+    Matrix<T> SparseMatrix<T>::toDense() const
+    {
+        Matrix<T> out(rows, cols);
+        if (vals.empty()) return out;
+
+        T* cells = out.data_storage();
+        const std::size_t width = cols;
+        const bool csr = order == SparseLayout::CSR;
+        parallelFor(outerSize(), detail::sparseGrain(outerSize(), vals.size()), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+                for (std::size_t k = starts[o]; k < starts[o + 1]; ++k)
+                    cells[csr ? o * width + inner[k] : inner[k] * width + o] = vals[k];
+        });
+        return out;
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::toLayout(SparseLayout layout) const
+    {
+        if (layout == order) return *this;
+
+        // Counting sort by the current inner index; walking the outer slots in
+        // order leaves each new slot sorted.
+        SparseMatrix out(rows, cols, layout);
+        for (const std::uint32_t i : inner) ++out.starts[i + 1];
+        detail::countsToOffsets(out.starts);
+
+        out.inner.resize(vals.size());
+        out.vals.resize(vals.size());
+        std::vector<std::size_t> next(out.starts.begin(), out.starts.end() - 1);
+        for (std::size_t o = 0; o < outerSize(); ++o)
+        {
+            for (std::size_t k = starts[o]; k < starts[o + 1]; ++k)
+            {
+                const std::size_t pos = next[inner[k]]++;
+                out.inner[pos] = static_cast<std::uint32_t>(o);
+                out.vals[pos] = vals[k];
+            }
+        }
+        return out;
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::transpose() const
+    {
+        // CSR of A holds exactly the arrays of CSC of A^T.
+        SparseMatrix out(cols, rows, detail::otherLayout(order));
+        out.starts = starts;
+        out.inner = inner;
+        out.vals = vals;
+        return out;
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::pruned(T tolerance) const
+    {
+        auto keep = [tolerance](T v) { return detail::sparseAbs(v) > tolerance; };
+        const std::size_t outer = outerSize();
+        const std::size_t grain = detail::sparseGrain(outer, vals.size());
+
+        SparseMatrix out(rows, cols, order);
+        parallelFor(outer, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+                out.starts[o + 1] = static_cast<std::size_t>(
+                    std::count_if(vals.begin() + static_cast<std::ptrdiff_t>(starts[o]),
+                                  vals.begin() + static_cast<std::ptrdiff_t>(starts[o + 1]), keep));
+        });
+        detail::countsToOffsets(out.starts);
+
+        out.inner.resize(out.starts.back());
+        out.vals.resize(out.starts.back());
+        parallelFor(outer, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+            {
+                std::size_t pos = out.starts[o];
+                for (std::size_t k = starts[o]; k < starts[o + 1]; ++k)
+                {
+                    if (!keep(vals[k])) continue;
+                    out.inner[pos] = inner[k];
+                    out.vals[pos] = vals[k];
+                    ++pos;
+                }
+            }
+        });
+        return out;
+    }
+
+    template<typename T>
+    template<typename F>
+    SparseMatrix<T> SparseMatrix<T>::mapValues(F f) const
+    {
+        SparseMatrix out(rows, cols, order);
+        out.starts = starts;
+        out.inner = inner;
+        out.vals.resize(vals.size());
+        parallelFor(vals.size(), detail::kSparseGrainEntries, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t k = begin; k < end; ++k) out.vals[k] = static_cast<T>(f(vals[k]));
+        });
+        return out;
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::transform(const std::function<T(T)>& f) const
+    {
+        return mapValues(f);
+    }
+
+    template<typename T>
+    template<typename Op>
+    SparseMatrix<T> SparseMatrix<T>::merge(const SparseMatrix& other, bool unionPattern, Op op) const
+    {
+        const SparseMatrix converted = other.order == order ? SparseMatrix(0, 0, order) : other.toLayout(order);
+        const SparseMatrix& rhs = other.order == order ? other : converted;
+
+        // Walk the two sorted slots together, emitting (index, value) per result entry.
+        auto walk = [&](std::size_t o, auto&& emit) {
+            std::size_t i = starts[o], j = rhs.starts[o];
+            const std::size_t iEnd = starts[o + 1], jEnd = rhs.starts[o + 1];
+            while (unionPattern ? (i < iEnd || j < jEnd) : (i < iEnd && j < jEnd))
+            {
+                if (j == jEnd || (i < iEnd && inner[i] < rhs.inner[j]))
+                {
+                    if (unionPattern) emit(inner[i], op(vals[i], T{0}));
+                    ++i;
+                }
+                else if (i == iEnd || rhs.inner[j] < inner[i])
+                {
+                    if (unionPattern) emit(rhs.inner[j], op(T{0}, rhs.vals[j]));
+                    ++j;
+                }
+                else
+                {
+                    emit(inner[i], op(vals[i], rhs.vals[j]));
+                    ++i;
+                    ++j;
+                }
+            }
+        };
+
+        const std::size_t outer = outerSize();
+        const std::size_t grain = detail::sparseGrain(outer, vals.size() + rhs.vals.size());
+        SparseMatrix out(rows, cols, order);
+        parallelFor(outer, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+            {
+                std::size_t n = 0;
+                walk(o, [&n](std::uint32_t, T) { ++n; });
+                out.starts[o + 1] = n;
+            }
+        });
+        detail::countsToOffsets(out.starts);
+
+        out.inner.resize(out.starts.back());
+        out.vals.resize(out.starts.back());
+        parallelFor(outer, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+            {
+                std::size_t pos = out.starts[o];
+                walk(o, [&](std::uint32_t index, T value) {
+                    out.inner[pos] = index;
+                    out.vals[pos] = value;
+                    ++pos;
+                });
+            }
+        });
+        return out;
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::operator+(const SparseMatrix& other) const
+    {
+        if (rows != other.rows || cols != other.cols)
+            throw std::invalid_argument("Matrix dimensions must match for addition.");
+        return merge(other, true, [](T a, T b) { return static_cast<T>(a + b); });
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::operator-(const SparseMatrix& other) const
+    {
+        if (rows != other.rows || cols != other.cols)
+            throw std::invalid_argument("Matrix dimensions must match for subtraction.");
+        return merge(other, true, [](T a, T b) { return static_cast<T>(a - b); });
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::operator*(const SparseMatrix& other) const
+    {
+        if (rows != other.rows || cols != other.cols)
+            throw std::invalid_argument("Matrix dimensions must match for multiplication.");
+        return merge(other, false, [](T a, T b) { return static_cast<T>(a * b); });
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::operator*(const Matrix<T>& other) const
+    {
+        if (rows != other.numRows() || cols != other.numCols())
+            throw std::invalid_argument("Matrix dimensions must match for multiplication.");
+
+        SparseMatrix out = *this;
+        const T* cells = other.data_storage();
+        const std::size_t width = cols;
+        const bool csr = order == SparseLayout::CSR;
+        parallelFor(outerSize(), detail::sparseGrain(outerSize(), vals.size()), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+                for (std::size_t k = starts[o]; k < starts[o + 1]; ++k)
+                    out.vals[k] = static_cast<T>(vals[k] * cells[csr ? o * width + inner[k] : inner[k] * width + o]);
+        });
+        return out;
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::operator*(const T& scalar) const
+    {
+        const T s = scalar;
+        return mapValues([s](T v) { return v * s; });
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::operator/(const T& scalar) const
+    {
+        const T s = scalar;
+        return mapValues([s](T v) { return v / s; });
+    }
+
+    template<typename T>
+    SparseMatrix<T> SparseMatrix<T>::operator-() const
+    {
+        return mapValues([](T v) { return -v; });
+    }
+
+    template<typename T>
+    Matrix<T> SparseMatrix<T>::operator+(const Matrix<T>& other) const
+    {
+        if (rows != other.numRows() || cols != other.numCols())
+            throw std::invalid_argument("Matrix dimensions must match for addition.");
+
+        Matrix<T> out = other;
+        if (out.empty()) return out;
+        T* cells = out.data_storage();   // detaches: one copy of other
+        const std::size_t width = cols;
+        const bool csr = order == SparseLayout::CSR;
+        parallelFor(outerSize(), detail::sparseGrain(outerSize(), vals.size()), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+                for (std::size_t k = starts[o]; k < starts[o + 1]; ++k)
+                    cells[csr ? o * width + inner[k] : inner[k] * width + o] += vals[k];
+        });
+        return out;
+    }
+
+    template<typename T>
+    Matrix<T> SparseMatrix<T>::operator-(const Matrix<T>& other) const
+    {
+        if (rows != other.numRows() || cols != other.numCols())
+            throw std::invalid_argument("Matrix dimensions must match for subtraction.");
+
+        Matrix<T> out(rows, cols);
+        if (out.empty()) return out;
+        T* cells = out.data_storage();
+        const T* src = other.data_storage();
+        parallelFor(out.size(), detail::kSparseReduceChunk, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) cells[i] = static_cast<T>(-src[i]);
+        });
+
+        const std::size_t width = cols;
+        const bool csr = order == SparseLayout::CSR;
+        parallelFor(outerSize(), detail::sparseGrain(outerSize(), vals.size()), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+                for (std::size_t k = starts[o]; k < starts[o + 1]; ++k)
+                    cells[csr ? o * width + inner[k] : inner[k] * width + o] += vals[k];
+        });
+        return out;
+    }
+
+    template<typename T>
+    T SparseMatrix<T>::sum() const
+    {
+        const std::size_t chunks = (vals.size() + detail::kSparseReduceChunk - 1) / detail::kSparseReduceChunk;
+        std::vector<T> partial(chunks);
+        parallelFor(chunks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t ch = begin; ch < end; ++ch)
+            {
+                detail::SparseSum<T> acc;
+                const std::size_t last = std::min(vals.size(), (ch + 1) * detail::kSparseReduceChunk);
+                for (std::size_t k = ch * detail::kSparseReduceChunk; k < last; ++k) acc.add(vals[k]);
+                partial[ch] = acc.s;
+            }
+        });
+
+        detail::SparseSum<T> total;
+        for (const T& p : partial) total.add(p);
+        return total.s;
+    }
+
+    template<typename T>
+    T SparseMatrix<T>::min() const
+    {
+        if (rows == 0 || cols == 0) throw std::runtime_error("SparseMatrix::min() on empty matrix");
+
+        const bool hasZeros = vals.size() < static_cast<std::size_t>(rows) * cols;
+        T best = hasZeros || vals.empty() ? T{0} : vals.front();
+        for (const T& v : vals)
+            if (v < best) best = v;
+        return best;
+    }
+
+    template<typename T>
+    T SparseMatrix<T>::max() const
+    {
+        if (rows == 0 || cols == 0) throw std::runtime_error("SparseMatrix::max() on empty matrix");
+
+        const bool hasZeros = vals.size() < static_cast<std::size_t>(rows) * cols;
+        T best = hasZeros || vals.empty() ? T{0} : vals.front();
+        for (const T& v : vals)
+            if (best < v) best = v;
+        return best;
+    }
+
+    template<typename T>
+    std::vector<T> SparseMatrix<T>::rowSums() const
+    {
+        return order == SparseLayout::CSR ? detail::outerSums(starts, vals) : detail::innerSums(inner, vals, rows);
+    }
+
+    template<typename T>
+    std::vector<T> SparseMatrix<T>::colSums() const
+    {
+        return order == SparseLayout::CSC ? detail::outerSums(starts, vals) : detail::innerSums(inner, vals, cols);
+    }
+
+    // ======================= CooBuilder =======================
+
+    template<typename T>
+    CooBuilder<T>::CooBuilder(std::uint32_t numRows, std::uint32_t numCols)
+        : rows(numRows), cols(numCols)
+    {
+    }
+
+    template<typename T>
+    void CooBuilder<T>::reserve(std::size_t entries)
+    {
+        rowIdx.reserve(entries);
+        colIdx.reserve(entries);
+        vals.reserve(entries);
+    }
+
+    template<typename T>
+    void CooBuilder<T>::add(std::uint32_t row, std::uint32_t col, const T& value)
+    {
+        if (row >= rows || col >= cols) throw std::out_of_range("CooBuilder: coordinates out of range.");
+        rowIdx.push_back(row);
+        colIdx.push_back(col);
+        vals.push_back(value);
+    }
+
+    template<typename T>
+    SparseMatrix<T> CooBuilder<T>::build(SparseLayout layout) const
+    {
+        const bool csr = layout == SparseLayout::CSR;
+        const std::size_t outer = csr ? rows : cols;
+        const std::vector<std::uint32_t>& outerIdx = csr ? rowIdx : colIdx;
+        const std::vector<std::uint32_t>& innerIdx = csr ? colIdx : rowIdx;
+
+        // Bucket by outer index (stable, so duplicates keep their insertion order) ...
+        std::vector<std::size_t> starts(outer + 1, 0);
+        for (const std::uint32_t o : outerIdx) ++starts[o + 1];
+        detail::countsToOffsets(starts);
+
+        std::vector<std::pair<std::uint32_t, T>> bucket(vals.size());
+        std::vector<std::size_t> next(starts.begin(), starts.end() - 1);
+        for (std::size_t e = 0; e < vals.size(); ++e)
+            bucket[next[outerIdx[e]]++] = {innerIdx[e], vals[e]};
+
+        // ... then sort each slot and fold duplicates in place.
+        const std::size_t grain = detail::sparseGrain(outer, vals.size(), 8);
+        std::vector<std::size_t> kept(outer + 1, 0);
+        parallelFor(outer, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+            {
+                const auto first = bucket.begin() + static_cast<std::ptrdiff_t>(starts[o]);
+                const auto last = bucket.begin() + static_cast<std::ptrdiff_t>(starts[o + 1]);
+                std::stable_sort(first, last, [](const auto& a, const auto& b) { return a.first < b.first; });
+                auto out = first;
+                for (auto it = first; it != last; ++it)
+                {
+                    if (out != first && (out - 1)->first == it->first)
+                        (out - 1)->second += it->second;
+                    else
+                        *out++ = *it;
+                }
+                kept[o + 1] = static_cast<std::size_t>(out - first);
+            }
+        });
+        detail::countsToOffsets(kept);
+
+        std::vector<std::uint32_t> indices(kept.back());
+        std::vector<T> values(kept.back());
+        parallelFor(outer, grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t o = begin; o < end; ++o)
+                for (std::size_t k = 0; k < kept[o + 1] - kept[o]; ++k)
+                {
+                    indices[kept[o] + k] = bucket[starts[o] + k].first;
+                    values[kept[o] + k] = bucket[starts[o] + k].second;
+                }
+        });
+        return SparseMatrix<T>(rows, cols, layout, std::move(kept), std::move(indices), std::move(values));
+    }
+
+    // ======================= Products =======================
+
+    template<typename T>
+    std::vector<T> matvec(const SparseMatrix<T>& a, const std::vector<T>& x)
+    {
+        BML_PERF_SCOPE("matvec_sparse", T);
+        if (x.size() != a.numCols())
+            throw std::invalid_argument("Vector length must match the number of matrix columns.");
+
+        std::vector<T> y(a.numRows(), T{0});
+        const auto& starts = a.offsets();
+        const auto& inner = a.indices();
+        const auto& vals = a.values();
+
+        if (a.layout() == SparseLayout::CSR)
+        {
+            parallelFor(a.numRows(), detail::sparseGrain(a.numRows(), vals.size()), [&](std::size_t begin, std::size_t end) {
+                for (std::size_t r = begin; r < end; ++r)
+                {
+                    T s{0};
+                    for (std::size_t k = starts[r]; k < starts[r + 1]; ++k) s += vals[k] * x[inner[k]];
+                    y[r] = s;
+                }
+            });
+        }
+        else
+        {
+            // Column scatter; rows are not independent here, so this runs on one thread.
+            for (std::size_t c = 0; c < a.numCols(); ++c)
+            {
+                const T xc = x[c];
+                if (xc == T{0}) continue;
+                for (std::size_t k = starts[c]; k < starts[c + 1]; ++k) y[inner[k]] += vals[k] * xc;
+            }
+        }
+        return y;
+    }
+
+    template<typename T>
+    Matrix<T> matmul(const SparseMatrix<T>& a, const Matrix<T>& b)
+    {
+        BML_PERF_SCOPE("matmul_sparse_dense", T);
+        if (a.numCols() != b.numRows())
+            throw std::invalid_argument("Matrix dimensions must match for multiplication.");
+
+        const SparseMatrix<T> converted = a.layout() == SparseLayout::CSR ? SparseMatrix<T>(0, 0) : a.toLayout(SparseLayout::CSR);
+        const SparseMatrix<T>& csr = a.layout() == SparseLayout::CSR ? a : converted;
+
+        Matrix<T> out(a.numRows(), b.numCols());
+        if (out.empty() || csr.nonZeros() == 0) return out;
+
+        T* o = out.data_storage();
+        const T* bCells = b.data_storage();
+        const std::size_t n = b.numCols();
+        const auto& starts = csr.offsets();
+        const auto& inner = csr.indices();
+        const auto& vals = csr.values();
+
+        // out[r][:] += a[r][j] * b[j][:]  — contiguous rows of b and out
+        parallelFor(a.numRows(), detail::sparseGrain(a.numRows(), vals.size(), n), [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; ++r)
+            {
+                T* row = o + r * n;
+                for (std::size_t k = starts[r]; k < starts[r + 1]; ++k)
+                {
+                    const T v = vals[k];
+                    const T* bRow = bCells + static_cast<std::size_t>(inner[k]) * n;
+                    for (std::size_t j = 0; j < n; ++j) row[j] += v * bRow[j];
+                }
+            }
+        });
+        return out;
+    }
+
+    template<typename T>
+    Matrix<T> matmul(const Matrix<T>& a, const SparseMatrix<T>& b)
+    {
+        BML_PERF_SCOPE("matmul_dense_sparse", T);
+        if (a.numCols() != b.numRows())
+            throw std::invalid_argument("Matrix dimensions must match for multiplication.");
+
+        const SparseMatrix<T> converted = b.layout() == SparseLayout::CSR ? SparseMatrix<T>(0, 0) : b.toLayout(SparseLayout::CSR);
+        const SparseMatrix<T>& csr = b.layout() == SparseLayout::CSR ? b : converted;
+
+        Matrix<T> out(a.numRows(), b.numCols());
+        if (out.empty() || csr.nonZeros() == 0) return out;
+
+        T* o = out.data_storage();
+        const T* aCells = a.data_storage();
+        const std::size_t k = a.numCols();
+        const std::size_t n = b.numCols();
+        const auto& starts = csr.offsets();
+        const auto& inner = csr.indices();
+        const auto& vals = csr.values();
+
+        // out[i][:] += a[i][j] * b[j][:]  with b's row j scattered by its column indices
+        const std::size_t grain = std::max<std::size_t>(1, detail::kSparseGrainEntries / (k + vals.size() + 1));
+        parallelFor(a.numRows(), grain, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                T* row = o + i * n;
+                const T* aRow = aCells + i * k;
+                for (std::size_t j = 0; j < k; ++j)
+                {
+                    const T d = aRow[j];
+                    if (d == T{0}) continue;
+                    for (std::size_t e = starts[j]; e < starts[j + 1]; ++e) row[inner[e]] += d * vals[e];
+                }
+            }
+        });
+        return out;
+    }
+} // namespace bml
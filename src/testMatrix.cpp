@@ -5,6 +5,8 @@
 #include <cmath>
 #include <cctype>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <exception>
 #include <iomanip>
 #include <iostream>
@@ -12,7 +14,10 @@
 #include <random>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <type_traits>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -669,6 +674,1933 @@ void test_rule_of_five_core() {
     LOG("[OK] Rule-of-Five");
 }
 
+// ---- FixedMatrix (compile-time shape) ----
+static void test_fixed_matrix() {
+    print_type_header<double>("FixedMatrix<T,R,C>");
+
+    static_assert(FixedMatrix4<double>::numRows() == 4 && FixedMatrix4<double>::size() == 16);
+    static_assert(std::is_trivially_copyable_v<FixedMatrix<float, 6, 6>>);
+    constexpr auto I3 = FixedMatrix3<int>::identity();
+    static_assert(I3(1, 1) == 1 && I3(0, 1) == 0, "constexpr identity");
+    static_assert(determinant(FixedMatrix2<int>({1, 2, 3, 4})) == -2, "constexpr 2x2 det");
+
+    // 4x4 affine transform: translate then scale
+    FixedMatrix4<double> t = FixedMatrix4<double>::identity();
+    t(0, 3) = 1.0; t(1, 3) = 2.0; t(2, 3) = 3.0;
+    FixedMatrix4<double> s = FixedMatrix4<double>::identity();
+    s(0, 0) = 2.0; s(1, 1) = 4.0; s(2, 2) = 8.0;
+    const auto st = matmul(s, t);
+    expect_eq(st(0, 3), 2.0,  "matmul translate col x");
+    expect_eq(st(2, 3), 24.0, "matmul translate col z");
+    expect_eq(determinant(st), 64.0, "det 4x4");
+
+    const auto inv = inverse(st);
+    const auto id = matmul(st, inv);
+    for (std::size_t r = 0; r < 4; ++r)
+        for (std::size_t c = 0; c < 4; ++c)
+            expect_true(std::fabs(id(r, c) - (r == c ? 1.0 : 0.0)) < 1e-12, "M * inv(M) == I (4x4)");
+
+    // 6x6 covariance-like SPD matrix: A^T A + I
+    FixedMatrix<double, 6, 6> a;
+    for (std::size_t r = 0; r < 6; ++r)
+        for (std::size_t c = 0; c < 6; ++c)
+            a(r, c) = static_cast<double>((r * 7 + c * 3) % 5) - 2.0;
+    const auto cov = matmul(transpose(a), a) + FixedMatrix<double, 6, 6>::identity();
+    const auto cinv = inverse(cov);
+    const auto cid = matmul(cinv, cov);
+    for (std::size_t r = 0; r < 6; ++r)
+        for (std::size_t c = 0; c < 6; ++c)
+            expect_true(std::fabs(cid(r, c) - (r == c ? 1.0 : 0.0)) < 1e-9, "inv(C) * C == I (6x6)");
+    expect_true(determinant(cov) > 0.0, "SPD determinant positive");
+
+    // Integral 5x5 determinant (Bareiss) against a triangular matrix
+    FixedMatrix<std::int64_t, 5, 5> tri;
+    for (std::size_t r = 0; r < 5; ++r)
+        for (std::size_t c = r; c < 5; ++c)
+            tri(r, c) = static_cast<std::int64_t>(r + c + 1);
+    FixedMatrix<std::int64_t, 5, 5> perm = tri;
+    for (std::size_t c = 0; c < 5; ++c) std::swap(perm(0, c), perm(4, c));
+    expect_eq(determinant(tri), std::int64_t{1 * 3 * 5 * 7 * 9}, "Bareiss det");
+    expect_eq(determinant(perm), std::int64_t{-(1 * 3 * 5 * 7 * 9)}, "Bareiss det with pivot swap");
+
+    // Element-wise semantics and interconversion with Matrix<T>
+    FixedMatrix<float, 2, 3> f({1.f, 2.f, 3.f, 4.f, 5.f, 6.f});
+    expect_eq((f * f)(1, 2), 36.f, "element-wise *");
+    expect_eq((f + 1.f)[0][0], 2.f, "scalar + and row access");
+    expect_eq(f.sum(), 21.f, "sum");
+
+    Matrix<float> dyn = f.toMatrix();
+    expect_eq(dyn.numRows(), 2u, "toMatrix rows");
+    expect_eq(dyn[1][2], 6.f, "toMatrix value");
+    dyn[0][1] = 9.f;
+    FixedMatrix<float, 2, 3> back(dyn);
+    expect_eq(back(0, 1), 9.f, "from Matrix value");
+
+    bool threw = false;
+    try { FixedMatrix<float, 3, 2> bad(dyn); (void)bad; } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "shape mismatch throws");
+
+    threw = false;
+    try { (void)inverse(FixedMatrix3<double>{}); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "singular inverse throws");
+
+    LOG("[OK] FixedMatrix");
+}
+
+// ---- Copy-on-write buffers ----
+template<typename T>
+void test_copy_on_write() {
+    print_type_header<T>("Copy-on-write");
+
+    Matrix<T> a(3,3);
+    for (std::uint32_t r=0; r<3; ++r)
+        for (std::uint32_t c=0; c<3; ++c)
+            a[r][c] = tv<T>(static_cast<int>(r*3 + c));
+
+    Matrix<T> b = a;
+    expect_true(a.sharesStorageWith(b), "copy shares buffer");
+    const Matrix<T>& cb = b;
+    expect_eq(cb[2][2], tv<T>(8), "read through const does not detach");
+    expect_true(a.sharesStorageWith(b), "still shared after const read");
+
+    b[0][0] = tv<T>(42);                       // operator[] detaches
+    expect_false(a.sharesStorageWith(b), "write via operator[] detaches");
+    expect_eq(a[0][0], tv<T>(0), "original untouched by operator[] write");
+
+    Matrix<T> c = a;
+    c.fill(tv<T>(7));                          // fill detaches without copying
+    expect_false(a.sharesStorageWith(c), "fill detaches");
+    expect_eq(a[1][1], tv<T>(4), "original untouched by fill");
+
+    Matrix<T> d = a;
+    for (auto it = d.begin(); it != d.end(); ++it) {
+        auto&& [r, cc, ref] = *it;
+        if (r == 1 && cc == 2) ref = tv<T>(99);
+    }
+    expect_eq(d[1][2], tv<T>(99), "iterator write lands");
+    expect_eq(a[1][2], tv<T>(5), "original untouched by iterator write");
+
+    if constexpr (is_math<T>::value) {
+        Matrix<T> e = a;
+        e += a;                                // compound op on a shared buffer
+        expect_eq(e[1][1], tv<T>(8), "compound result");
+        expect_eq(a[1][1], tv<T>(4), "original untouched by +=");
+        Matrix<T> f = a;
+        f *= tv<T>(2);
+        expect_false(a.sharesStorageWith(f), "scalar compound detaches");
+    }
+
+    Matrix<T> g = a;
+    g = b;                                     // re-share on assignment
+    expect_true(g.sharesStorageWith(b), "copy-assign shares");
+    expect_true(g == b, "shared copies compare equal");
+
+    LOG("[OK] Copy-on-write");
+}
+
+// ---- copy()/paste() block paths ----
+static void test_copy_paste_blocks() {
+    print_type_header<std::uint32_t>("copy/paste row blocks");
+
+    // Large enough to take the threaded path; force a few workers even on one core.
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+
+    const std::uint32_t R = 1100, C = 1300;
+    Matrix<std::uint32_t> big(R, C);
+    for (std::uint32_t r = 0; r < R; ++r) {
+        auto row = big[r];
+        for (std::uint32_t c = 0; c < C; ++c) row[c] = r * 100000u + c;
+    }
+
+    Matrix<std::uint32_t> tile = big.copy(17, 33, 1090, 1299);
+    expect_eq(tile.numRows(), 1073u, "tile rows");
+    expect_eq(tile.numCols(), 1266u, "tile cols");
+    expect_eq(tile[0][0], 17u * 100000u + 33u, "tile origin");
+    expect_eq(tile[1072][1265], 1089u * 100000u + 1298u, "tile last");
+
+    Matrix<std::uint32_t> rows = big.copy(5, 0, 900, -1);   // contiguous full-width block
+    expect_eq(rows[894][C - 1], 899u * 100000u + (C - 1), "full-width copy");
+
+    Matrix<std::uint32_t> canvas(R, C);
+    canvas.fill(0u);
+    canvas.paste(tile, 20, 30);
+    expect_eq(canvas[20][30], tile[0][0], "paste origin");
+    expect_eq(canvas[20 + 1072][30 + 1265], tile[1072][1265], "paste last");
+    expect_eq(canvas[19][30], 0u, "paste leaves rows above");
+    expect_eq(canvas[20][29], 0u, "paste leaves columns left");
+
+    Matrix<std::uint32_t> alias = canvas;                  // shares canvas' buffer
+    canvas.paste(alias, 0, 0);                             // paste of a shared copy of itself
+    expect_true(canvas == alias, "paste of shared copy is identity");
+    canvas.paste(canvas);                                  // self-paste
+    expect_true(canvas == alias, "self-paste is identity");
+
+    setParallelism(savedThreads);
+
+    // std::string: copy keeps the source, rvalue paste moves cells out
+    Matrix<std::string> words(2, 3);
+    words[0][0] = "alpha"; words[0][1] = "beta";  words[0][2] = "gamma";
+    words[1][0] = "delta"; words[1][1] = "epsilon"; words[1][2] = "zeta";
+    Matrix<std::string> sub = words.copy(0, 1, 2, 3);
+    expect_eq(sub[1][1], std::string("zeta"), "string copy");
+
+    Matrix<std::string> board(3, 4);
+    board.fill(".");
+    board.paste(std::move(sub), 1, 2);
+    expect_eq(board[1][2], std::string("beta"), "string move paste");
+    expect_eq(board[2][3], std::string("zeta"), "string move paste last");
+    expect_eq(board[0][0], std::string("."), "string move paste untouched");
+
+    Matrix<std::string> keep = words;                      // shared source must not be moved from
+    Matrix<std::string> keepAlias = keep;
+    board.paste(std::move(keep), 0, 0);
+    expect_eq(keepAlias[1][1], std::string("epsilon"), "shared source survives rvalue paste");
+
+    LOG("[OK] copy/paste row blocks");
+}
+
+static void test_compare_and_hash() {
+    print_type_header<std::int32_t>("comparison fast paths + hash");
+
+    // Reference XXH64 vectors
+    expect_true(hashBytes("", 0) == 0xEF46DB3751D8E999ULL, "xxh64 empty");
+    expect_true(hashBytes("abc", 3) == 0x44BC2CF5AD770999ULL, "xxh64 abc");
+    {
+        // Streaming in uneven pieces must match the one-shot digest
+        std::string text(1000, '\0');
+        for (std::size_t i = 0; i < text.size(); ++i) text[i] = static_cast<char>(i * 31 + 7);
+        Hasher64 h(42);
+        h.update(text.data(), 3);
+        h.update(text.data() + 3, 40);
+        h.update(text.data() + 43, text.size() - 43);
+        expect_true(h.digest() == hashBytes(text.data(), text.size(), 42), "streaming == one-shot");
+    }
+
+    // Integers: mismatch past the first memcmp block decides equality and ordering
+    Matrix<std::int32_t> a(40, 50), b(40, 50);
+    for (std::uint32_t r = 0; r < 40; ++r)
+        for (std::uint32_t c = 0; c < 50; ++c) a[r][c] = b[r][c] = static_cast<std::int32_t>(r * 50 + c);
+    expect_true(a == b, "equal ints");
+    expect_true(hash(a) == hash(b), "equal ints hash equal");
+    b[30][7] = -1;
+    expect_true(a != b, "late mismatch detected");
+    expect_true(b < a && a > b, "order at first mismatch");
+    expect_true(hash(a) != hash(b), "different ints hash differently");
+    expect_true(hash(Matrix<std::int32_t>(2, 3)) != hash(Matrix<std::int32_t>(3, 2)), "shape is hashed");
+
+    // Floating point: -0.0 == 0.0 with equal hashes, NaN never equal (even to a shared copy)
+    Matrix<double> z(3, 3), nz(3, 3);
+    z.fill(0.0);
+    nz.fill(-0.0);
+    expect_true(z == nz, "-0.0 == 0.0");
+    expect_true(hash(z) == hash(nz), "-0.0 hashes like 0.0");
+    Matrix<double> nan(2, 2);
+    nan.fill(std::numeric_limits<double>::quiet_NaN());
+    Matrix<double> nanAlias = nan;
+    expect_true(!(nan == nanAlias), "NaN matrix != itself");
+    expect_true(!(nan < nanAlias) && !(nanAlias < nan), "NaN unordered");
+
+    Matrix<float> f1(1, 300), f2(1, 300);
+    f1.fill(1.5f);
+    f2.fill(1.5f);
+    f2[0][299] = 2.5f;
+    expect_true(f1 < f2, "float order at last cell");
+
+    Matrix<long double> l1(2, 2), l2(2, 2);
+    l1.fill(3.25L);
+    l2.fill(3.25L);
+    expect_true(hash(l1) == hash(l2), "long double hash ignores padding");
+
+    // Strings: lengths are part of the hash, so {"ab","c"} != {"a","bc"}
+    Matrix<std::string> s1(1, 2), s2(1, 2);
+    s1[0][0] = "ab"; s1[0][1] = "c";
+    s2[0][0] = "a";  s2[0][1] = "bc";
+    expect_true(hash(s1) != hash(s2), "string boundaries hashed");
+    expect_true(s2 < s1, "string order");
+
+    Matrix<bool> t1(4, 4), t2(4, 4);
+    t1.fill(true);
+    t2.fill(true);
+    expect_true(hash(t1) == hash(t2), "bool hash");
+
+    std::unordered_set<Matrix<std::int32_t>> seen;
+    seen.insert(a);
+    seen.insert(b);
+    seen.insert(a.copy());
+    expect_eq(seen.size(), std::size_t{2}, "unordered_set dedup");
+
+    LOG("[OK] comparison fast paths + hash");
+}
+
+static void test_text_writer() {
+    print_type_header<double>("text formatting + streaming writer");
+
+    Matrix<double> d(2, 3);
+    d[0][0] = 1.5;  d[0][1] = -2.0;       d[0][2] = 0.1 + 0.2;
+    d[1][0] = 1e21; d[1][1] = 3.14159265; d[1][2] = 0.0;
+    expect_eq(d.toString(), std::string("1.5 -2 0.3 \n1e+21 3.14159 0 \n"), "legacy toString layout");
+
+    TextFormat csv;
+    csv.delimiter = ',';
+    csv.precision = TextFormat::kShortest;
+    expect_eq(d.toString(csv), std::string("1.5,-2,0.30000000000000004\n1e+21,3.14159265,0\n"), "csv shortest");
+    csv.precision = 3;
+    expect_eq(d.toString(csv), std::string("1.5,-2,0.3\n1e+21,3.14,0\n"), "csv precision 3");
+
+    bool threw = false;
+    try { csv.precision = 101; (void)d.toString(csv); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "precision out of range throws");
+
+    Matrix<std::int8_t> small(1, 3);
+    small[0][0] = -128; small[0][1] = 0; small[0][2] = 127;
+    expect_eq(small.toString(TextFormat()), std::string("-128 0 127\n"), "int8 as numbers");
+
+    Matrix<bool> flags(1, 3);
+    flags[0][1] = true;
+    TextFormat tsv;
+    tsv.delimiter = '\t';
+    expect_eq(flags.toString(tsv), std::string("0\t1\t0\n"), "bool tsv");
+
+    Matrix<std::string> words(2, 2);
+    words[0][0] = "a"; words[0][1] = "bc";
+    words[1][0] = "";  words[1][1] = "d e";
+    expect_eq(words.toString(tsv), std::string("a\tbc\n\td e\n"), "string cells verbatim");
+
+    // Large matrix through the parallel path must match the serial one byte for byte
+    const std::size_t savedThreads = parallelism();
+    const std::uint32_t R = 700, C = 300;
+    Matrix<float> big(R, C);
+    for (std::uint32_t r = 0; r < R; ++r)
+        for (std::uint32_t c = 0; c < C; ++c) big[r][c] = static_cast<float>(r) * 0.37f - static_cast<float>(c) / 7.0f;
+    TextFormat exact;
+    exact.precision = TextFormat::kShortest;
+    setParallelism(1);
+    const std::string serial = big.toString(exact);
+    setParallelism(4);
+    const std::string threaded = big.toString(exact);
+    setParallelism(savedThreads);
+    expect_true(serial == threaded, "parallel text == serial text");
+    expect_eq(static_cast<std::size_t>(std::count(serial.begin(), serial.end(), '\n')), std::size_t{R}, "row count");
+
+    // Shortest output reads back exactly
+    {
+        std::istringstream in(serial);
+        bool exactRoundTrip = true;
+        for (std::uint32_t r = 0; r < R && exactRoundTrip; ++r)
+            for (std::uint32_t c = 0; c < C; ++c) {
+                float v;
+                in >> v;
+                if (v != big[r][c]) { exactRoundTrip = false; break; }
+            }
+        expect_true(exactRoundTrip, "shortest floats round-trip");
+    }
+
+    // FILE* sink
+    std::FILE* tmp = std::tmpfile();
+    expect_true(tmp != nullptr, "tmpfile");
+    {
+        FileSink sink(tmp);
+        big.writeText(sink, exact);
+        sink.flush();
+    }
+    std::rewind(tmp);
+    std::string fromFile;
+    char buf[4096];
+    for (std::size_t n; (n = std::fread(buf, 1, sizeof buf, tmp)) > 0; ) fromFile.append(buf, n);
+    std::fclose(tmp);
+    expect_true(fromFile == serial, "FileSink output");
+
+    LOG("[OK] text formatting + streaming writer");
+}
+
+static void test_csv_reader() {
+    print_type_header<double>("CSV/TSV import");
+
+    const std::string text = "x,y,z\r\n1.5, -2 ,+3e2\r\n\r\n4,5,6\n";
+    CsvOptions header;
+    header.skipRows = 1;
+    Matrix<double> d = parseCsv<double>(text, header);
+    expect_eq(d.numRows(), 2u, "csv rows");
+    expect_eq(d.numCols(), 3u, "csv cols");
+    expect_eq(d[0][1], -2.0, "trimmed field");
+    expect_eq(d[0][2], 300.0, "leading plus");
+    expect_eq(d[1][2], 6.0, "last cell without trailing CRLF");
+
+    Matrix<std::int16_t> i16 = parseCsv<std::int16_t>("1\t-2\n3\t4", CsvOptions::tsv());
+    expect_eq(i16[1][1], static_cast<std::int16_t>(4), "tsv no final newline");
+
+    Matrix<bool> flags = parseCsv<bool>("true,0\nFALSE,1\n");
+    expect_true(flags[0][0] && !flags[0][1] && !flags[1][0] && flags[1][1], "bool spellings");
+
+    Matrix<std::string> words = parseCsv<std::string>("name,quote\n\"Doe, J\",\"say \"\"hi\"\"\"\n");
+    expect_eq(words[1][0], std::string("Doe, J"), "quoted delimiter");
+    expect_eq(words[1][1], std::string("say \"hi\""), "escaped quotes");
+
+    auto throwsRuntime = [](auto&& fn) {
+        try { fn(); } catch (const std::runtime_error&) { return true; }
+        return false;
+    };
+    expect_true(throwsRuntime([] { (void)parseCsv<int>("1,2\n3\n"); }), "ragged row throws");
+    expect_true(throwsRuntime([] { (void)parseCsv<std::uint8_t>("1,300\n"); }), "out of range throws");
+    expect_true(throwsRuntime([] { (void)parseCsv<int>("1,2x\n"); }), "trailing junk throws");
+    expect_true(throwsRuntime([] { (void)readCsv<int>("/nonexistent/bml.csv"); }), "missing file throws");
+    expect_eq(parseCsv<int>("\n\n").size(), std::size_t{0}, "blank input is empty");
+
+    // Multi-chunk file through mmap and the worker pool; round-trips writeText output
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+    const std::uint32_t R = 30000, C = 12;
+    Matrix<double> big(R, C);
+    for (std::uint32_t r = 0; r < R; ++r)
+        for (std::uint32_t c = 0; c < C; ++c) big[r][c] = r * 1.25 - c / 3.0;
+    TextFormat csv;
+    csv.delimiter = ',';
+    csv.precision = TextFormat::kShortest;
+
+    const std::string path = "bml_test_import.csv";
+    {
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        expect_true(f != nullptr, "open csv for writing");
+        FileSink sink(f);
+        big.writeText(sink, csv);
+        std::fclose(f);
+    }
+    Matrix<double> back = readCsv<double>(path);
+    std::remove(path.c_str());
+    setParallelism(savedThreads);
+    expect_true(back == big, "csv file round-trip");
+
+    LOG("[OK] CSV/TSV import");
+}
+
+// Hand-built .npy image with an arbitrary header dict (version 1.0 or 2.0).
+static std::string npy_image(const std::string& dict, const std::string& payload, int major = 1) {
+    std::string header = dict;
+    const std::size_t prefix = major == 1 ? 10 : 12;
+    while ((prefix + header.size() + 1) % 64 != 0) header.push_back(' ');
+    header.push_back('\n');
+    std::string out("\x93NUMPY", 6);
+    out.push_back(static_cast<char>(major));
+    out.push_back('\0');
+    const std::size_t len = header.size();
+    for (std::size_t i = 0; i < prefix - 8; ++i) out.push_back(static_cast<char>((len >> (8 * i)) & 0xFF));
+    return out + header + payload;
+}
+
+static void test_npy_npz() {
+    print_type_header<double>(".npy / .npz interchange");
+
+    Matrix<double> d(3, 4);
+    for (std::uint32_t r = 0; r < 3; ++r)
+        for (std::uint32_t c = 0; c < 4; ++c) d[r][c] = r * 10.0 + c + 0.5;
+
+    // Round trip through a buffer and a file
+    std::string image;
+    StringSink buffer(image);
+    writeNpy(d, buffer);
+    expect_true(image.compare(0, 6, "\x93NUMPY") == 0, "npy magic");
+    expect_true(image.find("'descr': '<f8'") != std::string::npos, "npy descr");
+    expect_eq((image.size() - d.size() * sizeof(double)) % 64, std::size_t{0}, "npy data aligned");
+    expect_true(parseNpy<double>(image.data(), image.size()) == d, "npy buffer round-trip");
+
+    const std::string path = "bml_test_matrix.npy";
+    saveNpy(d, path);
+    expect_true(loadNpy<double>(path) == d, "npy file round-trip");
+    {
+        Matrix<double> mapped = mapNpy<double>(path);
+        expect_true(mapped == d, "mapNpy contents");
+        Matrix<double> alias = mapped;
+        mapped[1][1] = -1.0;                                   // detaches from the mapping
+        expect_eq(alias[1][1], 11.5, "mapped alias unchanged");
+        Matrix<double> solo = mapNpy<double>(path);
+        solo[0][0] = 99.0;                                     // private page, file untouched
+    }
+    expect_eq(loadNpy<double>(path)[0][0], 0.5, "writes to a mapping never reach the file");
+
+    bool threw = false;
+    try { (void)loadNpy<float>(path); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "dtype mismatch throws");
+    std::remove(path.c_str());
+
+    // Fortran order, version 2.0 header: column-major payload is transposed on load
+    {
+        const std::int32_t colMajor[6] = {1, 4, 2, 5, 3, 6};   // [[1,2,3],[4,5,6]]
+        const std::string img = npy_image("{'descr': '<i4', 'fortran_order': True, 'shape': (2, 3), }",
+                                          std::string(reinterpret_cast<const char*>(colMajor), sizeof colMajor), 2);
+        Matrix<std::int32_t> m = parseNpy<std::int32_t>(img.data(), img.size());
+        expect_eq(m[0][2], 3, "fortran [0][2]");
+        expect_eq(m[1][0], 4, "fortran [1][0]");
+    }
+    // Big-endian and 1-d shapes
+    {
+        const unsigned char be[4] = {0x01, 0x02, 0x00, 0x07};
+        const std::string img = npy_image("{'descr': '>u2', 'fortran_order': False, 'shape': (2,), }",
+                                          std::string(reinterpret_cast<const char*>(be), sizeof be));
+        Matrix<std::uint16_t> m = parseNpy<std::uint16_t>(img.data(), img.size());
+        expect_eq(m.numRows(), 1u, "1-d shape is one row");
+        expect_eq(m[0][0], static_cast<std::uint16_t>(0x0102), "big-endian swap");
+        expect_eq(m[0][1], static_cast<std::uint16_t>(7), "big-endian swap 2");
+    }
+    // Large Fortran-order image exercises the tiled transpose
+    {
+        const std::uint32_t R = 300, C = 170;
+        std::string payload(std::size_t{R} * C * sizeof(float), '\0');
+        auto* cm = reinterpret_cast<float*>(payload.data());
+        for (std::uint32_t c = 0; c < C; ++c)
+            for (std::uint32_t r = 0; r < R; ++r) cm[std::size_t{c} * R + r] = static_cast<float>(r * 1000 + c);
+        const std::string img = npy_image("{'descr': '<f4', 'fortran_order': True, 'shape': (300, 170), }", payload);
+        Matrix<float> m = parseNpy<float>(img.data(), img.size());
+        bool ok = true;
+        for (std::uint32_t r = 0; r < R && ok; ++r)
+            for (std::uint32_t c = 0; c < C; ++c)
+                if (m[r][c] != static_cast<float>(r * 1000 + c)) { ok = false; break; }
+        expect_true(ok, "tiled fortran transpose");
+    }
+
+    // .npz archive with mixed types
+    const std::string archive = "bml_test_bundle.npz";
+    Matrix<bool> mask(2, 5);
+    mask[1][3] = true;
+    Matrix<std::int64_t> ids(1, 3);
+    ids[0][0] = -5; ids[0][1] = 1LL << 40; ids[0][2] = 7;
+    {
+        NpzWriter npz(archive);
+        npz.add("values", d);
+        npz.add("mask", mask);
+        npz.add("ids", ids);
+        npz.close();
+    }
+    {
+        NpzReader npz(archive);
+        expect_eq(npz.names().size(), std::size_t{3}, "npz entry count");
+        expect_true(npz.contains("mask") && !npz.contains("nope"), "npz contains");
+        expect_true(npz.get<double>("values") == d, "npz values");
+        expect_true(npz.get<bool>("mask") == mask, "npz mask");
+        expect_true(npz.get<std::int64_t>("ids") == ids, "npz ids");
+        threw = false;
+        try { (void)npz.get<double>("nope"); } catch (const std::out_of_range&) { threw = true; }
+        expect_true(threw, "npz missing entry throws");
+    }
+    std::remove(archive.c_str());
+
+    LOG("[OK] .npy / .npz interchange");
+}
+
+template<typename T>
+static bool codec_round_trip(const Matrix<T>& m, Codec codec, std::size_t* encodedSize = nullptr) {
+    const std::vector<std::uint8_t> bytes = encode(m, codec);
+    if (encodedSize) *encodedSize = bytes.size();
+    const Matrix<T> back = decode<T>(bytes);
+    if (back.numRows() != m.numRows() || back.numCols() != m.numCols()) return false;
+    // Compare bit patterns so NaN / -0.0 must survive too
+    return m.empty() || std::memcmp(back.data_storage(), m.data_storage(),
+                                    m.size() * sizeof(typename Matrix<T>::storage_type)) == 0;
+}
+
+static void test_codecs() {
+    print_type_header<double>("compression codecs");
+
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+
+    // bool mask: a few long runs -> RLE is tiny
+    Matrix<bool> mask(400, 500);                               // > 3 chunks
+    for (std::uint32_t r = 100; r < 180; ++r)
+        for (std::uint32_t c = 0; c < 500; ++c) mask[r][c] = true;
+    mask[399][499] = true;
+    std::size_t rleBytes = 0;
+    expect_true(codec_round_trip(mask, Codec::Rle, &rleBytes), "bool RLE round-trip");
+    expect_true(rleBytes < 200, "bool RLE compresses");
+
+    // integers: slowly increasing ids with noise -> delta + bitpack, plus wrap-around extremes
+    Matrix<std::int64_t> ids(300, 300);
+    std::mt19937_64 rng(7);
+    std::int64_t v = 1'000'000'000;
+    for (std::uint32_t r = 0; r < 300; ++r)
+        for (std::uint32_t c = 0; c < 300; ++c) ids[r][c] = (v += static_cast<std::int64_t>(rng() % 16));
+    ids[5][5] = std::numeric_limits<std::int64_t>::min();
+    ids[5][6] = std::numeric_limits<std::int64_t>::max();
+    std::size_t deltaBytes = 0;
+    expect_true(codec_round_trip(ids, Codec::DeltaBitpack, &deltaBytes), "int64 delta round-trip");
+    expect_true(deltaBytes < ids.size() * 2, "int64 delta compresses");
+
+    Matrix<std::uint8_t> bytes(1, 1000);
+    for (std::uint32_t c = 0; c < 1000; ++c) bytes[0][c] = static_cast<std::uint8_t>(c * 37);
+    expect_true(codec_round_trip(bytes, Codec::DeltaBitpack), "uint8 delta round-trip");
+
+    // floats: smooth field -> shuffle + LZ, time series -> Gorilla
+    Matrix<double> field(256, 512);
+    for (std::uint32_t r = 0; r < 256; ++r)
+        for (std::uint32_t c = 0; c < 512; ++c) field[r][c] = std::round(std::sin(r * 0.01) * 1000.0) / 8.0 + c * 0.25;
+    field[3][3] = -0.0;
+    field[3][4] = std::numeric_limits<double>::quiet_NaN();
+    std::size_t lzBytes = 0, gorillaBytes = 0;
+    expect_true(codec_round_trip(field, Codec::ShuffleLz, &lzBytes), "double shuffle+LZ round-trip");
+    expect_true(codec_round_trip(field, Codec::Gorilla, &gorillaBytes), "double Gorilla round-trip");
+    expect_true(lzBytes < field.size() * sizeof(double) / 2, "shuffle+LZ compresses");
+    expect_true(gorillaBytes < field.size() * sizeof(double), "Gorilla compresses");
+
+    Matrix<float> noise(100, 100);
+    std::uniform_real_distribution<float> dist(-1e6f, 1e6f);
+    for (std::uint32_t r = 0; r < 100; ++r)
+        for (std::uint32_t c = 0; c < 100; ++c) noise[r][c] = dist(rng);
+    expect_true(codec_round_trip(noise, Codec::ShuffleLz), "float noise shuffle+LZ (stored)");
+    expect_true(codec_round_trip(noise, Codec::Gorilla), "float noise Gorilla");
+    expect_true(codec_round_trip(noise, Codec::Rle), "float RLE");
+    expect_true(codec_round_trip(noise, Codec::None), "float None");
+
+    Matrix<long double> wide(3, 3);
+    wide.fill(1.0L / 3.0L);
+    expect_true(codec_round_trip(wide, Codec::ShuffleLz), "long double shuffle+LZ");
+    expect_true(codec_round_trip(Matrix<std::int32_t>(0, 5), Codec::DeltaBitpack), "empty matrix");
+
+    setParallelism(savedThreads);
+
+    // Type and codec checks
+    bool threw = false;
+    try { (void)encode(mask, Codec::Gorilla); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "unsupported codec throws");
+    expect_true(!codecSupports<double>(Codec::DeltaBitpack) && codecSupports<char>(Codec::DeltaBitpack), "codecSupports");
+
+    std::vector<std::uint8_t> stream = encode(ids, Codec::DeltaBitpack);
+    threw = false;
+    try { (void)decode<std::uint64_t>(stream); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "decode as wrong type throws");
+    stream.resize(stream.size() - 3);
+    threw = false;
+    try { (void)decode<std::int64_t>(stream); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "truncated stream throws");
+
+    LOG("[OK] compression codecs");
+}
+
+static void test_byte_streaming() {
+    print_type_header<double>("streaming byte serialization");
+
+    // POD: sink output matches the vector form, source reads it back
+    Matrix<double> dense(700, 400);                            // > 2 MiB, several sink writes
+    for (std::uint32_t r = 0; r < 700; ++r)
+        for (std::uint32_t c = 0; c < 400; ++c) dense[r][c] = r * 0.5 - c;
+    std::string denseOut;
+    StringSink denseSink(denseOut);
+    dense.toByteStream(denseSink);
+    const std::vector<std::uint8_t> denseBytes = dense.toByteStream();
+    expect_true(denseOut.size() == denseBytes.size()
+                && std::memcmp(denseOut.data(), denseBytes.data(), denseBytes.size()) == 0,
+                "POD sink bytes == toByteStream()");
+    Matrix<double> denseBack(700, 400);
+    MemorySource denseSource(denseOut.data(), denseOut.size());
+    denseBack.initFromByteStream(denseSource);
+    expect_true(denseBack == dense, "POD round-trip through MemorySource");
+
+    // strings: gathered writes to an fd, read back through stdio
+    Matrix<std::string> words(300, 7);
+    for (std::uint32_t r = 0; r < 300; ++r)
+        for (std::uint32_t c = 0; c < 7; ++c) words[r][c] = std::string((r * 7 + c) % 23, static_cast<char>('a' + c));
+    words[299][6] = std::string(100000, 'z');                 // spans a read block
+    std::FILE* tmp = std::tmpfile();
+    expect_true(tmp != nullptr, "tmpfile");
+    {
+        FdSink sink(fileno(tmp));
+        words.toByteStream(sink);
+    }
+    std::rewind(tmp);
+    Matrix<std::string> wordsBack(300, 7);
+    wordsBack[0][0] = "stale";
+    FileSource fileSource(tmp);
+    wordsBack.initFromByteStream(fileSource);
+    std::fclose(tmp);
+    expect_true(wordsBack == words, "string round-trip through FdSink/FileSource");
+
+    // incremental decoder: odd-sized pieces, stops exactly at the end of the matrix
+    std::vector<std::uint8_t> wordBytes = words.toByteStream();
+    const std::size_t wordSize = wordBytes.size();
+    wordBytes.push_back('!');
+    Matrix<std::string> pieces(300, 7);
+    ByteStreamDecoder<std::string> decoder(pieces);
+    std::size_t pos = 0;
+    for (std::size_t step = 1; !decoder.complete(); step = step % 7 + 1)
+        pos += decoder.feed(wordBytes.data() + pos, std::min(step, wordBytes.size() - pos));
+    expect_true(pos == wordSize && pieces == words, "decoder in 1..7 byte pieces");
+
+    Matrix<std::int16_t> shorts(3, 3);
+    ByteStreamDecoder<std::int16_t> shortDecoder(shorts);
+    const std::int16_t src[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 99};
+    expect_true(shortDecoder.feed(src, 3) == 3 && shortDecoder.cellsDone() == 1, "POD partial cell");
+    expect_true(shortDecoder.feed(reinterpret_cast<const char*>(src) + 3, sizeof src - 3) == 15
+                && shortDecoder.complete() && shorts[2][2] == 9, "POD decoder stops at the end");
+
+    // truncated input
+    bool threw = false;
+    Matrix<double> tooBig(701, 400);
+    MemorySource shortSource(denseOut.data(), denseOut.size());
+    try { tooBig.initFromByteStream(shortSource); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "POD early EOF throws");
+    threw = false;
+    Matrix<std::string> tooMany(301, 7);
+    MemorySource wordSource(wordBytes.data(), wordSize);
+    try { tooMany.initFromByteStream(wordSource); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "string early EOF throws");
+
+    LOG("[OK] streaming byte serialization");
+}
+
+static void test_async_snapshots() {
+    print_type_header<double>("async snapshots");
+
+    const std::string path = "bml_test_snapshot.bmls";
+    Matrix<double> field(333, 517);                            // ~1.3 MiB, not a block multiple
+    for (std::uint32_t r = 0; r < 333; ++r)
+        for (std::uint32_t c = 0; c < 517; ++c) field[r][c] = r * 1000.0 + c + 0.125;
+
+    AsyncIoOptions options;
+    options.blockBytes = 64 * 1024;
+    options.queueDepth = 3;
+    const IoBackend backends[] = {IoBackend::ThreadPool, availableIoBackend()};
+    for (IoBackend backend : backends)
+        for (bool direct : {false, true})
+        {
+            options.backend = backend;
+            options.direct = direct;
+            saveAsync(field, path, options).get();
+            expect_true(loadAsync<double>(path, options).get() == field, "double snapshot round-trip");
+        }
+    {
+        BlockFile file(path, BlockFile::Mode::Read);
+        expect_true(file.size() % BlockFile::kAlignment == 0, "snapshot padded to the block size");
+        expect_true(file.backend() == availableIoBackend(), "Auto backend resolves");
+    }
+
+    // The caller keeps writing while the snapshot is saved; the file holds the old cells.
+    Matrix<double> live = field;
+    std::future<void> pending = saveAsync(live, path, options);
+    live.fill(-1.0);
+    pending.get();
+    expect_true(loadAsync<double>(path).get() == field, "snapshot isolated from later writes");
+
+    Matrix<std::string> names(40, 30);
+    for (std::uint32_t r = 0; r < 40; ++r)
+        for (std::uint32_t c = 0; c < 30; ++c) names[r][c] = std::string((r + c) % 9 * 300, static_cast<char>('A' + c % 26));
+    saveAsync(names, path, options).get();
+    expect_true(loadAsync<std::string>(path, options).get() == names, "string snapshot round-trip");
+
+    Matrix<bool> mask(7, 9);
+    mask[6][8] = true;
+    saveAsync(mask, path).get();
+    expect_true(loadAsync<bool>(path).get() == mask, "bool snapshot round-trip");
+
+    // Failures surface through the future.
+    bool threw = false;
+    try { (void)loadAsync<std::int64_t>(path).get(); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "wrong cell type throws");
+
+    saveAsync(field, path, options).get();
+    {
+        std::FILE* f = std::fopen(path.c_str(), "r+b");
+        expect_true(f != nullptr, "reopen snapshot");
+        std::fseek(f, 5000, SEEK_SET);
+        std::fputc(0x5A, f);
+        std::fclose(f);
+    }
+    threw = false;
+    try { (void)loadAsync<double>(path, options).get(); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "corrupted payload fails its checksum");
+    std::remove(path.c_str());
+
+    threw = false;
+    try { (void)loadAsync<double>("bml_no_such_snapshot.bmls").get(); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "missing file throws");
+
+    LOG("[OK] async snapshots");
+}
+
+static void test_sparse_matrix() {
+    print_type_header<double>("sparse matrices");
+
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+
+    // ~2% dense reference matrices
+    std::mt19937 rng(11);
+    auto randomSparse = [&rng](std::uint32_t r, std::uint32_t c) {
+        Matrix<double> m(r, c);
+        for (std::uint32_t i = 0; i < r; ++i)
+            for (std::uint32_t j = 0; j < c; ++j)
+                if (rng() % 50 == 0) m[i][j] = static_cast<double>(rng() % 19) - 9.0 + 0.5;
+        return m;
+    };
+    const Matrix<double> a = randomSparse(400, 300);
+    const Matrix<double> b = randomSparse(400, 300);
+
+    const SparseMatrix<double> sa(a);
+    const SparseMatrix<double> sb(b, SparseLayout::CSC);
+    expect_true(sa.toDense() == a && sb.toDense() == b, "dense -> CSR/CSC -> dense");
+    expect_true(sa.nonZeros() < a.size() / 20 && sa.offsets().size() == 401, "CSR shape");
+    expect_true(sb.toLayout(SparseLayout::CSR).toDense() == b, "CSC -> CSR");
+    expect_true(sa.at(0, 0) == a[0][0] && sb.at(399, 299) == b[399][299], "at()");
+
+    expect_true((sa + sb).toDense() == a + b, "sparse + sparse");
+    expect_true((sa - sb).toDense() == a - b, "sparse - sparse");
+    expect_true((sa * sb).toDense() == a * b, "sparse * sparse (element-wise)");
+    expect_true((sa * b).toDense() == a * b, "sparse * dense (element-wise)");
+    expect_true(sa + b == a + b && sa - b == a - b, "sparse +/- dense");
+    expect_true((sa * 2.0).toDense() == a * 2.0 && (-sa).toDense() == a * -1.0, "scalar ops");
+    expect_true((sa - sa).pruned().nonZeros() == 0, "pruned() drops cancelled entries");
+    expect_true(sa.transpose().toDense() == SparseMatrix<double>(sa.transpose().toLayout(SparseLayout::CSR)).toDense()
+                && sa.transpose().at(7, 3) == a[3][7], "transpose");
+
+    expect_true(sa.sum() == a.sum() && sb.sum() == b.sum(), "sum");
+    expect_true(sa.min() == a.min() && sb.max() == b.max(), "min/max with implicit zeros");
+    const std::vector<double> rs = sb.rowSums(), cs = sa.colSums();
+    bool sumsOk = true;
+    for (std::uint32_t r = 0; r < 400; ++r)
+    {
+        double expected = 0;
+        for (double v : b.getRow(r)) expected += v;
+        sumsOk = sumsOk && rs[r] == expected;
+    }
+    for (std::uint32_t c = 0; c < 300; ++c)
+    {
+        double expected = 0;
+        for (double v : a.getColumn(c)) expected += v;
+        sumsOk = sumsOk && cs[c] == expected;
+    }
+    expect_true(sumsOk, "rowSums/colSums");
+
+    // products against a naive dense reference (all values are exact in double)
+    Matrix<double> dense(300, 5);
+    for (std::uint32_t i = 0; i < 300; ++i)
+        for (std::uint32_t j = 0; j < 5; ++j) dense[i][j] = static_cast<double>((i * 7 + j) % 11) - 5.0;
+    Matrix<double> expected(400, 5);
+    for (std::uint32_t i = 0; i < 400; ++i)
+        for (std::uint32_t j = 0; j < 5; ++j)
+            for (std::uint32_t k = 0; k < 300; ++k) expected[i][j] += a[i][k] * dense[k][j];
+    expect_true(matmul(sa, dense) == expected, "SpMM (CSR)");
+    expect_true(matmul(sa.toLayout(SparseLayout::CSC), dense) == expected, "SpMM (CSC)");
+
+    std::vector<double> x(300), y(400, 0.0);
+    for (std::uint32_t k = 0; k < 300; ++k) x[k] = dense[k][0];
+    for (std::uint32_t i = 0; i < 400; ++i) y[i] = expected[i][0];
+    expect_true(matvec(sa, x) == y && matvec(sa.toLayout(SparseLayout::CSC), x) == y, "SpMV");
+
+    Matrix<double> left(5, 400);
+    for (std::uint32_t i = 0; i < 5; ++i)
+        for (std::uint32_t k = 0; k < 400; ++k) left[i][k] = static_cast<double>((i + k) % 3);
+    Matrix<double> leftExpected(5, 300);
+    for (std::uint32_t i = 0; i < 5; ++i)
+        for (std::uint32_t j = 0; j < 300; ++j)
+            for (std::uint32_t k = 0; k < 400; ++k) leftExpected[i][j] += left[i][k] * a[k][j];
+    expect_true(matmul(left, sa) == leftExpected && matmul(left, sa.toLayout(SparseLayout::CSC)) == leftExpected
+                && matmul(left, sa + sb - sb) == leftExpected, "dense * sparse");
+
+    // COO builder: any order, duplicates summed
+    CooBuilder<std::int32_t> coo(3, 4);
+    coo.add(2, 3, 5);
+    coo.add(0, 1, 1);
+    coo.add(2, 0, -2);
+    coo.add(0, 1, 4);
+    const SparseMatrix<std::int32_t> built = coo.build();
+    const SparseMatrix<std::int32_t> builtCsc = coo.build(SparseLayout::CSC);
+    expect_true(built.nonZeros() == 3 && built.at(0, 1) == 5 && built.at(2, 0) == -2 && built.at(1, 1) == 0, "COO build");
+    expect_true(builtCsc.toDense() == built.toDense() && built.sum() == 8, "COO build (CSC)");
+
+    bool threw = false;
+    try { coo.add(3, 0, 1); } catch (const std::out_of_range&) { threw = true; }
+    expect_true(threw, "COO bounds");
+    threw = false;
+    try { (void)(sa + SparseMatrix<double>(3, 3)); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "shape mismatch throws");
+    threw = false;
+    try { SparseMatrix<int>(2, 2, SparseLayout::CSR, {0, 2, 2}, {1, 0}, {1, 1}); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "unsorted indices rejected");
+
+    setParallelism(savedThreads);
+    LOG("[OK] sparse matrices");
+}
+
+static void test_linear_algebra() {
+    print_type_header<double>("dense linear algebra");
+
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    auto randomMatrix = [&](std::uint32_t r, std::uint32_t c) {
+        Matrix<double> m(r, c);
+        for (std::uint32_t i = 0; i < r; ++i)
+            for (std::uint32_t j = 0; j < c; ++j) m[i][j] = dist(rng);
+        return m;
+    };
+    auto naiveProduct = [](const Matrix<double>& a, const Matrix<double>& b) {
+        Matrix<double> out(a.numRows(), b.numCols());
+        for (std::uint32_t i = 0; i < a.numRows(); ++i)
+            for (std::uint32_t p = 0; p < a.numCols(); ++p)
+                for (std::uint32_t j = 0; j < b.numCols(); ++j) out[i][j] += a[i][p] * b[p][j];
+        return out;
+    };
+    auto filled = [](std::uint32_t r, std::uint32_t c, double v) {
+        Matrix<double> out(r, c);
+        out.fill(v);
+        return out;
+    };
+    auto transposed = [](const Matrix<double>& in) {
+        Matrix<double> out(in.numCols(), in.numRows());
+        for (std::uint32_t i = 0; i < in.numRows(); ++i)
+            for (std::uint32_t j = 0; j < in.numCols(); ++j) out[j][i] = in[i][j];
+        return out;
+    };
+    auto identity = [](std::uint32_t n) {
+        Matrix<double> out(n, n);
+        for (std::uint32_t i = 0; i < n; ++i) out[i][i] = 1.0;
+        return out;
+    };
+    auto maxDiff = [](const Matrix<double>& a, const Matrix<double>& b) {
+        double d = 0.0;
+        for (std::uint32_t i = 0; i < a.numRows(); ++i)
+            for (std::uint32_t j = 0; j < a.numCols(); ++j) d = std::max(d, std::abs(a[i][j] - b[i][j]));
+        return d;
+    };
+
+    // GEMM: packed path (odd edges), transposes, alpha/beta and integer cells
+    const Matrix<double> a = randomMatrix(173, 301);
+    const Matrix<double> b = randomMatrix(301, 259);
+    const Matrix<double> ab = naiveProduct(a, b);
+    expect_true(maxDiff(matmul(a, b), ab) < 1e-10, "matmul vs naive");
+    expect_true(maxDiff(matmul(filled(4, 3, 1.0), filled(3, 2, 2.0)), filled(4, 2, 6.0)) == 0.0, "small matmul");
+
+    const Matrix<double> at = transposed(a);
+    const Matrix<double> bt = transposed(b);
+    Matrix<double> c = randomMatrix(173, 259);
+    const Matrix<double> c0 = c;
+    gemm(true, true, 173, 259, 301, 2.0, at.data_storage(), 173, bt.data_storage(), 301, -1.0, c.data_storage(), 259);
+    expect_true(maxDiff(c, ab + ab - c0) < 1e-10, "gemm transposed operands with alpha/beta");
+
+    Matrix<std::int32_t> ia(70, 90), ib(90, 80), ic(70, 80);
+    ia.fill(3);
+    ib.fill(-2);
+    ic.fill(-540);
+    expect_true(matmul(ia, ib) == ic, "integer matmul");
+
+    bool threw = false;
+    try { (void)matmul(a, a); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "matmul shape mismatch throws");
+
+    // LU: solve several right-hand sides, inverse, determinant
+    const std::uint32_t n = 200;
+    const Matrix<double> m = randomMatrix(n, n);
+    const Matrix<double> rhs = randomMatrix(n, 3);
+    const LuFactorization<double> lu(m);
+    expect_false(lu.singular(), "random matrix is regular");
+    expect_true(maxDiff(naiveProduct(m, lu.solve(rhs)), rhs) < 1e-9, "LU solve");
+    expect_true(maxDiff(naiveProduct(m, lu.inverse()), identity(n)) < 1e-9, "LU inverse");
+    expect_true(maxDiff(inverse(m), lu.inverse()) == 0.0, "inverse() helper");
+    const std::vector<double> x = lu.solve(std::vector<double>(n, 1.0));
+    const Matrix<double> xs = lu.solve(filled(n, 1, 1.0));
+    expect_true(x.size() == n && x[7] == xs[7][0], "LU vector solve");
+
+    Matrix<double> small(3, 3);
+    small[0][0] = 0; small[0][1] = 2; small[0][2] = 1;
+    small[1][0] = 1; small[1][1] = 1; small[1][2] = 0;
+    small[2][0] = 3; small[2][1] = 0; small[2][2] = 4;
+    expect_true(std::abs(determinant(small) - (-11.0)) < 1e-12, "determinant with row swap");
+
+    const Matrix<double> singularM = filled(4, 4, 1.0);
+    const LuFactorization<double> singularLu(singularM);
+    expect_true(singularLu.singular() && singularLu.determinant() == 0.0, "singular detected");
+    threw = false;
+    try { (void)singularLu.solve(rhs); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "rhs rows must match");
+    threw = false;
+    try { (void)inverse(singularM); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "singular inverse throws");
+
+    // Cholesky on A^T A + n I
+    Matrix<double> spd = naiveProduct(transposed(m), m);
+    for (std::uint32_t i = 0; i < n; ++i) spd[i][i] += n;
+    const CholeskyFactorization<double> chol(spd);
+    const Matrix<double> l = chol.lower();
+    expect_true(maxDiff(naiveProduct(l, transposed(l)), spd) < 1e-9 && l[0][1] == 0.0, "L * L^T");
+    expect_true(maxDiff(naiveProduct(spd, chol.solve(rhs)), rhs) < 1e-9, "Cholesky solve");
+    const Matrix<double> spdBlock = spd.copy(0, 0, 8, 8);
+    const double detLu = determinant(spdBlock);
+    expect_true(std::abs(CholeskyFactorization<double>(spdBlock).determinant() - detLu) < 1e-9 * detLu, "Cholesky determinant");
+    threw = false;
+    try { CholeskyFactorization<double> bad(filled(3, 3, 1.0)); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "non-SPD throws");
+
+    // QR least squares: exact fit recovers the coefficients, residual is orthogonal
+    const Matrix<double> design = randomMatrix(300, 130);
+    const Matrix<double> coef = randomMatrix(130, 2);
+    const Matrix<double> target = naiveProduct(design, coef);
+    const QrFactorization<double> qr(design);
+    expect_true(maxDiff(qr.solve(target), coef) < 1e-9, "QR exact least squares");
+    expect_true(maxDiff(naiveProduct(qr.Q(), qr.R()), design) < 1e-10, "Q * R");
+    expect_true(maxDiff(naiveProduct(transposed(qr.Q()), qr.Q()), identity(130)) < 1e-10, "Q has orthonormal columns");
+    const Matrix<double> noisy = randomMatrix(300, 1);
+    const Matrix<double> residual = noisy - naiveProduct(design, lstsq(design, noisy));
+    expect_true(maxDiff(naiveProduct(transposed(design), residual), Matrix<double>(130, 1)) < 1e-10, "normal equations hold");
+
+    Matrix<double> rankDeficient = randomMatrix(10, 3);
+    for (std::uint32_t i = 0; i < 10; ++i) rankDeficient[i][2] = 2.0 * rankDeficient[i][0];
+    threw = false;
+    try { (void)lstsq(rankDeficient, Matrix<double>(10, 1)); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "rank-deficient lstsq throws");
+
+    // float goes through the same kernels
+    Matrix<float> fm(90, 90);
+    for (std::uint32_t i = 0; i < 90; ++i)
+        for (std::uint32_t j = 0; j < 90; ++j) fm[i][j] = static_cast<float>(m[i][j]) + (i == j ? 10.0f : 0.0f);
+    Matrix<float> ones(90, 1);
+    ones.fill(1.0f);
+    const Matrix<float> fx = solve(fm, ones);
+    const Matrix<float> fb = matmul(fm, fx);
+    float worst = 0.0f;
+    for (std::uint32_t i = 0; i < 90; ++i) worst = std::max(worst, std::abs(fb[i][0] - 1.0f));
+    expect_true(worst < 1e-4f, "float solve");
+
+    setParallelism(savedThreads);
+    LOG("[OK] dense linear algebra");
+}
+
+static void test_integer_gemm() {
+    print_type_header<std::int8_t>("widened integer GEMM");
+
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+
+    std::mt19937 rng(37);
+    auto naive = [](const auto& a, const auto& b, auto acc) {
+        using Acc = decltype(acc);
+        Matrix<Acc> out(a.numRows(), b.numCols());
+        for (std::uint32_t i = 0; i < a.numRows(); ++i)
+            for (std::uint32_t p = 0; p < a.numCols(); ++p)
+                for (std::uint32_t j = 0; j < b.numCols(); ++j)
+                    out[i][j] += static_cast<Acc>(a[i][p]) * static_cast<Acc>(b[p][j]);
+        return out;
+    };
+    auto randomCells = [&rng](auto& m, int lo, int hi) {
+        using T = typename std::decay_t<decltype(m)>::value_type;
+        std::uniform_int_distribution<int> dist(lo, hi);
+        for (std::uint32_t i = 0; i < m.numRows(); ++i)
+            for (std::uint32_t j = 0; j < m.numCols(); ++j) m[i][j] = static_cast<T>(dist(rng));
+    };
+
+    // Odd shapes cover the k-group, row-sliver and column-sliver padding.
+    Matrix<std::int8_t> a8(67, 1031), b8(1031, 45);
+    randomCells(a8, -128, 127);
+    randomCells(b8, -128, 127);
+    const Matrix<std::int32_t> ref8 = naive(a8, b8, std::int32_t{});
+    expect_true(matmulWidened(a8, b8) == ref8, "int8 x int8 -> int32");
+
+    Matrix<std::int8_t> extremeA(40, 700), extremeB(700, 33);
+    extremeA.fill(-128);
+    extremeB.fill(-128);
+    const Matrix<std::int32_t> extreme = matmulWidened(extremeA, extremeB);
+    expect_true(extreme[0][0] == 700 * 16384 && extreme[39][32] == 700 * 16384, "int8 -128 * -128 does not saturate");
+
+    Matrix<std::uint8_t> au(50, 900), bu(900, 70);
+    randomCells(au, 0, 255);
+    randomCells(bu, 0, 255);
+    expect_true(matmulWidened(au, bu) == naive(au, bu, std::int32_t{}), "uint8 x uint8 -> int32");
+    au.fill(255);
+    bu.fill(255);
+    expect_true(matmulWidened(au, bu)[49][69] == 900 * 65025, "uint8 extremes");
+
+    Matrix<std::int16_t> a16(33, 300), b16(300, 41);
+    randomCells(a16, -32768, 32767);
+    randomCells(b16, -32768, 32767);
+    expect_true(matmulWidened(a16, b16) == naive(a16, b16, std::int64_t{}), "int16 x int16 -> int64");
+
+    // Transposed operands through the raw interface, accumulating into C.
+    Matrix<std::int8_t> at(1031, 67), bt(45, 1031);
+    for (std::uint32_t i = 0; i < 67; ++i)
+        for (std::uint32_t p = 0; p < 1031; ++p) at[p][i] = a8[i][p];
+    for (std::uint32_t p = 0; p < 1031; ++p)
+        for (std::uint32_t j = 0; j < 45; ++j) bt[j][p] = b8[p][j];
+    Matrix<std::int32_t> c = ref8;
+    gemmWidened(true, true, 67, 45, 1031, at.data_storage(), 67, bt.data_storage(), 1031, c.data_storage(), 45, true);
+    expect_true(c == ref8 + ref8, "transposed operands, accumulate");
+
+    // Zero points: (a - za)(b - zb) with uint8 activations and weights.
+    Matrix<std::uint8_t> qa(20, 64), qb(64, 10);
+    randomCells(qa, 0, 255);
+    randomCells(qb, 0, 255);
+    Matrix<std::int32_t> shiftedA(20, 64), shiftedB(64, 10);
+    for (std::uint32_t i = 0; i < 20; ++i)
+        for (std::uint32_t p = 0; p < 64; ++p) shiftedA[i][p] = qa[i][p] - 128;
+    for (std::uint32_t p = 0; p < 64; ++p)
+        for (std::uint32_t j = 0; j < 10; ++j) shiftedB[p][j] = qb[p][j] - 3;
+    const Matrix<std::int32_t> zeroPointRef = naive(shiftedA, shiftedB, std::int32_t{});
+    expect_true(matmulWidened(qa, qb, 128, 3) == zeroPointRef, "zero points");
+
+    // Requantization rounds half away from zero and saturates.
+    Matrix<std::int32_t> acc(1, 5);
+    acc[0][0] = 5; acc[0][1] = -5; acc[0][2] = 1000; acc[0][3] = -1000; acc[0][4] = 0;
+    const Matrix<std::int8_t> r8 = requantize<std::int8_t>(acc, Requantization{0.5f, 1});
+    expect_true(r8[0][0] == 4 && r8[0][1] == -2 && r8[0][2] == 127 && r8[0][3] == -128 && r8[0][4] == 1, "requantize int8");
+    const Matrix<std::uint8_t> ru = requantize<std::uint8_t>(acc, Requantization{0.1f, 100});
+    expect_true(ru[0][0] == 101 && ru[0][1] == 99 && ru[0][2] == 200 && ru[0][3] == 0, "requantize uint8");
+
+    const Matrix<std::uint8_t> quantized = matmulQuantized(qa, qb, 128, 3, Requantization{0.001f, 128});
+    const Matrix<std::uint8_t> expectedQ = requantize<std::uint8_t>(zeroPointRef, Requantization{0.001f, 128});
+    expect_true(quantized == expectedQ, "matmulQuantized");
+
+    bool threw = false;
+    try { (void)matmulWidened(a8, a8); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "shape mismatch throws");
+
+    setParallelism(savedThreads);
+    LOG("[OK] widened integer GEMM");
+}
+
+static void test_convolution() {
+    print_type_header<double>("2D convolution");
+
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+
+    std::mt19937 rng(41);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    auto randomMatrix = [&](std::uint32_t r, std::uint32_t c) {
+        Matrix<double> m(r, c);
+        for (std::uint32_t i = 0; i < r; ++i)
+            for (std::uint32_t j = 0; j < c; ++j) m[i][j] = dist(rng);
+        return m;
+    };
+    auto boundaryIndex = [](std::int64_t i, std::int64_t n, BoundaryMode mode) -> std::int64_t {
+        for (int guard = 0; (i < 0 || i >= n) && guard < 64; ++guard) {
+            if (mode == BoundaryMode::Zero) return -1;
+            if (mode == BoundaryMode::Wrap) i = i < 0 ? i + n : i - n;
+            else if (n == 1) i = 0;
+            else i = i < 0 ? -i : 2 * (n - 1) - i;
+        }
+        return i;
+    };
+    // Textbook definitions, one cell at a time: sign +1 correlates, -1 convolves.
+    auto reference = [&](const Matrix<double>& in, const Matrix<double>& k, BoundaryMode mode, int sign = 1) {
+        const std::int64_t kr = k.numRows(), kc = k.numCols();
+        Matrix<double> out(in.numRows(), in.numCols());
+        for (std::int64_t i = 0; i < in.numRows(); ++i)
+            for (std::int64_t j = 0; j < in.numCols(); ++j) {
+                double s = 0.0;
+                for (std::int64_t u = 0; u < kr; ++u)
+                    for (std::int64_t v = 0; v < kc; ++v) {
+                        const std::int64_t r = boundaryIndex(i + sign * (u - kr / 2), in.numRows(), mode);
+                        const std::int64_t c = boundaryIndex(j + sign * (v - kc / 2), in.numCols(), mode);
+                        if (r >= 0 && c >= 0)
+                            s += k[static_cast<std::uint32_t>(u)][static_cast<std::uint32_t>(v)] *
+                                 in[static_cast<std::uint32_t>(r)][static_cast<std::uint32_t>(c)];
+                    }
+                out[static_cast<std::uint32_t>(i)][static_cast<std::uint32_t>(j)] = s;
+            }
+        return out;
+    };
+    auto maxDiff = [](const Matrix<double>& a, const Matrix<double>& b) {
+        double d = 0.0;
+        for (std::uint32_t i = 0; i < a.numRows(); ++i)
+            for (std::uint32_t j = 0; j < a.numCols(); ++j) d = std::max(d, std::abs(a[i][j] - b[i][j]));
+        return d;
+    };
+    auto rotated = [](const Matrix<double>& k) {
+        Matrix<double> out(k.numRows(), k.numCols());
+        for (std::uint32_t u = 0; u < k.numRows(); ++u)
+            for (std::uint32_t v = 0; v < k.numCols(); ++v) out[k.numRows() - 1 - u][k.numCols() - 1 - v] = k[u][v];
+        return out;
+    };
+
+    const BoundaryMode modes[] = {BoundaryMode::Zero, BoundaryMode::Reflect, BoundaryMode::Wrap};
+    const ConvolutionMethod methods[] = {ConvolutionMethod::Auto, ConvolutionMethod::Direct,
+                                         ConvolutionMethod::Gemm, ConvolutionMethod::Fft};
+    const Matrix<double> image = randomMatrix(83, 150);
+    const Matrix<double> kernels[] = {randomMatrix(3, 3), randomMatrix(4, 7), randomMatrix(17, 19)};
+    for (const Matrix<double>& k : kernels)
+        for (BoundaryMode mode : modes) {
+            const Matrix<double> expected = reference(image, k, mode);
+            const Matrix<double> expectedConv = reference(image, k, mode, -1);
+            for (ConvolutionMethod method : methods) {
+                const ConvolutionOptions options{mode, method};
+                expect_true(maxDiff(correlate2d(image, k, options), expected) < 1e-10, "correlate2d matches the definition");
+                expect_true(maxDiff(convolve2d(image, k, options), expectedConv) < 1e-10, "convolve2d matches the definition");
+                if (k.numRows() % 2 == 1 && k.numCols() % 2 == 1)
+                    expect_true(maxDiff(convolve2d(image, rotated(k), options), expected) < 1e-10, "convolve2d = correlation with rotated kernel");
+            }
+        }
+
+    // Kernels wider than the input make the reflection and wrap-around periodic.
+    const Matrix<double> tiny = randomMatrix(3, 4);
+    const Matrix<double> wide = randomMatrix(9, 11);
+    for (BoundaryMode mode : modes)
+        for (ConvolutionMethod method : methods)
+            expect_true(maxDiff(correlate2d(tiny, wide, {mode, method}), reference(tiny, wide, mode)) < 1e-10, "kernel larger than input");
+
+    // Rank-1 kernels take the separable path.
+    Matrix<double> gaussian(5, 5);
+    const double taps[] = {1, 4, 6, 4, 1};
+    for (std::uint32_t u = 0; u < 5; ++u)
+        for (std::uint32_t v = 0; v < 5; ++v) gaussian[u][v] = taps[u] * taps[v] / 256.0;
+    for (BoundaryMode mode : modes) {
+        const Matrix<double> expected = reference(image, gaussian, mode);
+        expect_true(maxDiff(correlate2d(image, gaussian, {mode, ConvolutionMethod::Separable}), expected) < 1e-12, "separable pass");
+        expect_true(maxDiff(correlate2d(image, gaussian, {mode, ConvolutionMethod::Auto}), expected) < 1e-12, "separable detection");
+    }
+    Matrix<double> constantImage(20, 20);
+    constantImage.fill(3.0);
+    const Matrix<double> blurred = convolve2d(constantImage, gaussian, {BoundaryMode::Reflect, ConvolutionMethod::Auto});
+    expect_true(std::abs(blurred[0][0] - 3.0) < 1e-12 && std::abs(blurred[19][7] - 3.0) < 1e-12, "normalized blur keeps a constant image");
+
+    // Streaming rows reproduce the batch result for every boundary mode.
+    const Matrix<double> streamKernel = randomMatrix(6, 5);
+    for (BoundaryMode mode : modes)
+        for (bool correlate : {false, true}) {
+            Matrix<double> streamed(image.numRows(), image.numCols());
+            std::vector<std::uint32_t> order;
+            StreamingConvolver<double> conv(streamKernel, image.numCols(),
+                [&](std::uint32_t row, const double* values) {
+                    order.push_back(row);
+                    for (std::uint32_t j = 0; j < streamed.numCols(); ++j) streamed[row][j] = values[j];
+                }, mode, correlate);
+            std::size_t emittedWhilePushing = 0;
+            for (std::uint32_t i = 0; i < image.numRows(); ++i) {
+                conv.push(image.getRow(i));
+                emittedWhilePushing = order.size();
+            }
+            conv.finish();
+            const Matrix<double> batch = correlate
+                ? correlate2d(image, streamKernel, {mode, ConvolutionMethod::Direct})
+                : convolve2d(image, streamKernel, {mode, ConvolutionMethod::Direct});
+            expect_true(maxDiff(streamed, batch) == 0.0, "streaming matches batch");
+            expect_true(order.size() == image.numRows() && emittedWhilePushing + 6 >= image.numRows(), "rows emitted as soon as possible");
+        }
+
+    bool threw = false;
+    try { (void)correlate2d(image, Matrix<double>(0, 0)); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "empty kernel throws");
+    threw = false;
+    try { (void)correlate2d(image, kernels[0], {BoundaryMode::Zero, ConvolutionMethod::Separable}); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "non-separable kernel rejected by Separable");
+
+    // float goes through the same kernels
+    Matrix<float> fimage(64, 64), fkernel(21, 21);
+    fimage.fill(1.0f);
+    fkernel.fill(1.0f / 441.0f);
+    const Matrix<float> fout = correlate2d(fimage, fkernel, {BoundaryMode::Wrap, ConvolutionMethod::Fft});
+    expect_true(std::abs(fout[10][40] - 1.0f) < 1e-5f, "float FFT path");
+
+    setParallelism(savedThreads);
+    LOG("[OK] 2D convolution");
+}
+
+static void test_prefix_sums() {
+    print_type_header<std::int32_t>("prefix sums / summed-area table");
+
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+
+    static_assert(std::is_same_v<scan_accumulator_t<std::int8_t>, std::int64_t>);
+    static_assert(std::is_same_v<scan_accumulator_t<std::uint16_t>, std::uint64_t>);
+    static_assert(std::is_same_v<scan_accumulator_t<float>, float>);
+
+    std::mt19937 rng(40);
+    std::uniform_int_distribution<int> small(-128, 127);
+
+    // Every code path (interleaved rows, column strips, chunked long lines) against a naive scan.
+    auto checkScans = [&](std::uint32_t r, std::uint32_t c) {
+        Matrix<std::int8_t> m(r, c);
+        for (std::uint32_t i = 0; i < r; ++i)
+            for (std::uint32_t j = 0; j < c; ++j) m[i][j] = static_cast<std::int8_t>(small(rng));
+        const Matrix<std::int64_t> rowIn = inclusiveScan(m, ScanAxis::Rows);
+        const Matrix<std::int64_t> rowEx = exclusiveScan(m, ScanAxis::Rows);
+        const Matrix<std::int64_t> colIn = inclusiveScan(m, ScanAxis::Cols);
+        const Matrix<std::int64_t> colEx = exclusiveScan(m, ScanAxis::Cols);
+        bool ok = true;
+        for (std::uint32_t i = 0; i < r; ++i) {
+            std::int64_t s = 0;
+            for (std::uint32_t j = 0; j < c; ++j) {
+                ok = ok && rowEx[i][j] == s;
+                s += m[i][j];
+                ok = ok && rowIn[i][j] == s;
+            }
+        }
+        for (std::uint32_t j = 0; j < c; ++j) {
+            std::int64_t s = 0;
+            for (std::uint32_t i = 0; i < r; ++i) {
+                ok = ok && colEx[i][j] == s;
+                s += m[i][j];
+                ok = ok && colIn[i][j] == s;
+            }
+        }
+        expect_true(ok, "scans match the naive running sums");
+    };
+    checkScans(37, 45);
+    checkScans(1, 200000);
+    checkScans(3, 70000);
+    checkScans(150000, 2);
+    checkScans(20, 1500);
+    expect_true(inclusiveScan(Matrix<std::int8_t>(0, 5)).numRows() == 0, "empty scan");
+
+    // int8 sums do not wrap in the widened accumulator.
+    Matrix<std::int8_t> saturated(2, 100000);
+    saturated.fill(127);
+    expect_true(inclusiveScan(saturated)[1][99999] == 12700000, "widened accumulator");
+
+    // Compensated float scans keep the error of a long running sum near one rounding.
+    Matrix<float> tenths(1, 1u << 20);
+    tenths.fill(0.1f);
+    const double exact = static_cast<double>(0.1f) * static_cast<double>(1u << 20);
+    const float plain = inclusiveScan(tenths)[0][(1u << 20) - 1];
+    const float compensated = inclusiveScan(tenths, ScanAxis::Rows, Summation::Compensated)[0][(1u << 20) - 1];
+    expect_true(std::abs(plain - exact) > 100.0, "plain float scan drifts");
+    expect_true(std::abs(compensated - exact) <= exact * 1e-7, "compensated float scan");
+    Matrix<float> tenthsDown(1u << 18, 3);
+    tenthsDown.fill(0.1f);
+    const Matrix<float> down = exclusiveScan(tenthsDown, ScanAxis::Cols, Summation::Compensated);
+    const double exactDown = static_cast<double>(0.1f) * static_cast<double>((1u << 18) - 1);
+    expect_true(std::abs(down[(1u << 18) - 1][2] - exactDown) <= exactDown * 1e-7, "compensated column scan");
+
+    // Summed-area table: random rectangles against copy().sum().
+    Matrix<std::int32_t> cells(123, 77);
+    std::uniform_int_distribution<std::int32_t> wide(-1000000, 1000000);
+    for (std::uint32_t i = 0; i < cells.numRows(); ++i)
+        for (std::uint32_t j = 0; j < cells.numCols(); ++j) cells[i][j] = wide(rng);
+    const SummedAreaTable<std::int32_t> table(cells);
+    bool ok = true;
+    for (int t = 0; t < 500; ++t) {
+        std::uint32_t r0 = rng() % 124, r1 = rng() % 124, c0 = rng() % 78, c1 = rng() % 78;
+        if (r0 > r1) std::swap(r0, r1);
+        if (c0 > c1) std::swap(c0, c1);
+        std::int64_t expected = 0;
+        for (std::uint32_t i = r0; i < r1; ++i)
+            for (std::uint32_t j = c0; j < c1; ++j) expected += cells[i][j];
+        ok = ok && table.rectSum(r0, c0, r1, c1) == expected;
+    }
+    expect_true(ok, "rectSum matches the cell sums");
+    std::int64_t all = 0;
+    for (std::uint32_t i = 0; i < cells.numRows(); ++i)
+        for (std::uint32_t j = 0; j < cells.numCols(); ++j) all += cells[i][j];
+    expect_true(table.total() == all && table.rectSum(0, 0, 123, 77) == all, "total");
+    expect_true(table.rectSum(5, 5, 5, 60) == 0, "empty rectangle");
+    bool threw = false;
+    try { (void)table.rectSum(0, 0, 124, 1); } catch (const std::out_of_range&) { threw = true; }
+    expect_true(threw, "rectangle outside the table throws");
+    threw = false;
+    try { (void)table.rectSum(3, 0, 2, 1); } catch (const std::out_of_range&) { threw = true; }
+    expect_true(threw, "reversed rectangle throws");
+
+    // 64-bit tables wrap, yet rectangles whose own sum fits stay exact.
+    Matrix<std::int64_t> huge(4, 4);
+    huge.fill(std::numeric_limits<std::int64_t>::max() / 3);
+    huge[2][1] = -17;
+    const SummedAreaTable<std::int64_t> hugeTable(huge);
+    expect_true(hugeTable.rectSum(2, 1, 3, 2) == -17, "wrapped table, exact cell");
+    expect_true(hugeTable.rectSum(0, 0, 2, 1) == 2 * (std::numeric_limits<std::int64_t>::max() / 3), "wrapped table, exact pair");
+
+    // A small window far from the origin of a float table: compensated keeps it accurate.
+    Matrix<float> offsetImage(1000, 1000);
+    std::uniform_real_distribution<float> noise(0.0f, 1.0f);
+    for (std::uint32_t i = 0; i < 1000; ++i)
+        for (std::uint32_t j = 0; j < 1000; ++j) offsetImage[i][j] = 1000.0f + noise(rng);
+    const SummedAreaTable<float> plainTable(offsetImage);
+    const SummedAreaTable<float> exactTable(offsetImage, Summation::Compensated);
+    expect_true(plainTable.summation() == Summation::Plain && exactTable.summation() == Summation::Compensated, "summation mode");
+    double worstPlain = 0.0, worstCompensated = 0.0;
+    for (std::uint32_t r = 900; r < 990; r += 7) {
+        double window = 0.0;
+        for (std::uint32_t i = r; i < r + 3; ++i)
+            for (std::uint32_t j = 950; j < 953; ++j) window += offsetImage[i][j];
+        worstPlain = std::max(worstPlain, std::abs(plainTable.rectSum(r, 950, r + 3, 953) - window));
+        worstCompensated = std::max(worstCompensated, std::abs(exactTable.rectSum(r, 950, r + 3, 953) - window));
+    }
+    expect_true(worstCompensated < 1e-2 && worstCompensated < worstPlain, "compensated rectSum far from the origin");
+
+    SummedAreaTable<std::uint8_t> emptyTable(Matrix<std::uint8_t>(0, 0));
+    expect_true(emptyTable.total() == 0 && emptyTable.rectSum(0, 0, 0, 0) == 0, "empty table");
+
+    setParallelism(savedThreads);
+    LOG("[OK] prefix sums / summed-area table");
+}
+
+static void test_perf_counters() {
+    print_type_header<std::int32_t>("performance counters");
+
+    const bool wasEnabled = perfCountersEnabled();
+    const std::size_t savedThreads = parallelism();
+    setParallelism(4);
+
+    expect_true(std::string(perfEventName(PerfEvent::LlcMisses)) == "llc-misses", "event names");
+
+    setPerfCountersEnabled(true);
+    if (!perfCountersCompiledIn()) {
+        expect_true(!perfCountersEnabled(), "cannot enable counters that are not compiled in");
+        std::ostringstream dump;
+        dumpPerfCounters(dump);
+        expect_true(dump.str().find("not compiled in") != std::string::npos, "dump without counters");
+        setParallelism(savedThreads);
+        LOG("[OK] performance counters (not compiled in)");
+        return;
+    }
+    expect_true(perfCountersEnabled(), "enable counters");
+
+    auto find = [](const std::vector<PerfRecord>& records, const std::string& op, const std::string& type) {
+        for (const PerfRecord& r : records)
+            if (r.operation == op && r.type == type) return r.counts;
+        return PerfCounts{};
+    };
+
+    resetPerfCounters();
+    Matrix<std::int32_t> a(64, 64), b(64, 64);
+    a.fill(3);
+    b.fill(4);
+    const Matrix<std::int32_t> c = a + b;
+    const Matrix<std::int32_t> d = c + 1;
+    Matrix<double> x(192, 192);
+    x.fill(0.5);
+    const Matrix<double> y = matmul(x, x);
+    expect_true(d[5][5] == 8 && y.sum() == 192 * 0.25 * 192 * 192, "instrumented results unchanged");
+
+    std::vector<PerfRecord> records = perfCounterSnapshot();
+    expect_true(find(records, "operator+", "int32").calls == 2, "both operator+ overloads merge per (operation, type)");
+    expect_true(find(records, "fill", "int32").calls == 2 && find(records, "fill", "double").calls == 1, "per-type records");
+    const PerfCounts mm = find(records, "matmul", "double");
+    expect_true(mm.calls == 1 && mm.nanoseconds > 0, "matmul timed");
+    expect_true(find(records, "gemm", "double").calls >= 1, "nested scopes count too");
+    for (std::size_t e = 0; e < kPerfEventCount; ++e) {
+        const PerfEvent event = static_cast<PerfEvent>(e);
+        if (perfEventAvailable(event) && (event == PerfEvent::Cycles || event == PerfEvent::Instructions))
+            expect_true(mm[event] > 0, "matmul cycles/instructions counted");
+        if (!perfEventAvailable(event))
+            expect_true(mm[event] == 0, "unavailable events read 0");
+    }
+    expect_true(std::is_sorted(records.begin(), records.end(), [](const PerfRecord& l, const PerfRecord& r) {
+        return std::tie(l.operation, l.type) < std::tie(r.operation, r.type);
+    }), "snapshot sorted");
+
+    std::ostringstream dump;
+    dumpPerfCounters(dump);
+    expect_true(dump.str().find("operator+") != std::string::npos && dump.str().find("int32") != std::string::npos,
+                "dump lists operations");
+
+    // Disabled scopes record nothing.
+    setPerfCountersEnabled(false);
+    const Matrix<std::int32_t> e = a + b;
+    expect_true(find(perfCounterSnapshot(), "operator+", "int32").calls == 2, "disabled counters stay put");
+
+    resetPerfCounters();
+    expect_true(perfCounterSnapshot().empty(), "reset clears totals");
+
+    setPerfCountersEnabled(wasEnabled);
+    setParallelism(savedThreads);
+    LOG("[OK] performance counters");
+}
+
+static void test_tracing() {
+    print_type_header<std::int32_t>("tracing");
+
+    const bool wasEnabled = tracingEnabled();
+    setTracingEnabled(true);
+    if (!tracingCompiledIn()) {
+        expect_true(!tracingEnabled(), "cannot enable tracing that is not compiled in");
+        LOG("[OK] tracing (not compiled in)");
+        return;
+    }
+    clearTrace();
+
+    Matrix<std::int32_t> a(64, 48), b(64, 48);
+    a.fill(1);
+    b.fill(2);
+    {
+        TraceSpan span("user \"step\"", "app");
+        const Matrix<std::int32_t> c = a + b;
+        expect_true(c.sum() == 3 * 64 * 48, "traced result unchanged");
+        const Matrix<std::int32_t> part = c.copy(8, 4, 24, 36);
+        expect_true(part.numRows() == 16, "traced copy");
+    }
+    std::thread worker([] {
+        Matrix<double> m(10, 20);
+        m.fill(0.5);
+        expect_true(m.max() == 0.5, "traced on another thread");
+    });
+    worker.join();
+    setTracingEnabled(false);
+    const Matrix<std::int32_t> untraced = a - b;
+
+    const std::vector<TraceEvent> events = traceSnapshot();
+    auto find = [&](const std::string& name) -> const TraceEvent* {
+        for (const TraceEvent& e : events)
+            if (e.name == name) return &e;
+        return nullptr;
+    };
+    const TraceEvent* add = find("operator+");
+    const TraceEvent* user = find("user \"step\"");
+    const TraceEvent* copy = find("copy");
+    const TraceEvent* max = find("max");
+    expect_true(add && add->type == "int32" && add->category == "bml" && add->rows == 64 && add->cols == 48
+                && add->bytes == 3u * 64 * 48 * 4, "operator+ span carries dtype, shape and bytes");
+    expect_true(copy && copy->rows == 16 && copy->cols == 32 && copy->bytes == 2u * 16 * 32 * 4, "copy span is the copied region");
+    expect_true(user && user->category == "app" && user->type.empty(), "user span");
+    expect_true(user && add && user->startNs <= add->startNs
+                && add->startNs + add->durationNs <= user->startNs + user->durationNs, "library spans nest in user spans");
+    expect_true(user && add && user->threadId == add->threadId, "same thread id");
+    expect_true(max && add && max->threadId != add->threadId && max->type == "double", "spans of finished threads kept");
+    expect_true(find("operator-") == nullptr, "nothing recorded while disabled");
+    expect_true(std::is_sorted(events.begin(), events.end(), [](const TraceEvent& l, const TraceEvent& r) {
+        return l.startNs < r.startNs;
+    }), "snapshot ordered by start");
+
+    std::string json;
+    StringSink sink(json);
+    writeChromeTrace(sink);
+    expect_true(json.find("\"traceEvents\":[") != std::string::npos && json.find("\"ph\":\"X\"") != std::string::npos,
+                "chrome trace events");
+    expect_true(json.find("\"dtype\":\"int32\",\"rows\":64,\"cols\":48") != std::string::npos, "chrome trace args");
+    expect_true(json.find("\"user \\\"step\\\"\"") != std::string::npos, "names are JSON-escaped");
+
+    // The ring keeps the most recent spans of each thread.
+    setTracingEnabled(true);
+    clearTrace();
+    for (int i = 0; i < 40000; ++i) TraceSpan span("tick");
+    setTracingEnabled(false);
+    const std::vector<TraceEvent> ticks = traceSnapshot();
+    expect_true(ticks.size() == 32768 && traceEventsDropped() == 40000 - 32768, "ring overwrites the oldest spans");
+    clearTrace();
+    expect_true(traceSnapshot().empty() && traceEventsDropped() == 0, "clearTrace");
+
+    setTracingEnabled(wasEnabled);
+    LOG("[OK] tracing");
+}
+
+static void test_memory_stats() {
+    print_type_header<double>("allocation accounting");
+
+    const AllocationStats before = allocationStats();
+    {
+        AllocationScope scope;
+        Matrix<double> a(100, 50), b(100, 50);
+        AllocationStats s = scope.stats();
+        expect_true(s.allocations == 2 && s.bytesAllocated == 2 * 100 * 50 * sizeof(double), "two buffers allocated");
+        expect_true(s.liveMatrices == 2 && s.liveBuffers == 2 && s.liveBytes == s.bytesAllocated, "live counters");
+        expect_true(allocationStats().liveMatrices >= before.liveMatrices + 2, "global live matrices");
+
+        // a + b * 2: the product is a temporary, the sum survives.
+        const Matrix<double> r = a + b * 2.0;
+        s = scope.stats();
+        expect_true(s.allocations == 4 && s.temporaries == 1 && s.temporaryBytes == 100 * 50 * sizeof(double),
+                    "expression temporaries");
+        expect_true(s.peakBytes == 4 * 100 * 50 * sizeof(double) && s.liveBytes == 3 * 100 * 50 * sizeof(double),
+                    "peak includes the temporary");
+
+        // Copies share the buffer until written.
+        Matrix<double> c = a;
+        expect_true(scope.stats().allocations == 4 && scope.stats().liveMatrices == 4, "copy shares the buffer");
+        c[0][0] = 1.0;
+        expect_true(scope.stats().allocations == 5, "copy-on-write detach allocates");
+
+        {
+            AllocationScope inner;
+            const Matrix<double> t = a * 3.0;
+            expect_true(inner.stats().allocations == 1 && inner.stats().temporaries == 0, "inner scope");
+        }
+        expect_true(scope.stats().temporaries == 2, "freed inside the outer scope too");
+    }
+    const AllocationStats after = allocationStats();
+    expect_true(after.liveBuffers == before.liveBuffers && after.liveBytes == before.liveBytes
+                && after.liveMatrices == before.liveMatrices, "everything released");
+    expect_true(after.allocations - before.allocations == after.deallocations - before.deallocations, "balanced");
+    expect_true(threadAllocationStats().allocations >= 6, "per-thread counters");
+
+    // memoryUsage(): object + cells, plus string payloads off the small-string buffer.
+    const Matrix<std::int32_t> ints(10, 10);
+    expect_true(ints.memoryUsage() == sizeof(ints) + 100 * sizeof(std::int32_t), "memoryUsage of ints");
+    Matrix<std::string> strings(2, 2);
+    const std::size_t empty = strings.memoryUsage();
+    expect_true(empty == sizeof(strings) + 4 * sizeof(std::string), "memoryUsage of short strings");
+    strings[0][0] = "ab";
+    expect_true(strings.memoryUsage() == empty, "short strings stay inline");
+    strings[1][1] = std::string(1000, 'x');
+    expect_true(strings.memoryUsage() >= empty + 1001, "long string payload counted");
+
+    resetAllocationStats();
+    const AllocationStats reset = allocationStats();
+    expect_true(reset.allocations == 0 && reset.peakBytes == reset.liveBytes, "reset");
+
+    LOG("[OK] allocation accounting");
+}
+
+static void test_kernel_dispatch() {
+    print_type_header<double>("kernel multiversioning");
+
+    const std::string isa = kernelIsa();
+    expect_true(isa == "x86-64-v4" || isa == "x86-64-v3" || isa == "x86-64-v2" || isa == "default", "known ISA level");
+    if (!multiversioningCompiledIn()) expect_true(isa == "default", "baseline kernels only");
+
+    // Whichever clone runs, products round like a plain left-to-right loop (no FMA contraction).
+    for (std::uint32_t n : {8u, 64u}) {
+        Matrix<double> a(n, n), b(n, n);
+        for (std::uint32_t i = 0; i < n; ++i)
+            for (std::uint32_t j = 0; j < n; ++j) {
+                a[i][j] = 1.0 / (1.0 + i + 3.0 * j);
+                b[i][j] = std::sin(0.1 * i + 0.7 * j);
+            }
+        const Matrix<double> c = matmul(a, b);
+        bool same = true;
+        for (std::uint32_t i = 0; i < n; ++i)
+            for (std::uint32_t j = 0; j < n; ++j) {
+                double ref = 0.0;
+                for (std::uint32_t p = 0; p < n; ++p) ref += a[i][p] * b[p][j];
+                same = same && c[i][j] == ref;
+            }
+        expect_true(same, "matmul matches the scalar reference bit for bit");
+    }
+
+    LOG("[OK] kernel multiversioning (" << isa << ")");
+}
+
+static void test_gemv() {
+    print_type_header<double>("matrix-vector products");
+
+    // Odd sizes leave tails after the lane blocks; 300 x 257 spreads over several tasks.
+    const std::uint32_t m = 300, n = 257;
+    Matrix<double> a(m, n);
+    std::vector<double> x(n), bias(m);
+    for (std::uint32_t i = 0; i < m; ++i) {
+        bias[i] = 0.01 * i - 1.5;
+        for (std::uint32_t j = 0; j < n; ++j) a[i][j] = std::cos(0.37 * i + 0.11 * j);
+    }
+    for (std::uint32_t j = 0; j < n; ++j) x[j] = std::sin(0.05 * j);
+
+    std::vector<double> ref(m);
+    for (std::uint32_t i = 0; i < m; ++i) {
+        double s = 0.0;
+        for (std::uint32_t j = 0; j < n; ++j) s += a[i][j] * x[j];
+        ref[i] = s;
+    }
+    auto close = [](double u, double v) { return std::abs(u - v) <= 1e-9 * (1.0 + std::abs(v)); };
+
+    const std::vector<double> y = matvec(a, x);
+    bool ok = y.size() == m;
+    for (std::uint32_t i = 0; ok && i < m; ++i) ok = close(y[i], ref[i]);
+    expect_true(ok, "matvec");
+
+    GemvEpilogue<double> ep;
+    ep.scale = 2.0;
+    ep.bias = bias.data();
+    ep.activation = Activation::Relu;
+    const std::vector<double> yr = matvec(a, x, ep);
+    ok = true;
+    for (std::uint32_t i = 0; ok && i < m; ++i) ok = close(yr[i], std::max(0.0, 2.0 * ref[i] + bias[i]));
+    expect_true(ok, "fused scale, bias and relu");
+
+    ep.activation = Activation::Clamp;
+    ep.clampLow = -0.5;
+    ep.clampHigh = 0.5;
+    const std::vector<double> yc = matvec(a, x, ep);
+    ep.activation = Activation::Sigmoid;
+    const std::vector<double> ys = matvec(a, x, ep);
+    ok = true;
+    for (std::uint32_t i = 0; ok && i < m; ++i) {
+        const double v = 2.0 * ref[i] + bias[i];
+        ok = close(yc[i], std::min(0.5, std::max(-0.5, v))) && close(ys[i], 1.0 / (1.0 + std::exp(-v)));
+    }
+    expect_true(ok, "fused clamp and sigmoid");
+
+    // Column and row vectors keep their orientation.
+    Matrix<double> xc(n, 1), xr(1, n);
+    for (std::uint32_t j = 0; j < n; ++j) xc[j][0] = xr[0][j] = x[j];
+    const Matrix<double> yc1 = matvec(a, xc), yr1 = matvec(a, xr);
+    expect_true(yc1.numRows() == m && yc1.numCols() == 1 && yr1.numRows() == 1 && yr1.numCols() == m, "vector shapes");
+    ok = true;
+    for (std::uint32_t i = 0; ok && i < m; ++i) ok = yc1[i][0] == y[i] && yr1[0][i] == y[i];
+    expect_true(ok, "matrix vectors match std::vector");
+
+    // x^T * a
+    std::vector<double> xt(m);
+    for (std::uint32_t i = 0; i < m; ++i) xt[i] = 1.0 / (1.0 + i);
+    const std::vector<double> yt = vecmat(xt, a);
+    ok = yt.size() == n;
+    for (std::uint32_t j = 0; ok && j < n; ++j) {
+        double s = 0.0;
+        for (std::uint32_t i = 0; i < m; ++i) s += xt[i] * a[i][j];
+        ok = close(yt[j], s);
+    }
+    expect_true(ok, "vecmat");
+
+    // A batch of 7 (one short group of four) matches one matvec per row.
+    ep.activation = Activation::Relu;
+    Matrix<double> xs(7, n);
+    for (std::uint32_t b = 0; b < 7; ++b)
+        for (std::uint32_t j = 0; j < n; ++j) xs[b][j] = x[j] * (1.0 + b) - 0.1 * b;
+    const Matrix<double> yb = matvecBatch(a, xs, ep);
+    ok = yb.numRows() == 7 && yb.numCols() == m;
+    for (std::uint32_t b = 0; ok && b < 7; ++b) {
+        const std::vector<double> one = matvec(a, xs.getRow(b), ep);
+        for (std::uint32_t i = 0; ok && i < m; ++i) ok = yb[b][i] == one[i];
+    }
+    expect_true(ok, "batched matvec");
+
+    // Integers are exact.
+    Matrix<std::int32_t> ia(3, 3);
+    for (std::uint32_t i = 0; i < 9; ++i) ia[i / 3][i % 3] = static_cast<std::int32_t>(i + 1);
+    const std::vector<std::int32_t> ib{-100, 0, 100};
+    GemvEpilogue<std::int32_t> iep;
+    iep.bias = ib.data();
+    iep.activation = Activation::Relu;
+    expect_true(matvec(ia, std::vector<std::int32_t>{1, 1, 1}, iep) == std::vector<std::int32_t>{0, 15, 124}, "integer matvec");
+    expect_true(vecmat(std::vector<std::int32_t>{1, 0, 1}, ia) == std::vector<std::int32_t>{8, 10, 12}, "integer vecmat");
+
+    bool threw = false;
+    try { (void)matvec(a, std::vector<double>(n + 1)); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "length mismatch throws");
+    threw = false;
+    iep.activation = Activation::Sigmoid;
+    try { (void)matvec(ia, std::vector<std::int32_t>{1, 1, 1}, iep); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "integer sigmoid throws");
+
+    LOG("[OK] matrix-vector products");
+}
+
+static void test_matrix_batch() {
+    print_type_header<double>("matrix batches");
+
+    // 37 matrices: four full interleaved groups of 8 doubles plus a short one.
+    const std::size_t count = 37;
+    std::vector<Matrix<double>> as, bs, rhs;
+    for (std::size_t b = 0; b < count; ++b) {
+        Matrix<double> a(5, 5), m(5, 3), r(5, 2);
+        for (std::uint32_t i = 0; i < 5; ++i) {
+            for (std::uint32_t j = 0; j < 5; ++j) a[i][j] = std::sin(1.0 + b + 0.3 * i + 0.7 * j) + (i == j ? 3.0 : 0.0);
+            for (std::uint32_t j = 0; j < 3; ++j) m[i][j] = std::cos(0.5 * b + i - j);
+            for (std::uint32_t j = 0; j < 2; ++j) r[i][j] = 0.1 * b + i + j;
+        }
+        as.push_back(a);
+        bs.push_back(m);
+        rhs.push_back(r);
+    }
+    auto close = [](const Matrix<double>& u, const Matrix<double>& v) {
+        if (u.numRows() != v.numRows() || u.numCols() != v.numCols()) return false;
+        for (std::uint32_t i = 0; i < u.numRows(); ++i)
+            for (std::uint32_t j = 0; j < u.numCols(); ++j)
+                if (std::abs(u[i][j] - v[i][j]) > 1e-10 * (1.0 + std::abs(v[i][j]))) return false;
+        return true;
+    };
+
+    for (BatchLayout layout : {BatchLayout::Contiguous, BatchLayout::Interleaved}) {
+        const MatrixBatch<double> a(as, layout), m(bs, layout), r(rhs, BatchLayout::Contiguous);
+        expect_true(a.size() == count && a.numRows() == 5 && a.layout() == layout, "batch shape");
+        bool ok = true;
+        for (std::size_t b = 0; ok && b < count; ++b) ok = a.get(b) == as[b] && a(b, 2, 3) == as[b][2][3];
+        expect_true(ok, "get and unchecked access");
+
+        const MatrixBatch<double> sum = a + a * 2.0, prod = matmul(a, m), t = m.transpose();
+        const MatrixBatch<double> x = solve(a, r);
+        const std::vector<double> sums = a.sums(), mins = a.mins(), maxs = a.maxs();
+        for (std::size_t b = 0; ok && b < count; ++b) {
+            ok = sum.get(b) == as[b] + as[b] * 2.0
+                 && close(prod.get(b), matmul(as[b], bs[b]))
+                 && t.get(b).numRows() == 3 && t.get(b)[2][4] == bs[b][4][2]
+                 && close(x.get(b), solve(as[b], rhs[b]))
+                 && sums[b] == as[b].sum() && mins[b] == as[b].min() && maxs[b] == as[b].max();
+        }
+        expect_true(ok, "element-wise, matmul, transpose, solve and reductions match Matrix");
+        expect_true(a.toLayout(BatchLayout::Contiguous).get(36) == as[36]
+                    && a.toLayout(BatchLayout::Interleaved).get(17) == as[17], "layout conversion");
+    }
+
+    // Integers, and mixed layouts on the two sides.
+    MatrixBatch<std::int32_t> ia(20, 2, 2, BatchLayout::Interleaved), ib(20, 2, 2);
+    for (std::size_t b = 0; b < 20; ++b)
+        for (std::uint32_t i = 0; i < 2; ++i)
+            for (std::uint32_t j = 0; j < 2; ++j) {
+                ia(b, i, j) = static_cast<std::int32_t>(b + i * 2 + j);
+                ib(b, i, j) = (i == j) ? 2 : 0;
+            }
+    const MatrixBatch<std::int32_t> ip = matmul(ia, ib);
+    expect_true(ip.layout() == BatchLayout::Interleaved && ip(19, 1, 1) == 2 * (19 + 3), "integer matmul across layouts");
+    expect_true((ia - ia).sums() == std::vector<std::int32_t>(20, 0), "integer subtraction");
+
+    bool threw = false;
+    try { (void)(ia / (ib - ib + 1)); (void)(ia / (ib * 0)); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "division by zero throws");
+    threw = false;
+    try { (void)(ia + MatrixBatch<std::int32_t>(19, 2, 2)); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "count mismatch throws");
+    threw = false;
+    try { (void)ia.at(20, 0, 0); } catch (const std::out_of_range&) { threw = true; }
+    expect_true(threw, "checked access throws");
+    threw = false;
+    try { (void)solve(MatrixBatch<double>(3, 2, 2), MatrixBatch<double>(3, 2, 1)); }
+    catch (const std::runtime_error& e) { threw = std::string(e.what()).find("matrix 0") != std::string::npos; }
+    expect_true(threw, "singular matrix reported");
+
+    LOG("[OK] matrix batches");
+}
+
+static void test_lazy_graph() {
+    print_type_header<double>("lazy expression graphs");
+
+    // 300 x 70: several tiles of 512 doubles and a partial one.
+    Matrix<double> A(300, 70), B(300, 70);
+    for (std::uint32_t i = 0; i < 300; ++i)
+        for (std::uint32_t j = 0; j < 70; ++j) {
+            A[i][j] = std::sin(0.01 * i + 0.3 * j);
+            B[i][j] = 2.0 + std::cos(0.02 * i - 0.1 * j);
+        }
+
+    LazyGraph<double> g;
+    const LazyExpr<double> a = g.input(A), b = g.input(B);
+    expect_true(g.input(A).id() == a.id(), "same input is one node");
+    const LazyExpr<double> ab = a * b;
+    const LazyExpr<double> e = (ab + 1.0) / (b * a - 1.0);
+    expect_true((b * a).id() == ab.id() && g.size() == 7, "common subexpressions are shared");
+    expect_true(e.numRows() == 300 && e.numCols() == 70, "expression shape");
+
+    const Matrix<double> eager = (A * B + 1.0) / (A * B - 1.0);
+    expect_true(e.eval() == eager, "fused evaluation matches eager operators");
+    const std::vector<Matrix<double>> both = g.evaluate({e, ab * 2.0 - a});
+    expect_true(both[0] == eager && both[1] == A * B * 2.0 - A, "several results in one pass");
+
+    const double dot = (a * b).sum();
+    expect_true(std::abs(dot - (A * B).sum()) <= 1e-12 * std::abs((A * B).sum()), "fused sum(a * b)");
+    expect_true((a - b).min() == (A - B).min() && (a / 3.0).max() == (A / 3.0).max(), "fused min and max");
+
+    // Integers wrap like the eager operators.
+    Matrix<std::int8_t> I(40, 40);
+    for (std::uint32_t i = 0; i < 40; ++i)
+        for (std::uint32_t j = 0; j < 40; ++j) I[i][j] = static_cast<std::int8_t>(i * 7 + j);
+    LazyGraph<std::int8_t> gi;
+    const LazyExpr<std::int8_t> li = gi.input(I);
+    expect_true((li * li + li).eval() == I * I + I && (li * li).sum() == (I * I).sum(), "integer expressions");
+
+    bool threw = false;
+    try { (void)(a + g.input(Matrix<double>(3, 3))); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "shape mismatch throws");
+    threw = false;
+    try { (void)(li / (li - li)).eval(); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "zero divisor throws on evaluation");
+    threw = false;
+    try { (void)(a / 0.0); } catch (const std::runtime_error&) { threw = true; }
+    expect_true(threw, "zero scalar divisor throws");
+    threw = false;
+    LazyGraph<double> other;
+    try { (void)(a + other.input(A)); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "expressions of another graph are rejected");
+
+    LOG("[OK] lazy expression graphs");
+}
+
+static void test_reduction_cache() {
+    print_type_header<std::int64_t>("cached reductions");
+
+    Matrix<std::int64_t> m(500, 37);
+    for (std::uint32_t i = 0; i < 500; ++i)
+        for (std::uint32_t j = 0; j < 37; ++j) m[i][j] = static_cast<std::int64_t>(i * 37 + j) % 1001 - 500;
+    m.enableReductionCache(16);
+    expect_true(m.reductionCacheEnabled(), "cache enabled");
+    auto plain = [](Matrix<std::int64_t> c) { c.disableReductionCache(); return std::make_tuple(c.sum(), c.min(), c.max()); };
+    expect_true(std::make_tuple(m.sum(), m.min(), m.max()) == plain(m), "cached reductions match a full scan");
+
+    // Writes through operator[], paste, a compound operator and data_storage().
+    m[77][3] = 100000;
+    expect_true(m.max() == 100000 && m.sum() == std::get<0>(plain(m)), "operator[] write seen");
+    Matrix<std::int64_t> patch(20, 5);
+    patch.fill(-7000);
+    m.paste(patch, 480, 30);
+    expect_true(m.min() == -7000 && std::make_tuple(m.sum(), m.min(), m.max()) == plain(m), "paste across the last block seen");
+    m += 1;
+    expect_true(std::make_tuple(m.sum(), m.min(), m.max()) == plain(m), "compound operator seen");
+    m.data_storage()[0] = -9000000;
+    expect_true(m.min() == -9000000, "data_storage() write seen");
+
+    // A copy has its own cache; a write to one does not leak into the other.
+    Matrix<std::int64_t> copy = m;
+    copy[0][0] = 9000000;
+    expect_true(copy.max() == 9000000 && m.max() != 9000000 && m.min() == -9000000, "copies track their own writes");
+
+    Matrix<bool> mask(300, 300);
+    mask.enableReductionCache();
+    for (std::uint32_t i = 0; i < 300; i += 3) mask[i][i] = true;
+    expect_true(mask.count_true() == 100, "cached count_true");
+    mask[3][3] = false;
+    mask[299][0] = true;
+    expect_true(mask.count_true() == 100, "count_true after writes");
+
+    Matrix<double> d(256, 256);
+    for (std::uint32_t i = 0; i < 256; ++i)
+        for (std::uint32_t j = 0; j < 256; ++j) d[i][j] = std::sin(0.1 * i * j);
+    const double exact = d.sum();
+    d.enableReductionCache();
+    expect_true(std::abs(d.sum() - exact) <= 1e-12 * (1.0 + std::abs(exact)), "cached floating-point sum");
+
+    LOG("[OK] cached reductions");
+}
+
+static void test_matrix_resizing() {
+    print_type_header<std::int32_t>("resizing");
+
+    auto value = [](std::uint32_t i, std::uint32_t j) { return static_cast<std::int32_t>(i * 100 + j); };
+    Matrix<std::int32_t> m(0, 0);
+    m.reserve(8);
+    for (std::uint32_t i = 0; i < 50; ++i) {
+        std::vector<std::int32_t> row;
+        for (std::uint32_t j = 0; j < 6; ++j) row.push_back(value(i, j));
+        m.appendRow(row);
+    }
+    bool ok = m.numRows() == 50 && m.numCols() == 6 && m.rowCapacity() >= 50;
+    for (std::uint32_t i = 0; ok && i < 50; ++i)
+        for (std::uint32_t j = 0; j < 6; ++j) ok = ok && m[i][j] == value(i, j);
+    expect_true(ok, "appendRow grows a 0 x 0 matrix");
+
+    const Matrix<std::int32_t> before = m;
+    m.appendRow(m[0].begin(), 6);   // a row of the matrix itself
+    expect_true(m.numRows() == 51 && m.getRow(50) == before.getRow(0) && before.numRows() == 50, "self-append; copies unaffected");
+
+    m.eraseRows(10, 5);
+    expect_true(m.numRows() == 46 && m[10][2] == value(15, 2) && m[9][5] == value(9, 5), "eraseRows");
+    m.insertRows(10, before.copy(10, 0, 15, -1));
+    expect_true(m.copy(0, 0, 50, -1) == before, "insertRows restores erased rows");
+    m.appendRows(m.copy(0, 0, 2, -1));
+    expect_true(m.numRows() == 53 && m.getRow(52) == before.getRow(1), "appendRows");
+
+    Matrix<std::int32_t> extra(53, 2);
+    extra.fill(-1);
+    m.insertCols(3, extra);
+    expect_true(m.numCols() == 8 && m[7][2] == value(7, 2) && m[7][3] == -1 && m[7][4] == -1 && m[7][5] == value(7, 3),
+                "insertCols");
+    m.eraseCols(3, 2);
+    expect_true(m.copy(0, 0, 50, -1) == before, "eraseCols");
+
+    m.resize(60, 9);
+    expect_true(m[49][5] == value(49, 5) && m[49][8] == 0 && m[59][0] == 0 && m.copy(0, 0, 50, 6) == before, "resize larger");
+    m.resize(4, 3);
+    expect_true(m.numRows() == 4 && m.numCols() == 3 && m[3][2] == value(3, 2), "resize smaller");
+    m.resize(5, 5);
+    expect_true(m[3][4] == 0 && m[4][0] == 0, "regrown cells are zero");
+    m.shrinkToFit();
+    expect_true(m.rowCapacity() == 5, "shrinkToFit");
+
+    Matrix<std::string> names(0, 0);
+    names.appendRow(std::vector<std::string>{"alpha", "beta"});
+    names.appendRow(std::vector<std::string>{"a rather long string that is not stored inline", "delta"});
+    names.insertRows(0, names.copy(1, 0, 2, -1));
+    names.eraseCols(0, 1);
+    expect_true(names.numRows() == 3 && names.numCols() == 1 && names[0][0] == "delta" && names[1][0] == "beta", "string rows");
+
+    Matrix<std::int64_t> cached(100, 4);
+    cached.enableReductionCache(8);
+    (void)cached.sum();
+    cached.appendRow(std::vector<std::int64_t>{1, 2, 3, 4});
+    expect_true(cached.sum() == 10 && cached.max() == 4, "cached reductions follow appends");
+
+    bool threw = false;
+    try { m.appendRow(std::vector<std::int32_t>{1, 2}); } catch (const std::invalid_argument&) { threw = true; }
+    expect_true(threw, "wrong row length throws");
+    threw = false;
+    try { m.eraseRows(4, 2); } catch (const std::out_of_range&) { threw = true; }
+    expect_true(threw, "bad erase range throws");
+
+    LOG("[OK] resizing");
+}
+
 // ---------- stress tests ----------
 template<typename T>
 void stress_numeric(const char* label, std::uint32_t R, std::uint32_t C, int repeats = 2) {
@@ -848,6 +2780,9 @@ int testMatrix() {
         // Strings
         test_string_verbose();
 
+        // Compile-time fixed shapes
+        test_fixed_matrix();
+
         SEP();
         LOG("[BML TEST] Functional tests passed. Beginning stress…");
         SEP();
@@ -857,6 +2792,33 @@ int testMatrix() {
         test_rule_of_five_core<double>();
         test_rule_of_five_core<bool>(); // if Matrix<bool> meets the semantics
 
+        test_copy_on_write<std::int32_t>();
+        test_copy_on_write<double>();
+        test_copy_on_write<bool>();
+        test_copy_on_write<std::string>();
+        test_copy_paste_blocks();
+        test_compare_and_hash();
+        test_text_writer();
+        test_csv_reader();
+        test_npy_npz();
+        test_codecs();
+        test_byte_streaming();
+        test_async_snapshots();
+        test_sparse_matrix();
+        test_linear_algebra();
+        test_integer_gemm();
+        test_convolution();
+        test_prefix_sums();
+        test_perf_counters();
+        test_tracing();
+        test_memory_stats();
+        test_kernel_dispatch();
+        test_gemv();
+        test_matrix_batch();
+        test_lazy_graph();
+        test_reduction_cache();
+        test_matrix_resizing();
+
         // --- Stress sizes (adaptive)
         struct Attempt { std::uint32_t r,c; };
         const Attempt big_attempts[] = { {4096,4096}, {2048,2048} };
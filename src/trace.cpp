@@ -0,0 +1,353 @@
+#include "bml/trace.hpp"
+#include "bml/sink.hpp"
+#include "bml/version.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__linux__)
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#elif !defined(_WIN32)
+  #include <unistd.h>
+#endif
+
+namespace bml
+{
+    namespace detail
+    {
+        namespace
+        {
+            constexpr std::size_t kTraceRingEvents = std::size_t{1} << 15;
+
+            bool enabledFromEnvironment() noexcept
+            {
+#if defined(BML_TRACING) && BML_TRACING
+                const char* env = std::getenv("BML_TRACE");
+                return env != nullptr && std::strtol(env, nullptr, 10) != 0;
+#else
+                return false;
+#endif
+            }
+
+            std::uint64_t nowNs() noexcept
+            {
+                // Relative to the first call, so microsecond timestamps keep their nanosecond digits.
+                using clock = std::chrono::steady_clock;
+                static const clock::time_point epoch = clock::now();
+                return static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - epoch).count());
+            }
+
+            std::uint64_t osThreadId() noexcept
+            {
+#if defined(__linux__)
+                return static_cast<std::uint64_t>(syscall(SYS_gettid));
+#else
+                return static_cast<std::uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+            }
+
+            // Fields are relaxed atomics so a snapshot may read a slot the owner is
+            // rewriting without a data race; such slots are detected and skipped.
+            struct TraceSlot
+            {
+                std::atomic<const char*> name{nullptr};
+                std::atomic<const char*> category{nullptr};
+                std::atomic<const char*> type{nullptr};
+                std::atomic<std::uint64_t> shape{0};   // rows << 32 | cols
+                std::atomic<std::uint64_t> bytes{0};
+                std::atomic<std::uint64_t> startNs{0};
+                std::atomic<std::uint64_t> durationNs{0};
+            };
+
+            // Spans of one thread. Only the owner writes; snapshots read concurrently.
+            // Event i lives in slot i % kTraceRingEvents. claimed runs ahead of
+            // published while a slot is being written, like a sequence lock.
+            struct ThreadRing
+            {
+                explicit ThreadRing(std::uint64_t id) : threadId(id), slots(new TraceSlot[kTraceRingEvents]) {}
+
+                std::uint64_t threadId;
+                std::unique_ptr<TraceSlot[]> slots;
+                std::atomic<std::uint64_t> claimed{0};
+                std::atomic<std::uint64_t> published{0};
+                std::atomic<std::uint64_t> floor{0};   // events before this were cleared
+            };
+
+            std::mutex& registryMutex()
+            {
+                static std::mutex m;
+                return m;
+            }
+
+            // Rings stay registered after their thread exits, so its spans can still be exported.
+            std::vector<std::shared_ptr<ThreadRing>>& registry()
+            {
+                static std::vector<std::shared_ptr<ThreadRing>> rings;
+                return rings;
+            }
+
+            ThreadRing* threadRing() noexcept
+            {
+                thread_local ThreadRing* ring = nullptr;
+                if (ring) return ring;
+                try
+                {
+                    auto created = std::make_shared<ThreadRing>(osThreadId());
+                    std::lock_guard<std::mutex> lock(registryMutex());
+                    registry().push_back(created);
+                    ring = created.get();
+                }
+                catch (...)
+                {
+                    // Out of memory: this span is not recorded; the next one tries again.
+                }
+                return ring;
+            }
+
+            void record(const char* name, const char* category, const char* type, std::uint32_t rows,
+                        std::uint32_t cols, std::uint64_t bytes, std::uint64_t startNs, std::uint64_t endNs) noexcept
+            {
+                ThreadRing* ring = threadRing();
+                if (!ring) return;
+
+                const std::uint64_t i = ring->published.load(std::memory_order_relaxed);
+                ring->claimed.store(i + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                TraceSlot& slot = ring->slots[i % kTraceRingEvents];
+                slot.name.store(name, std::memory_order_relaxed);
+                slot.category.store(category, std::memory_order_relaxed);
+                slot.type.store(type, std::memory_order_relaxed);
+                slot.shape.store(std::uint64_t{rows} << 32 | cols, std::memory_order_relaxed);
+                slot.bytes.store(bytes, std::memory_order_relaxed);
+                slot.startNs.store(startNs, std::memory_order_relaxed);
+                slot.durationNs.store(endNs - startNs, std::memory_order_relaxed);
+
+                ring->published.store(i + 1, std::memory_order_release);
+            }
+
+            // Oldest event of the ring that is still held and not cleared.
+            std::uint64_t oldestKept(const ThreadRing& ring, std::uint64_t published) noexcept
+            {
+                const std::uint64_t overwritten = published > kTraceRingEvents ? published - kTraceRingEvents : 0;
+                return std::max(overwritten, ring.floor.load(std::memory_order_relaxed));
+            }
+
+            void appendJsonString(std::string& out, const char* s)
+            {
+                out += '"';
+                for (; *s; ++s)
+                {
+                    const unsigned char ch = static_cast<unsigned char>(*s);
+                    if (ch == '"' || ch == '\\')
+                    {
+                        out += '\\';
+                        out += static_cast<char>(ch);
+                    }
+                    else if (ch < 0x20)
+                    {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                        out += escaped;
+                    }
+                    else
+                    {
+                        out += static_cast<char>(ch);
+                    }
+                }
+                out += '"';
+            }
+
+            // Microseconds with three decimals, exact.
+            void appendMicros(std::string& out, std::uint64_t ns)
+            {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "%llu.%03llu", static_cast<unsigned long long>(ns / 1000),
+                              static_cast<unsigned long long>(ns % 1000));
+                out += buffer;
+            }
+
+            std::uint64_t processId() noexcept
+            {
+#if defined(_WIN32)
+                return 0;
+#else
+                return static_cast<std::uint64_t>(getpid());
+#endif
+            }
+        } // namespace
+
+        std::atomic<bool> traceEnabled{enabledFromEnvironment()};
+
+        void TraceScope::open(const char* n, const char* c, const char* t,
+                              std::uint32_t r, std::uint32_t k, std::uint64_t b) noexcept
+        {
+            name = n;
+            category = c;
+            type = t;
+            rows = r;
+            cols = k;
+            bytes = b;
+            startNs = nowNs();
+        }
+
+        void TraceScope::close() noexcept
+        {
+            record(name, category, type, rows, cols, bytes, startNs, nowNs());
+        }
+    } // namespace detail
+
+    bool tracingCompiledIn() noexcept
+    {
+#if defined(BML_TRACING) && BML_TRACING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void setTracingEnabled(bool enabled) noexcept
+    {
+        detail::traceEnabled.store(enabled && tracingCompiledIn(), std::memory_order_relaxed);
+    }
+
+    bool tracingEnabled() noexcept
+    {
+        return detail::traceEnabled.load(std::memory_order_relaxed);
+    }
+
+    std::vector<TraceEvent> traceSnapshot()
+    {
+        std::vector<TraceEvent> events;
+        std::lock_guard<std::mutex> lock(detail::registryMutex());
+        for (const auto& ring : detail::registry())
+        {
+            const std::uint64_t published = ring->published.load(std::memory_order_acquire);
+            const std::uint64_t first = detail::oldestKept(*ring, published);
+            const std::size_t base = events.size();
+
+            for (std::uint64_t i = first; i < published; ++i)
+            {
+                const detail::TraceSlot& slot = ring->slots[i % detail::kTraceRingEvents];
+                TraceEvent e;
+                const char* type = slot.type.load(std::memory_order_relaxed);
+                e.name = slot.name.load(std::memory_order_relaxed);
+                e.category = slot.category.load(std::memory_order_relaxed);
+                e.type = type ? type : "";
+                const std::uint64_t shape = slot.shape.load(std::memory_order_relaxed);
+                e.rows = static_cast<std::uint32_t>(shape >> 32);
+                e.cols = static_cast<std::uint32_t>(shape);
+                e.bytes = slot.bytes.load(std::memory_order_relaxed);
+                e.startNs = slot.startNs.load(std::memory_order_relaxed);
+                e.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+                e.threadId = ring->threadId;
+                events.push_back(std::move(e));
+            }
+
+            // Drop the events whose slots the owner started rewriting while we copied them.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const std::uint64_t claimed = ring->claimed.load(std::memory_order_relaxed);
+            const std::uint64_t reusedBefore = claimed > detail::kTraceRingEvents ? claimed - detail::kTraceRingEvents : 0;
+            if (reusedBefore > first)
+            {
+                const std::size_t stale = static_cast<std::size_t>(std::min(reusedBefore, published) - first);
+                events.erase(events.begin() + static_cast<std::ptrdiff_t>(base),
+                             events.begin() + static_cast<std::ptrdiff_t>(base + stale));
+            }
+        }
+
+        std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+            return a.startNs < b.startNs;
+        });
+        return events;
+    }
+
+    std::uint64_t traceEventsDropped() noexcept
+    {
+        std::lock_guard<std::mutex> lock(detail::registryMutex());
+        std::uint64_t dropped = 0;
+        for (const auto& ring : detail::registry())
+        {
+            const std::uint64_t published = ring->published.load(std::memory_order_acquire);
+            const std::uint64_t floor = ring->floor.load(std::memory_order_relaxed);
+            const std::uint64_t overwritten = published > detail::kTraceRingEvents ? published - detail::kTraceRingEvents : 0;
+            if (overwritten > floor) dropped += overwritten - floor;
+        }
+        return dropped;
+    }
+
+    void clearTrace() noexcept
+    {
+        std::lock_guard<std::mutex> lock(detail::registryMutex());
+        for (const auto& ring : detail::registry())
+            ring->floor.store(ring->published.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+
+    void writeChromeTrace(ByteSink& sink)
+    {
+        const std::vector<TraceEvent> events = traceSnapshot();
+        const std::uint64_t pid = detail::processId();
+
+        std::string out;
+        out.reserve(256 + events.size() * 192);
+        char buffer[160];
+        std::snprintf(buffer, sizeof(buffer),
+                      "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"library\":\"BML %d.%d.%d\",\"dropped\":%llu},"
+                      "\"traceEvents\":[",
+                      BML_VERSION_MAJOR, BML_VERSION_MINOR, BML_VERSION_PATCH,
+                      static_cast<unsigned long long>(traceEventsDropped()));
+        out += buffer;
+
+        for (std::size_t i = 0; i < events.size(); ++i)
+        {
+            const TraceEvent& e = events[i];
+            out += i == 0 ? "\n{\"name\":" : ",\n{\"name\":";
+            detail::appendJsonString(out, e.name.c_str());
+            out += ",\"cat\":";
+            detail::appendJsonString(out, e.category.c_str());
+            out += ",\"ph\":\"X\",\"ts\":";
+            detail::appendMicros(out, e.startNs);
+            out += ",\"dur\":";
+            detail::appendMicros(out, e.durationNs);
+            std::snprintf(buffer, sizeof(buffer), ",\"pid\":%llu,\"tid\":%llu", static_cast<unsigned long long>(pid),
+                          static_cast<unsigned long long>(e.threadId));
+            out += buffer;
+            if (!e.type.empty())
+            {
+                out += ",\"args\":{\"dtype\":";
+                detail::appendJsonString(out, e.type.c_str());
+                std::snprintf(buffer, sizeof(buffer), ",\"rows\":%u,\"cols\":%u,\"bytes\":%llu}", e.rows, e.cols,
+                              static_cast<unsigned long long>(e.bytes));
+                out += buffer;
+            }
+            out += '}';
+
+            if (out.size() >= (std::size_t{1} << 20))
+            {
+                sink.write(out.data(), out.size());
+                out.clear();
+            }
+        }
+        out += "\n]}\n";
+        sink.write(out.data(), out.size());
+        sink.flush();
+    }
+
+    void saveChromeTrace(const std::string& path)
+    {
+        std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+        if (!file) throw std::runtime_error("saveChromeTrace: cannot open '" + path + "' for writing.");
+        FileSink sink(file.get());
+        writeChromeTrace(sink);
+        if (std::fclose(file.release()) != 0) throw std::runtime_error("saveChromeTrace: cannot finish '" + path + "'.");
+    }
+} // namespace bml